@@ -0,0 +1,131 @@
+#ifndef ASYNCRENDERQUEUE_H
+#define ASYNCRENDERQUEUE_H
+
+#include <string>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <exception>
+
+/**
+ * \class AsyncRenderQueue
+ *
+ * Bounded job queue with a single background worker thread, used by the monitoring
+ * tools to draw their plots outside of Execute. Each job consists of a plot type and
+ * an immutable snapshot of the data needed to draw it. Only the newest snapshot per
+ * plot type is kept: publishing a snapshot for a plot type that is still waiting in
+ * the queue replaces the waiting one. If the queue is full, the oldest waiting job is
+ * dropped (drop-oldest policy), so the producer never blocks on rendering.
+ */
+template <class Snapshot> class AsyncRenderQueue{
+
+ public:
+
+  typedef std::function<void(const std::string&, const Snapshot&)> RenderFunction;
+
+  AsyncRenderQueue() : max_jobs(8), running(false), stop_requested(false), n_published(0), n_replaced(0), n_dropped(0), n_rendered(0) {}
+  ~AsyncRenderQueue(){ Stop(false); }
+
+  /// Start the render thread. @param render Function called in the render thread for every job. @param max_queued Maximum number of waiting jobs.
+  void Start(RenderFunction render, unsigned int max_queued){
+    if (running) return;
+    render_function = render;
+    max_jobs = (max_queued > 0) ? max_queued : 1;
+    stop_requested = false;
+    running = true;
+    worker = std::thread(&AsyncRenderQueue::Loop,this);
+  }
+
+  /// Hand a snapshot to the render thread. Never blocks on rendering.
+  void Publish(const std::string &plot_type, std::shared_ptr<const Snapshot> snapshot){
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    n_published++;
+    for (typename std::deque<Job>::iterator it = jobs.begin(); it != jobs.end(); ++it){
+      if (it->plot_type == plot_type){
+        it->snapshot = snapshot;
+        n_replaced++;
+        return;
+      }
+    }
+    if (jobs.size() >= max_jobs){
+      jobs.pop_front();
+      n_dropped++;
+    }
+    Job job;
+    job.plot_type = plot_type;
+    job.snapshot = snapshot;
+    jobs.push_back(job);
+    lock.unlock();
+    queue_condition.notify_one();
+  }
+
+  /// Stop the render thread. @param drain Render the jobs still waiting in the queue before stopping.
+  void Stop(bool drain=true){
+    if (!running) return;
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      if (!drain) {
+        n_dropped += jobs.size();
+        jobs.clear();
+      }
+      stop_requested = true;
+    }
+    queue_condition.notify_one();
+    if (worker.joinable()) worker.join();
+    running = false;
+  }
+
+  bool IsRunning(){ return running; }
+  unsigned long GetNumPublished(){ std::lock_guard<std::mutex> lock(queue_mutex); return n_published; }
+  unsigned long GetNumReplaced(){ std::lock_guard<std::mutex> lock(queue_mutex); return n_replaced; }
+  unsigned long GetNumDropped(){ std::lock_guard<std::mutex> lock(queue_mutex); return n_dropped; }
+  unsigned long GetNumRendered(){ std::lock_guard<std::mutex> lock(queue_mutex); return n_rendered; }
+
+ private:
+
+  struct Job{
+    std::string plot_type;
+    std::shared_ptr<const Snapshot> snapshot;
+  };
+
+  void Loop(){
+    while (true){
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_condition.wait(lock,[this]{return stop_requested || !jobs.empty();});
+        if (jobs.empty()) break;        //only reached when stopping
+        job = jobs.front();
+        jobs.pop_front();
+      }
+      try {
+        render_function(job.plot_type,*job.snapshot);
+      } catch (std::exception &e){
+        std::cout <<"ERROR (AsyncRenderQueue): Rendering of plot type "<<job.plot_type<<" failed: "<<e.what()<<std::endl;
+      }
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      n_rendered++;
+    }
+  }
+
+  RenderFunction render_function;
+  std::deque<Job> jobs;
+  unsigned int max_jobs;
+  std::thread worker;
+  std::mutex queue_mutex;
+  std::condition_variable queue_condition;
+  bool running;
+  bool stop_requested;
+
+  unsigned long n_published;
+  unsigned long n_replaced;
+  unsigned long n_dropped;
+  unsigned long n_rendered;
+
+};
+
+#endif
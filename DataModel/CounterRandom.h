@@ -0,0 +1,62 @@
+/* vim:set noexpandtab tabstop=4 wrap */
+#ifndef CounterRandom_H
+#define CounterRandom_H
+
+#include <stdint.h>
+#include <cmath>
+#include <cstddef>
+
+// Counter-based random numbers, used by the fast PulseSimulation emulation and
+// the synthetic benchmark inputs. Number n of a stream is a hash of (stream key, n),
+// so every card (or channel) has its own stream and the generated data does not
+// depend on the number of threads or the order in which the streams are used.
+// The hash is the splitmix64 finaliser.
+class CounterRandom {
+
+	public:
+	explicit CounterRandom(uint64_t stream_key) : key(Mix(stream_key)), counter(0) {}
+
+	static uint64_t Mix(uint64_t z){
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+
+	// key of the stream for one card in one readout
+	static uint64_t StreamKey(uint64_t seed, uint64_t readout, uint64_t card){
+		return Mix(Mix(Mix(seed) ^ readout) ^ (card + 0x9e3779b97f4a7c15ULL));
+	}
+
+	// uniform in (0,1)
+	double Uniform(){ return ToUnit(Mix(key + 0x9e3779b97f4a7c15ULL*(counter++))); }
+	double Uniform(double low, double high){ return low + (high-low)*Uniform(); }
+
+	// fill n gaussian numbers with mean 0 and the given sigma (Box-Muller on pairs).
+	// The uniforms are hashed in a separate loop without dependencies between iterations,
+	// so both loops can be vectorised by the compiler.
+	void FillGaus(double* out, size_t n, double sigma){
+		const size_t npairs = (n+1)/2;
+		const uint64_t first = counter;
+		for(size_t i=0; i<n; i++) out[i] = ToUnit(Mix(key + 0x9e3779b97f4a7c15ULL*(first+i)));
+		double last_u2 = (n%2) ? ToUnit(Mix(key + 0x9e3779b97f4a7c15ULL*(first+n))) : 0.;
+		counter += 2*npairs;
+		const double twopi = 6.283185307179586;
+		for(size_t p=0; p+1<n; p+=2){
+			double r = sigma*std::sqrt(-2.*std::log(out[p]));
+			double phi = twopi*out[p+1];
+			out[p] = r*std::cos(phi);
+			out[p+1] = r*std::sin(phi);
+		}
+		if(n%2){
+			out[n-1] = sigma*std::sqrt(-2.*std::log(out[n-1]))*std::cos(twopi*last_u2);
+		}
+	}
+
+	private:
+	static double ToUnit(uint64_t bits){ return ((bits >> 11) + 0.5) * (1./9007199254740992.); }
+
+	uint64_t key;
+	uint64_t counter;
+};
+
+#endif
@@ -38,6 +38,7 @@
 #include "LAPPDPulse.h"
 #include "CardData.h"
 #include "TriggerData.h"
+#include "EventArena.h"
 
 #include <zmq.hpp>
 
@@ -72,6 +73,8 @@ class DataModel {
 
   zmq::context_t* context; ///< ZMQ contex used for producing zmq sockets for inter thread,  process, or computer communication
 
+  EventArena Arena; ///< Event scoped memory pools for the per event objects of the Tools, see EventArena.h
+
 
  private:
 
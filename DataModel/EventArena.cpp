@@ -0,0 +1,99 @@
+#include "EventArena.h"
+
+#include <cstdlib>
+
+EventArena::Pool::Pool(const std::string &owner, size_t block_size) : block_size(block_size), current_block(0), offset(0) {
+  stats.owner = owner;
+}
+
+EventArena::Pool::~Pool(){
+  DestroyObjects();
+  for(size_t i=0; i<blocks.size(); i++) std::free(blocks.at(i).data);
+  blocks.clear();
+}
+
+void EventArena::Pool::BeginEvent(){
+  Release();
+  stats.events++;
+}
+
+void EventArena::Pool::Release(){
+  DestroyObjects();
+  current_block = 0;
+  offset = 0;
+  stats.event_allocations = 0;
+  stats.event_bytes = 0;
+}
+
+void EventArena::Pool::DestroyObjects(){
+  // reverse order of construction, like automatic objects
+  for(std::vector<Destructor>::reverse_iterator it=destructors.rbegin(); it!=destructors.rend(); ++it) it->destroy(it->object);
+  destructors.clear();
+}
+
+void* EventArena::Pool::Allocate(size_t bytes, size_t alignment){
+  if(bytes==0) bytes = 1;
+  stats.allocations++;
+  stats.bytes += bytes;
+  stats.event_allocations++;
+  stats.event_bytes += bytes;
+  if(stats.event_bytes>stats.peak_event_bytes) stats.peak_event_bytes = stats.event_bytes;
+
+  // first fit in the current and the following blocks, the blocks are reused every event
+  while(current_block<blocks.size()){
+    Block &block = blocks.at(current_block);
+    uintptr_t address = reinterpret_cast<uintptr_t>(block.data) + offset;
+    size_t padding = (alignment - address%alignment) % alignment;
+    if(offset+padding+bytes<=block.size){
+      offset += padding+bytes;
+      return block.data + offset - bytes;
+    }
+    current_block++;
+    offset = 0;
+  }
+
+  // malloc memory is aligned for any standard type, larger requests get their own block
+  size_t size = (bytes+alignment>block_size) ? bytes+alignment : block_size;
+  Block block;
+  block.data = static_cast<char*>(std::malloc(size));
+  if(block.data==nullptr) throw std::bad_alloc();
+  block.size = size;
+  blocks.push_back(block);
+  stats.reserved_bytes += size;
+  current_block = blocks.size()-1;
+  uintptr_t address = reinterpret_cast<uintptr_t>(block.data);
+  size_t padding = (alignment - address%alignment) % alignment;
+  offset = padding+bytes;
+  return block.data + padding;
+}
+
+
+EventArena::EventArena(size_t block_size) : block_size(block_size) {}
+
+EventArena::~EventArena(){
+  pools.clear();
+}
+
+EventArena::Pool* EventArena::NewPool(const std::string &owner){
+  std::lock_guard<std::mutex> lock(pools_mutex);
+  pools.emplace_back(new Pool(owner,block_size));
+  return pools.back().get();
+}
+
+std::vector<EventArena::Stats> EventArena::GetStats() const {
+  std::lock_guard<std::mutex> lock(pools_mutex);
+  std::vector<Stats> all;
+  for(size_t i=0; i<pools.size(); i++) all.push_back(pools.at(i)->GetStats());
+  return all;
+}
+
+void EventArena::PrintStats(std::ostream &out) const {
+  std::vector<Stats> all = GetStats();
+  for(size_t i=0; i<all.size(); i++){
+    const Stats &stats = all.at(i);
+    double per_event = (stats.events>0) ? double(stats.allocations)/stats.events : 0.;
+    out << "EventArena: " << stats.owner << ": " << stats.events << " events, " << stats.allocations << " allocations ("
+        << per_event << " per event), " << stats.bytes << " bytes, peak " << stats.peak_event_bytes << " bytes per event, "
+        << stats.reserved_bytes << " bytes reserved" << std::endl;
+  }
+}
@@ -0,0 +1,119 @@
+#ifndef EVENTARENA_H
+#define EVENTARENA_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <ostream>
+#include <type_traits>
+
+/**
+ * \class EventArena
+ *
+ * Event scoped memory for the many small objects the reconstruction tools create per event
+ * (cluster digits, seed vertices, scratch arrays). Each tool takes its own Pool from the
+ * DataModel in Initialise and allocates from it instead of new/delete. Calling BeginEvent()
+ * at the start of Execute destroys everything allocated in the previous event at once.
+ * The memory blocks are kept and reused, so after the first events the pools do not touch
+ * the heap at all and their size stays at the largest event seen.
+ *
+ * Objects from a pool live until the next BeginEvent() of the same pool, so they can be
+ * passed to the tools after it within the event. They must not be handed to a store that
+ * takes ownership of its pointers.
+ */
+class EventArena{
+
+ public:
+
+  /// Allocation counters of one pool
+  struct Stats{
+    std::string owner;
+    uint64_t events = 0;              ///< number of BeginEvent calls
+    uint64_t allocations = 0;         ///< total number of allocations
+    uint64_t bytes = 0;               ///< total number of bytes allocated
+    uint64_t event_allocations = 0;   ///< allocations of the current event
+    uint64_t event_bytes = 0;         ///< bytes of the current event
+    uint64_t peak_event_bytes = 0;    ///< largest event_bytes seen
+    uint64_t reserved_bytes = 0;      ///< size of the memory blocks held by the pool
+  };
+
+  class Pool{
+
+   public:
+
+    Pool(const std::string &owner, size_t block_size);
+    ~Pool();
+
+    void BeginEvent();   ///< Destroy all objects of the previous event, keeps the memory
+    void Release();      ///< Same as BeginEvent without counting an event, for Finalise
+
+    /// Construct a T in the pool. Its destructor is called by the next BeginEvent/Release.
+    template<class T, class... Args> T* Create(Args&&... args){
+      void* mem = Allocate(sizeof(T),alignof(T));
+      T* object = new (mem) T(std::forward<Args>(args)...);
+      if(!std::is_trivially_destructible<T>::value) destructors.push_back(Destructor{&Destroy<T>,object});
+      return object;
+    }
+
+    /// Zero initialised array of n trivially destructible T
+    template<class T> T* CreateArray(size_t n){
+      static_assert(std::is_trivially_destructible<T>::value,"EventArena::Pool::CreateArray needs a trivially destructible type");
+      T* array = static_cast<T*>(Allocate(sizeof(T)*n,alignof(T)));
+      for(size_t i=0; i<n; i++) new (array+i) T();
+      return array;
+    }
+
+    void* Allocate(size_t bytes, size_t alignment);
+
+    const Stats& GetStats() const {return stats;}
+
+   private:
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    template<class T> static void Destroy(void* object){static_cast<T*>(object)->~T();}
+
+    struct Block{
+      char* data;
+      size_t size;
+    };
+
+    struct Destructor{
+      void (*destroy)(void*);
+      void* object;
+    };
+
+    void DestroyObjects();
+
+    size_t block_size;
+    std::vector<Block> blocks;
+    size_t current_block;
+    size_t offset;
+    std::vector<Destructor> destructors;
+    Stats stats;
+  };
+
+  EventArena(size_t block_size = 65536);
+  ~EventArena();
+
+  Pool* NewPool(const std::string &owner);   ///< A new pool owned by the arena, one per tool instance
+  std::vector<Stats> GetStats() const;       ///< Statistics of all pools in creation order
+  void PrintStats(std::ostream &out) const;
+
+ private:
+
+  EventArena(const EventArena&) = delete;
+  EventArena& operator=(const EventArena&) = delete;
+
+  size_t block_size;
+  std::vector<std::unique_ptr<Pool>> pools;
+  mutable std::mutex pools_mutex;
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "EventTagTable.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace {
+  const char tag_magic[8] = {'A','N','N','I','E','T','A','G'};
+  const uint32_t tag_version = 1;
+
+  std::string Trim(const std::string &s){
+    size_t first = s.find_first_not_of(" \t");
+    if(first==std::string::npos) return "";
+    size_t last = s.find_last_not_of(" \t");
+    return s.substr(first,last-first+1);
+  }
+}
+
+void EventTagTable::SetColumns(const std::vector<std::string> &names){
+  columns = names;
+  values.clear();
+}
+
+int EventTagTable::GetColumn(const std::string &name) const{
+  for(size_t i=0; i<columns.size(); i++){
+    if(columns[i]==name) return i;
+  }
+  return -1;
+}
+
+bool EventTagTable::Open(const std::string &filename){
+  Close();
+  out.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if(!out.good()) return false;
+  uint32_t ncolumns = columns.size();
+  out.write(tag_magic, sizeof(tag_magic));
+  out.write(reinterpret_cast<const char*>(&tag_version), sizeof(tag_version));
+  out.write(reinterpret_cast<const char*>(&ncolumns), sizeof(ncolumns));
+  for(const std::string &name : columns){
+    uint32_t length = name.size();
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(name.data(), length);
+  }
+  return out.good();
+}
+
+bool EventTagTable::WriteRow(const std::vector<double> &row){
+  if(!out.is_open() || row.size()!=columns.size()) return false;
+  out.write(reinterpret_cast<const char*>(row.data()), row.size()*sizeof(double));
+  return out.good();
+}
+
+void EventTagTable::Close(){
+  if(out.is_open()) out.close();
+}
+
+bool EventTagTable::Read(const std::string &filename){
+  columns.clear();
+  values.clear();
+  std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+  if(!in.good()) return false;
+
+  char magic[8];
+  uint32_t version = 0, ncolumns = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(&version), sizeof(version));
+  in.read(reinterpret_cast<char*>(&ncolumns), sizeof(ncolumns));
+  if(!in.good() || std::memcmp(magic, tag_magic, sizeof(magic))!=0 || version!=tag_version) return false;
+  for(uint32_t i=0; i<ncolumns; i++){
+    uint32_t length = 0;
+    in.read(reinterpret_cast<char*>(&length), sizeof(length));
+    std::string name(length, ' ');
+    if(length>0) in.read(&name[0], length);
+    if(!in.good()) return false;
+    columns.push_back(name);
+  }
+  if(ncolumns==0) return true;
+
+  // rows: up to the end of the file, dropping an incomplete last row
+  std::streampos start = in.tellg();
+  in.seekg(0, std::ios::end);
+  size_t bytes = in.tellg()-start;
+  size_t nrows = bytes/(ncolumns*sizeof(double));
+  in.seekg(start);
+  values.resize(nrows*ncolumns);
+  if(nrows>0) in.read(reinterpret_cast<char*>(values.data()), values.size()*sizeof(double));
+  return in.good();
+}
+
+bool EventTagCut::Parse(const std::string &cuts, const EventTagTable &table, std::string &error){
+  comparisons.clear();
+
+  // split at ',' and "&&"
+  std::vector<std::string> terms;
+  std::string term;
+  for(size_t i=0; i<cuts.size(); i++){
+    if(cuts[i]==',' || (cuts[i]=='&' && i+1<cuts.size() && cuts[i+1]=='&')){
+      terms.push_back(term);
+      term.clear();
+      if(cuts[i]=='&') i++;
+    }
+    else term += cuts[i];
+  }
+  terms.push_back(term);
+
+  static const char* op_names[] = {"==","!=","<=",">=","<",">"};
+  static const Op ops[] = {Equal, NotEqual, LessEqual, GreaterEqual, Less, Greater};
+  for(const std::string &raw : terms){
+    std::string text = Trim(raw);
+    if(text.empty()) continue;
+    size_t pos = std::string::npos;
+    int which = -1;
+    for(int o=0; o<6 && which<0; o++){
+      pos = text.find(op_names[o]);
+      if(pos!=std::string::npos) which = o;
+    }
+    if(which<0){
+      error = "no comparison in \""+text+"\"";
+      return false;
+    }
+    Comparison comparison;
+    std::string name = Trim(text.substr(0,pos));
+    std::string value = Trim(text.substr(pos+std::strlen(op_names[which])));
+    comparison.column = table.GetColumn(name);
+    comparison.op = ops[which];
+    if(comparison.column<0){
+      error = "no tag \""+name+"\"";
+      return false;
+    }
+    try{
+      size_t used = 0;
+      comparison.value = std::stod(value, &used);
+      if(used!=value.size()) throw std::invalid_argument(value);
+    }
+    catch(...){
+      error = "bad value in \""+text+"\"";
+      return false;
+    }
+    comparisons.push_back(comparison);
+  }
+  return true;
+}
+
+bool EventTagCut::Pass(const EventTagTable &table, size_t row) const{
+  for(const Comparison &comparison : comparisons){
+    double tag = table.Get(row, comparison.column);
+    bool pass = true;
+    switch(comparison.op){
+      case Equal:        pass = (tag==comparison.value); break;
+      case NotEqual:     pass = (tag!=comparison.value); break;
+      case Less:         pass = (tag<comparison.value); break;
+      case LessEqual:    pass = (tag<=comparison.value); break;
+      case Greater:      pass = (tag>comparison.value); break;
+      case GreaterEqual: pass = (tag>=comparison.value); break;
+    }
+    if(!pass) return false;
+  }
+  return true;
+}
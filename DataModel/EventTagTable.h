@@ -0,0 +1,76 @@
+#ifndef EVENTTAGTABLE_H
+#define EVENTTAGTABLE_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * \class EventTagTable
+ *
+ * Small per-event summary ("tags") of an ANNIEEvent file, kept in a separate file next to it
+ * (<ANNIEEvent file>.tags), so that a selection can be evaluated without reading the events.
+ *
+ * The table has named double columns; row i describes entry i of the ANNIEEvent file. The file is
+ * written one row at a time while the events are saved:
+ *   "ANNIETAG", uint32 version, uint32 number of columns, per column uint32 length + name,
+ *   then the rows, each number-of-columns doubles.
+ * A file cut short by a crash is read up to its last complete row.
+ */
+class EventTagTable {
+
+ public:
+
+  EventTagTable(){}
+  ~EventTagTable(){Close();}
+
+  void SetColumns(const std::vector<std::string> &names);
+  const std::vector<std::string>& GetColumns() const {return columns;}
+  int GetColumn(const std::string &name) const;   ///< -1 if there is no such column
+
+  /// Writing: open the file and write the header, then one WriteRow per event
+  bool Open(const std::string &filename);
+  bool WriteRow(const std::vector<double> &values);
+  void Close();
+
+  /// Reading: load a whole tag file
+  bool Read(const std::string &filename);
+  size_t GetNRows() const {return columns.empty() ? 0 : values.size()/columns.size();}
+  double Get(size_t row, int column) const {return values[row*columns.size()+column];}
+
+ private:
+
+  std::vector<std::string> columns;
+  std::vector<double> values;   // rows of the table read from a file
+  std::ofstream out;
+
+};
+
+/**
+ * \class EventTagCut
+ *
+ * Selection on the tags: comparisons "<column><op><value>" with op one of == != < <= > >=,
+ * separated by ',' or "&&", all of which must be true.
+ */
+class EventTagCut {
+
+ public:
+
+  /// @return false with a message in error if a comparison can not be parsed or its column is missing
+  bool Parse(const std::string &cuts, const EventTagTable &table, std::string &error);
+  bool Pass(const EventTagTable &table, size_t row) const;
+  bool Empty() const {return comparisons.empty();}
+
+ private:
+
+  enum Op { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+  struct Comparison {
+    int column;
+    Op op;
+    double value;
+  };
+  std::vector<Comparison> comparisons;
+
+};
+
+#endif
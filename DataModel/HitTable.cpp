@@ -0,0 +1,226 @@
+#include "HitTable.h"
+
+#include <algorithm>
+#include <numeric>
+
+void HitTable::Clear(){
+  channels.clear();
+  channel.clear();
+  tube_id.clear();
+  time.clear();
+  charge.clear();
+  parent_offset.clear();
+  parents.clear();
+  channel_begin.clear();
+  channel_rows.clear();
+}
+
+void HitTable::Fill(const std::map<unsigned long, std::vector<Hit>> &hits){
+  Clear();
+  FillRows(hits);
+  SortByTime();
+  BuildChannelIndex();
+}
+
+void HitTable::Fill(const std::map<unsigned long, std::vector<MCHit>> &hits){
+  Clear();
+  parent_offset.push_back(0);
+  FillRows(hits);
+  SortByTime();
+  BuildChannelIndex();
+}
+
+template<class HitType> void HitTable::FillRows(const std::map<unsigned long, std::vector<HitType>> &hits){
+  size_t nhits = 0;
+  for(const std::pair<const unsigned long, std::vector<HitType>> &apair : hits) nhits += apair.second.size();
+  channels.reserve(hits.size());
+  channel.reserve(nhits);
+  tube_id.reserve(nhits);
+  time.reserve(nhits);
+  charge.reserve(nhits);
+
+  for(const std::pair<const unsigned long, std::vector<HitType>> &apair : hits){
+    uint32_t ichannel = channels.size();
+    channels.push_back(apair.first);
+    for(const HitType &ahit : apair.second){
+      channel.push_back(ichannel);
+      tube_id.push_back(ahit.GetTubeId());
+      time.push_back(ahit.GetTime());
+      charge.push_back(ahit.GetCharge());
+      AddParents(ahit);
+    }
+  }
+}
+
+void HitTable::AddParents(const MCHit &hit){
+  const std::vector<int>* hitparents = hit.GetParents();
+  parents.insert(parents.end(),hitparents->begin(),hitparents->end());
+  parent_offset.push_back(parents.size());
+}
+
+void HitTable::SortByTime(){
+  size_t nhits = time.size();
+  if(std::is_sorted(time.begin(),time.end())) return;
+
+  // stable, so hits at the same time stay in channel order
+  order.resize(nhits);
+  std::iota(order.begin(),order.end(),0);
+  std::stable_sort(order.begin(),order.end(),[this](uint32_t a, uint32_t b){return time[a]<time[b];});
+
+  scratch_double.resize(nhits);
+  for(size_t i=0; i<nhits; i++) scratch_double[i] = time[order[i]];
+  time.swap(scratch_double);
+  for(size_t i=0; i<nhits; i++) scratch_double[i] = charge[order[i]];
+  charge.swap(scratch_double);
+  scratch_u32.resize(nhits);
+  for(size_t i=0; i<nhits; i++) scratch_u32[i] = channel[order[i]];
+  channel.swap(scratch_u32);
+  scratch_int.resize(nhits);
+  for(size_t i=0; i<nhits; i++) scratch_int[i] = tube_id[order[i]];
+  tube_id.swap(scratch_int);
+
+  if(!parent_offset.empty()){
+    scratch_int.clear();
+    scratch_u32.resize(nhits+1);
+    scratch_u32[0] = 0;
+    for(size_t i=0; i<nhits; i++){
+      scratch_int.insert(scratch_int.end(),parents.begin()+parent_offset[order[i]],parents.begin()+parent_offset[order[i]+1]);
+      scratch_u32[i+1] = scratch_int.size();
+    }
+    parents.swap(scratch_int);
+    parent_offset.swap(scratch_u32);
+  }
+}
+
+void HitTable::BuildChannelIndex(){
+  // counting sort of the rows by channel, rows stay in time order within a channel
+  size_t nhits = time.size();
+  channel_begin.assign(channels.size()+1,0);
+  for(size_t i=0; i<nhits; i++) channel_begin[channel[i]+1]++;
+  for(size_t c=0; c<channels.size(); c++) channel_begin[c+1] += channel_begin[c];
+  channel_rows.resize(nhits);
+  order.assign(channel_begin.begin(),channel_begin.end()-1);
+  for(size_t i=0; i<nhits; i++) channel_rows[order[channel[i]]++] = i;
+}
+
+const int* HitTable::GetParents(size_t row, size_t &nparents) const {
+  if(parent_offset.empty()){
+    nparents = 0;
+    return nullptr;
+  }
+  nparents = parent_offset[row+1]-parent_offset[row];
+  return parents.data()+parent_offset[row];
+}
+
+Hit HitTable::GetHit(size_t row) const {
+  return Hit(tube_id[row],time[row],charge[row]);
+}
+
+MCHit HitTable::GetMCHit(size_t row) const {
+  size_t nparents = 0;
+  const int* hitparents = GetParents(row,nparents);
+  std::vector<int> parentvector;
+  if(nparents>0) parentvector.assign(hitparents,hitparents+nparents);
+  return MCHit(tube_id[row],time[row],charge[row],parentvector);
+}
+
+void HitTable::GetChannelRows(uint32_t ichannel, size_t &begin, size_t &end) const {
+  begin = channel_begin[ichannel];
+  end = channel_begin[ichannel+1];
+}
+
+void HitTable::GetTimeWindow(double tmin, double tmax, size_t &begin, size_t &end) const {
+  begin = std::lower_bound(time.begin(),time.end(),tmin) - time.begin();
+  end = std::upper_bound(time.begin()+begin,time.end(),tmax) - time.begin();
+}
+
+void HitTable::ToMap(std::map<unsigned long, std::vector<Hit>> &hits) const {
+  hits.clear();
+  for(uint32_t c=0; c<channels.size(); c++){
+    std::vector<Hit> &channelhits = hits[channels[c]];
+    channelhits.reserve(channel_begin[c+1]-channel_begin[c]);
+    for(uint32_t r=channel_begin[c]; r<channel_begin[c+1]; r++) channelhits.push_back(GetHit(channel_rows[r]));
+  }
+}
+
+void HitTable::ToMap(std::map<unsigned long, std::vector<MCHit>> &hits) const {
+  hits.clear();
+  for(uint32_t c=0; c<channels.size(); c++){
+    std::vector<MCHit> &channelhits = hits[channels[c]];
+    channelhits.reserve(channel_begin[c+1]-channel_begin[c]);
+    for(uint32_t r=channel_begin[c]; r<channel_begin[c+1]; r++) channelhits.push_back(GetMCHit(channel_rows[r]));
+  }
+}
+
+void HitTable::Pack(){
+  size_t nhits = GetNHits();
+  packed_nhits.resize(channels.size());
+  packed_tube_per_channel = true;
+  for(uint32_t c=0; c<channels.size(); c++){
+    packed_nhits[c] = channel_begin[c+1]-channel_begin[c];
+    for(uint32_t r=channel_begin[c]+1; r<channel_begin[c+1]; r++){
+      if(tube_id[channel_rows[r]]!=tube_id[channel_rows[channel_begin[c]]]) packed_tube_per_channel = false;
+    }
+  }
+  packed_tube_id.clear();
+  if(packed_tube_per_channel){
+    for(uint32_t c=0; c<channels.size(); c++){
+      packed_tube_id.push_back((packed_nhits[c]>0) ? tube_id[channel_rows[channel_begin[c]]] : 0);
+    }
+  } else {
+    for(size_t r=0; r<nhits; r++) packed_tube_id.push_back(tube_id[channel_rows[r]]);
+  }
+  packed_time.resize(nhits);
+  packed_charge.resize(nhits);
+  for(size_t r=0; r<nhits; r++){
+    packed_time[r] = time[channel_rows[r]];
+    packed_charge[r] = charge[channel_rows[r]];
+  }
+  packed_has_parents = !parent_offset.empty();
+  packed_nparents.clear();
+  packed_parents.clear();
+  if(packed_has_parents){
+    packed_nparents.resize(nhits);
+    for(size_t r=0; r<nhits; r++){
+      uint32_t row = channel_rows[r];
+      packed_nparents[r] = parent_offset[row+1]-parent_offset[row];
+      packed_parents.insert(packed_parents.end(),parents.begin()+parent_offset[row],parents.begin()+parent_offset[row+1]);
+    }
+  }
+}
+
+void HitTable::Unpack(){
+  std::vector<unsigned long> loaded_channels;
+  loaded_channels.swap(channels);
+  Clear();
+  channels.swap(loaded_channels);
+  size_t nhits = packed_time.size();
+  channel.reserve(nhits);
+  tube_id.reserve(nhits);
+  for(uint32_t c=0; c<packed_nhits.size(); c++){
+    for(uint32_t i=0; i<packed_nhits[c]; i++){
+      channel.push_back(c);
+      tube_id.push_back(packed_tube_per_channel ? packed_tube_id[c] : packed_tube_id[tube_id.size()]);
+    }
+  }
+  time.assign(packed_time.begin(),packed_time.end());
+  charge.assign(packed_charge.begin(),packed_charge.end());
+  if(packed_has_parents){
+    parents.assign(packed_parents.begin(),packed_parents.end());
+    parent_offset.resize(nhits+1);
+    parent_offset[0] = 0;
+    for(size_t r=0; r<nhits; r++) parent_offset[r+1] = parent_offset[r]+packed_nparents[r];
+  }
+  SortByTime();
+  BuildChannelIndex();
+}
+
+bool HitTable::Print(){
+  std::cout<<"HitTable: "<<GetNHits()<<" hits on "<<channels.size()<<" channels";
+  if(!parent_offset.empty()) std::cout<<", "<<parents.size()<<" MC parents";
+  std::cout<<std::endl;
+  for(size_t i=0; i<GetNHits(); i++){
+    std::cout<<"  channel "<<GetChannelKey(i)<<", tube "<<tube_id[i]<<", time "<<time[i]<<", charge "<<charge[i]<<std::endl;
+  }
+  return true;
+}
@@ -0,0 +1,122 @@
+#ifndef HITTABLE_H
+#define HITTABLE_H
+
+#include <SerialisableObject.h>
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+#include "Hit.h"
+
+/**
+ * \class HitTable
+ *
+ * Column store of the hits of one event, as an alternative to the
+ * std::map<unsigned long, std::vector<Hit>> form of the ANNIEEvent. The hits are kept in
+ * flat arrays sorted by time; row i is made of the entries i of the channel, tube id, time
+ * and charge columns, and its MC parents are parents[parent_offset[i]..parent_offset[i+1]).
+ * The channel index gives the rows of each channel, in time order.
+ *
+ * Fill() converts from the map form and ToMap() back; within a channel ToMap gives the hits
+ * in time order. Refilling a table reuses its memory, so per event there is no allocation
+ * once the table has seen the largest event. The serialised form stores the hits grouped by
+ * channel with the time and charge arrays and, for MC, the parent counts; the time order and
+ * the channel index are rebuilt on reading.
+ */
+class HitTable : public SerialisableObject {
+
+  friend class boost::serialization::access;
+
+ public:
+
+  HitTable(){serialise=true;}
+
+  void Clear();
+  void Fill(const std::map<unsigned long, std::vector<Hit>> &hits);
+  void Fill(const std::map<unsigned long, std::vector<MCHit>> &hits);   ///< also fills the parent columns
+  void ToMap(std::map<unsigned long, std::vector<Hit>> &hits) const;
+  void ToMap(std::map<unsigned long, std::vector<MCHit>> &hits) const;
+
+  size_t GetNHits() const {return time.size();}
+  unsigned long GetChannelKey(size_t row) const {return channels[channel[row]];}
+  uint32_t GetChannelIndex(size_t row) const {return channel[row];}
+  int GetTubeId(size_t row) const {return tube_id[row];}
+  double GetTime(size_t row) const {return time[row];}
+  double GetCharge(size_t row) const {return charge[row];}
+  const int* GetParents(size_t row, size_t &nparents) const;
+  Hit GetHit(size_t row) const;
+  MCHit GetMCHit(size_t row) const;
+
+  /// Columns, for loops over all hits
+  const std::vector<double>& Times() const {return time;}
+  const std::vector<double>& Charges() const {return charge;}
+
+  /// Channels of the input map in key order, including channels without hits
+  const std::vector<unsigned long>& GetChannels() const {return channels;}
+  /// Rows of the hits of channel number ichannel are channel_rows[begin..end)
+  void GetChannelRows(uint32_t ichannel, size_t &begin, size_t &end) const;
+  const std::vector<uint32_t>& GetChannelRowIndex() const {return channel_rows;}
+
+  /// First and last+1 row with tmin <= time <= tmax
+  void GetTimeWindow(double tmin, double tmax, size_t &begin, size_t &end) const;
+
+  bool Print();
+
+ private:
+
+  template<class HitType> void FillRows(const std::map<unsigned long, std::vector<HitType>> &hits);
+  void AddParents(const Hit &hit){}
+  void AddParents(const MCHit &hit);
+  void SortByTime();
+  void BuildChannelIndex();
+
+  // columns
+  std::vector<unsigned long> channels;   // channel keys, index of the channel column
+  std::vector<uint32_t> channel;
+  std::vector<int> tube_id;
+  std::vector<double> time;
+  std::vector<double> charge;
+  std::vector<uint32_t> parent_offset;   // size GetNHits()+1, empty for data hits
+  std::vector<int> parents;
+
+  // channel index: rows of channel c are channel_rows[channel_begin[c]..channel_begin[c+1])
+  std::vector<uint32_t> channel_begin;
+  std::vector<uint32_t> channel_rows;
+
+  // scratch space of the sort, kept between events
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> scratch_u32;
+  std::vector<int> scratch_int;
+  std::vector<double> scratch_double;
+
+  // serialised form: rows in channel order, so the channel column is replaced by the number
+  // of hits per channel, and the tube id is stored once per channel when it is the same for all its hits
+  void Pack();
+  void Unpack();
+  std::vector<uint32_t> packed_nhits;
+  bool packed_tube_per_channel = true;
+  std::vector<int> packed_tube_id;
+  std::vector<double> packed_time;
+  std::vector<double> packed_charge;
+  bool packed_has_parents = false;
+  std::vector<uint32_t> packed_nparents;
+  std::vector<int> packed_parents;
+
+  template<class Archive> void serialize(Archive & ar, const unsigned int version){
+    if(serialise){
+      if(Archive::is_saving::value) Pack();
+      ar & channels;
+      ar & packed_nhits;
+      ar & packed_tube_per_channel;
+      ar & packed_tube_id;
+      ar & packed_time;
+      ar & packed_charge;
+      ar & packed_has_parents;
+      ar & packed_nparents;
+      ar & packed_parents;
+      if(Archive::is_loading::value) Unpack();
+    }
+  }
+};
+
+#endif
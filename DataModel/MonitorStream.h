@@ -0,0 +1,63 @@
+#ifndef MONITORSTREAM_H
+#define MONITORSTREAM_H
+
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <zmq.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/string.hpp>
+
+/**
+ * Wire format of the streaming monitoring data path (MonitorReceive Mode Stream).
+ *
+ * The DAQ side publishes one ZMQ multipart message per batch of raw data entries on the MonitorData
+ * socket. Frame 0 is the data type, every following frame is one entry serialised with a boost
+ * binary archive:
+ *   "PMTData"   std::vector<CardData>, one entry of the PMTData store of a raw file
+ *   "CCData"    MRDOut, one entry of the CCData store
+ *   "TrigData"  TriggerData, one entry of the TrigData store
+ * The type names differ from the "DataFile"/"MRDSingle" commands of the file hand-off, so both can
+ * share a socket. MonitorSimStream is a publisher stand-in that replays raw files in this format.
+ */
+namespace MonitorStream{
+
+  const std::string PMTType = "PMTData";
+  const std::string MRDType = "CCData";
+  const std::string TrigType = "TrigData";
+
+  template<class T> void Pack(const T &entry, zmq::message_t &frame){
+    std::ostringstream buffer(std::ios::out | std::ios::binary);
+    {
+      boost::archive::binary_oarchive oa(buffer, boost::archive::no_header);
+      oa << entry;
+    }
+    const std::string &bytes = buffer.str();
+    frame.rebuild(bytes.size());
+    std::memcpy(frame.data(), bytes.data(), bytes.size());
+  }
+
+  /// Throws a boost::archive::archive_exception if the frame does not hold a T
+  template<class T> void Unpack(zmq::message_t &frame, T &entry){
+    std::istringstream buffer(std::string(static_cast<const char*>(frame.data()), frame.size()), std::ios::in | std::ios::binary);
+    boost::archive::binary_iarchive ia(buffer, boost::archive::no_header);
+    ia >> entry;
+  }
+
+  inline void TypeFrame(const std::string &type, zmq::message_t &frame){
+    frame.rebuild(type.size());
+    std::memcpy(frame.data(), type.data(), type.size());
+  }
+
+  /// The file hand-off commands are sent as C strings, so a trailing 0 is ignored
+  inline std::string GetType(zmq::message_t &frame){
+    std::string type(static_cast<const char*>(frame.data()), frame.size());
+    while (!type.empty() && type.back()=='\0') type.pop_back();
+    return type;
+  }
+
+}
+
+#endif
@@ -0,0 +1,363 @@
+#include "MonitoringHistory.h"
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+
+namespace {
+  const char history_magic[8] = {'A','N','N','I','E','M','H','S'};
+  const uint32_t history_version = 1;
+  //header: magic, version, nchannels, nchannelvars, nscalarvars, width
+  const std::streamoff history_header_size = 8 + 4*sizeof(uint32_t) + sizeof(uint64_t);
+  //record prefix: key, t_start, t_end, n_entries, padding
+  const std::size_t history_record_prefix = 3*sizeof(uint64_t) + 2*sizeof(uint32_t);
+}
+
+MonitoringHistory::MonitoringHistory() : nchannels(0), is_open(false), payload_size(0), record_size(0), flush_interval(60.) {}
+
+MonitoringHistory::~MonitoringHistory(){
+  Close();
+  for (unsigned int i_level = 0; i_level < levels.size(); i_level++) delete levels.at(i_level);
+  levels.clear();
+}
+
+void MonitoringHistory::AddChannelVariable(std::string name, Aggregation mode){
+  if (is_open) {
+    std::cout <<"ERROR (MonitoringHistory): Cannot add variable "<<name<<" to an open history store"<<std::endl;
+    return;
+  }
+  channel_variables.push_back(name);
+  channel_modes.push_back(mode);
+}
+
+void MonitoringHistory::AddScalarVariable(std::string name, Aggregation mode){
+  if (is_open) {
+    std::cout <<"ERROR (MonitoringHistory): Cannot add variable "<<name<<" to an open history store"<<std::endl;
+    return;
+  }
+  scalar_variables.push_back(name);
+  scalar_modes.push_back(mode);
+}
+
+void MonitoringHistory::AddLevel(uint64_t width_msec){
+  if (is_open || width_msec == 0) {
+    std::cout <<"ERROR (MonitoringHistory): Cannot add level of width "<<width_msec<<" msec"<<std::endl;
+    return;
+  }
+  //keep the levels sorted from the finest to the coarsest resolution
+  Level *level = new Level;
+  level->width = width_msec;
+  level->file = nullptr;
+  level->num_records = 0;
+  std::vector<Level*>::iterator it = levels.begin();
+  while (it != levels.end() && (*it)->width < width_msec) ++it;
+  if (it != levels.end() && (*it)->width == width_msec) {
+    delete level;
+    return;
+  }
+  levels.insert(it,level);
+}
+
+bool MonitoringHistory::Open(std::string path_prefix, int num_channels){
+
+  if (is_open) Close();
+  if (levels.empty()) {
+    std::cout <<"ERROR (MonitoringHistory): No rollup levels defined, cannot open "<<path_prefix<<std::endl;
+    return false;
+  }
+
+  prefix = path_prefix;
+  nchannels = num_channels;
+  payload_size = 1 + channel_variables.size()*nchannels + scalar_variables.size();
+  record_size = history_record_prefix + payload_size*sizeof(double);
+
+  for (unsigned int i_level = 0; i_level < levels.size(); i_level++){
+    std::stringstream ss_filename;
+    ss_filename << prefix << "_" << levels.at(i_level)->width/1000 << "s.bin";
+    levels.at(i_level)->filename = ss_filename.str();
+    if (!OpenLevel(levels.at(i_level))) {
+      Close();
+      return false;
+    }
+  }
+
+  is_open = true;
+  last_flush = std::chrono::steady_clock::now();
+  return true;
+
+}
+
+bool MonitoringHistory::OpenLevel(Level *level){
+
+  level->index.clear();
+  level->num_records = 0;
+  level->file = new std::fstream(level->filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+
+  bool recreate = !level->file->is_open();
+  if (!recreate){
+    char magic[8];
+    uint32_t version, file_nchannels, file_nchvars, file_nscalars;
+    uint64_t width;
+    level->file->read(magic,8);
+    level->file->read((char*)&version,sizeof(uint32_t));
+    level->file->read((char*)&file_nchannels,sizeof(uint32_t));
+    level->file->read((char*)&file_nchvars,sizeof(uint32_t));
+    level->file->read((char*)&file_nscalars,sizeof(uint32_t));
+    level->file->read((char*)&width,sizeof(uint64_t));
+    if (!level->file->good() || std::memcmp(magic,history_magic,8) != 0 || version != history_version ||
+        int(file_nchannels) != nchannels || file_nchvars != channel_variables.size() ||
+        file_nscalars != scalar_variables.size() || width != level->width) {
+      std::cout <<"WARNING (MonitoringHistory): History file "<<level->filename<<" has an incompatible layout (channel configuration changed?). Starting a new history."<<std::endl;
+      recreate = true;
+    } else {
+      //build the in-memory bucket index, skipping the payloads
+      level->file->seekg(0,std::ios::end);
+      std::streamoff file_size = level->file->tellg();
+      int64_t num_records = (file_size - history_header_size) / std::streamoff(record_size);
+      for (int64_t i_record = 0; i_record < num_records; i_record++){
+        uint64_t key;
+        BucketIndex bucket;
+        uint32_t padding;
+        level->file->seekg(RecordOffset(i_record));
+        level->file->read((char*)&key,sizeof(uint64_t));
+        level->file->read((char*)&bucket.t_start,sizeof(uint64_t));
+        level->file->read((char*)&bucket.t_end,sizeof(uint64_t));
+        level->file->read((char*)&bucket.n_entries,sizeof(uint32_t));
+        level->file->read((char*)&padding,sizeof(uint32_t));
+        if (!level->file->good()) break;
+        bucket.record = i_record;
+        level->index[key] = bucket;
+        level->num_records = i_record+1;
+      }
+      level->file->clear();
+    }
+  }
+
+  if (recreate){
+    if (level->file->is_open()) level->file->close();
+    level->file->open(level->filename.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!level->file->is_open()){
+      std::cout <<"ERROR (MonitoringHistory): Could not create history file "<<level->filename<<std::endl;
+      delete level->file;
+      level->file = nullptr;
+      return false;
+    }
+    uint32_t version = history_version;
+    uint32_t file_nchannels = nchannels;
+    uint32_t file_nchvars = channel_variables.size();
+    uint32_t file_nscalars = scalar_variables.size();
+    level->file->write(history_magic,8);
+    level->file->write((char*)&version,sizeof(uint32_t));
+    level->file->write((char*)&file_nchannels,sizeof(uint32_t));
+    level->file->write((char*)&file_nchvars,sizeof(uint32_t));
+    level->file->write((char*)&file_nscalars,sizeof(uint32_t));
+    level->file->write((char*)&level->width,sizeof(uint64_t));
+    level->file->flush();
+  }
+
+  return level->file->good();
+
+}
+
+void MonitoringHistory::Flush(){
+
+  for (unsigned int i_level = 0; i_level < levels.size(); i_level++){
+    Level *level = levels.at(i_level);
+    if (level->file && level->file->is_open()) level->file->flush();
+  }
+  last_flush = std::chrono::steady_clock::now();
+
+}
+
+void MonitoringHistory::Close(){
+
+  for (unsigned int i_level = 0; i_level < levels.size(); i_level++){
+    Level *level = levels.at(i_level);
+    if (level->file){
+      if (level->file->is_open()) level->file->close();
+      delete level->file;
+      level->file = nullptr;
+    }
+    level->index.clear();
+    level->num_records = 0;
+  }
+  is_open = false;
+
+}
+
+std::streamoff MonitoringHistory::RecordOffset(int64_t record){
+  return history_header_size + std::streamoff(record)*std::streamoff(record_size);
+}
+
+bool MonitoringHistory::ReadRecord(Level *level, int64_t record, std::vector<double> &payload){
+
+  payload.resize(payload_size);
+  level->file->seekg(RecordOffset(record)+std::streamoff(history_record_prefix));
+  level->file->read((char*)payload.data(),payload_size*sizeof(double));
+  if (!level->file->good()){
+    level->file->clear();
+    return false;
+  }
+  return true;
+
+}
+
+bool MonitoringHistory::WriteRecord(Level *level, int64_t record, uint64_t key, const BucketIndex &bucket, const std::vector<double> &payload){
+
+  uint32_t padding = 0;
+  level->file->seekp(RecordOffset(record));
+  level->file->write((char*)&key,sizeof(uint64_t));
+  level->file->write((char*)&bucket.t_start,sizeof(uint64_t));
+  level->file->write((char*)&bucket.t_end,sizeof(uint64_t));
+  level->file->write((char*)&bucket.n_entries,sizeof(uint32_t));
+  level->file->write((char*)&padding,sizeof(uint32_t));
+  level->file->write((const char*)payload.data(),payload_size*sizeof(double));
+  if (!level->file->good()){
+    level->file->clear();
+    return false;
+  }
+  return true;
+
+}
+
+bool MonitoringHistory::Add(uint64_t t_start, uint64_t t_end, const std::vector<std::vector<double>> &channel_values, const std::vector<double> &scalar_values){
+
+  if (!is_open) return false;
+  if (channel_values.size() != channel_variables.size() || scalar_values.size() != scalar_variables.size()){
+    std::cout <<"ERROR (MonitoringHistory): Add: Number of variables does not match the registered variables"<<std::endl;
+    return false;
+  }
+  for (unsigned int i_var = 0; i_var < channel_values.size(); i_var++){
+    if (int(channel_values.at(i_var).size()) != nchannels){
+      std::cout <<"ERROR (MonitoringHistory): Add: Variable "<<channel_variables.at(i_var)<<" has "<<channel_values.at(i_var).size()<<" channels, expected "<<nchannels<<std::endl;
+      return false;
+    }
+  }
+
+  //mean variables are weighted with the duration of the entry, zero-length entries get unit weight
+  double weight = (t_end > t_start) ? double(t_end - t_start) : 1.;
+
+  bool success = true;
+  std::vector<double> payload;
+  for (unsigned int i_level = 0; i_level < levels.size(); i_level++){
+
+    Level *level = levels.at(i_level);
+    uint64_t key = (t_start / level->width) * level->width;
+    BucketIndex bucket;
+
+    std::map<uint64_t,BucketIndex>::iterator it = level->index.find(key);
+    if (it != level->index.end()){
+      bucket = it->second;
+      if (!ReadRecord(level,bucket.record,payload)) {
+        std::cout <<"ERROR (MonitoringHistory): Could not read bucket "<<key<<" from "<<level->filename<<std::endl;
+        success = false;
+        continue;
+      }
+      if (t_start < bucket.t_start) bucket.t_start = t_start;
+      if (t_end > bucket.t_end) bucket.t_end = t_end;
+      bucket.n_entries++;
+    } else {
+      payload.assign(payload_size,0.);
+      bucket.t_start = t_start;
+      bucket.t_end = t_end;
+      bucket.n_entries = 1;
+      bucket.record = level->num_records;
+    }
+
+    payload.at(0) += weight;
+    std::size_t offset = 1;
+    for (unsigned int i_var = 0; i_var < channel_variables.size(); i_var++){
+      double scale = (channel_modes.at(i_var) == kMean) ? weight : 1.;
+      const std::vector<double> &values = channel_values.at(i_var);
+      for (int i_ch = 0; i_ch < nchannels; i_ch++) payload[offset+i_ch] += scale*values[i_ch];
+      offset += nchannels;
+    }
+    for (unsigned int i_var = 0; i_var < scalar_variables.size(); i_var++){
+      double scale = (scalar_modes.at(i_var) == kMean) ? weight : 1.;
+      payload[offset+i_var] += scale*scalar_values.at(i_var);
+    }
+
+    if (!WriteRecord(level,bucket.record,key,bucket,payload)){
+      std::cout <<"ERROR (MonitoringHistory): Could not write bucket "<<key<<" to "<<level->filename<<std::endl;
+      success = false;
+      continue;
+    }
+    if (bucket.record == level->num_records) level->num_records++;
+    level->index[key] = bucket;
+  }
+
+  if (std::chrono::duration<double>(std::chrono::steady_clock::now() - last_flush).count() >= flush_interval) Flush();
+
+  return success;
+
+}
+
+int MonitoringHistory::Query(uint64_t t_start, uint64_t t_end, unsigned int max_points, std::vector<MonitoringHistoryPoint> &points){
+
+  points.clear();
+  if (!is_open || t_end < t_start) return -1;
+
+  //select the finest level that resolves the window with at most max_points buckets.
+  //Counting stops at max_points+1, so the selection is bounded by the number of points as well
+  int selected_level = int(levels.size()) - 1;
+  for (unsigned int i_level = 0; i_level < levels.size(); i_level++){
+    Level *level = levels.at(i_level);
+    uint64_t first_key = (t_start / level->width) * level->width;
+    unsigned int n_buckets = 0;
+    std::map<uint64_t,BucketIndex>::iterator it = level->index.lower_bound(first_key);
+    for (; it != level->index.end() && it->first <= t_end && n_buckets <= max_points; ++it) n_buckets++;
+    if (n_buckets <= max_points){
+      selected_level = i_level;
+      break;
+    }
+  }
+
+  Level *level = levels.at(selected_level);
+  uint64_t first_key = (t_start / level->width) * level->width;
+  std::vector<double> payload;
+  std::map<uint64_t,BucketIndex>::iterator it = level->index.lower_bound(first_key);
+  for (; it != level->index.end() && it->first <= t_end; ++it){
+
+    const BucketIndex &bucket = it->second;
+    //buckets are assigned to the window by their center to avoid a bias at the edges
+    uint64_t center = bucket.t_start + (bucket.t_end - bucket.t_start)/2;
+    if (center < t_start || center > t_end) continue;
+    if (!ReadRecord(level,bucket.record,payload)) {
+      std::cout <<"ERROR (MonitoringHistory): Could not read bucket "<<it->first<<" from "<<level->filename<<std::endl;
+      continue;
+    }
+
+    MonitoringHistoryPoint point;
+    point.t_start = bucket.t_start;
+    point.t_end = bucket.t_end;
+    point.n_entries = bucket.n_entries;
+    double weight = (payload.at(0) > 0.) ? payload.at(0) : 1.;
+    std::size_t offset = 1;
+    point.channel_values.resize(channel_variables.size());
+    for (unsigned int i_var = 0; i_var < channel_variables.size(); i_var++){
+      double norm = (channel_modes.at(i_var) == kMean) ? 1./weight : 1.;
+      std::vector<double> &values = point.channel_values.at(i_var);
+      values.resize(nchannels);
+      for (int i_ch = 0; i_ch < nchannels; i_ch++) values[i_ch] = payload[offset+i_ch]*norm;
+      offset += nchannels;
+    }
+    point.scalar_values.resize(scalar_variables.size());
+    for (unsigned int i_var = 0; i_var < scalar_variables.size(); i_var++){
+      double norm = (scalar_modes.at(i_var) == kMean) ? 1./weight : 1.;
+      point.scalar_values.at(i_var) = payload[offset+i_var]*norm;
+    }
+    points.push_back(point);
+  }
+
+  return selected_level;
+
+}
+
+bool MonitoringHistory::IsEmpty(){
+
+  for (unsigned int i_level = 0; i_level < levels.size(); i_level++){
+    if (!levels.at(i_level)->index.empty()) return false;
+  }
+  return true;
+
+}
@@ -0,0 +1,104 @@
+#ifndef MONITORINGHISTORY_H
+#define MONITORINGHISTORY_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <chrono>
+
+/**
+ * \struct MonitoringHistoryPoint
+ *
+ * One point of a monitoring time-series as returned by MonitoringHistory::Query.
+ * Per-channel values are indexed [variable][channel] in the order the variables
+ * were registered with the store.
+ */
+struct MonitoringHistoryPoint{
+  uint64_t t_start;                                   ///< earliest start time of all entries in the point (msec)
+  uint64_t t_end;                                     ///< latest end time of all entries in the point (msec)
+  uint32_t n_entries;                                 ///< number of monitoring entries merged into the point
+  std::vector<std::vector<double>> channel_values;    ///< [variable][channel]
+  std::vector<double> scalar_values;                  ///< [variable]
+};
+
+/**
+ * \class MonitoringHistory
+ *
+ * Multi-resolution store for monitoring time-series. Every entry added to the store
+ * is folded into pre-aggregated rollup buckets of each configured width (e.g. 1 min,
+ * 10 min, 1 h, 1 day). Each resolution level lives in its own binary file with
+ * fixed-size records, only the bucket index is kept in memory. Range queries pick
+ * the finest level that yields at most the requested number of points and read
+ * exactly those records, so the cost scales with the number of plotted points
+ * rather than with the number of raw entries in the time window.
+ *
+ * Variables aggregated as kMean are averaged weighted by the entry duration,
+ * variables aggregated as kSum are summed up.
+ *
+ * Writes are buffered by the level files and flushed to disk at most every
+ * flush interval (default 60 s), on Flush() and on Close().
+ */
+class MonitoringHistory{
+
+ public:
+
+  enum Aggregation {kMean, kSum};
+
+  MonitoringHistory();
+  ~MonitoringHistory();
+
+  void AddChannelVariable(std::string name, Aggregation mode);   ///< Register a per-channel variable. Must be called before Open.
+  void AddScalarVariable(std::string name, Aggregation mode);    ///< Register a global variable. Must be called before Open.
+  void AddLevel(uint64_t width_msec);                            ///< Register a rollup level. Must be called before Open.
+  bool Open(std::string path_prefix, int num_channels);          ///< Open (or create) the level files <path_prefix>_<width>s.bin
+  void Close();
+  void Flush();                                                  ///< Write the buffered records of all levels to disk
+  void SetFlushInterval(double seconds){flush_interval = seconds;}
+
+  bool Add(uint64_t t_start, uint64_t t_end, const std::vector<std::vector<double>> &channel_values, const std::vector<double> &scalar_values);   ///< Fold one monitoring entry into all rollup levels
+  int Query(uint64_t t_start, uint64_t t_end, unsigned int max_points, std::vector<MonitoringHistoryPoint> &points);   ///< Fill points for the time window, returns the selected level (-1 on error)
+  bool IsEmpty();
+  uint64_t GetLevelWidth(int level){return levels.at(level)->width;}
+  int GetNumberOfLevels(){return int(levels.size());}
+
+ private:
+
+  struct BucketIndex{
+    uint64_t t_start;
+    uint64_t t_end;
+    uint32_t n_entries;
+    int64_t record;
+  };
+
+  struct Level{
+    uint64_t width;
+    std::string filename;
+    std::fstream *file;
+    int64_t num_records;
+    std::map<uint64_t,BucketIndex> index;   //bucket start time --> record
+  };
+
+  bool OpenLevel(Level *level);
+  bool ReadRecord(Level *level, int64_t record, std::vector<double> &payload);
+  bool WriteRecord(Level *level, int64_t record, uint64_t key, const BucketIndex &bucket, const std::vector<double> &payload);
+  std::streamoff RecordOffset(int64_t record);
+
+  std::vector<std::string> channel_variables;
+  std::vector<Aggregation> channel_modes;
+  std::vector<std::string> scalar_variables;
+  std::vector<Aggregation> scalar_modes;
+  std::vector<Level*> levels;
+
+  std::string prefix;
+  int nchannels;
+  bool is_open;
+  std::size_t payload_size;     //number of doubles per record: weight + channel variables + scalar variables
+  std::size_t record_size;      //bytes per record
+  double flush_interval;        //seconds between flushes of the level files in Add
+  std::chrono::steady_clock::time_point last_flush;
+
+};
+
+#endif
@@ -23,6 +23,11 @@ void RecoCluster::Reset()
   fDigitList.clear();
 }
 
+void RecoCluster::ClearDigits()
+{
+  fDigitList.clear();
+}
+
 static bool CompareTimes(RecoDigit *rd1, RecoDigit *rd2)
 {
   return ( rd1->GetCalTime() > rd2->GetCalTime() );
@@ -14,6 +14,7 @@ class RecoCluster : public SerialisableObject {
   ~RecoCluster();
 
   void Reset();
+  void ClearDigits();  ///< Remove the digits without deleting them, for digits owned elsewhere
   void SortCluster();
 
   void AddDigit(RecoDigit* digit);
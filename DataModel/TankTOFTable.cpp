@@ -0,0 +1,83 @@
+#include "TankTOFTable.h"
+
+#include <algorithm>
+#include <cmath>
+
+void TankTOFTable::SetSeedGrid(const std::vector<Position> &grid, double speed){
+  seed_grid = grid;
+  light_speed = speed;
+  seed_x.resize(grid.size());
+  seed_y.resize(grid.size());
+  seed_z.resize(grid.size());
+  for(size_t i=0; i<grid.size(); i++){
+    seed_x[i] = grid[i].X();
+    seed_y[i] = grid[i].Y();
+    seed_z[i] = grid[i].Z();
+  }
+  sensor_rows.clear();
+  num_sensors = 0;
+  num_persistent = 0;
+  tof.clear();
+}
+
+int TankTOFTable::AddSensor(const Position &pos){
+  std::tuple<long,long,long> key(std::lround(pos.X()*100.), std::lround(pos.Y()*100.), std::lround(pos.Z()*100.));
+  std::map<std::tuple<long,long,long>,int>::iterator it = sensor_rows.find(key);
+  if(it!=sensor_rows.end()) return it->second;
+
+  // persistent rows stay in front of the event rows
+  ClearEventSensors();
+  int row = AddRow(pos);
+  num_persistent = num_sensors;
+  sensor_rows.emplace(key,row);
+  return row;
+}
+
+int TankTOFTable::AddEventSensor(const Position &pos){
+  return AddRow(pos);
+}
+
+void TankTOFTable::ClearEventSensors(){
+  num_sensors = num_persistent;
+  tof.resize(num_sensors*seed_grid.size());
+}
+
+int TankTOFTable::AddRow(const Position &pos){
+  const size_t nseeds = seed_grid.size();
+  const size_t first = num_sensors*nseeds;
+  tof.resize(first+nseeds);
+  double* trow = tof.data()+first;
+  const double x = pos.X(), y = pos.Y(), z = pos.Z();
+  for(size_t i=0; i<nseeds; i++){
+    double dx = x-seed_x[i];
+    double dy = y-seed_y[i];
+    double dz = z-seed_z[i];
+    trow[i] = std::sqrt(dx*dx+dy*dy+dz*dz)/light_speed;
+  }
+  return num_sensors++;
+}
+
+void TankTOFTable::MedianSeedTimes(const std::vector<int> &sensors, const std::vector<double> &times,
+                                   std::vector<double> &medians){
+  const size_t nseeds = seed_grid.size();
+  const size_t ndigits = sensors.size();
+  medians.assign(nseeds,0.);
+  if(ndigits==0) return;
+
+  // digit-major: one contiguous pass over the row of each digit
+  seed_times.resize(ndigits*nseeds);
+  for(size_t d=0; d<ndigits; d++){
+    const double* trow = TOFs(sensors[d]);
+    double* out = seed_times.data()+d*nseeds;
+    const double t = times[d];
+    for(size_t i=0; i<nseeds; i++) out[i] = t-trow[i];
+  }
+
+  std::vector<double> column(ndigits);
+  const size_t median_index = ndigits/2;
+  for(size_t i=0; i<nseeds; i++){
+    for(size_t d=0; d<ndigits; d++) column[d] = seed_times[d*nseeds+i];
+    std::nth_element(column.begin(), column.begin()+median_index, column.end());
+    medians[i] = column[median_index];
+  }
+}
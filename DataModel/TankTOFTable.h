@@ -0,0 +1,68 @@
+#ifndef TANKTOFTABLE_H
+#define TANKTOFTABLE_H
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "Position.h"
+
+/**
+ * \class TankTOFTable
+ *
+ * Light travel times from a fixed grid of vertex seeds to the positions of the
+ * photosensors, for seeding and scoring many vertex hypotheses per event with table lookups.
+ *
+ * The grid is set once per geometry. Sensor positions are added as they are first seen and
+ * keep their row for the rest of the job, so for the tank PMTs every row is computed once.
+ * Positions that change from hit to hit (LAPPD strip positions) are added as event sensors,
+ * whose rows are dropped again by ClearEventSensors().
+ *
+ * Row s holds the values of all seeds, entry [s*NumSeeds()+seed], so filling a row and
+ * evaluating all seeds for one digit are contiguous loops.
+ */
+class TankTOFTable {
+
+ public:
+
+  TankTOFTable(){}
+
+  /// Set the seed grid and the light speed used for the travel times, dropping all sensors
+  void SetSeedGrid(const std::vector<Position> &grid, double light_speed);
+  bool HasSeedGrid() const {return !seed_grid.empty();}
+  int NumSeeds() const {return seed_grid.size();}
+  const std::vector<Position>& GetSeedGrid() const {return seed_grid;}
+  double GetLightSpeed() const {return light_speed;}
+
+  /// Row of the sensor at this position, computed the first time the position is seen
+  int AddSensor(const Position &pos);
+  /// Row for a position used in this event only. Add the sensors of an event with AddSensor
+  /// first: a new persistent row drops the event rows.
+  int AddEventSensor(const Position &pos);
+  void ClearEventSensors();
+  int NumSensors() const {return num_sensors;}
+
+  const double* TOFs(int sensor) const {return tof.data()+sensor*seed_grid.size();}
+
+  /// For every seed, the median over the digits of time - TOF(seed, sensor of the digit)
+  void MedianSeedTimes(const std::vector<int> &sensors, const std::vector<double> &times,
+                       std::vector<double> &medians);
+
+ private:
+
+  int AddRow(const Position &pos);
+
+  std::vector<Position> seed_grid;
+  std::vector<double> seed_x, seed_y, seed_z;
+  double light_speed = 1.;
+
+  std::map<std::tuple<long,long,long>,int> sensor_rows;   // position in 1/100 cm -> row
+  int num_sensors = 0;
+  int num_persistent = 0;
+  std::vector<double> tof;        // [sensor*NumSeeds()+seed], ns
+
+  std::vector<double> seed_times;   // scratch of MedianSeedTimes
+
+};
+
+#endif
@@ -59,6 +59,8 @@ VertexGeometry::VertexGeometry()
   fZenith = new double[fNDigitsMax];
   fAzimuth = new double[fNDigitsMax];
   fSolidAngle = new double[fNDigitsMax];
+  fCosZenith = new double[fNDigitsMax];
+  fSinZenith = new double[fNDigitsMax];
 
   fDistPoint = new double[fNDigitsMax];
   fDistTrack = new double[fNDigitsMax];
@@ -93,6 +95,8 @@ VertexGeometry::VertexGeometry()
     fZenith[n] = 0.0;
     fAzimuth[n] = 0.0;
     fSolidAngle[n] = 0.0;
+    fCosZenith[n] = 1.0;
+    fSinZenith[n] = 0.0;
     fDistPoint[n] = 0.0;
     fDistTrack[n] = 0.0;
     fDistPhoton[n] = 0.0; 
@@ -147,6 +151,8 @@ VertexGeometry::~VertexGeometry()
   if( fZenith ) delete [] fZenith;
   if( fAzimuth ) delete [] fAzimuth;
   if( fSolidAngle ) delete [] fSolidAngle;
+  if( fCosZenith ) delete [] fCosZenith;
+  if( fSinZenith ) delete [] fSinZenith;
 
   if( fDistPoint )  delete [] fDistPoint;
   if( fDistTrack )  delete [] fDistTrack;
@@ -249,6 +255,8 @@ void VertexGeometry::LoadDigits(std::vector<RecoDigit>* vDigitList)
     fZenith[idigit] = 0.0;
     fAzimuth[idigit] = 0.0;
     fSolidAngle[idigit] = 0.0;
+    fCosZenith[idigit] = 1.0;
+    fSinZenith[idigit] = 0.0;
 
     fDistPoint[idigit] = 0.0;
     fDistTrack[idigit] = 0.0;
@@ -457,6 +465,8 @@ void VertexGeometry::CalcResiduals(double vtxX, double vtxY, double vtxZ, double
     fZenith[idigit] = 0.0;
     fAzimuth[idigit] = 0.0;
     fSolidAngle[idigit] = 0.0;
+    fCosZenith[idigit] = 1.0;
+    fSinZenith[idigit] = 0.0;
     fDistPoint[idigit] = 0.0;
     fDistTrack[idigit] = 0.0;
     fDistPhoton[idigit] = 0.0;  
@@ -483,6 +493,12 @@ void VertexGeometry::CalcResiduals(double vtxX, double vtxY, double vtxZ, double
   //theta = acos(30.0/(29.0*1.38));
   //bool truehits = (Interface::Instance())->IsTrueHits(); 
 
+  double fC = Parameters::SpeedOfLight();
+  double fVmu = fC;
+  //double fN = Parameters::RefractiveIndex(Lphoton);
+  //chrom.....
+  double fN = Parameters::Index0(); //...chrom1.34, 1.333;	
+
   // loop over digits
   // ================
   for( int idigit=0; idigit<fNDigits; idigit++ ){
@@ -516,6 +532,8 @@ void VertexGeometry::CalcResiduals(double vtxX, double vtxY, double vtxZ, double
       phi = acos(cosphi); // radians
       phideg = phi/(TMath::Pi()/180.0); // radians->degrees
       sinphi = sqrt(1.0-cosphi*cosphi);
+      fCosZenith[idigit] = cosphi;
+      fSinZenith[idigit] = sinphi;
       sinphi += 0.24*exp(-sinphi/0.24);
       sinphi /= 0.684;  // sin(phideg)/sin(thetadeg)
 
@@ -551,12 +569,6 @@ void VertexGeometry::CalcResiduals(double vtxX, double vtxY, double vtxZ, double
       Lscatter = Lpoint*(phi-theta);
     }
 
-    double fC = Parameters::SpeedOfLight();
-    double fVmu = fC;
-    //double fN = Parameters::RefractiveIndex(Lphoton);
-    //chrom.....
-    double fN = Parameters::Index0(); //...chrom1.34, 1.333;	
-
     double dt = fDigitT[idigit] - vtxTime; 
     double qpes = fDigitQ[idigit];
 //    double tres = Parameters::TimeResolution(qpes);
@@ -617,15 +629,17 @@ double VertexGeometry::GetDeltaCorrection(int idigit, double Length)
     double Lpoint = GetDistPoint(idigit);
     double Ltrack = GetDistTrack(idigit);
     double Lphoton = GetDistPhoton(idigit);
-    double AngleRad = (TMath::Pi()/180.0)*GetAngle(idigit);    
+    // cos and sin of the zenith angle are kept by CalcResiduals
+    double CosAngle = fCosZenith[idigit];
+    double SinAngle = fSinZenith[idigit];
     double ConeAngleRad = (TMath::Pi()/180.0)*GetConeAngle(idigit);  
 
     double LtrackNew = Length;
     double LphotonNew = sqrt( Lpoint*Lpoint + Length*Length
-                                -2.0*Lpoint*Length*cos(AngleRad) );
+                                -2.0*Lpoint*Length*CosAngle );
 
     double theta = ConeAngleRad;
-    double sinphi = (Lpoint/LphotonNew)*sin(AngleRad);
+    double sinphi = (Lpoint/LphotonNew)*SinAngle;
     double phi = asin(sinphi);
     double alpha = theta-phi;
     double LphotonNewCorrected = LphotonNew*alpha/sin(alpha);
@@ -322,6 +322,8 @@ class VertexGeometry {
   double* fZenith;           // Zenith (degrees)
   double* fAzimuth;          // Azimuth (degrees)
   double* fSolidAngle;       // SolidAngle = sin(angle)/sin(42)
+  double* fCosZenith;        // cos(Zenith), kept for GetDeltaCorrection
+  double* fSinZenith;        // sin(Zenith)
   double* fConeAngle;        // Cone Angle (degrees)
 
   double* fDistPoint;        // Distance from Vertex (S)
@@ -78,11 +78,25 @@ bool ANNIEEventBuilder::Initialise(std::string configfile, DataModel &data){
   
   OrphanStore = new BoostStore(false,2);
 
+  std::string CheckpointFile;
+  m_data->CStore.Get("CheckpointFile",CheckpointFile);
+  Checkpointing = (CheckpointFile!="");
+  bool ResumeFromCheckpoint = false;
+  m_data->CStore.Get("ResumeFromCheckpoint",ResumeFromCheckpoint);
+  if(ResumeFromCheckpoint) this->LoadCheckpoint();
+
   return true;
 }
 
 
 bool ANNIEEventBuilder::Execute(){
+  bool CheckpointRequested = false;
+  m_data->CStore.Get("SaveCheckpoint",CheckpointRequested);
+  if(CheckpointRequested) this->SaveCheckpoint();
+  bool WaitingForRawData = false;
+  m_data->CStore.Get("WaitingForRawData",WaitingForRawData);
+  if(WaitingForRawData) return true;
+
   bool NewEntryAvailable;
   m_data->CStore.Get("NewRawDataEntryAccessed",NewEntryAvailable);
   if(!NewEntryAvailable){ //Something went wrong processing raw data.  Stop and save what's left
@@ -843,7 +857,7 @@ void ANNIEEventBuilder::ManageOrphanage(){
 //  std::cout<<"Going to manage the orphanage"<<std::endl;
   
   std::string OrphanFile = SavePath + OrphanFileBase + "R" + to_string(CurrentRunNum) + 
-      "S" + to_string(CurrentSubRunNum);
+      "S" + to_string(CurrentSubRunNum) + this->OutputPartSuffix();
 //  std::cout<<"orphans will be saved to "<<OrphanFile<<std::endl;
 //  std::cout<<"OrphanStore is "<<OrphanStore<<std::endl;
   
@@ -1101,7 +1115,7 @@ void ANNIEEventBuilder::SaveEntryToFile(int RunNum, int SubRunNum)
 {
   /*if(verbosity>4)*/ std::cout << "ANNIEEvent: Saving ANNIEEvent entry"+to_string(ANNIEEventNum) << std::endl;
   std::string Filename = SavePath + ProcessedFilesBasename + "R" + to_string(RunNum) + 
-      "S" + to_string(SubRunNum);
+      "S" + to_string(SubRunNum) + this->OutputPartSuffix();
   ANNIEEvent->Save(Filename);
   //std::cout <<"ANNIEEvent saved, now delete"<<std::endl;
   ANNIEEvent->Delete();		//Delete() will delete the last entry in the store from memory and enable us to set a new pointer (won't erase the entry from saved file)
@@ -1133,5 +1147,59 @@ void ANNIEEventBuilder::OpenNewANNIEEvent(int RunNum, int SubRunNum,uint64_t Sta
   CurrentSubRunNum = SubRunNum;
   CurrentRunType = RunT;
   CurrentStarTime = StarT;
+  OutputPart = 0;
   if((CurrentRunNum != RunNum)) CurrentDriftMean = 0;
 }
+
+std::string ANNIEEventBuilder::OutputPartSuffix(){
+  if(!Checkpointing) return "";
+  return "p" + to_string(OutputPart);
+}
+
+void ANNIEEventBuilder::SaveCheckpoint(){
+  //Everything built up to the checkpoint goes into closed part files; a chain resumed from it
+  //starts the next part, which replaces whatever a crashed chain had written there
+  ANNIEEvent->Close();
+  ANNIEEvent->Delete();
+  delete ANNIEEvent; ANNIEEvent = new BoostStore(false,2);
+  OrphanStore->Close();
+  OrphanStore->Delete();
+  delete OrphanStore; OrphanStore = new BoostStore(false,2);
+  OutputPart+=1;
+
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  Checkpoint->Set("BuilderFinishedTankEvents",FinishedTankEvents);
+  Checkpoint->Set("BuilderBeamTankTimestamps",myTimeStream.BeamTankTimestamps);
+  Checkpoint->Set("BuilderBeamMRDTimestamps",myTimeStream.BeamMRDTimestamps);
+  Checkpoint->Set("BuilderCTCTimestamps",myTimeStream.CTCTimestamps);
+  Checkpoint->Set("BuilderNewestTankTimestamp",NewestTankTimestamp);
+  Checkpoint->Set("BuilderDriftMean",CurrentDriftMean);
+  Checkpoint->Set("BuilderDriftVariance",CurrentDriftVariance);
+  Checkpoint->Set("BuilderExecuteCount",ExecuteCount);
+  Checkpoint->Set("ANNIEEventNum",ANNIEEventNum);
+  Checkpoint->Set("BuilderRunNum",CurrentRunNum);
+  Checkpoint->Set("BuilderSubRunNum",CurrentSubRunNum);
+  Checkpoint->Set("BuilderRunType",CurrentRunType);
+  Checkpoint->Set("BuilderStarTime",CurrentStarTime);
+  Checkpoint->Set("BuilderOutputPart",OutputPart);
+}
+
+void ANNIEEventBuilder::LoadCheckpoint(){
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  if(!Checkpoint->Get("ANNIEEventNum",ANNIEEventNum)) return;
+  Checkpoint->Get("BuilderFinishedTankEvents",FinishedTankEvents);
+  Checkpoint->Get("BuilderBeamTankTimestamps",myTimeStream.BeamTankTimestamps);
+  Checkpoint->Get("BuilderBeamMRDTimestamps",myTimeStream.BeamMRDTimestamps);
+  Checkpoint->Get("BuilderCTCTimestamps",myTimeStream.CTCTimestamps);
+  Checkpoint->Get("BuilderNewestTankTimestamp",NewestTankTimestamp);
+  Checkpoint->Get("BuilderDriftMean",CurrentDriftMean);
+  Checkpoint->Get("BuilderDriftVariance",CurrentDriftVariance);
+  Checkpoint->Get("BuilderExecuteCount",ExecuteCount);
+  Checkpoint->Get("BuilderRunNum",CurrentRunNum);
+  Checkpoint->Get("BuilderSubRunNum",CurrentSubRunNum);
+  Checkpoint->Get("BuilderRunType",CurrentRunType);
+  Checkpoint->Get("BuilderStarTime",CurrentStarTime);
+  Checkpoint->Get("BuilderOutputPart",OutputPart);
+  Log("ANNIEEventBuilder: Resumed at ANNIEEvent "+to_string(ANNIEEventNum)+", writing part "+to_string(OutputPart)+
+      " of run "+to_string(CurrentRunNum)+" subrun "+to_string(CurrentSubRunNum),v_message,verbosity);
+}
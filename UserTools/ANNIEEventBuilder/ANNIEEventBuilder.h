@@ -68,6 +68,11 @@ class ANNIEEventBuilder: public Tool {
   void SaveEntryToFile(int RunNum, int SubRunNum);
   void OpenNewANNIEEvent(int RunNum, int SubRunNum,uint64_t StarT, int RunT);
 
+  //Checkpoints of the LoadRawData Online mode
+  void SaveCheckpoint();            // Close the output part and add the building state to the Checkpoint store
+  void LoadCheckpoint();
+  std::string OutputPartSuffix();   // "p<part>" when checkpointing, so a resumed chain rewrites only the parts after the checkpoint
+
   //Methods for getting all timestamps encountered by decoder tools
   void ProcessNewTankPMTData();
   void ProcessNewMRDData();
@@ -158,6 +163,8 @@ class ANNIEEventBuilder: public Tool {
 
   std::string SavePath;
   std::string ProcessedFilesBasename;
+  bool Checkpointing = false;
+  int OutputPart = 0;
 
   /// \brief verbosity levels: if 'verbosity' < this level, the message type will be logged.
   int verbosity;
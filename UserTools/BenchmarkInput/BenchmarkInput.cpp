@@ -0,0 +1,164 @@
+#include "BenchmarkInput.h"
+
+BenchmarkInput::BenchmarkInput():Tool(){}
+
+
+bool BenchmarkInput::Initialise(std::string configfile, DataModel &data){
+
+  /////////////////// Useful header ///////////////////////
+  if(configfile!="") m_variables.Initialise(configfile); // loading config file
+  //m_variables.Print();
+
+  m_data= &data; //assigning transient data pointer
+  /////////////////////////////////////////////////////////////////
+
+  int seed = 1;
+  mode = "Waveforms";
+  m_variables.Get("verbosity",verbosity);
+  m_variables.Get("Mode",mode);
+  m_variables.Get("Seed",seed);
+  m_variables.Get("WaveformSamples",waveform_samples);
+  m_variables.Get("MaxEvents",max_events);
+
+  if(mode!="CardData" && mode!="Waveforms" && mode!="RecoDigits"){
+    Log("BenchmarkInput Tool: Unknown Mode "+mode+", must be CardData, Waveforms or RecoDigits",v_error,verbosity);
+    return false;
+  }
+  generator = SyntheticEvents(seed);
+  m_variables.Get("Occupancy",generator.occupancy);
+  m_variables.Get("MeanPE",generator.mean_pe);
+  m_variables.Get("TimeJitter",generator.time_jitter);
+  m_variables.Get("Noise",generator.noise);
+
+  if(!LoadChannels()) return false;
+
+  if(m_data->Stores.count("ANNIEEvent")==0) m_data->Stores["ANNIEEvent"] = new BoostStore(false,2);
+  if(mode=="RecoDigits" && m_data->Stores.count("RecoEvent")==0) m_data->Stores["RecoEvent"] = new BoostStore(false,2);
+
+  if(mode=="CardData"){
+    carddata = new std::vector<CardData>;
+    m_data->CStore.Set("PauseTankDecoding",false);
+  } else if(mode=="Waveforms"){
+    beam_status = new BeamStatusClass(TimeClass(0), 4.777e+12, 3.2545e+16, "stable");
+  } else {
+    digits = new std::vector<RecoDigit>;
+    true_vertex = new RecoVertex();
+  }
+
+  Log("BenchmarkInput Tool: Generating "+mode+" for "+std::to_string(pmts.size())+" tank PMTs"
+      +((mode=="CardData") ? " on "+std::to_string(cards.size())+" cards" : ""),v_message,verbosity);
+
+  return true;
+}
+
+
+bool BenchmarkInput::LoadChannels(){
+
+  Geometry* geom = nullptr;
+  bool got_geometry = m_data->Stores.count("ANNIEEvent")
+    && m_data->Stores.at("ANNIEEvent")->Header->Get("AnnieGeometry",geom);
+  if(!got_geometry || geom==nullptr){
+    Log("BenchmarkInput Tool: No AnnieGeometry in the ANNIEEvent header, LoadGeometry must run before this tool",v_error,verbosity);
+    return false;
+  }
+  Position centre = geom->GetTankCentre();
+  centre.UnitToCentimeter();
+
+  std::map<unsigned long,SyntheticEvents::PMT> pmt_by_channel;
+  for(const std::pair<const unsigned long,Detector*> &apair : geom->GetDetectors()->at("Tank")){
+    Detector* det = apair.second;
+    if(det->GetChannels()->empty()) continue;
+    Position pos = det->GetDetectorPosition();
+    pos.UnitToCentimeter();
+    SyntheticEvents::PMT pmt;
+    pmt.chankey = det->GetChannels()->begin()->first;
+    pmt.id = det->GetDetectorID();
+    pmt.x = pos.X()-centre.X();
+    pmt.y = pos.Y()-centre.Y();
+    pmt.z = pos.Z()-centre.Z();
+    pmt_by_channel.emplace(pmt.chankey,pmt);
+    pmts.push_back(pmt);
+  }
+
+  if(mode=="CardData"){
+    std::map<std::vector<int>,int>* crate_map = nullptr;
+    m_data->CStore.Get("TankPMTCrateSpaceToChannelNumMap",crate_map);
+    if(crate_map==nullptr){
+      Log("BenchmarkInput Tool: No TankPMTCrateSpaceToChannelNumMap in the CStore",v_error,verbosity);
+      return false;
+    }
+    // CardID = crate*1000+slot, see ANNIEEventBuilder::CardIDToElectronicsSpace
+    for(const std::pair<const std::vector<int>,int> &apair : *crate_map){
+      auto pmt = pmt_by_channel.find(apair.second);
+      if(pmt==pmt_by_channel.end()) continue;
+      int CardID = apair.first.at(0)*1000 + apair.first.at(1);
+      cards[CardID].push_back(std::make_pair(apair.first.at(2),pmt->second));
+    }
+  }
+
+  if(pmts.empty()){
+    Log("BenchmarkInput Tool: The geometry has no tank PMTs",v_error,verbosity);
+    return false;
+  }
+  return true;
+}
+
+
+bool BenchmarkInput::Execute(){
+
+  if(max_events>=0 && event_number>=(uint64_t)max_events){
+    m_data->vars.Set("StopLoop",1);
+    if(mode=="CardData") m_data->CStore.Set("NewRawDataEntryAccessed",false);
+    return true;
+  }
+
+  BoostStore* annie_event = m_data->Stores["ANNIEEvent"];
+
+  if(mode=="CardData"){
+    generator.MakeCardData(event_number,cards,waveform_samples,*carddata);
+    Store RunInfoPostgress;
+    RunInfoPostgress.Set("RunNumber",0);
+    RunInfoPostgress.Set("SubRunNumber",0);
+    RunInfoPostgress.Set("RunType",0);
+    RunInfoPostgress.Set("StarTime",0);
+    m_data->CStore.Set("RunInfoPostgress",RunInfoPostgress);
+    m_data->CStore.Set("CardData",carddata,false);
+    m_data->CStore.Set("NewRawDataEntryAccessed",true);
+    m_data->CStore.Set("NewRawDataFileAccessed",event_number==0);
+    m_data->CStore.Set("FileCompleted",false);
+  }
+
+  else if(mode=="Waveforms"){
+    std::map<unsigned long, std::vector<Waveform<unsigned short>>> raw_waveforms;
+    std::map<unsigned long, std::vector<Waveform<unsigned short>>> raw_aux_waveforms;
+    generator.MakeWaveforms(event_number,pmts,waveform_samples,raw_waveforms);
+    annie_event->Set("RawADCData",raw_waveforms);
+    annie_event->Set("RawADCAuxData",raw_aux_waveforms);
+    annie_event->Set("EventTimeTank",generator.TriggerCounter(event_number)*8);
+    annie_event->Set("BeamStatus",beam_status,false);
+  }
+
+  else {
+    generator.MakeRecoDigits(event_number,pmts,*digits);
+    SyntheticEvents::Vertex vtx = generator.TrueVertex(event_number);
+    true_vertex->SetVertex(vtx.x,vtx.y,vtx.z,vtx.t);
+    true_vertex->SetDirection(vtx.dx,vtx.dy,vtx.dz);
+    m_data->Stores.at("RecoEvent")->Set("RecoDigit",digits,false);
+    m_data->Stores.at("RecoEvent")->Set("TrueVertex",true_vertex,false);
+  }
+
+  annie_event->Set("EventNumber",static_cast<int>(event_number));
+  Log("BenchmarkInput Tool: Generated event "+std::to_string(event_number),v_debug,verbosity);
+  event_number++;
+
+  return true;
+}
+
+
+bool BenchmarkInput::Finalise(){
+
+  // the generated objects are owned by the stores they were put in
+  Log("BenchmarkInput Tool: Generated "+std::to_string(event_number)+" events",v_message,verbosity);
+
+  return true;
+}
@@ -0,0 +1,65 @@
+#ifndef BenchmarkInput_H
+#define BenchmarkInput_H
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <map>
+
+#include "Tool.h"
+#include "SyntheticEvents.h"
+#include "BeamStatusClass.h"
+#include "RecoVertex.h"
+#include "Geometry.h"
+
+/**
+ * \class BenchmarkInput
+ *
+ * Replaces the data loaders in the benchmark toolchains. Each Execute puts the next deterministic synthetic event
+ * (see SyntheticEvents) into the stores, in the form written by the tool it stands in for:
+ *   CardData    raw PMT readout in the CStore, like LoadRawData (for PMTDataDecoder/ANNIEEventBuilder)
+ *   Waveforms   RawADCData in the ANNIEEvent, like ANNIEEventBuilder (for PhaseIIADCCalibrator and the hit finding)
+ *   RecoDigits  RecoDigit and TrueVertex in the RecoEvent, like DigitBuilder (for HitCleaner and the vertex fits)
+ * The channels are the tank PMTs of the geometry, so LoadGeometry has to run first.
+ */
+
+class BenchmarkInput: public Tool {
+
+
+ public:
+
+  BenchmarkInput(); ///< Simple constructor
+  bool Initialise(std::string configfile,DataModel &data); ///< Initialise Function for setting up Tool resources. @param configfile The path and name of the dynamic configuration file to read in. @param data A reference to the transient data class used to pass information between Tools.
+  bool Execute(); ///< Execute function used to perform Tool purpose.
+  bool Finalise(); ///< Finalise function used to clean up resources.
+
+
+ private:
+
+  bool LoadChannels();
+
+  int verbosity = 1;
+  std::string mode;
+  int waveform_samples = 2000;
+  int max_events = -1;
+
+  SyntheticEvents generator;
+  uint64_t event_number = 0;
+
+  std::vector<SyntheticEvents::PMT> pmts;
+  std::map<int, std::vector<std::pair<int,SyntheticEvents::PMT>>> cards;  // CardID -> (ChannelID, PMT)
+
+  std::vector<CardData>* carddata = nullptr;
+  std::vector<RecoDigit>* digits = nullptr;
+  RecoVertex* true_vertex = nullptr;
+  BeamStatusClass* beam_status = nullptr;
+
+  int v_error=0;
+  int v_warning=1;
+  int v_message=2;
+  int v_debug=3;
+
+};
+
+
+#endif
@@ -0,0 +1,164 @@
+#include "SyntheticEvents.h"
+#include "CounterRandom.h"
+
+#include <cmath>
+#include <algorithm>
+#include <endian.h>
+
+namespace {
+
+  const double LightSpeedInWater = 29.9792458/1.33;  // cm/ns
+  const uint64_t NoiseStream = 0x6e6f697365ULL;
+
+  uint16_t ClipADC(double value){
+    // 0 and 0xFFF are avoided, a 0x000 0xFFF pair marks a record header in the raw data
+    if(value < 1.) return 1;
+    if(value > 4094.) return 4094;
+    return static_cast<uint16_t>(value+0.5);
+  }
+
+  // 40 samples of 12 bits in 15 words, least significant bits first, as read by PMTDataDecoder::DecodeFrames
+  void PackFrame(const uint16_t *samples, int ChannelID, std::vector<uint32_t> &bank){
+    uint32_t words[15] = {0};
+    for(size_t i=0; i<SyntheticEvents::SamplesPerFrame; i++){
+      size_t bit = 12*i;
+      size_t w = bit/32;
+      size_t offset = bit%32;
+      words[w] |= static_cast<uint32_t>(samples[i]) << offset;
+      if(offset > 20) words[w+1] |= static_cast<uint32_t>(samples[i]) >> (32-offset);
+    }
+    for(int w=0; w<15; w++) bank.push_back(htobe32(words[w]));
+    bank.push_back(htobe32(static_cast<uint32_t>(ChannelID) << 24));
+  }
+
+}
+
+
+SyntheticEvents::Vertex SyntheticEvents::TrueVertex(uint64_t event) const {
+
+  CounterRandom rnd(CounterRandom::StreamKey(seed,event,0));
+  Vertex vtx;
+  double r = tank_radius*std::sqrt(rnd.Uniform());
+  double phi = 2.*M_PI*rnd.Uniform();
+  vtx.x = r*std::cos(phi);
+  vtx.z = r*std::sin(phi);
+  vtx.y = rnd.Uniform(-tank_halfheight,tank_halfheight);
+  vtx.t = 0.;
+  // mostly forward going, like beam events
+  double costheta = rnd.Uniform(0.5,1.);
+  double sintheta = std::sqrt(1.-costheta*costheta);
+  phi = 2.*M_PI*rnd.Uniform();
+  vtx.dx = sintheta*std::cos(phi);
+  vtx.dy = sintheta*std::sin(phi);
+  vtx.dz = costheta;
+  return vtx;
+}
+
+
+bool SyntheticEvents::PMTHit(uint64_t event, const PMT &pmt, double &time, double &charge) const {
+
+  CounterRandom rnd(CounterRandom::StreamKey(seed,event,pmt.chankey+1));
+  if(rnd.Uniform() > occupancy) return false;
+  charge = -mean_pe*std::log(rnd.Uniform());
+  double jitter = 0.;
+  rnd.FillGaus(&jitter,1,time_jitter);
+  Vertex vtx = TrueVertex(event);
+  double dist = std::sqrt((pmt.x-vtx.x)*(pmt.x-vtx.x) + (pmt.y-vtx.y)*(pmt.y-vtx.y) + (pmt.z-vtx.z)*(pmt.z-vtx.z));
+  time = vtx.t + dist/LightSpeedInWater + jitter;
+  return true;
+}
+
+
+void SyntheticEvents::FillWaveform(uint64_t event, const PMT &pmt, uint16_t *samples, size_t n) const {
+
+  std::vector<double> wave(n);
+  CounterRandom rnd(CounterRandom::StreamKey(seed^NoiseStream,event,pmt.chankey+1));
+  rnd.FillGaus(wave.data(),n,noise);
+  for(size_t i=0; i<n; i++) wave[i] += baseline;
+
+  double time, charge;
+  if(PMTHit(event,pmt,time,charge)){
+    double peak = trigger_offset + time;
+    double height = charge*adc_per_pe;
+    long first = std::max(0L, static_cast<long>((peak-5.*pulse_width)/2.));
+    long last = std::min(static_cast<long>(n)-1, static_cast<long>((peak+5.*pulse_width)/2.)+1);
+    for(long i=first; i<=last; i++){
+      double dt = (2.*i-peak)/pulse_width;
+      wave[i] += height*std::exp(-0.5*dt*dt);
+    }
+  }
+
+  for(size_t i=0; i<n; i++) samples[i] = ClipADC(wave[i]);
+}
+
+
+void SyntheticEvents::MakeWaveforms(uint64_t event, const std::vector<PMT> &pmts, size_t nsamples,
+                                    std::map<unsigned long, std::vector<Waveform<unsigned short>>> &waveforms) const {
+
+  waveforms.clear();
+  std::vector<uint16_t> samples(nsamples);
+  double start = TriggerCounter(event)*8.;
+  for(const PMT &pmt : pmts){
+    FillWaveform(event,pmt,samples.data(),nsamples);
+    std::vector<Waveform<unsigned short>> waves{Waveform<unsigned short>(start,samples)};
+    waveforms.emplace(pmt.chankey,waves);
+  }
+}
+
+
+uint64_t SyntheticEvents::TriggerCounter(uint64_t event) const {
+
+  uint64_t counter = static_cast<uint64_t>((event+1)*event_spacing/8.);
+  // the counter must not contain a 0x000 0xFFF sample pair, or the decoder would see a second record header
+  while(true){
+    uint16_t rh[6];
+    for(int j=0; j<2; j++) rh[j] = (counter >> (48+12*j)) & 0xfff;
+    for(int j=0; j<4; j++) rh[2+j] = (counter >> (12*j)) & 0xfff;
+    bool label = false;
+    for(int j=0; j<5; j++) label |= (rh[j]==0x000 && rh[j+1]==0xfff);
+    if(!label) return counter;
+    counter++;
+  }
+}
+
+
+void SyntheticEvents::MakeCardData(uint64_t event, const std::map<int, std::vector<std::pair<int,PMT>>> &cards, size_t nsamples,
+                                   std::vector<CardData> &carddata) const {
+
+  const size_t nframes = (RecordHeaderSamples+nsamples+SamplesPerFrame-1)/SamplesPerFrame;
+  const size_t nwave = nframes*SamplesPerFrame - RecordHeaderSamples;
+  const uint64_t counter = TriggerCounter(event);
+
+  std::vector<uint16_t> stream(nframes*SamplesPerFrame);
+  stream[0] = 0x000;
+  stream[1] = 0xfff;
+  for(int j=0; j<2; j++) stream[2+j] = (counter >> (48+12*j)) & 0xfff;
+  for(int j=0; j<4; j++) stream[4+j] = (counter >> (12*j)) & 0xfff;
+
+  carddata.resize(cards.size());
+  size_t icard = 0;
+  for(const auto &card : cards){
+    CardData &cd = carddata[icard++];
+    cd.CardID = card.first;
+    cd.SequenceID = static_cast<int>(event);
+    cd.FirmwareVersion = 0;
+    cd.FIFOstate = 0;
+    cd.Data.clear();
+    cd.Data.reserve(card.second.size()*nframes*16);
+    for(const std::pair<int,PMT> &channel : card.second){
+      FillWaveform(event,channel.second,&stream[RecordHeaderSamples],nwave);
+      for(size_t f=0; f<nframes; f++) PackFrame(&stream[f*SamplesPerFrame],channel.first,cd.Data);
+    }
+  }
+}
+
+
+void SyntheticEvents::MakeRecoDigits(uint64_t event, const std::vector<PMT> &pmts, std::vector<RecoDigit> &digits) const {
+
+  digits.clear();
+  double time, charge;
+  for(const PMT &pmt : pmts){
+    if(!PMTHit(event,pmt,time,charge)) continue;
+    digits.push_back(RecoDigit(0,Position(pmt.x,pmt.y,pmt.z),time,charge,RecoDigit::PMT8inch,pmt.id));
+  }
+}
@@ -0,0 +1,84 @@
+#ifndef SyntheticEvents_H
+#define SyntheticEvents_H
+
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+#include "CardData.h"
+#include "Waveform.h"
+#include "RecoDigit.h"
+
+/**
+ * \class SyntheticEvents
+ *
+ * Deterministic synthetic detector data for the benchmarks. All numbers come from CounterRandom streams keyed by
+ * (seed, event, channel), so event n is identical in every run, on every machine, whatever was generated before it.
+ *
+ * The event model is a short light burst in the tank: every PMT is hit with probability occupancy, with an
+ * exponential number of photoelectrons of mean mean_pe, at the direct light time from the vertex smeared by
+ * time_jitter. The same hits are used for the digitised waveforms (positive gaussian pulses on a noisy baseline)
+ * and for the RecoDigits.
+ */
+
+class SyntheticEvents {
+
+ public:
+
+  struct PMT {
+    unsigned long chankey;
+    int id;
+    double x, y, z;    ///< cm, relative to the tank centre
+  };
+
+  struct Vertex {
+    double x, y, z, t;   ///< cm, ns
+    double dx, dy, dz;
+  };
+
+  SyntheticEvents(uint64_t seed=1) : seed(seed) {}
+
+  Vertex TrueVertex(uint64_t event) const;
+
+  /// Hit time (ns) and charge (PE) of a PMT, false if the PMT is not hit in this event
+  bool PMTHit(uint64_t event, const PMT &pmt, double &time, double &charge) const;
+
+  /// Digitised waveform of one channel, n samples of 2 ns
+  void FillWaveform(uint64_t event, const PMT &pmt, uint16_t *samples, size_t n) const;
+
+  /// Raw waveforms of all PMTs as written by ANNIEEventBuilder in RawADCData
+  void MakeWaveforms(uint64_t event, const std::vector<PMT> &pmts, size_t nsamples,
+                     std::map<unsigned long, std::vector<Waveform<unsigned short>>> &waveforms) const;
+
+  /// Phase II VME readout of one trigger: one CardData per card with the record header and waveform frames of its channels.
+  /// cards maps CardID to (ChannelID, PMT). nsamples is rounded so header and waveform fill whole frames.
+  void MakeCardData(uint64_t event, const std::map<int, std::vector<std::pair<int,PMT>>> &cards, size_t nsamples,
+                    std::vector<CardData> &carddata) const;
+
+  /// Clock counter (8 ns ticks) written in the record headers of an event
+  uint64_t TriggerCounter(uint64_t event) const;
+
+  void MakeRecoDigits(uint64_t event, const std::vector<PMT> &pmts, std::vector<RecoDigit> &digits) const;
+
+  double occupancy = 0.3;
+  double mean_pe = 4.;
+  double time_jitter = 1.5;      ///< ns
+  double adc_per_pe = 10.;       ///< pulse height
+  double pulse_width = 3.;       ///< ns, sigma of the pulse
+  double baseline = 350.;
+  double noise = 1.5;            ///< ADC counts
+  double trigger_offset = 400.;  ///< ns, light arrives this long after the start of the waveform
+  double event_spacing = 66.7e3; ///< ns between triggers
+  double tank_radius = 100.;     ///< cm, vertices are generated in this cylinder
+  double tank_halfheight = 100.;
+
+  static const size_t SamplesPerFrame = 40;
+  static const size_t RecordHeaderSamples = 8;
+
+ private:
+
+  uint64_t seed;
+
+};
+
+#endif
@@ -0,0 +1,317 @@
+#include "BenchmarkSuite.h"
+#include "Factory.h"
+
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <ctime>
+#include <unistd.h>
+
+BenchmarkSuite::BenchmarkSuite():Tool(){}
+
+
+bool BenchmarkSuite::Initialise(std::string configfile, DataModel &data){
+
+  /////////////////// Useful header ///////////////////////
+  if(configfile!="") m_variables.Initialise(configfile); // loading config file
+  //m_variables.Print();
+
+  m_data= &data; //assigning transient data pointer
+  /////////////////////////////////////////////////////////////////
+
+  results_file = "benchmark_results.csv";
+  baseline_file = "";
+  only = "";
+  m_variables.Get("verbosity",verbosity);
+  m_variables.Get("BenchmarkList",benchmark_list);
+  m_variables.Get("ResultsFile",results_file);
+  m_variables.Get("BaselineFile",baseline_file);
+  m_variables.Get("Only",only);
+  m_variables.Get("WarmupEvents",warmup_events);
+  m_variables.Get("Tolerance",tolerance);
+  m_variables.Get("FailOnRegression",fail_on_regression);
+
+  if(!ReadBenchmarkList()) return false;
+
+  return true;
+}
+
+
+bool BenchmarkSuite::Execute(){
+
+  // everything runs in the first Execute
+  m_data->vars.Set("StopLoop",1);
+
+  for(const Benchmark &bench : benchmarks){
+    if(only!="" && bench.name!=only) continue;
+    if(!RunBenchmark(bench)){
+      Log("BenchmarkSuite Tool: Benchmark "+bench.name+" failed, no results",v_error,verbosity);
+    }
+  }
+
+  for(Result &res : results){
+    std::vector<double> sorted(res.times_us);
+    std::sort(sorted.begin(),sorted.end());
+    size_t n = sorted.size();
+    if(n>0) res.median = (n%2) ? sorted[n/2] : 0.5*(sorted[n/2-1]+sorted[n/2]);
+  }
+
+  int regressions = CompareToBaseline();
+  if(!WriteResults()) return false;
+
+  if(regressions>0 && fail_on_regression){
+    Log("BenchmarkSuite Tool: "+std::to_string(regressions)+" benchmarks slower than the baseline",v_error,verbosity);
+    return false;
+  }
+  return true;
+}
+
+
+bool BenchmarkSuite::Finalise(){
+
+  delete vertex_kernels;
+  vertex_kernels = nullptr;
+
+  return true;
+}
+
+
+bool BenchmarkSuite::ReadBenchmarkList(){
+
+  std::ifstream list(benchmark_list.c_str());
+  if(!list.is_open()){
+    Log("BenchmarkSuite Tool: Cannot open BenchmarkList "+benchmark_list,v_error,verbosity);
+    return false;
+  }
+  std::string line;
+  while(std::getline(list,line)){
+    size_t comment = line.find('#');
+    if(comment!=std::string::npos) line.erase(comment);
+    std::stringstream ss(line);
+    Benchmark bench;
+    if(!(ss >> bench.name)) continue;
+    if(!(ss >> bench.tools_file >> bench.events)){
+      Log("BenchmarkSuite Tool: Invalid line in "+benchmark_list+": "+line,v_error,verbosity);
+      return false;
+    }
+    if(!(ss >> bench.kernels)) bench.kernels = "";
+    if(bench.kernels!="" && bench.kernels!="Vertex"){
+      Log("BenchmarkSuite Tool: Unknown kernel set "+bench.kernels+" for "+bench.name,v_error,verbosity);
+      return false;
+    }
+    benchmarks.push_back(bench);
+  }
+  Log("BenchmarkSuite Tool: "+std::to_string(benchmarks.size())+" benchmarks in "+benchmark_list,v_message,verbosity);
+  return true;
+}
+
+
+bool BenchmarkSuite::RunBenchmark(const Benchmark &bench){
+
+  typedef std::chrono::steady_clock clock;
+
+  std::ifstream tools_config(bench.tools_file.c_str());
+  if(!tools_config.is_open()){
+    Log("BenchmarkSuite Tool: Cannot open "+bench.tools_file,v_error,verbosity);
+    return false;
+  }
+
+  // same format as the ToolsConfig of a toolchain: <name> <class> <configfile>
+  std::vector<std::string> names;
+  std::vector<std::string> configs;
+  std::vector<Tool*> tools;
+  std::string line;
+  bool ok = true;
+  while(ok && std::getline(tools_config,line)){
+    if(line.empty() || line[0]=='#') continue;
+    std::stringstream ss(line);
+    std::string name, classname, config;
+    if(!(ss >> name >> classname >> config)) continue;
+    Tool* tool = Factory(classname);
+    if(tool==nullptr){
+      Log("BenchmarkSuite Tool: Unknown tool "+classname+" in "+bench.tools_file,v_error,verbosity);
+      ok = false;
+      break;
+    }
+    names.push_back(name);
+    configs.push_back(config);
+    tools.push_back(tool);
+  }
+
+  // every benchmark gets a fresh DataModel, like a toolchain of its own
+  DataModel* data = new DataModel();
+  data->Log = m_data->Log;
+  data->context = m_data->context;
+
+  size_t ninit = 0;
+  while(ok && ninit<tools.size()){
+    Log("BenchmarkSuite Tool: "+bench.name+": initialising "+names[ninit],v_message,verbosity);
+    ok = tools[ninit]->Initialise(configs[ninit],*data);
+    if(ok) ninit++;
+    else Log("BenchmarkSuite Tool: "+bench.name+": "+names[ninit]+" failed to initialise",v_error,verbosity);
+  }
+
+  std::vector<Result> bench_results(tools.size()+1);
+  for(size_t i=0; i<tools.size(); i++){
+    bench_results[i].item = names[i];
+    bench_results[i].kind = "tool";
+  }
+  bench_results.back().item = "chain";
+  bench_results.back().kind = "chain";
+  std::vector<Result> kernel_results;
+  if(bench.kernels=="Vertex"){
+    if(vertex_kernels==nullptr) vertex_kernels = new VertexKernels();
+    for(const std::string &kernel : VertexKernels::Names()){
+      Result res;
+      res.item = kernel;
+      res.kind = "function";
+      kernel_results.push_back(res);
+    }
+  }
+
+  int executed = 0;
+  std::vector<double> kernel_times;
+  for(int event=0; ok && event<warmup_events+bench.events; event++){
+    bool timed = (event>=warmup_events);
+    double chain_us = 0.;
+    for(size_t i=0; i<tools.size(); i++){
+      clock::time_point start = clock::now();
+      bool success = tools[i]->Execute();
+      double us = std::chrono::duration<double,std::micro>(clock::now()-start).count();
+      if(!success) Log("BenchmarkSuite Tool: "+bench.name+": "+names[i]+" Execute returned false",v_warning,verbosity);
+      chain_us += us;
+      if(timed) bench_results[i].times_us.push_back(us);
+    }
+    if(timed) bench_results.back().times_us.push_back(chain_us);
+
+    if(bench.kernels=="Vertex"){
+      std::vector<RecoDigit>* digits = nullptr;
+      RecoVertex* vertex = nullptr;
+      if(data->Stores.count("RecoEvent")==0 || !data->Stores["RecoEvent"]->Get("RecoDigit",digits)
+         || !data->Stores["RecoEvent"]->Get("TrueVertex",vertex) || digits==nullptr || vertex==nullptr){
+        Log("BenchmarkSuite Tool: "+bench.name+": the Vertex kernels need RecoDigit and TrueVertex in the RecoEvent",v_error,verbosity);
+        ok = false;
+        break;
+      }
+      vertex_kernels->Run(digits,vertex,event,kernel_times);
+      for(size_t k=0; timed && k<kernel_times.size(); k++) kernel_results[k].times_us.push_back(kernel_times[k]);
+    }
+    executed++;
+
+    int stop = 0;
+    data->vars.Get("StopLoop",stop);
+    if(stop){
+      Log("BenchmarkSuite Tool: "+bench.name+": StopLoop set after "+std::to_string(executed)+" events",v_warning,verbosity);
+      break;
+    }
+  }
+
+  for(size_t i=0; i<ninit; i++) tools[i]->Finalise();
+  if(verbosity>=v_message) data->Arena.PrintStats(std::cout);
+  for(Tool* tool : tools) delete tool;
+  delete data;
+
+  if(!ok) return false;
+  Log("BenchmarkSuite Tool: "+bench.name+": "+std::to_string(executed)+" events ("+std::to_string(warmup_events)
+      +" warmup)",v_message,verbosity);
+
+  for(Result &res : bench_results){
+    res.benchmark = bench.name;
+    results.push_back(res);
+  }
+  for(Result &res : kernel_results){
+    res.benchmark = bench.name;
+    results.push_back(res);
+  }
+  return true;
+}
+
+
+bool BenchmarkSuite::ReadBaseline(std::map<std::string,double> &baseline){
+
+  std::ifstream in(baseline_file.c_str());
+  if(!in.is_open()){
+    Log("BenchmarkSuite Tool: Cannot open BaselineFile "+baseline_file,v_error,verbosity);
+    return false;
+  }
+  std::string line;
+  while(std::getline(in,line)){
+    if(line.empty() || line[0]=='#' || line.compare(0,10,"benchmark,")==0) continue;
+    std::vector<std::string> columns;
+    std::stringstream ss(line);
+    std::string column;
+    while(std::getline(ss,column,',')) columns.push_back(column);
+    if(columns.size()<6) continue;
+    baseline[columns[0]+"/"+columns[1]] = std::stod(columns[5]);
+  }
+  return true;
+}
+
+
+int BenchmarkSuite::CompareToBaseline(){
+
+  std::map<std::string,double> baseline;
+  if(baseline_file!="" && !ReadBaseline(baseline)) return 0;
+
+  int regressions = 0;
+  for(Result &res : results){
+    auto base = baseline.find(res.benchmark+"/"+res.item);
+    if(baseline_file=="" || base==baseline.end()){
+      res.status = (baseline_file=="") ? "" : "new";
+      continue;
+    }
+    res.baseline = base->second;
+    double ratio = (res.baseline>0.) ? res.median/res.baseline : 1.;
+    if(ratio > 1.+tolerance){
+      res.status = "regression";
+      regressions++;
+      Log("BenchmarkSuite Tool: REGRESSION "+res.benchmark+"/"+res.item+": median "+std::to_string(res.median)
+          +" us, baseline "+std::to_string(res.baseline)+" us",v_warning,verbosity);
+    }
+    else if(ratio < 1.-tolerance) res.status = "improved";
+    else res.status = "ok";
+  }
+  return regressions;
+}
+
+
+bool BenchmarkSuite::WriteResults(){
+
+  std::ofstream out(results_file.c_str());
+  if(!out.is_open()){
+    Log("BenchmarkSuite Tool: Cannot write ResultsFile "+results_file,v_error,verbosity);
+    return false;
+  }
+
+  char host[256] = "unknown";
+  gethostname(host,sizeof(host)-1);
+  char date[64];
+  std::time_t now = std::time(nullptr);
+  std::strftime(date,sizeof(date),"%Y-%m-%d %H:%M:%S",std::localtime(&now));
+  out << "# ToolAnalysis benchmarks, host " << host << ", " << date << ", "
+      << warmup_events << " warmup events, times in microseconds per event\n";
+  out << "benchmark,item,kind,calls,mean_us,median_us,min_us,max_us,baseline_median_us,ratio,status\n";
+
+  for(const Result &res : results){
+    size_t n = res.times_us.size();
+    double mean = n ? std::accumulate(res.times_us.begin(),res.times_us.end(),0.)/n : 0.;
+    double min = n ? *std::min_element(res.times_us.begin(),res.times_us.end()) : 0.;
+    double max = n ? *std::max_element(res.times_us.begin(),res.times_us.end()) : 0.;
+    out << res.benchmark << "," << res.item << "," << res.kind << "," << n << "," << mean << "," << res.median
+        << "," << min << "," << max << ",";
+    if(res.baseline>=0.) out << res.baseline << "," << ((res.baseline>0.) ? res.median/res.baseline : 1.);
+    else out << ",";
+    out << "," << res.status << "\n";
+
+    if(verbosity>=v_message){
+      std::cout << "BenchmarkSuite: " << res.benchmark << "/" << res.item << " median " << res.median
+                << " us, mean " << mean << " us over " << n << " events";
+      if(res.baseline>=0.) std::cout << ", baseline " << res.baseline << " us (" << res.status << ")";
+      std::cout << std::endl;
+    }
+  }
+  Log("BenchmarkSuite Tool: Results written to "+results_file,v_message,verbosity);
+  return true;
+}
@@ -0,0 +1,79 @@
+#ifndef BenchmarkSuite_H
+#define BenchmarkSuite_H
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <map>
+
+#include "Tool.h"
+#include "VertexKernels.h"
+
+/**
+ * \class BenchmarkSuite
+ *
+ * Runs the benchmarks of BenchmarkList and writes the timings to a csv file. Each benchmark is a toolchain given as a
+ * ToolsConfig file; its tools are created with the Factory and run on their own DataModel, and every Execute call is
+ * timed, so one run gives the time of each tool (micro) and of the whole chain per event (macro). The inputs come from
+ * BenchmarkInput, so the results do not depend on data files. With a baseline file (an earlier results file) the
+ * medians are compared and changes beyond Tolerance are flagged as regressions.
+ */
+
+class BenchmarkSuite: public Tool {
+
+
+ public:
+
+  BenchmarkSuite(); ///< Simple constructor
+  bool Initialise(std::string configfile,DataModel &data); ///< Initialise Function for setting up Tool resources. @param configfile The path and name of the dynamic configuration file to read in. @param data A reference to the transient data class used to pass information between Tools.
+  bool Execute(); ///< Execute function used to perform Tool purpose.
+  bool Finalise(); ///< Finalise function used to clean up resources.
+
+
+ private:
+
+  struct Benchmark {
+    std::string name;
+    std::string tools_file;
+    int events;
+    std::string kernels;
+  };
+
+  struct Result {
+    std::string benchmark;
+    std::string item;
+    std::string kind;       ///< tool, chain or function
+    std::vector<double> times_us;
+    double median = 0.;
+    double baseline = -1.;
+    std::string status;
+  };
+
+  bool ReadBenchmarkList();
+  bool RunBenchmark(const Benchmark &bench);
+  bool ReadBaseline(std::map<std::string,double> &baseline);
+  int CompareToBaseline();
+  bool WriteResults();
+
+  int verbosity = 1;
+  std::string benchmark_list;
+  std::string results_file;
+  std::string baseline_file;
+  std::string only;
+  int warmup_events = 5;
+  double tolerance = 0.1;
+  bool fail_on_regression = false;
+
+  std::vector<Benchmark> benchmarks;
+  std::vector<Result> results;
+  VertexKernels* vertex_kernels = nullptr;
+
+  int v_error=0;
+  int v_warning=1;
+  int v_message=2;
+  int v_debug=3;
+
+};
+
+
+#endif
@@ -0,0 +1,61 @@
+#include "VertexKernels.h"
+#include "TRandom.h"
+
+#include <chrono>
+
+VertexKernels::VertexKernels(){
+  vtxgeo = VertexGeometry::Instance();
+  fom.LoadVertexGeometry(vtxgeo);
+}
+
+
+const std::vector<std::string>& VertexKernels::Names(){
+  static const std::vector<std::string> names{"VertexGeometry::LoadDigits","VertexGeometry::CalcPointResiduals",
+      "VertexGeometry::CalcExtendedResiduals","VertexGeometry::CalcVertexSeeds","FoMCalculator::PointPositionChi2",
+      "FoMCalculator::PointVertexChi2","FoMCalculator::ExtendedVertexChi2"};
+  return names;
+}
+
+
+void VertexKernels::Run(std::vector<RecoDigit>* digits, RecoVertex* vertex, unsigned int event, std::vector<double> &times_us){
+
+  typedef std::chrono::steady_clock clock;
+  const double x = vertex->GetPosition().X();
+  const double y = vertex->GetPosition().Y();
+  const double z = vertex->GetPosition().Z();
+  const double t = vertex->GetTime();
+  const double dx = vertex->GetDirection().X();
+  const double dy = vertex->GetDirection().Y();
+  const double dz = vertex->GetDirection().Z();
+  double result = 0.;
+
+  times_us.assign(Names().size(),0.);
+  clock::time_point start = clock::now();
+  auto lap = [&](int i){
+    clock::time_point now = clock::now();
+    times_us[i] = std::chrono::duration<double,std::micro>(now-start).count();
+    start = now;
+  };
+
+  vtxgeo->LoadDigits(digits);
+  lap(0);
+  vtxgeo->CalcPointResiduals(x,y,z,t,dx,dy,dz);
+  lap(1);
+  vtxgeo->CalcExtendedResiduals(x,y,z,t,dx,dy,dz);
+  lap(2);
+  // CalcVertexSeeds draws from gRandom: it gets our own generator, seeded per event so every run
+  // picks the same quadruples, and the generator of the chain is restored afterwards
+  seed_random.SetSeed(event+1);
+  TRandom* chain_random = gRandom;
+  gRandom = &seed_random;
+  start = clock::now();
+  vtxgeo->CalcVertexSeeds(num_seeds);
+  lap(3);
+  gRandom = chain_random;
+  fom.PointPositionChi2(x,y,z,t,result);
+  lap(4);
+  fom.PointVertexChi2(x,y,z,dx,dy,dz,cone_angle,t,result);
+  lap(5);
+  fom.ExtendedVertexChi2(x,y,z,dx,dy,dz,cone_angle,t,result);
+  lap(6);
+}
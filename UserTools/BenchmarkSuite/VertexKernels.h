@@ -0,0 +1,42 @@
+#ifndef VertexKernels_H
+#define VertexKernels_H
+
+#include <string>
+#include <vector>
+
+#include "RecoDigit.h"
+#include "RecoVertex.h"
+#include "VertexGeometry.h"
+#include "FoMCalculator.h"
+#include "TRandom3.h"
+
+/**
+ * \class VertexKernels
+ *
+ * Per-function benchmarks of the vertex reconstruction classes of the DataModel. Run() calls each function once
+ * on the digits of an event, at the true vertex, and returns the time of each call in microseconds in the order
+ * of Names(). The functions are the ones the Vtx* tools call for every candidate vertex of the fits.
+ */
+
+class VertexKernels {
+
+ public:
+
+  VertexKernels();
+
+  static const std::vector<std::string>& Names();
+
+  void Run(std::vector<RecoDigit>* digits, RecoVertex* vertex, unsigned int event, std::vector<double> &times_us);
+
+  int num_seeds = 500;     ///< CalcVertexSeeds, default NumberOfSeeds of VtxSeedGenerator
+  double cone_angle = 42.;
+
+ private:
+
+  VertexGeometry* vtxgeo;
+  FoMCalculator fom;
+  TRandom3 seed_random;    ///< generator for CalcVertexSeeds, so the chain's gRandom is not reseeded
+
+};
+
+#endif
@@ -18,10 +18,18 @@ bool CNNImage::Initialise(std::string configfile, DataModel &data){
   m_variables.Get("Dimension",dimension);
   m_variables.Get("OutputFile",cnn_outpath);
   m_variables.Get("DetectorConf",detector_config);
+  output_format = "csv";
+  batch_size = 1000;
+  save_root = true;
+  m_variables.Get("OutputFormat",output_format);
+  m_variables.Get("BatchSize",batch_size);
+  m_variables.Get("SaveRootFile",save_root);
 
 
   if (mode != "Charge" && mode != "Time") mode = "Charge";
   if (verbosity > 2) std::cout <<"Mode: "<<mode<<std::endl;
+  if (output_format != "csv" && output_format != "binary") output_format = "csv";
+  if (verbosity > 2) std::cout <<"OutputFormat: "<<output_format<<std::endl;
 
   //get geometry		
 
@@ -72,8 +80,13 @@ bool CNNImage::Initialise(std::string configfile, DataModel &data){
   std::string rootfile_name = cnn_outpath + str_root;
   std::string csvfile_name = cnn_outpath + str_csv;
 
-  file = new TFile(rootfile_name.c_str(),"RECREATE");
-  outfile.open(csvfile_name.c_str());
+  if (save_root) file = new TFile(rootfile_name.c_str(),"RECREATE");
+  if (output_format == "binary") {
+    //binary tensor file (cnn_outpath.bin) + event index (cnn_outpath_index.csv)
+    if (!tensor_writer.Open(cnn_outpath,mode,1,dimension,dimension,batch_size)) return false;
+    image_pixels.assign(dimension*dimension,0.);
+  }
+  else outfile.open(csvfile_name.c_str());
 
   return true;
 }
@@ -239,16 +252,28 @@ bool CNNImage::Execute(){
 
   if (bool_primary && bool_geometry && bool_nhits) {
 
-    hist_cnn->Write();
-    for (int i_binY=0; i_binY < hist_cnn->GetNbinsY();i_binY++){
-      for (int i_binX=0; i_binX < hist_cnn->GetNbinsX();i_binX++){
-        outfile << hist_cnn->GetBinContent(i_binX+1,i_binY+1);
-        if (i_binX != hist_cnn->GetNbinsX()-1 || i_binY!=hist_cnn->GetNbinsY()-1) outfile<<",";
+    if (save_root) hist_cnn->Write();
+    if (output_format == "binary"){
+      //same flattening as the csv format, collected in batches by the tensor writer
+      for (int i_binY=0; i_binY < hist_cnn->GetNbinsY();i_binY++){
+        for (int i_binX=0; i_binX < hist_cnn->GetNbinsX();i_binX++){
+          image_pixels[i_binY*dimension+i_binX] = hist_cnn->GetBinContent(i_binX+1,i_binY+1);
+        }
+      }
+      if (!tensor_writer.AddImage(image_pixels,runnumber,subrunnumber,evnum)) std::cout <<"Tool CNNImage: ERROR: Could not write image of event "<<evnum<<" to the binary tensor file"<<std::endl;
+    } else {
+      for (int i_binY=0; i_binY < hist_cnn->GetNbinsY();i_binY++){
+        for (int i_binX=0; i_binX < hist_cnn->GetNbinsX();i_binX++){
+          outfile << hist_cnn->GetBinContent(i_binX+1,i_binY+1);
+          if (i_binX != hist_cnn->GetNbinsX()-1 || i_binY!=hist_cnn->GetNbinsY()-1) outfile<<",";
+        }
       }
+      outfile << std::endl;
     }
-    outfile << std::endl;
   }
 
+  delete hist_cnn;
+
   return true;
 }
 
@@ -256,8 +281,12 @@ bool CNNImage::Execute(){
 bool CNNImage::Finalise(){
   
   if (verbosity >=2 ) std::cout <<"Finalising tool: CNNImage..."<<std::endl;
-  file->Close();
-  outfile.close();
+  if (file) file->Close();
+  if (output_format == "binary") {
+    if (!tensor_writer.Close()) std::cout <<"Tool CNNImage: ERROR: Writing the binary tensor file failed"<<std::endl;
+    if (verbosity >= 1) std::cout <<"Tool CNNImage: Wrote "<<tensor_writer.GetNumEvents()<<" images to "<<cnn_outpath<<".bin"<<std::endl;
+  }
+  else outfile.close();
 
   return true;
 }
@@ -10,6 +10,7 @@
 #include "TFile.h"
 
 #include "Tool.h"
+#include "CNNTensorWriter.h"
 
 
 /**
@@ -40,6 +41,9 @@ class CNNImage: public Tool {
   std::string detector_config;
   int verbosity;
   std::string mode;     //Charge, Time
+  std::string output_format;    //csv, binary
+  int batch_size;       //number of images per write in binary format
+  bool save_root;       //save the images as TH2F in the root file as well
   int dimension;        //dimension of the CNN image (e.g. 32, 64)
   int runnumber;
   int subrunnumber;
@@ -62,6 +66,8 @@ class CNNImage: public Tool {
   double size_top_drawing = 0.1;
 
   ofstream outfile;
+  CNNTensorWriter tensor_writer;
+  std::vector<float> image_pixels;
 
   Position truevtx;
   double truevtx_x, truevtx_y, truevtx_z;
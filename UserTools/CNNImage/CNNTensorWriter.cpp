@@ -0,0 +1,107 @@
+#include "CNNTensorWriter.h"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+
+namespace {
+  const char tensor_magic[8] = {'A','N','N','I','E','C','N','N'};
+  const uint32_t tensor_version = 1;
+  const uint32_t tensor_header_size = 64;
+  const uint32_t tensor_dtype_float32 = 1;
+  const std::streamoff tensor_nevents_offset = 32;
+}
+
+CNNTensorWriter::CNNTensorWriter() : batch_size(1000), batch_events(0), image_size(0), num_events(0), is_open(false) {}
+
+CNNTensorWriter::~CNNTensorWriter(){
+  if (is_open) Close();
+}
+
+bool CNNTensorWriter::Open(std::string filename_base, std::string mode, int channels, int height, int width, int batchsize){
+
+  if (channels <= 0 || height <= 0 || width <= 0) return false;
+  batch_size = (batchsize > 0)? batchsize : 1;
+  image_size = std::size_t(channels)*height*width;
+  num_events = 0;
+  batch_events = 0;
+  batch.clear();
+  batch.reserve(image_size*batch_size);
+  batch_index.clear();
+
+  std::string tensor_name = filename_base + ".bin";
+  std::string index_name = filename_base + "_index.csv";
+  tensor_file.open(tensor_name.c_str(),std::ios::out | std::ios::binary | std::ios::trunc);
+  index_file.open(index_name.c_str(),std::ios::out | std::ios::trunc);
+  if (!tensor_file.is_open() || !index_file.is_open()){
+    std::cout <<"CNNTensorWriter: ERROR: Could not open "<<tensor_name<<" / "<<index_name<<" for writing"<<std::endl;
+    return false;
+  }
+
+  //fixed-size header, the number of events is filled in on Close
+  char header[tensor_header_size];
+  std::memset(header,0,tensor_header_size);
+  uint32_t dims[6] = {tensor_version, tensor_header_size, tensor_dtype_float32, uint32_t(channels), uint32_t(height), uint32_t(width)};
+  std::memcpy(header,tensor_magic,8);
+  std::memcpy(header+8,dims,6*sizeof(uint32_t));
+  std::memcpy(header+tensor_nevents_offset,&num_events,sizeof(uint64_t));
+  std::strncpy(header+40,mode.c_str(),15);
+  tensor_file.write(header,tensor_header_size);
+
+  index_file << "index,runnumber,subrunnumber,eventnumber" << std::endl;
+  is_open = tensor_file.good();
+  return is_open;
+
+}
+
+bool CNNTensorWriter::AddImage(const std::vector<float> &pixels, int runnumber, int subrunnumber, int evnum){
+
+  if (!is_open) return false;
+  if (pixels.size() != image_size){
+    std::cout <<"CNNTensorWriter: ERROR: Image has "<<pixels.size()<<" values, expected "<<image_size<<std::endl;
+    return false;
+  }
+
+  batch.insert(batch.end(),pixels.begin(),pixels.end());
+  std::stringstream ss_index;
+  ss_index << num_events+batch_events << "," << runnumber << "," << subrunnumber << "," << evnum;
+  batch_index.push_back(ss_index.str());
+  batch_events++;
+
+  if (batch_events >= batch_size) return Flush();
+  return true;
+
+}
+
+bool CNNTensorWriter::Flush(){
+
+  if (batch_events == 0) return true;
+  tensor_file.write(reinterpret_cast<const char*>(batch.data()),batch.size()*sizeof(float));
+  for (unsigned int i_ev = 0; i_ev < batch_index.size(); i_ev++) index_file << batch_index.at(i_ev) << "\n";
+  num_events += batch_events;
+  batch.clear();
+  batch_index.clear();
+  batch_events = 0;
+  if (!tensor_file.good() || !index_file.good()){
+    std::cout <<"CNNTensorWriter: ERROR: Writing the tensor/index file failed"<<std::endl;
+    return false;
+  }
+  return true;
+
+}
+
+bool CNNTensorWriter::Close(){
+
+  if (!is_open) return false;
+  bool ok = Flush();
+
+  //update the number of events in the header
+  tensor_file.seekp(tensor_nevents_offset,std::ios::beg);
+  tensor_file.write(reinterpret_cast<const char*>(&num_events),sizeof(uint64_t));
+  ok = ok && tensor_file.good();
+
+  tensor_file.close();
+  index_file.close();
+  is_open = false;
+  return ok;
+
+}
@@ -0,0 +1,60 @@
+#ifndef CNNTensorWriter_H
+#define CNNTensorWriter_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+
+/**
+ * \class CNNTensorWriter
+ *
+ * Writes CNN images as one contiguous binary tensor file that can be memory-mapped by the training code.
+ *
+ * <OutputFile>.bin: 64 byte header followed by num_events x channels x height x width float32 values (row-major, the x index
+ * runs fastest like in the csv format). All values are written in the byte order of the host (little endian on x86). Header layout:
+ *   0  char[8]   magic "ANNIECNN"
+ *   8  uint32    format version (1)
+ *   12 uint32    header size in bytes (64)
+ *   16 uint32    data type (1 = float32)
+ *   20 uint32    channels
+ *   24 uint32    height
+ *   28 uint32    width
+ *   32 uint64    number of events (updated on Close, can otherwise be derived from the file size)
+ *   40 char[16]  image mode (Charge/Time)
+ *   56 8 bytes   reserved
+ *
+ * <OutputFile>_index.csv: one line per written image with the tensor index, run, subrun and event number.
+ *
+ * Images are collected in memory and written in batches of BatchSize events.
+ */
+
+class CNNTensorWriter {
+
+ public:
+
+  CNNTensorWriter();
+  ~CNNTensorWriter();
+
+  bool Open(std::string filename_base, std::string mode, int channels, int height, int width, int batch_size);  ///< Create the tensor and index files
+  bool AddImage(const std::vector<float> &pixels, int runnumber, int subrunnumber, int evnum);               ///< Append one image of channels x height x width values
+  bool Close();                                                                                          ///< Flush the last batch and write the final event count to the header
+  uint64_t GetNumEvents(){return num_events;}
+
+ private:
+
+  bool Flush();
+
+  std::ofstream tensor_file;
+  std::ofstream index_file;
+  std::vector<float> batch;
+  std::vector<std::string> batch_index;
+  int batch_size;
+  int batch_events;
+  std::size_t image_size;
+  uint64_t num_events;
+  bool is_open;
+
+};
+
+#endif
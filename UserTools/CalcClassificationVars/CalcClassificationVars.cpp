@@ -13,6 +13,7 @@ bool CalcClassificationVars::Initialise(std::string configfile, DataModel &data)
 	isData = 0;
 	neutrino_sample = false;
 	charge_conversion = 1.375;
+	fast_likelihood = true;
 	pdf_emu = "/annie/app/users/mnieslon/MyToolAnalysis6/pdfs/pdf_beamlike_emu_500bins_sumw2.root";
 	pdf_rings = "/annie/app/users/mnieslon/MyToolAnalysis6/pdfs/pdf_beam_rings_500bins_sumw2.root";
 
@@ -24,6 +25,7 @@ bool CalcClassificationVars::Initialise(std::string configfile, DataModel &data)
 	m_variables.Get("PDF_rings",pdf_rings);
 	m_variables.Get("SinglePEgains",singlePEgains);
 	m_variables.Get("ChargeConversionMCData",charge_conversion);
+	m_variables.Get("FastLikelihood",fast_likelihood);
 
 	// Geometry variables
 	m_data->Stores["ANNIEEvent"]->Header->Get("AnnieGeometry",geom);
@@ -169,6 +171,10 @@ bool CalcClassificationVars::Finalise(){
   
 	TFile *f = new TFile("temp.root","RECREATE");
 	f->cd();
+	this->FillTH1F(hist_charge,event_charge);
+	this->FillTH1F(hist_time,event_time);
+	this->FillTH1F(hist_theta,event_theta);
+	this->FillTH1F(hist_phi,event_phi);
 	pdf_mu_charge->Write();
 	pdf_mu_time->Write();
 	pdf_mu_theta->Write();
@@ -248,6 +254,36 @@ void CalcClassificationVars::InitialisePDFs(){
 	pdf_single_charge->Rebin(50);
 	pdf_multi_charge->Rebin(50);
 
+	// Event distributions and PDFs as flat arrays for the fast likelihood evaluation
+	hist_charge.SetBinning(nbins_charge,min_charge,max_charge);
+	hist_time.SetBinning(nbins_time,min_time,max_time);
+	hist_theta.SetBinning(nbins_theta,min_theta,max_theta);
+	hist_phi.SetBinning(nbins_phi,min_phi,max_phi);
+
+	PDFChi2Kernel* kernels[4] = {&kernel_charge,&kernel_time,&kernel_theta,&kernel_phi};
+	int nbins[4] = {nbins_charge,nbins_time,nbins_theta,nbins_phi};
+	TH1F* pdfs[4][4] = {{pdf_mu_charge,pdf_e_charge,pdf_single_charge,pdf_multi_charge},
+		{pdf_mu_time,pdf_e_time,pdf_single_time,pdf_multi_time},
+		{pdf_mu_theta,pdf_e_theta,pdf_single_theta,pdf_multi_theta},
+		{pdf_mu_phi,pdf_e_phi,pdf_single_phi,pdf_multi_phi}};
+
+	for (int i_var=0; i_var < 4; i_var++){
+		kernels[i_var]->SetNbins(nbins[i_var]);
+		for (int i_pdf=0; i_pdf < 4; i_pdf++){
+			TH1F *pdf = pdfs[i_var][i_pdf];
+			std::vector<double> contents, errors_sq;
+			for (int i_bin=1; i_bin <= pdf->GetNbinsX(); i_bin++){
+				contents.push_back(pdf->GetBinContent(i_bin));
+				errors_sq.push_back(pow(pdf->GetBinError(i_bin),2));
+			}
+			std::string error;
+			if (fast_likelihood && !kernels[i_var]->AddPDF(contents,errors_sq,error)){
+				Log("CalcClassificationVars tool: Cannot preload PDF "+std::string(pdf->GetName())+" ("+error+"), using TH1F::Chi2Test for the likelihoods",v_warning,verbosity);
+				fast_likelihood = false;
+			}
+		}
+	}
+
 
 }
 
@@ -418,10 +454,10 @@ void CalcClassificationVars::ClassificationVarsPMTLAPPD(){
 
 	Log("CalcClassificationVars tool: Reading out PMT/LAPPD data",v_message,verbosity);
 	
-	event_charge->Reset();
-	event_time->Reset();
-	event_theta->Reset();
-	event_phi->Reset();
+	hist_charge.Reset();
+	hist_time.Reset();
+	hist_theta.Reset();
+	hist_phi.Reset();
 
 	// Information available both in data & MC
 	double pmt_QDownstream=0.;
@@ -498,8 +534,8 @@ void CalcClassificationVars::ClassificationVarsPMTLAPPD(){
 			pmtQ.push_back(digitQ);
 			pmtT.push_back(digitT);
 			pmtID.push_back(digitID);
-			event_charge->Fill(digitQ);
-			event_time->Fill(digitT);
+			hist_charge.Fill(digitQ);
+			hist_time.Fill(digitT);
 			pmtPos.push_back(detector_pos);
 			pmt_totalQ+=digitQ;
 			pmt_avgT+=digitT;
@@ -727,7 +763,7 @@ void CalcClassificationVars::ClassificationVarsPMTLAPPD(){
 		pmt_varT+=pow(pmtT.at(i_pmt)-pmt_avgT,2);
 		pmt_varTheta+=(pow(pmtTheta.at(i_pmt),2)*pmtQ.at(i_pmt)/pmt_totalQ);
 		pmt_theta_bary = pmtTheta.at(i_pmt) - pmtBaryTheta;
-		event_theta->Fill(pmt_theta_bary);
+		hist_theta.Fill(pmt_theta_bary);
 		pmtThetaBary.push_back(pmt_theta_bary);
 		pmt_rmsThetaBary+=pow(pmt_theta_bary,2);
 		pmt_varThetaBary+=(pow(pmt_theta_bary,2)*pmtQ.at(i_pmt)/pmt_totalQ);
@@ -743,7 +779,7 @@ void CalcClassificationVars::ClassificationVarsPMTLAPPD(){
 		double pmt_phi_bary = (pmtPhi.at(i_pmt)-pmtBaryPhi);
 		if (pmt_phi_bary > TMath::Pi()) pmt_phi_bary = -(2*TMath::Pi()-pmt_phi_bary);
 		else if (pmt_phi_bary < -TMath::Pi()) pmt_phi_bary = 2*TMath::Pi()+pmt_phi_bary;
-		event_phi->Fill(pmt_phi_bary);
+		hist_phi.Fill(pmt_phi_bary);
 		pmtPhiBary.push_back(pmt_phi_bary);
 		pmt_rmsPhiBary+=(pow(pmt_phi_bary,2));
 		pmt_varPhiBary+=(pow(pmt_phi_bary,2)*pmtQ.at(i_pmt)/pmt_totalQ);
@@ -795,27 +831,29 @@ void CalcClassificationVars::ClassificationVarsPMTLAPPD(){
 	}
 
 	// Calculate likelihood variables
-	double pmt_charge_mu = pdf_mu_charge->Chi2Test(event_charge,"UUNORMCHI2/NDF");
-	double pmt_time_mu = pdf_mu_time->Chi2Test(event_time,"UUNORMCHI2/NDF");
-	double pmt_theta_mu = pdf_mu_theta->Chi2Test(event_theta,"UUNORMCHI2/NDF");
-	double pmt_phi_mu = pdf_mu_phi->Chi2Test(event_phi,"UUNORMCHI2/NDF");
-	double pmt_charge_e = pdf_e_charge->Chi2Test(event_charge,"UUNORMCHI2/NDF");
-	double pmt_time_e = pdf_e_time->Chi2Test(event_time,"UUNORMCHI2/NDF");
-	double pmt_theta_e = pdf_e_theta->Chi2Test(event_theta,"UUNORMCHI2/NDF");
-	double pmt_phi_e = pdf_e_phi->Chi2Test(event_phi,"UUNORMCHI2/NDF");
+	double chi2_charge[4], chi2_time[4], chi2_theta[4], chi2_phi[4];
+	this->CompareToPDFs(chi2_charge,chi2_time,chi2_theta,chi2_phi);
+	double pmt_charge_mu = chi2_charge[0];
+	double pmt_time_mu = chi2_time[0];
+	double pmt_theta_mu = chi2_theta[0];
+	double pmt_phi_mu = chi2_phi[0];
+	double pmt_charge_e = chi2_charge[1];
+	double pmt_time_e = chi2_time[1];
+	double pmt_theta_e = chi2_theta[1];
+	double pmt_phi_e = chi2_phi[1];
 	double pmt_charge_likelihood = pmt_charge_e - pmt_charge_mu;
 	double pmt_time_likelihood = pmt_time_e - pmt_time_mu;
 	double pmt_theta_likelihood = pmt_theta_e - pmt_theta_mu;
 	double pmt_phi_likelihood = pmt_phi_e - pmt_phi_mu;
 	
-	double pmt_charge_single = pdf_single_charge->Chi2Test(event_charge,"UUNORMCHI2/NDF");
-	double pmt_time_single = pdf_single_time->Chi2Test(event_time,"UUNORMCHI2/NDF");
-	double pmt_theta_single = pdf_single_theta->Chi2Test(event_theta,"UUNORMCHI2/NDF");
-	double pmt_phi_single = pdf_single_phi->Chi2Test(event_phi,"UUNORMCHI2/NDF");
-	double pmt_charge_multi = pdf_multi_charge->Chi2Test(event_charge,"UUNORMCHI2/NDF");
-	double pmt_time_multi = pdf_multi_time->Chi2Test(event_time,"UUNORMCHI2/NDF");
-	double pmt_theta_multi = pdf_multi_theta->Chi2Test(event_theta,"UUNORMCHI2/NDF");
-	double pmt_phi_multi = pdf_multi_phi->Chi2Test(event_phi,"UUNORMCHI2/NDF");
+	double pmt_charge_single = chi2_charge[2];
+	double pmt_time_single = chi2_time[2];
+	double pmt_theta_single = chi2_theta[2];
+	double pmt_phi_single = chi2_phi[2];
+	double pmt_charge_multi = chi2_charge[3];
+	double pmt_time_multi = chi2_time[3];
+	double pmt_theta_multi = chi2_theta[3];
+	double pmt_phi_multi = chi2_phi[3];
 	double pmt_charge_likelihood_rings = pmt_charge_multi - pmt_charge_single;
 	double pmt_time_likelihood_rings = pmt_time_multi - pmt_time_single;
 	double pmt_theta_likelihood_rings = pmt_theta_multi - pmt_theta_single;
@@ -1192,6 +1230,55 @@ void CalcClassificationVars::StorePionEnergies(){
 
 }
 
+void CalcClassificationVars::CompareToPDFs(double *chi2_charge, double *chi2_time, double *chi2_theta, double *chi2_phi){
+
+	//Chi2/NDF of the event distributions with respect to the mu, e, single ring and multi ring PDFs (in this order)
+
+	if (fast_likelihood){
+		kernel_charge.Evaluate(hist_charge,chi2_charge);
+		kernel_time.Evaluate(hist_time,chi2_time);
+		kernel_theta.Evaluate(hist_theta,chi2_theta);
+		kernel_phi.Evaluate(hist_phi,chi2_phi);
+		return;
+	}
+
+	this->FillTH1F(hist_charge,event_charge);
+	this->FillTH1F(hist_time,event_time);
+	this->FillTH1F(hist_theta,event_theta);
+	this->FillTH1F(hist_phi,event_phi);
+
+	chi2_charge[0] = pdf_mu_charge->Chi2Test(event_charge,"UUNORMCHI2/NDF");
+	chi2_time[0] = pdf_mu_time->Chi2Test(event_time,"UUNORMCHI2/NDF");
+	chi2_theta[0] = pdf_mu_theta->Chi2Test(event_theta,"UUNORMCHI2/NDF");
+	chi2_phi[0] = pdf_mu_phi->Chi2Test(event_phi,"UUNORMCHI2/NDF");
+	chi2_charge[1] = pdf_e_charge->Chi2Test(event_charge,"UUNORMCHI2/NDF");
+	chi2_time[1] = pdf_e_time->Chi2Test(event_time,"UUNORMCHI2/NDF");
+	chi2_theta[1] = pdf_e_theta->Chi2Test(event_theta,"UUNORMCHI2/NDF");
+	chi2_phi[1] = pdf_e_phi->Chi2Test(event_phi,"UUNORMCHI2/NDF");
+	chi2_charge[2] = pdf_single_charge->Chi2Test(event_charge,"UUNORMCHI2/NDF");
+	chi2_time[2] = pdf_single_time->Chi2Test(event_time,"UUNORMCHI2/NDF");
+	chi2_theta[2] = pdf_single_theta->Chi2Test(event_theta,"UUNORMCHI2/NDF");
+	chi2_phi[2] = pdf_single_phi->Chi2Test(event_phi,"UUNORMCHI2/NDF");
+	chi2_charge[3] = pdf_multi_charge->Chi2Test(event_charge,"UUNORMCHI2/NDF");
+	chi2_time[3] = pdf_multi_time->Chi2Test(event_time,"UUNORMCHI2/NDF");
+	chi2_theta[3] = pdf_multi_theta->Chi2Test(event_theta,"UUNORMCHI2/NDF");
+	chi2_phi[3] = pdf_multi_phi->Chi2Test(event_phi,"UUNORMCHI2/NDF");
+
+}
+
+void CalcClassificationVars::FillTH1F(const FixedHistogram &hist, TH1F *h){
+
+	//Copy the contents including under- and overflow, the TH1F has the same binning
+	h->Reset();
+	double entries = 0.;
+	for (int i_bin=0; i_bin <= hist.GetNbins()+1; i_bin++){
+		h->SetBinContent(i_bin,hist.GetBinContent(i_bin));
+		entries += hist.GetBinContent(i_bin);
+	}
+	h->SetEntries(entries);
+
+}
+
 double CalcClassificationVars::ComputeChi2(TH1F *h1, TH1F *h2){
 
   //Copy of ROOT code for calculating chi2-values when comparing two histograms.
@@ -21,6 +21,8 @@
 #include "RecoDigit.h"
 #include "RecoCluster.h"
 
+#include "FixedHistogram.h"
+
 class CalcClassificationVars: public Tool {
 
  public:
@@ -39,6 +41,8 @@ class CalcClassificationVars: public Tool {
   void ClassificationVarsPMTLAPPD();
   void ClassificationVarsMRD();
   double ComputeChi2(TH1F *h1, TH1F *h2);
+  void CompareToPDFs(double *chi2_charge, double *chi2_time, double *chi2_theta, double *chi2_phi);
+  void FillTH1F(const FixedHistogram &hist, TH1F *h);
 
 
  private:
@@ -51,6 +55,7 @@ class CalcClassificationVars: public Tool {
   std::string pdf_rings;
   std::string singlePEgains;
   double charge_conversion;
+  bool fast_likelihood;
 
   // ANNIEEvent / RecoStore variables
   int evnum, mcevnum;
@@ -112,6 +117,9 @@ class CalcClassificationVars: public Tool {
   TH1F *pdf_multi_theta = nullptr;
   TH1F *pdf_multi_phi = nullptr;
 
+  //Fast likelihood evaluation: event distributions and PDFs as flat arrays, PDF order mu, e, single ring, multi ring
+  FixedHistogram hist_charge, hist_time, hist_theta, hist_phi;
+  PDFChi2Kernel kernel_charge, kernel_time, kernel_theta, kernel_phi;
 
   //General variables
   double pos_x, pos_y, pos_z, dir_x, dir_y, dir_z;
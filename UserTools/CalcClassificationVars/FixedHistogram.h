@@ -0,0 +1,142 @@
+#ifndef FixedHistogram_H
+#define FixedHistogram_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * \class FixedHistogram
+ *
+ * Minimal 1D histogram with fixed binning for the per-event distributions of CalcClassificationVars.
+ * Bin numbering follows ROOT: 0 is the underflow, 1..nbins the bins and nbins+1 the overflow.
+ * FindBin has no branches, the edge cases are resolved with selects, so filling does not depend on
+ * how well the branch predictor guesses the hit values.
+ */
+
+class FixedHistogram {
+
+ public:
+
+  void SetBinning(int n, double low, double high){
+    nbins = n;
+    xmin = low;
+    xmax = high;
+    counts.assign(nbins+2, 0.);
+  }
+
+  void Reset(){ std::fill(counts.begin(), counts.end(), 0.); }
+
+  /// Same bin as TAxis::FindFixBin, NaN goes to the overflow like in ROOT
+  int FindBin(double x) const {
+    double v = nbins*(x-xmin)/(xmax-xmin);
+    v = (v < nbins) ? v : nbins;
+    v = (v > 0.) ? v : 0.;
+    int bin = 1 + static_cast<int>(v);
+    bin = (x < xmin) ? 0 : bin;
+    bin = (x < xmax) ? bin : nbins+1;
+    return bin;
+  }
+
+  void Fill(double x){ counts[FindBin(x)] += 1.; }
+
+  int GetNbins() const { return nbins; }
+  double GetXmin() const { return xmin; }
+  double GetXmax() const { return xmax; }
+  double GetBinContent(int bin) const { return counts[bin]; }
+
+  /// Contents of bins 1..nbins
+  const double* Contents() const { return counts.data()+1; }
+
+ private:
+
+  int nbins = 0;
+  double xmin = 0.;
+  double xmax = 1.;
+  std::vector<double> counts;
+
+};
+
+/**
+ * \class PDFChi2Kernel
+ *
+ * Compares an unweighted event histogram with up to MaxPDFs PDFs of the same binning in one pass over the bins.
+ * The result for each PDF is the chi2/ndf of TH1::Chi2Test(event,"UUNORMCHI2/NDF") called on the PDF
+ * (see CalcClassificationVars::ComputeChi2 for the reference implementation).
+ * The effective entries floor(content^2/error^2+0.5) of the PDFs do not change between events, so they are
+ * computed once in AddPDF and stored interleaved by bin, [bin*MaxPDFs+pdf], for the vectorised inner loop.
+ */
+
+class PDFChi2Kernel {
+
+ public:
+
+  static const int MaxPDFs = 4;
+
+  void SetNbins(int n){
+    nbins = n;
+    npdfs = 0;
+    pdf_counts.assign(nbins*MaxPDFs, 0.);
+    std::fill(pdf_sums, pdf_sums+MaxPDFs, 0.);
+  }
+
+  /// contents and squared errors of bins 1..nbins of the PDF
+  bool AddPDF(const std::vector<double> &contents, const std::vector<double> &errors_sq, std::string &error){
+    if(npdfs>=MaxPDFs){
+      error = "too many PDFs";
+      return false;
+    }
+    if((int)contents.size()!=nbins || (int)errors_sq.size()!=nbins){
+      error = "PDF has "+std::to_string(contents.size())+" bins, event histogram has "+std::to_string(nbins);
+      return false;
+    }
+    for(int b=0; b<nbins; b++){
+      double cnt = (errors_sq[b] > 0.) ? std::floor(contents[b]*contents[b]/errors_sq[b]+0.5) : 0.;
+      pdf_counts[b*MaxPDFs+npdfs] = cnt;
+      pdf_sums[npdfs] += cnt;
+    }
+    npdfs++;
+    return true;
+  }
+
+  int GetNPDFs() const { return npdfs; }
+
+  /// chi2/ndf for each PDF, 0 where ROOT would report an empty histogram
+  void Evaluate(const FixedHistogram &event, double *chi2_ndf) const {
+
+    const double *cnt2 = event.Contents();
+    double sum2 = 0.;
+    for(int b=0; b<nbins; b++) sum2 += cnt2[b];
+
+    double chi2[MaxPDFs] = {0.};
+    int ndf[MaxPDFs];
+    std::fill(ndf, ndf+MaxPDFs, nbins-1);
+
+    for(int b=0; b<nbins; b++){
+      const double *cnt1 = &pdf_counts[b*MaxPDFs];
+      for(int p=0; p<MaxPDFs; p++){
+        double cntsum = cnt1[p]+cnt2[b];
+        bool empty = (cntsum == 0.);
+        double delta = sum2*cnt1[p]-pdf_sums[p]*cnt2[b];
+        chi2[p] += empty ? 0. : delta*delta/(empty ? 1. : cntsum);
+        ndf[p] -= empty;
+      }
+    }
+
+    for(int p=0; p<npdfs; p++){
+      if(pdf_sums[p]==0. || sum2==0. || ndf[p]<=0) chi2_ndf[p] = 0.;
+      else chi2_ndf[p] = chi2[p]/(pdf_sums[p]*sum2)/ndf[p];
+    }
+  }
+
+ private:
+
+  int nbins = 0;
+  int npdfs = 0;
+  std::vector<double> pdf_counts;
+  double pdf_sums[MaxPDFs] = {0.};
+
+};
+
+#endif
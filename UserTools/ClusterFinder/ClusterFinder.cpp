@@ -150,7 +150,6 @@ bool ClusterFinder::Execute(){
   std::map<unsigned long, std::vector<std::vector<ADCPulse>>> RecoADCHits;
 
   // Some initialization
-  v_hittimes.clear();
   v_hittimes_sorted.clear();
   v_mini_hits.clear();
   m_time_Nhits.clear();
@@ -196,44 +195,34 @@ bool ClusterFinder::Execute(){
     PMT_ishit[detkey] = 0;
   }
 
+  // Copy the hits into the time sorted table once, all loops below run on it
   if(HitStoreName=="MCHits"){
-    int vectsize = MCHits->size();
-    if (verbose > 3) std::cout <<"ClusterFinder tool: MCHits size: "<<vectsize<<std::endl;
-    for(std::pair<unsigned long, std::vector<MCHit>>&& apair : *MCHits){
-      unsigned long chankey = apair.first;
-      Detector* thistube = geom->ChannelToDetector(chankey);
-      int detectorkey = thistube->GetDetectorID();
-      if (thistube->GetDetectorElement()=="Tank"){
-        std::vector<MCHit>& ThisPMTHits = apair.second;
-        PMT_ishit[detectorkey] = 1;
-        for (MCHit &ahit : ThisPMTHits){
-          //std::cout <<"Key: "<<detectorkey<<", charge "<<ahit.GetCharge()<<", time "<<ahit.GetTime()<<std::endl;
-          if (ahit.GetTime() < end_of_window_time_cut*AcqTimeWindow) v_hittimes.push_back(ahit.GetTime()); // fill a vector with all hit times (unsorted)
-        }
-      }
-    }
+    if (verbose > 3) std::cout <<"ClusterFinder tool: MCHits size: "<<MCHits->size()<<std::endl;
+    hit_table.Fill(*MCHits);
+  } else {
+    if (verbose > 0) std::cout <<"Hits size: "<<Hits->size()<<std::endl;
+    hit_table.Fill(*Hits);
   }
 
-  if(HitStoreName=="Hits"){
-    int vectsize = Hits->size();
-    if (verbose > 0) std::cout <<"Hits size: "<<vectsize<<std::endl;
-    for(std::pair<unsigned long, std::vector<Hit>>&& apair : *Hits){
-      unsigned long chankey = apair.first;
-      Detector* thistube = geom->ChannelToDetector(chankey);
-      int detectorkey = thistube->GetDetectorID();
-      if (thistube->GetDetectorElement()=="Tank"){
-        std::vector<Hit>& ThisPMTHits = apair.second;
-        PMT_ishit[detectorkey] = 1;
-        for (Hit &ahit : ThisPMTHits){
-          if (verbose > 2) std::cout << "Key: " << detectorkey << ", charge "<<ahit.GetCharge()<<", time "<<ahit.GetTime()<<std::endl;
-          if (ahit.GetTime() < end_of_window_time_cut*AcqTimeWindow) v_hittimes.push_back(ahit.GetTime()); // fill a vector with all hit times (unsorted)
-        }
-      }
+  // Tank detector key of each channel of the table, -1 for the other detectors
+  const std::vector<unsigned long> &table_channels = hit_table.GetChannels();
+  channel_detkey.assign(table_channels.size(),-1);
+  for (size_t i_channel = 0; i_channel < table_channels.size(); i_channel++){
+    Detector* thistube = geom->ChannelToDetector(table_channels.at(i_channel));
+    if (thistube->GetDetectorElement()=="Tank"){
+      channel_detkey.at(i_channel) = thistube->GetDetectorID();
+      PMT_ishit[thistube->GetDetectorID()] = 1;
     }
   }
 
-  
-  if (v_hittimes.size() == 0) {
+  // The table rows are in time order, so the tank hit times come out sorted
+  for (size_t row = 0; row < hit_table.GetNHits(); row++){
+    if (channel_detkey.at(hit_table.GetChannelIndex(row)) < 0) continue;
+    if (verbose > 2) std::cout << "Key: " << channel_detkey.at(hit_table.GetChannelIndex(row)) << ", charge "<<hit_table.GetCharge(row)<<", time "<<hit_table.GetTime(row)<<std::endl;
+    if (hit_table.GetTime(row) < end_of_window_time_cut*AcqTimeWindow) v_hittimes_sorted.push_back(hit_table.GetTime(row));
+  }
+
+  if (v_hittimes_sorted.size() == 0) {
     if (verbose > 1) cout << "No hits, event is skipped..." << endl;
       if (HitStoreName == "Hits") m_data->CStore.Set("ClusterMap",m_all_clusters);
       else if (HitStoreName == "MCHits") m_data->CStore.Set("ClusterMapMC",m_all_clusters_MC);
@@ -241,26 +230,6 @@ bool ClusterFinder::Execute(){
       return true;
   }
 
-  if (verbose > 2) {
-    for (std::vector<double>::iterator it = v_hittimes.begin(); it != v_hittimes.end(); ++it) {
-      cout << "Hit time -> " << *it << endl;
-    }
-  }
-
-  // Now sort the hit time array, fill the highest time in a new array until the old array is empty
-  do {
-    double max_time =0;
-    int i_max_time =0;
-    for (std::vector<double>::iterator it = v_hittimes.begin(); it != v_hittimes.end(); ++it) {
-      if (*it > max_time) {
-        max_time = *it;
-        i_max_time = std::distance(v_hittimes.begin(),it);
-      } 
-    }
-    v_hittimes_sorted.insert(v_hittimes_sorted.begin(),max_time);
-    v_hittimes.erase(v_hittimes.begin() + i_max_time);
-  } while (v_hittimes.size() != 0);
-  
   if (verbose > 2) {
     for (std::vector<double>::iterator it = v_hittimes_sorted.begin(); it != v_hittimes_sorted.end(); ++it) {
       cout << "Hit time (sorted) -> " << *it << endl;
@@ -276,11 +245,10 @@ bool ClusterFinder::Execute(){
     thiswindow_Nhits = 0;   
     v_mini_hits.clear();
     for (double j_time = *it; j_time < *it + ClusterFindingWindow; j_time+=2){  // loops through times in the window and check if there's a hit at this time
-      for(std::vector<double>::iterator it2 = v_hittimes_sorted.begin(); it2 != v_hittimes_sorted.end(); ++it2) {
-        if (*it2 == j_time) {
-          thiswindow_Nhits++;
-          v_mini_hits.push_back(*it2);
-        }
+      std::pair<std::vector<double>::iterator,std::vector<double>::iterator> same_time = std::equal_range(v_hittimes_sorted.begin(),v_hittimes_sorted.end(),j_time);
+      for (std::vector<double>::iterator it2 = same_time.first; it2 != same_time.second; ++it2) {
+        thiswindow_Nhits++;
+        v_mini_hits.push_back(*it2);
       }
     }
     if (!v_mini_hits.empty()) {
@@ -348,45 +316,18 @@ bool ClusterFinder::Execute(){
   } while (true); 
   m_time_Nhits.clear();
 
-  // Now loop on the hit map again to get info about those local maxima, cluster per cluster
+  // Now loop on the hits of the table again to get info about those local maxima, cluster per cluster
   for (std::vector<double>::iterator it = v_clusters.begin(); it != v_clusters.end(); ++it) {
     double local_cluster_charge = 0;
     double local_cluster_time = 0;
     v_local_cluster_times.clear();
-    if (HitStoreName == "Hits"){
-      for(std::pair<unsigned long, std::vector<Hit>>&& apair : *Hits){
-        unsigned long chankey = apair.first;
-        Detector* thistube = geom->ChannelToDetector(chankey);
-        int detectorkey = thistube->GetDetectorID();
-        if (thistube->GetDetectorElement()=="Tank"){
-          std::vector<Hit>& ThisPMTHits = apair.second;
-          PMT_ishit[detectorkey] = 1;
-          for (Hit &ahit : ThisPMTHits){
-            if (ahit.GetTime() >= *it && ahit.GetTime() <= *it + ClusterFindingWindow) {
-              local_cluster_charge += ahit.GetCharge();
-              v_local_cluster_times.push_back(ahit.GetTime());
-              if (verbose > 2) cout << "Local cluster at " << *it << " and hit is " << ahit.GetTime() << endl;
-            }
-          }
-        }
-      }
-    } else if (HitStoreName == "MCHits"){
-      for(std::pair<unsigned long, std::vector<MCHit>>&& apair : *MCHits){
-        unsigned long chankey = apair.first;
-        Detector* thistube = geom->ChannelToDetector(chankey);
-        int detectorkey = thistube->GetDetectorID();
-        if (thistube->GetDetectorElement()=="Tank"){
-          std::vector<MCHit>& ThisPMTHits = apair.second;
-          PMT_ishit[detectorkey] = 1;
-          for (MCHit &ahit : ThisPMTHits){
-            if (ahit.GetTime() >= *it && ahit.GetTime() <= *it + ClusterFindingWindow) {
-              local_cluster_charge += ahit.GetCharge();
-              v_local_cluster_times.push_back(ahit.GetTime());
-              if (verbose > 2) cout << "Local cluster at " << *it << " and hit is " << ahit.GetTime() << endl;
-            }
-          }
-        }
-      }
+    size_t first_row, end_row;
+    hit_table.GetTimeWindow(*it, *it + ClusterFindingWindow, first_row, end_row);
+    for (size_t row = first_row; row < end_row; row++){
+      if (channel_detkey.at(hit_table.GetChannelIndex(row)) < 0) continue;
+      local_cluster_charge += hit_table.GetCharge(row);
+      v_local_cluster_times.push_back(hit_table.GetTime(row));
+      if (verbose > 2) cout << "Local cluster at " << *it << " and hit is " << hit_table.GetTime(row) << endl;
     }
     
     for (std::vector<double>::iterator itt = v_local_cluster_times.begin(); itt != v_local_cluster_times.end(); ++itt) {
@@ -403,49 +344,14 @@ bool ClusterFinder::Execute(){
     }
     if (verbose > 2) cout << "Next cluster ..." << endl;
 
-    // Fills the map of clusters (to be passed through CStore)
-    if (HitStoreName == "Hits"){
-      for(std::pair<unsigned long, std::vector<Hit>>&& apair : *Hits) {   
-        unsigned long chankey = apair.first;
-        Detector* thistube = geom->ChannelToDetector(chankey);
-        unsigned long detectorkey = thistube->GetDetectorID();
-        if (thistube->GetDetectorElement()=="Tank"){
-          std::vector<Hit>& ThisPMTHits = apair.second;
-          PMT_ishit[detectorkey] = 1;
-          for (Hit &ahit : ThisPMTHits){
-            if (ahit.GetTime() >= *it && ahit.GetTime() <= *it + ClusterFindingWindow) { 
-              if(m_all_clusters->count(local_cluster_time)==0) {
-                m_all_clusters->emplace(local_cluster_time, std::vector<Hit>{ahit});
-                m_all_clusters_detkey->emplace(local_cluster_time, std::vector<unsigned long>{detectorkey});
-              } else { 
-                m_all_clusters->at(local_cluster_time).push_back(ahit);
-                m_all_clusters_detkey->at(local_cluster_time).push_back(detectorkey);
-              }
-            }
-          }  
-        }
-      }
-    } else if (HitStoreName == "MCHits"){
-      for(std::pair<unsigned long, std::vector<MCHit>>&& apair : *MCHits) {   
-        unsigned long chankey = apair.first;
-        Detector* thistube = geom->ChannelToDetector(chankey);
-        unsigned long detectorkey = thistube->GetDetectorID();
-        if (thistube->GetDetectorElement()=="Tank"){
-          std::vector<MCHit>& ThisPMTHits = apair.second;
-          PMT_ishit[detectorkey] = 1;
-          for (MCHit &ahit : ThisPMTHits){
-            if (ahit.GetTime() >= *it && ahit.GetTime() <= *it + ClusterFindingWindow) { 
-              if(m_all_clusters_MC->count(local_cluster_time)==0) {
-                m_all_clusters_MC->emplace(local_cluster_time, std::vector<MCHit>{ahit});
-                m_all_clusters_detkey->emplace(local_cluster_time, std::vector<unsigned long>{detectorkey});
-              } else { 
-                m_all_clusters_MC->at(local_cluster_time).push_back(ahit);
-                m_all_clusters_detkey->at(local_cluster_time).push_back(detectorkey);
-              }
-            }
-          }  
-        }
-      }
+    // Fills the map of clusters (to be passed through CStore), hits in time order
+    for (size_t row = first_row; row < end_row; row++){
+      int detkey = channel_detkey.at(hit_table.GetChannelIndex(row));
+      if (detkey < 0) continue;
+      unsigned long detectorkey = detkey;
+      if (HitStoreName == "Hits") (*m_all_clusters)[local_cluster_time].push_back(hit_table.GetHit(row));
+      else if (HitStoreName == "MCHits") (*m_all_clusters_MC)[local_cluster_time].push_back(hit_table.GetMCHit(row));
+      (*m_all_clusters_detkey)[local_cluster_time].push_back(detectorkey);
     }
   }
 
@@ -11,6 +11,7 @@
 
 #include "Tool.h"
 #include "Hit.h"
+#include "HitTable.h"
 #include "ADCPulse.h"
 #include "BeamStatus.h"
 #include "TriggerClass.h"
@@ -78,6 +79,8 @@ class ClusterFinder: public Tool {
   std::map<unsigned long, std::vector<Hit>>* Hits = nullptr;
   Geometry *geom = nullptr;
   std::vector<unsigned long> pmt_detkeys;
+  HitTable hit_table;                // hits of the event, sorted by time
+  std::vector<int> channel_detkey;   // tank detector key per channel of hit_table, -1 if not a tank PMT
 
   //define useful variables
   const double n_water = 1.33;
@@ -111,7 +114,6 @@ class ClusterFinder: public Tool {
   std::map<unsigned long, double> rawarea_mean;
 
   // Arrays and vectors
-  std::vector<double> v_hittimes; // array used to sort hits times
   std::vector<double> v_hittimes_sorted;
   std::vector<double> v_mini_hits;
   std::map<double, std::vector<double>> m_time_Nhits;
@@ -8,6 +8,9 @@
 #include <unistd.h>
 #include <memory>
 #include <regex>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 #include "TFile.h"
 #include "TTree.h"
@@ -40,6 +43,8 @@ bool DataSummary::Initialise(std::string configfile, DataModel &data){
 	EndPart=-1;
 	OutputFileDir=".";
 	OutputFileName="DataSummary.root";
+	ScanMode=false;
+	ScanThreads=4;
 	
 	// read the user's preferences
 	m_variables.Get("verbosity",verbosity);
@@ -53,6 +58,9 @@ bool DataSummary::Initialise(std::string configfile, DataModel &data){
 	m_variables.Get("EndPart",EndPart);
 	m_variables.Get("OutputFileDir",OutputFileDir);
 	m_variables.Get("OutputFileName",OutputFileName);
+	m_variables.Get("ScanMode",ScanMode);
+	m_variables.Get("ScanThreads",ScanThreads);
+	if(ScanThreads<1) ScanThreads=1;
 	
 	// scan for matching input files
 	int numfilesfound = ScanForFiles(DataPath,InputFilePattern);
@@ -70,6 +78,13 @@ bool DataSummary::Initialise(std::string configfile, DataModel &data){
 
 bool DataSummary::Execute(){
 	
+	if(ScanMode){
+		// the whole scan is done in the first Execute
+		bool scan_ok = ScanFiles();
+		m_data->vars.Set("StopLoop",1);
+		return scan_ok;
+	}
+	
 	// load next entry. Return of false indicates end of files: StopLoop will be set.
 	bool got_annieevent = LoadNextANNIEEventEntry();
 	bool got_orphan = LoadNextOrphanStoreEntry();
@@ -83,35 +98,10 @@ bool DataSummary::Execute(){
 		
 		// variables we can directly retrieve
 		ANNIEEvent->Get("EventNumber",EventNumber);
-		ANNIEEvent->Get("EventTimeTank",PMTtimestamp);
-		ANNIEEvent->Get("CTCTimestamp",CTCtimestamp);
-		ANNIEEvent->Get("EventTime",mrd_timeclass);       // convertme to MRDtimestamp
-		ANNIEEvent->Get("TriggerWord",TriggerWord);       // convert to TriggerTypeString
-		ANNIEEvent->Get("MRDLoopbackTDC",MRDLoopbackTDC); // convert to LoopbackTimestamp values
 		// TODO optional sanity checks: consistency of RunNumber and other constants
-		
-		// calculated variables
-		MRDtimestamp = mrd_timeclass.GetNs();
-		// extract out the TDC vals
-		int beamloopbackTDCticks = MRDLoopbackTDC.at("BeamLoopbackTDC");
-		int cosmicloopbackTDCticks = MRDLoopbackTDC.at("CosmicLoopbackTDC");
-		// convert to ns
-		BeamLoopbackTimestamp = 4000. - 4.*(double)beamloopbackTDCticks;
-		CosmicLoopbackTimestamp = 4000. - 4.*(double)cosmicloopbackTDCticks;
-		// FIXME to convert loopback TDC ticks to UTC time, we need to know the time difference
-		// between the loopback signal entering the TDC card and the loopback CTC event associated with it
-		// for now, i dunno, just neglect this
-		BeamLoopbackTimestamp += CTCtimestamp;
-		CosmicLoopbackTimestamp += CTCtimestamp;
-		// convert int word to enum class TriggerType, then convert enum class to string
-		TriggerTypeString = trigtype_to_string(TrigTypeEnum(TriggerWord));
-		SystemsPresent=0;
-		if(CTCtimestamp!=0) SystemsPresent |= 1;
-		if(PMTtimestamp!=0) SystemsPresent |= 2;
-		if(MRDtimestamp!=0) SystemsPresent |= 4;
-		LoopbacksPresent=0;
-		if(BeamLoopbackTimestamp!=0) LoopbacksPresent |= 1;
-		if(CosmicLoopbackTimestamp!=0) LoopbacksPresent |= 2;
+		EventSummary event;
+		GetEventSummary(ANNIEEvent,event);
+		SetEventBranches(event);
 		
 		Log("DataSummary Tool: Filling Event tree",v_debug,verbosity);
 		outtree->Fill();
@@ -153,6 +143,178 @@ bool DataSummary::Finalise(){
 	return true;
 }
 
+bool DataSummary::GetEventSummary(BoostStore* store, EventSummary &event){
+	// only these keys of the entry are decoded
+	uint64_t PMTtimestamp=0, CTCtimestamp=0;
+	uint32_t TriggerWord=0;
+	TimeClass mrd_timeclass;
+	std::map<std::string,int> MRDLoopbackTDC;
+	store->Get("EventTimeTank",PMTtimestamp);
+	store->Get("CTCTimestamp",CTCtimestamp);
+	store->Get("EventTime",mrd_timeclass);       // convertme to MRDtimestamp
+	store->Get("TriggerWord",TriggerWord);
+	bool got_tdc = store->Get("MRDLoopbackTDC",MRDLoopbackTDC); // convert to LoopbackTimestamp values
+	
+	event.PMTtimestamp = PMTtimestamp;
+	event.CTCtimestamp = CTCtimestamp;
+	event.TriggerWord = TriggerWord;
+	// calculated variables
+	event.MRDtimestamp = mrd_timeclass.GetNs();
+	// extract out the TDC vals
+	event.BeamLoopbackTimestamp = 0;
+	event.CosmicLoopbackTimestamp = 0;
+	got_tdc = got_tdc && MRDLoopbackTDC.count("BeamLoopbackTDC") && MRDLoopbackTDC.count("CosmicLoopbackTDC");
+	if(got_tdc){
+		int beamloopbackTDCticks = MRDLoopbackTDC.at("BeamLoopbackTDC");
+		int cosmicloopbackTDCticks = MRDLoopbackTDC.at("CosmicLoopbackTDC");
+		// convert to ns
+		event.BeamLoopbackTimestamp = 4000. - 4.*(double)beamloopbackTDCticks;
+		event.CosmicLoopbackTimestamp = 4000. - 4.*(double)cosmicloopbackTDCticks;
+		// FIXME to convert loopback TDC ticks to UTC time, we need to know the time difference
+		// between the loopback signal entering the TDC card and the loopback CTC event associated with it
+		// for now, i dunno, just neglect this
+		event.BeamLoopbackTimestamp += CTCtimestamp;
+		event.CosmicLoopbackTimestamp += CTCtimestamp;
+	}
+	event.SystemsPresent=0;
+	if(event.CTCtimestamp!=0) event.SystemsPresent |= 1;
+	if(event.PMTtimestamp!=0) event.SystemsPresent |= 2;
+	if(event.MRDtimestamp!=0) event.SystemsPresent |= 4;
+	event.LoopbacksPresent=0;
+	if(event.BeamLoopbackTimestamp!=0) event.LoopbacksPresent |= 1;
+	if(event.CosmicLoopbackTimestamp!=0) event.LoopbacksPresent |= 2;
+	return got_tdc;
+}
+
+void DataSummary::SetEventBranches(const EventSummary &event){
+	CTCtimestamp = event.CTCtimestamp;
+	PMTtimestamp = event.PMTtimestamp;
+	MRDtimestamp = event.MRDtimestamp;
+	BeamLoopbackTimestamp = event.BeamLoopbackTimestamp;
+	CosmicLoopbackTimestamp = event.CosmicLoopbackTimestamp;
+	TriggerWord = event.TriggerWord;
+	// convert int word to enum class TriggerType, then convert enum class to string
+	TriggerTypeString = trigtype_to_string(TrigTypeEnum(TriggerWord));
+	SystemsPresent = event.SystemsPresent;
+	LoopbacksPresent = event.LoopbacksPresent;
+}
+
+bool DataSummary::ScanFiles(){
+	// one FileSummary per file, in file order; the threads take the next unread file
+	std::vector<FileSummary> files(filelist.size());
+	size_t filei=0;
+	for(auto& afile : filelist){
+		FileSummary& file = files.at(filei++);
+		file.filename = afile.second;
+		// the key is the zero-padded run, subrun and part
+		file.run = stoi(afile.first.substr(0,6));
+		file.subrun = stoi(afile.first.substr(6,3));
+		file.part = stoi(afile.first.substr(9,3));
+	}
+	
+	int nthreads = std::min<int>(ScanThreads, files.size());
+	Log("DataSummary Tool: Scanning "+std::to_string(files.size())+" files with "+std::to_string(nthreads)+" threads",v_message,verbosity);
+	std::atomic<size_t> next_file(0);
+	std::vector<std::thread> threads;
+	for(int i=0; i<nthreads; ++i){
+		threads.emplace_back([this,&files,&next_file]{
+			for(size_t f=next_file++; f<files.size(); f=next_file++) SummariseFile(files.at(f));
+		});
+	}
+	for(auto& athread : threads) athread.join();
+	
+	// merge, in file order, into the trees used for the plots
+	int nerrors=0;
+	for(auto& file : files){
+		if(file.error!=""){
+			Log("DataSummary Tool: "+file.error,v_error,verbosity);
+			++nerrors;
+			continue;
+		}
+		FillFileSummary(file);
+		globalentry += file.events.size();
+		globalorphan += file.orphans.size();
+	}
+	Log("DataSummary Tool: Scanned "+std::to_string(globalentry)+" events and "+std::to_string(globalorphan)
+		+" orphans from "+std::to_string(files.size()-nerrors)+" files",v_message,verbosity);
+	return (nerrors==0);
+}
+
+void DataSummary::SummariseFile(FileSummary &file) const{
+	// runs in a scan thread: no ROOT objects and no members other than the settings are touched here
+	BoostStore FileStore(false,BOOST_STORE_BINARY_FORMAT);
+	if(not FileStore.Initialise(file.filename)){
+		file.error = "Error reading file "+file.filename;
+		return;
+	}
+	BoostStore FileANNIEEvent(false, BOOST_STORE_MULTIEVENT_FORMAT);
+	BoostStore FileOrphanStore(false, BOOST_STORE_MULTIEVENT_FORMAT);
+	uint64_t nentries=0, norphans=0;
+	FileStore.Get("ANNIEEvent",FileANNIEEvent);
+	FileANNIEEvent.Header->Get("TotalEntries", nentries);
+	FileStore.Get("OrphanStore",FileOrphanStore);
+	FileOrphanStore.Header->Get("TotalEntries", norphans);
+	
+	file.events.reserve(nentries);
+	for(uint64_t entry=0; entry<nentries; ++entry){
+		if(not FileANNIEEvent.GetEntry(entry)){
+			file.error = "Error getting ANNIEEvent entry "+std::to_string(entry)+" from file "+file.filename;
+			return;
+		}
+		if(entry==0){
+			// run constants
+			FileANNIEEvent.Get("RunNumber",file.RunNumber);
+			FileANNIEEvent.Get("SubrunNumber",file.SubrunNumber);
+			FileANNIEEvent.Get("RunStartTime",file.RunStartTime);
+			FileANNIEEvent.Get("RunType",file.RunType);
+		}
+		EventSummary event;
+		GetEventSummary(&FileANNIEEvent,event);
+		file.events.push_back(event);
+		FileANNIEEvent.Delete();
+	}
+	
+	file.orphans.reserve(norphans);
+	for(uint64_t entry=0; entry<norphans; ++entry){
+		if(not FileOrphanStore.GetEntry(entry)) break;
+		OrphanSummary orphan;
+		FileOrphanStore.Get("EventType",orphan.type);
+		FileOrphanStore.Get("Timestamp",orphan.timestamp);
+		FileOrphanStore.Get("Reason",orphan.cause);
+		file.orphans.push_back(orphan);
+		FileOrphanStore.Delete();
+	}
+}
+
+void DataSummary::FillFileSummary(const FileSummary &file){
+	RunNumber = file.RunNumber;
+	SubrunNumber = file.SubrunNumber;
+	if(file.events.empty()){
+		// no ANNIEEvent entry to read the run constants from, take them from the filename
+		RunNumber = file.run;
+		SubrunNumber = file.subrun;
+	}
+	if(RunNumber!=file.run)
+		Log("DataSummary Tool: filename / entry mismatch for RunNumber in "+file.filename,v_error,verbosity);
+	if(SubrunNumber!=file.subrun)
+		Log("DataSummary Tool: filename / entry mismatch for SubrunNumber in "+file.filename,v_error,verbosity);
+	PartNumber = file.part;
+	RunStartTime = file.RunStartTime;
+	RunType = file.RunType;
+	RunTypeString = runtype_to_string(RunTypeEnum(RunType));
+	
+	for(auto& event : file.events){
+		SetEventBranches(event);
+		outtree->Fill();
+	}
+	for(auto& orphan : file.orphans){
+		orphantype = orphan.type;
+		orphantimestamp = orphan.timestamp;
+		orphancause = orphan.cause;
+		outtree2->Fill();
+	}
+}
+
 int DataSummary::ScanForFiles(std::string inputdir, std::string filepattern){
 	// Scan the input directory for all files matching the specified pattern and run range
 	
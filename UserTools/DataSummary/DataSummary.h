@@ -4,6 +4,7 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
 
 #include "Tool.h"
 
@@ -95,7 +96,43 @@ class DataSummary: public Tool {
 	uint64_t orphantimestamp;         // Timestamp
 	std::string orphancause;          // Reason
 	
+	// scan mode: files are summarised in parallel, only the summary keys of each entry are decoded,
+	// and the per-file results are filled into the trees in file order at the end
+	bool ScanMode;
+	int ScanThreads;
+	struct EventSummary {
+		uint64_t CTCtimestamp;
+		uint64_t PMTtimestamp;
+		uint64_t MRDtimestamp;
+		uint64_t BeamLoopbackTimestamp;
+		uint64_t CosmicLoopbackTimestamp;
+		uint32_t TriggerWord;
+		uint8_t SystemsPresent;
+		uint8_t LoopbacksPresent;
+	};
+	struct OrphanSummary {
+		std::string type;
+		uint64_t timestamp;
+		std::string cause;
+	};
+	struct FileSummary {
+		std::string filename;
+		int run, subrun, part;          // from the filename
+		uint32_t RunNumber=0;
+		uint32_t SubrunNumber=0;
+		int RunType=0;
+		uint64_t RunStartTime=0;
+		std::vector<EventSummary> events;
+		std::vector<OrphanSummary> orphans;
+		std::string error;              // set if the file could not be read
+	};
+	bool ScanFiles();
+	void SummariseFile(FileSummary &file) const;
+	void FillFileSummary(const FileSummary &file);
+	
 	// functions
+	static bool GetEventSummary(BoostStore* store, EventSummary &event);
+	void SetEventBranches(const EventSummary &event);
 	int ScanForFiles(std::string inputdir, std::string filepattern);
 	bool LoadNextANNIEEventEntry();
 	bool LoadNextOrphanStoreEntry();
@@ -1,5 +1,51 @@
 #include "EventSelector.h"
 
+#include <chrono>
+
+namespace {
+  // Mean time and total charge of each cluster; the prompt cluster is the
+  // one with the largest charge before 2 us
+  template<typename HitType>
+  void SummariseClusters(std::map<double,std::vector<HitType>> &clusters, std::vector<double> &charges,
+                         std::vector<double> &times, bool &prompt_cluster, double &pmt_time){
+    double max_charge = 0;
+    for(std::pair<const double,std::vector<HitType>> &apair : clusters){
+      std::vector<HitType> &hits = apair.second;
+      double time_temp = 0;
+      double charge_temp = 0;
+      for(HitType &ahit : hits){
+        time_temp+=ahit.GetTime();
+        charge_temp+=ahit.GetCharge();
+      }
+      if (hits.size()>0) time_temp/=hits.size();
+      charges.push_back(charge_temp);
+      times.push_back(time_temp);
+      if (time_temp > 2000.) continue;	//not a prompt event
+      if (charge_temp > max_charge){
+        max_charge = charge_temp;
+        prompt_cluster = true;
+        pmt_time = time_temp;
+      }
+    }
+  }
+
+  template<typename HitType>
+  bool HasChannelIn(const std::map<unsigned long,std::vector<HitType>> &hits, const std::set<unsigned long> &chankeys){
+    for(auto&& achannel : hits){
+      if(chankeys.count(achannel.first)) return true;
+    }
+    return false;
+  }
+
+  void AddChannels(std::map<std::string,std::map<unsigned long,Detector*> >* detectors, const std::string &element,
+                   std::set<unsigned long> &chankeys){
+    if(detectors->count(element)==0) return;
+    for(auto&& adet : detectors->at(element)){
+      for(auto&& achannel : *(adet.second->GetChannels())) chankeys.insert(achannel.first);
+    }
+  }
+}
+
 EventSelector::EventSelector():Tool(){}
 
 
@@ -42,6 +88,7 @@ bool EventSelector::Initialise(std::string configfile, DataModel &data){
   m_variables.Get("Veto",fVetoCut);
   m_variables.Get("SaveStatusToStore", fSaveStatusToStore);
   m_variables.Get("IsMC",fIsMC);
+  m_variables.Get("EarlyExit",fEarlyExit);
 
   if (!fIsMC){fMCFVCut = false; fMCPMTVolCut = false; fMCMRDCut = false; fMCPiKCut = false; fMCIsMuonCut = false; fMCIsElectronCut = false; fMCIsSingleRingCut = false; fMCIsMultiRingCut = false; fMCProjectedMRDHit = false; fMCEnergyCut = false; fPromptTrigOnly = false;}
 
@@ -59,6 +106,21 @@ bool EventSelector::Initialise(std::string configfile, DataModel &data){
     return false; 
   }
 
+  // The cut volumes only depend on the geometry
+  double fidcutradius = 0.8 * ANNIEGeometry::Instance()->GetCylRadius();
+  fFVRadius2 = fidcutradius*fidcutradius;
+  double pmtvolradius = fGeometry->GetPMTEnclosedRadius()*100.;
+  fPMTVolRadius2 = pmtvolradius*pmtvolradius;
+  fPMTVolHalfY = fGeometry->GetPMTEnclosedHalfheight()*100.;
+  fMrdStartZ = fGeometry->GetMrdStart()*100-168.1;
+  fMrdEndZ = fGeometry->GetMrdEnd()*100-168.1;
+  fMrdHalfY = fGeometry->GetMrdHeight()*100;
+  fMrdHalfX = fGeometry->GetMrdWidth()*100;
+  AddChannels(fGeometry->GetDetectors(),"MRD",fMrdChankeys);
+  AddChannels(fGeometry->GetDetectors(),"Veto",fVetoChankeys);
+
+  this->CompileCuts();
+
   vec_pmtclusters_charge = new std::vector<double>; 
   vec_pmtclusters_time = new std::vector<double>; 
   vec_mrdclusters_time = new std::vector<double>; 
@@ -100,197 +162,24 @@ bool EventSelector::Execute(){
   	return false;
   }
 
-  // BEGIN CUTS USING TRUTH INFORMATION //
-
-  if (fIsMC){
-    // get truth vertex information 
-    auto get_truevtx = m_data->Stores.at("RecoEvent")->Get("TrueVertex", fMuonStartVertex);
-    if(!get_truevtx){ 
-      Log("EventSelector Tool: Error retrieving TrueVertex from RecoEvent!",v_error,verbosity); 
-      return false; 
-    }
-  
-    auto get_truestopvtx = m_data->Stores.at("RecoEvent")->Get("TrueStopVertex", fMuonStopVertex);
-    if(!get_truestopvtx){ 
-      Log("EventSelector Tool: Error retrieving TrueStopVertex from RecoEvent!",v_error,verbosity); 
-      return false; 
-    }
-   
-    //Get MC version of MRD hits
-    bool get_mrd = m_data->Stores.at("ANNIEEvent")->Get("TDCData",TDCData_MC);
-    if (!get_mrd) {
-      Log("EventSelector Tool: Error retrieving TDCData, true from ANNIEEvent!",v_error,verbosity);
-      return false;
-    }
-  } else {
-  
-    //Get data version of MRD hits
-    bool get_mrd = m_data->Stores.at("ANNIEEvent")->Get("TDCData",TDCData);
-    if (!get_mrd) {
-      Log("EventSelector Tool: Error retrieving TDCData, true from ANNIEEvent!",v_error,verbosity);
-      return false;
-    }
-
-  }
-
-  bool IsSingleRing = false, IsMultiRing = false, HasProjectedMRDHit = false, passNoPiK = false, passMCFVCut = false, passMCPMTCut = false, passMCMRDCut = false, IsInsideEnergyWindow = false, IsElectron = false, IsMuon = false, isPromptTrigger=false;
- 
-  if (fIsMC){
-
-    isPromptTrigger = this->PromptTriggerCheck();
-    m_data->Stores.at("RecoEvent")->Set("PromptEvent",isPromptTrigger);
-    
-    IsSingleRing = this->EventSelectionByMCSingleRing();
-    m_data->Stores.at("RecoEvent")->Set("MCSingleRingEvent",IsSingleRing);
-
-    IsMultiRing = this->EventSelectionByMCMultiRing();
-    m_data->Stores.at("RecoEvent")->Set("MCMultiRingEvent",IsMultiRing);
-
-    HasProjectedMRDHit = this->EventSelectionByMCProjectedMRDHit();
-    //information about projected MRD hit already stored in the RecoEvent store by MCRecoEventLoader
-
-    passNoPiK = this->EventSelectionNoPiK();
-    m_data->Stores.at("RecoEvent")->Set("MCNoPiK",passNoPiK);
-
-    passMCFVCut = this->EventSelectionByFV(true);
-    m_data->Stores.at("RecoEvent")->Set("MCFV",passMCFVCut);
-
-    passMCPMTCut = this->EventSelectionByPMTVol(true);
-    m_data->Stores.at("RecoEvent")->Set("MCPMTVol",passMCPMTCut);
- 
-    passMCMRDCut= this->EventSelectionByMCTruthMRD();
-    m_data->Stores.at("RecoEvent")->Set("MCMRDStop",passMCMRDCut);
-
-    IsInsideEnergyWindow = this->EnergyCutCheck(Emin,Emax);
-    m_data->Stores.at("RecoEvent")->Set("MCEnergyCut",IsInsideEnergyWindow);
-
-    IsMuon = this->ParticleCheck(13);
-    m_data->Stores.at("RecoEvent")->Set("MCIsMuon",IsMuon);
-
-    IsElectron = this->ParticleCheck(11);
-    m_data->Stores.at("RecoEvent")->Set("MCIsElectron",IsElectron);
-  }
-
-
-  bool HasEnoughHits = this->NHitCountCheck(fNHitmin);
-  m_data->Stores.at("RecoEvent")->Set("NHitCut",HasEnoughHits);  
-
-  bool passPMTMRDCoincCut = this->EventSelectionByPMTMRDCoinc();
-  m_data->Stores.at("RecoEvent")->Set("PMTMRDCoinc",passPMTMRDCoincCut);
-
-  bool passVetoCut = this->EventSelectionByVetoCut();
-  m_data->Stores.at("RecoEvent")->Set("NoVeto",passVetoCut);
-
-  // Fill the EventSelection mask for the cuts that are supposed to be applied
-  if (fMCPiKCut){
-    fEventApplied |= EventSelector::kFlagMCPiK; 
-    if(!passNoPiK) fEventFlagged |= EventSelector::kFlagMCPiK;
-  }  
-
-  if(fMCFVCut || fMCPMTVolCut){
-    if (fMCFVCut){
-      fEventApplied |= EventSelector::kFlagMCFV; 
-      if(!passMCFVCut) fEventFlagged |= EventSelector::kFlagMCFV;
-    }
-    if (fMCPMTVolCut){
-      fEventApplied |= EventSelector::kFlagMCPMTVol; 
-      if(!passMCPMTCut) fEventFlagged |= EventSelector::kFlagMCPMTVol;
-    }
-  }
-
-  if(fMCMRDCut){
-    fEventApplied |= EventSelector::kFlagMCMRD; 
-    if(!passMCMRDCut) fEventFlagged |= EventSelector::kFlagMCMRD;
-  }
-
-  if(fPromptTrigOnly){
-    fEventApplied |= EventSelector::kFlagPromptTrig; 
-    if(!isPromptTrigger) fEventFlagged |= EventSelector::kFlagPromptTrig;
-  }
-
-  if(fNHitCut){
-    fEventApplied |= EventSelector::kFlagNHit;
-    if(!HasEnoughHits) fEventFlagged |= EventSelector::kFlagNHit;
-  }
-
-  if (fMCEnergyCut){
-    fEventApplied |= EventSelector::kFlagMCEnergyCut;
-    if (!IsInsideEnergyWindow) fEventFlagged |= EventSelector::kFlagMCEnergyCut;
-  }
-
-  if (fMCIsMuonCut){
-    fEventApplied |= EventSelector::kFlagMCIsMuon;
-    if (!IsMuon) fEventFlagged |= EventSelector::kFlagMCIsMuon;
-  }
-
-  if (fMCIsElectronCut){
-    fEventApplied |= EventSelector::kFlagMCIsElectron;
-    if (!IsElectron) fEventFlagged |= EventSelector::kFlagMCIsElectron;
-  }
-
-  if (fMCIsSingleRingCut){
-    fEventApplied |= EventSelector::kFlagMCIsSingleRing;
-    if (!IsSingleRing) fEventFlagged |= EventSelector::kFlagMCIsSingleRing;
-  }
-
-  if (fMCIsMultiRingCut){
-    fEventApplied |= EventSelector::kFlagMCIsMultiRing;
-    if (!IsMultiRing) fEventFlagged |= EventSelector::kFlagMCIsMultiRing;
-  }
-
-  if (fMCProjectedMRDHit){
-    fEventApplied |= EventSelector::kFlagMCProjectedMRDHit;
-    if (!HasProjectedMRDHit) fEventFlagged |= EventSelector::kFlagMCProjectedMRDHit;
-  }
-
-  // BEGIN CUTS USING RECONSTRUCTED INFORMATION //
-  if(fRecoFVCut || fRecoPMTVolCut){
-	// Retrive Reconstructed vertex from RecoEvent 
-	auto get_ok = m_data->Stores.at("RecoEvent")->Get("ExtendedVertex",fRecoVertex);  ///> Get reconstructed vertex 
-    if(not get_ok){
-  	  Log("EventSelector Tool: Error retrieving Extended vertex from RecoEvent!",v_error,verbosity); 
-  	  return false;
-    }
-    if(fRecoFVCut){
-      fEventApplied |= EventSelector::kFlagRecoFV; 
-      bool passRecoFVCut= this->EventSelectionByFV(false);
-      if(!passRecoFVCut) fEventFlagged |= EventSelector::kFlagRecoFV;
-    }
-    if(fRecoPMTVolCut){
-      fEventApplied |= EventSelector::kFlagRecoPMTVol; 
-      bool passRecoPMTVolCut= this->EventSelectionByPMTVol(false);
-      if(!passRecoPMTVolCut) fEventFlagged |= EventSelector::kFlagRecoPMTVol;
-    }
-  }
-
-  //FIXME: This isn't working according to Jingbo
-  if(fMRDRecoCut){
-    fEventApplied |= EventSelector::kFlagRecoMRD; 
-    std::cout << "EventSelector Tool: Currently not implemented. Setting to false" << std::endl;
-    Log("EventSelector Tool: MRDReco not implemented.  Setting cut bit to false",v_message,verbosity);
-    bool passMRDRecoCut = false;
-    //bool passMRDRecoCut = this->EventSelectionByMRDReco(); 
-    if(!passMRDRecoCut) fEventFlagged |= EventSelector::kFlagRecoMRD; 
-  }
-
-  //Fast check whether the times of MRD and PMT clusters are coincident
-  if(fPMTMRDCoincCut){
-    fEventApplied |= EventSelector::kFlagPMTMRDCoinc;
-    if (!passPMTMRDCoincCut) fEventFlagged |= EventSelector::kFlagPMTMRDCoinc;
-  }
-
-  if (fNoVetoCut){
-    fEventApplied |= EventSelector::kFlagNoVeto;
-    if (!passVetoCut) fEventFlagged |= EventSelector::kFlagNoVeto;
-  }
-
-  if (fVetoCut){
-    fEventApplied |= EventSelector::kFlagVeto;
-    if (passVetoCut) fEventFlagged |= EventSelector::kFlagVeto;
+  // Run the compiled selection. With EarlyExit the first flagged cut ends
+  // the selection, and the checks that are only stored are skipped.
+  fNumEvents++;
+  for(EventCut &cut : fCuts){
+    if(fEarlyExit && (!cut.applied || fEventFlagged != EventSelector::kFlagNone)) break;
+    bool pass;
+    if(!this->RunCheck(cut,pass)) return false;
+    cut.n_checked++;
+    bool flagged = (cut.flag_on_pass) ? pass : !pass;
+    if(flagged) cut.n_flagged++;
+    if(!cut.applied) continue;
+    fEventApplied |= cut.flag;
+    if(flagged) fEventFlagged |= cut.flag;
   }
   
   if(fEventFlagged != EventSelector::kFlagNone) fEventCutStatus = false;
   if(fEventCutStatus){  
+    fNumSelected++;
     Log("EventSelector Tool: Event is clean according to current event selection.",v_message,verbosity);
   }
   if(fSaveStatusToStore) m_data->Stores.at("RecoEvent")->Set("EventCutStatus", fEventCutStatus);
@@ -303,7 +192,18 @@ bool EventSelector::Execute(){
 
 
 bool EventSelector::Finalise(){
-  if(verbosity>0) cout<<"EventSelector exitting"<<endl;
+  if(verbosity>0){
+    std::cout<<"EventSelector Tool: "<<fNumEvents<<" events, "<<fNumSelected<<" passed the selection"<<std::endl;
+    for(const EventCut &cut : fCuts){
+      long n_evaluated = cut.n_checked-cut.n_cached;
+      double mean_time = (n_evaluated>0) ? cut.time/n_evaluated*1.e6 : 0.;
+      std::cout<<"  "<<cut.name<<(cut.applied ? "" : " (stored only)")<<": checked "<<cut.n_checked
+               <<", "<<(cut.applied ? "flagged " : "false ")<<cut.n_flagged;
+      if(cut.n_cached>0) std::cout<<", result reused "<<cut.n_cached;
+      std::cout<<", "<<mean_time<<" us/evaluation"<<std::endl;
+    }
+    cout<<"EventSelector exitting"<<endl;
+  }
   delete vec_pmtclusters_charge;
   delete vec_pmtclusters_time;
   delete vec_mrdclusters_time;
@@ -430,21 +330,8 @@ bool EventSelector::EventSelectionByFV(bool isMC) {
       Log("EventSelector Tool: Checking FV cut for reconstructed muon vertex",v_debug,verbosity); 
     checkedVertex=fRecoVertex;
   }
-  double checkedVtxX, checkedVtxY, checkedVtxZ;
   Position vtxPos = checkedVertex->GetPosition();
-  Direction vtxDir = checkedVertex->GetDirection();
-  checkedVtxX = vtxPos.X();
-  checkedVtxY = vtxPos.Y();
-  checkedVtxZ = vtxPos.Z();
-  //std::cout<<"checkedVtxX, Y, Z = "<<checkedVtxX<<", "<<checkedVtxY<<", "<<checkedVtxZ<<std::endl;
-  double tankradius = ANNIEGeometry::Instance()->GetCylRadius();
-  double fidcutradius = 0.8 * tankradius;
-  double fidcuty = 50.;
-  double fidcutz = 0.;
-  if(checkedVtxZ > fidcutz) return false;
-  if( (TMath::Sqrt(TMath::Power(checkedVtxX, 2) + TMath::Power(checkedVtxZ,2)) > fidcutradius) 
-  	  || (TMath::Abs(checkedVtxY) > fidcuty) 
-  	  || (checkedVtxZ > fidcutz) ){
+  if( vtxPos.Z() > fFVMaxZ || !InCylinder(vtxPos.X(),vtxPos.Y(),vtxPos.Z(),fFVRadius2,fFVHalfY) ){
   Log("EventSelector Tool: This event is not contained inside the FV",v_message,verbosity); 
   return false;
   }	
@@ -463,16 +350,8 @@ bool EventSelector::EventSelectionByPMTVol(bool isMC) {
       Log("EventSelector Tool: Checking PMT volume cut for reconstructed muon vertex",v_debug,verbosity); 
     checkedVertex=fRecoVertex;
   }
-  double checkedVtxX, checkedVtxY, checkedVtxZ;
   Position vtxPos = checkedVertex->GetPosition();
-  Direction vtxDir = checkedVertex->GetDirection();
-  checkedVtxX = vtxPos.X();
-  checkedVtxY = vtxPos.Y();
-  checkedVtxZ = vtxPos.Z();
-  double fidcutradius = fGeometry->GetPMTEnclosedRadius()*100.;
-  double fidcuty = fGeometry->GetPMTEnclosedHalfheight()*100.;
-  if( (TMath::Sqrt(TMath::Power(checkedVtxX, 2) + TMath::Power(checkedVtxZ,2)) > fidcutradius) 
-  	  || (TMath::Abs(checkedVtxY) > fidcuty)){
+  if( !InCylinder(vtxPos.X(),vtxPos.Y(),vtxPos.Z(),fPMTVolRadius2,fPMTVolHalfY) ){
   Log("EventSelector Tool: This event is not contained within the PMT volume",v_message,verbosity); 
   return false;
   }	
@@ -487,14 +366,10 @@ bool EventSelector::EventSelectionByMCTruthMRD() {
   muonStopX = fMuonStopVertex->GetPosition().X();
   muonStopY = fMuonStopVertex->GetPosition().Y();
   muonStopZ = fMuonStopVertex->GetPosition().Z();
-  double mrdStartZ = fGeometry->GetMrdStart()*100-168.1;
-  double mrdEndZ = fGeometry->GetMrdEnd()*100-168.1;
-  double mrdHeightY = fGeometry->GetMrdHeight()*100;                                                                                     
-  double mrdWidthX = fGeometry->GetMrdWidth()*100;
-  Log("EventSelector tool: Read in MuonStop (X,Y,Z) = ("+std::to_string(muonStopX)+","+std::to_string(muonStopY)+","+std::to_string(muonStopZ)+")");
-  if(muonStopZ<mrdStartZ || muonStopZ>mrdEndZ
-  	|| muonStopX<-1.0*mrdWidthX || muonStopX>mrdWidthX
-  	|| muonStopY<-1.0*mrdHeightY || muonStopY>mrdHeightY) {
+  if(verbosity>=v_debug) Log("EventSelector tool: Read in MuonStop (X,Y,Z) = ("+std::to_string(muonStopX)+","+std::to_string(muonStopY)+","+std::to_string(muonStopZ)+")",v_debug,verbosity);
+  if(muonStopZ<fMrdStartZ || muonStopZ>fMrdEndZ
+  	|| muonStopX<-1.0*fMrdHalfX || muonStopX>fMrdHalfX
+  	|| muonStopY<-1.0*fMrdHalfY || muonStopY>fMrdHalfY) {
     Log("EventSelector Tool: This MC Event's muon does not stop in the MRD",v_message,verbosity); 
     return false;	
   }
@@ -579,78 +454,26 @@ bool EventSelector::EventSelectionByPMTMRDCoinc() {
   bool prompt_cluster = false;
   double pmt_time = 0;
 
-
-  if (fIsMC){
-    if (m_all_clusters_MC->size()){
-      double max_charge = 0;
-      double cluster_time;
-      for(std::pair<double,std::vector<MCHit>>&& apair : *m_all_clusters_MC){
-        std::vector<MCHit>&MCHits = apair.second;
-        double time_temp = 0;
-        double charge_temp = 0;
-        for (unsigned int i_hit = 0; i_hit < MCHits.size(); i_hit++){
-          time_temp+=MCHits.at(i_hit).GetTime();
-          charge_temp+=MCHits.at(i_hit).GetCharge();
-        }
-        if (MCHits.size()>0) time_temp/=MCHits.size();
-        vec_pmtclusters_charge->push_back(charge_temp);
-        vec_pmtclusters_time->push_back(time_temp);
-        if (time_temp > 2000.) continue;	//not a prompt event
-        if (charge_temp > max_charge){
-          max_charge = charge_temp;
-          prompt_cluster = true;
-          pmt_time = time_temp;
-        }
-      }
-    }
-  } else {
-    if (m_all_clusters->size()){
-      double max_charge = 0;
-      double cluster_time;
-      for(std::pair<double,std::vector<Hit>>&& apair : *m_all_clusters){
-        std::vector<Hit>&Hits = apair.second;
-        double time_temp = 0;
-        double charge_temp = 0;
-        for (unsigned int i_hit = 0; i_hit < Hits.size(); i_hit++){
-          time_temp+=Hits.at(i_hit).GetTime();
-          charge_temp+=Hits.at(i_hit).GetCharge();
-        }
-        if (Hits.size()>0) time_temp/=Hits.size();
-        vec_pmtclusters_charge->push_back(charge_temp);
-        vec_pmtclusters_time->push_back(time_temp);
-        if (time_temp > 2000.) continue;	//not a prompt event
-        if (charge_temp > max_charge){
-          max_charge = charge_temp;
-          prompt_cluster = true;
-          pmt_time = time_temp;
-        }
-      }
-    }
-  }
+  if (fIsMC) SummariseClusters(*m_all_clusters_MC,*vec_pmtclusters_charge,*vec_pmtclusters_time,prompt_cluster,pmt_time);
+  else SummariseClusters(*m_all_clusters,*vec_pmtclusters_charge,*vec_pmtclusters_time,prompt_cluster,pmt_time);
 
   m_data->Stores["RecoEvent"]->Set("PMTClustersCharge",vec_pmtclusters_charge,false);
   m_data->Stores["RecoEvent"]->Set("PMTClustersTime",vec_pmtclusters_time,false);
 
+  // Mean time of the MRD paddle hits of each cluster
   std::vector<double> mrd_meantimes;
   for(unsigned int thiscluster=0; thiscluster<MrdTimeClusters.size(); thiscluster++){
- 
-    std::vector<int> hitmrd_times;
-    std::vector<int> single_mrdcluster = MrdTimeClusters.at(thiscluster);
-    int numdigits = single_mrdcluster.size();
+    const std::vector<int> &single_mrdcluster = MrdTimeClusters.at(thiscluster);
+    int num_mrdhits = 0;
     double mrd_meantime = 0.;
-    for(int thisdigit=0;thisdigit<numdigits;thisdigit++){
-      int digit_value = single_mrdcluster.at(thisdigit);
-      unsigned long chankey = MrdDigitChankeys.at(digit_value);
-      Detector *thedetector = fGeometry->ChannelToDetector(chankey);
-      unsigned long detkey = thedetector->GetDetectorID();
-      if (thedetector->GetDetectorElement()=="MRD") {
-        double mrdtimes=MrdDigitTimes.at(digit_value);
-        hitmrd_times.push_back(mrdtimes);
-        mrd_meantime += mrdtimes;
+    for(int digit_value : single_mrdcluster){
+      if (fMrdChankeys.count(MrdDigitChankeys.at(digit_value))) {
+        mrd_meantime += MrdDigitTimes.at(digit_value);
+        num_mrdhits++;
       }
-      if (hitmrd_times.size()>0) mrd_meantime /= hitmrd_times.size();
-      mrd_meantimes.push_back(mrd_meantime);
     }
+    if (num_mrdhits>0) mrd_meantime /= num_mrdhits;
+    mrd_meantimes.push_back(mrd_meantime);
   }
 
   vec_mrdclusters_time->clear();
@@ -671,10 +494,10 @@ bool EventSelector::EventSelectionByPMTMRDCoinc() {
   bool coincidence = false;
   for (int i_mrd = 0; i_mrd < int(mrd_meantimes.size()); i_mrd++){
     double time_diff = mrd_meantimes.at(i_mrd) - pmt_time;
-    if (verbosity > 0) std::cout <<"MRD time: "<<mrd_meantimes.at(i_mrd)<<", PMT time: "<<pmt_time<<", difference: "<<time_diff<<std::endl;
-    Log("EventSelector tool: MRD/Tank coincidene candidate "+std::to_string(i_mrd)+ " has time difference: "+std::to_string(time_diff),v_message,verbosity);
+    if (verbosity >= v_message) Log("EventSelector tool: MRD/Tank coincidene candidate "+std::to_string(i_mrd)+ " has time difference: "+std::to_string(time_diff),v_message,verbosity);
     if (time_diff > pmtmrd_coinc_min && time_diff < pmtmrd_coinc_max){
       coincidence = true;
+      if (verbosity < v_message) break;
     }
   }
 
@@ -684,47 +507,233 @@ bool EventSelector::EventSelectionByPMTMRDCoinc() {
 
 bool EventSelector::EventSelectionByVetoCut(){
 
- bool has_veto = false;
- if (fIsMC) {
-    if(TDCData_MC){
-    if (TDCData_MC->size()==0){
-      Log("EventSelector tool: TDC data is empty in this event.",v_message,verbosity);
-    } else {
-      for (auto&& anmrdpmt : (*TDCData_MC)){
-        unsigned long chankey = anmrdpmt.first;
-        Detector* thedetector = fGeometry->ChannelToDetector(chankey);
-        unsigned long detkey = thedetector->GetDetectorID();
-        if (thedetector->GetDetectorElement()=="Veto") has_veto = true;
-      }
-    }
-  } else {
-    Log("EventSelector tool: No TDC data available in this event.",v_message,verbosity);
-  }
- }
-else {
-  if(TDCData){
-    if (TDCData->size()==0){
-      Log("EventSelector tool: TDC data is empty in this event.",v_message,verbosity);
-    } else {
-      for (auto&& anmrdpmt : (*TDCData)){
-        unsigned long chankey = anmrdpmt.first;
-        Detector* thedetector = fGeometry->ChannelToDetector(chankey);
-        unsigned long detkey = thedetector->GetDetectorID();
-        if (thedetector->GetDetectorElement()=="Veto") has_veto = true;
-      }
-    }
+  bool has_veto = false;
+  if (fIsMC) {
+    if (!TDCData_MC) Log("EventSelector tool: No TDC data available in this event.",v_message,verbosity);
+    else if (TDCData_MC->size()==0) Log("EventSelector tool: TDC data is empty in this event.",v_message,verbosity);
+    else has_veto = HasChannelIn(*TDCData_MC,fVetoChankeys);
   } else {
-    Log("EventSelector tool: No TDC data available in this event.",v_message,verbosity);
-  }
+    if (!TDCData) Log("EventSelector tool: No TDC data available in this event.",v_message,verbosity);
+    else if (TDCData->size()==0) Log("EventSelector tool: TDC data is empty in this event.",v_message,verbosity);
+    else has_veto = HasChannelIn(*TDCData,fVetoChankeys);
   }
 
   return (!has_veto);	//Successful selection means no veto hit 
 
 }
 
+void EventSelector::CompileCuts(){
+  struct CutConfig {
+    const char* name;
+    CutChecks_t check;
+    EventFlags_t flag;
+    bool configured;
+    bool flag_on_pass;
+  };
+  // in order of increasing cost of the check
+  const CutConfig cut_configs[] = {
+    {"MRDRecoCut", kCheckRecoMRD, kFlagRecoMRD, fMRDRecoCut, false},
+    {"PromptTrigOnly", kCheckPromptTrig, kFlagPromptTrig, fPromptTrigOnly, false},
+    {"MCIsMuonCut", kCheckMCIsMuon, kFlagMCIsMuon, fMCIsMuonCut, false},
+    {"MCIsElectronCut", kCheckMCIsElectron, kFlagMCIsElectron, fMCIsElectronCut, false},
+    {"MCIsSingleRingCut", kCheckMCSingleRing, kFlagMCIsSingleRing, fMCIsSingleRingCut, false},
+    {"MCIsMultiRingCut", kCheckMCMultiRing, kFlagMCIsMultiRing, fMCIsMultiRingCut, false},
+    {"MCProjectedMRDHit", kCheckMCProjectedMRDHit, kFlagMCProjectedMRDHit, fMCProjectedMRDHit, false},
+    {"MCEnergyCut", kCheckMCEnergy, kFlagMCEnergyCut, fMCEnergyCut, false},
+    {"MCPiKCut", kCheckMCNoPiK, kFlagMCPiK, fMCPiKCut, false},
+    {"MCFVCut", kCheckMCFV, kFlagMCFV, fMCFVCut, false},
+    {"MCPMTVolCut", kCheckMCPMTVol, kFlagMCPMTVol, fMCPMTVolCut, false},
+    {"MCMRDCut", kCheckMCMRD, kFlagMCMRD, fMCMRDCut, false},
+    {"RecoFVCut", kCheckRecoFV, kFlagRecoFV, fRecoFVCut, false},
+    {"RecoPMTVolCut", kCheckRecoPMTVol, kFlagRecoPMTVol, fRecoPMTVolCut, false},
+    {"NHitCut", kCheckNHit, kFlagNHit, fNHitCut, false},
+    {"NoVeto", kCheckNoVeto, kFlagNoVeto, fNoVetoCut, false},
+    {"Veto", kCheckNoVeto, kFlagVeto, fVetoCut, true},
+    {"PMTMRDCoincCut", kCheckPMTMRDCoinc, kFlagPMTMRDCoinc, fPMTMRDCoincCut, false}
+  };
+
+  fCuts.clear();
+  bool used[kNumChecks] = {false};
+  for(const CutConfig &config : cut_configs){
+    if(!config.configured) continue;
+    EventCut cut;
+    cut.name = config.name;
+    cut.check = config.check;
+    cut.flag = config.flag;
+    cut.applied = true;
+    cut.flag_on_pass = config.flag_on_pass;
+    fCuts.push_back(cut);
+    used[config.check] = true;
+  }
+
+  // checks whose results are stored in RecoEvent for every event
+  std::vector<std::pair<const char*,CutChecks_t>> stored_checks;
+  if(fIsMC){
+    stored_checks = {{"PromptEvent",kCheckPromptTrig}, {"MCIsMuon",kCheckMCIsMuon}, {"MCIsElectron",kCheckMCIsElectron},
+                     {"MCSingleRingEvent",kCheckMCSingleRing}, {"MCMultiRingEvent",kCheckMCMultiRing},
+                     {"ProjectedMRDHit",kCheckMCProjectedMRDHit}, {"MCEnergyCut",kCheckMCEnergy}, {"MCNoPiK",kCheckMCNoPiK},
+                     {"MCFV",kCheckMCFV}, {"MCPMTVol",kCheckMCPMTVol}, {"MCMRDStop",kCheckMCMRD}};
+  }
+  stored_checks.push_back({"NHitCut",kCheckNHit});
+  stored_checks.push_back({"NoVeto",kCheckNoVeto});
+  stored_checks.push_back({"PMTMRDCoinc",kCheckPMTMRDCoinc});
+  for(const std::pair<const char*,CutChecks_t> &stored : stored_checks){
+    if(used[stored.second]) continue;
+    EventCut cut;
+    cut.name = stored.first;
+    cut.check = stored.second;
+    cut.flag = kFlagNone;
+    cut.applied = false;
+    cut.flag_on_pass = false;
+    fCuts.push_back(cut);
+  }
+
+  std::string cut_order;
+  for(const EventCut &cut : fCuts) if(cut.applied) cut_order += " "+cut.name;
+  Log("EventSelector Tool: Cut order:"+cut_order,v_message,verbosity);
+}
+
+bool EventSelector::RunCheck(EventCut &cut, bool &pass){
+  if(fCheckResult[cut.check]>=0){
+    pass = fCheckResult[cut.check];
+    cut.n_cached++;
+    return true;
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const char* store_key = nullptr;
+  switch(cut.check){
+    case kCheckRecoMRD:
+      //FIXME: This isn't working according to Jingbo
+      Log("EventSelector Tool: MRDReco not implemented.  Setting cut bit to false",v_message,verbosity);
+      pass = false;
+      break;
+    case kCheckPromptTrig:
+      pass = this->PromptTriggerCheck();
+      store_key = "PromptEvent";
+      break;
+    case kCheckMCIsMuon:
+      pass = this->ParticleCheck(13);
+      store_key = "MCIsMuon";
+      break;
+    case kCheckMCIsElectron:
+      pass = this->ParticleCheck(11);
+      store_key = "MCIsElectron";
+      break;
+    case kCheckMCSingleRing:
+      pass = this->EventSelectionByMCSingleRing();
+      store_key = "MCSingleRingEvent";
+      break;
+    case kCheckMCMultiRing:
+      pass = this->EventSelectionByMCMultiRing();
+      store_key = "MCMultiRingEvent";
+      break;
+    case kCheckMCProjectedMRDHit:
+      //information about projected MRD hit already stored in the RecoEvent store by MCRecoEventLoader
+      pass = this->EventSelectionByMCProjectedMRDHit();
+      break;
+    case kCheckMCEnergy:
+      pass = this->EnergyCutCheck(Emin,Emax);
+      store_key = "MCEnergyCut";
+      break;
+    case kCheckMCNoPiK:
+      pass = this->EventSelectionNoPiK();
+      store_key = "MCNoPiK";
+      break;
+    case kCheckMCFV:
+      if(!this->LoadTrueVertices()) return false;
+      pass = this->EventSelectionByFV(true);
+      store_key = "MCFV";
+      break;
+    case kCheckMCPMTVol:
+      if(!this->LoadTrueVertices()) return false;
+      pass = this->EventSelectionByPMTVol(true);
+      store_key = "MCPMTVol";
+      break;
+    case kCheckMCMRD:
+      if(!this->LoadTrueVertices()) return false;
+      pass = this->EventSelectionByMCTruthMRD();
+      store_key = "MCMRDStop";
+      break;
+    case kCheckRecoFV:
+      if(!this->LoadRecoVertex()) return false;
+      pass = this->EventSelectionByFV(false);
+      break;
+    case kCheckRecoPMTVol:
+      if(!this->LoadRecoVertex()) return false;
+      pass = this->EventSelectionByPMTVol(false);
+      break;
+    case kCheckNHit:
+      pass = this->NHitCountCheck(fNHitmin);
+      store_key = "NHitCut";
+      break;
+    case kCheckNoVeto:
+      if(!this->LoadTDCData()) return false;
+      pass = this->EventSelectionByVetoCut();
+      store_key = "NoVeto";
+      break;
+    case kCheckPMTMRDCoinc:
+      pass = this->EventSelectionByPMTMRDCoinc();
+      store_key = "PMTMRDCoinc";
+      break;
+    default:
+      pass = true;
+  }
+  if(store_key) m_data->Stores.at("RecoEvent")->Set(store_key,pass);
+  fCheckResult[cut.check] = pass;
+  cut.time += std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  return true;
+}
+
+bool EventSelector::LoadTrueVertices(){
+  if(fHaveTrueVertices) return true;
+  // get truth vertex information 
+  auto get_truevtx = m_data->Stores.at("RecoEvent")->Get("TrueVertex", fMuonStartVertex);
+  if(!get_truevtx){ 
+    Log("EventSelector Tool: Error retrieving TrueVertex from RecoEvent!",v_error,verbosity); 
+    return false; 
+  }
+  auto get_truestopvtx = m_data->Stores.at("RecoEvent")->Get("TrueStopVertex", fMuonStopVertex);
+  if(!get_truestopvtx){ 
+    Log("EventSelector Tool: Error retrieving TrueStopVertex from RecoEvent!",v_error,verbosity); 
+    return false; 
+  }
+  fHaveTrueVertices = true;
+  return true;
+}
+
+bool EventSelector::LoadRecoVertex(){
+  if(fHaveRecoVertex) return true;
+  // Retrive Reconstructed vertex from RecoEvent 
+  auto get_ok = m_data->Stores.at("RecoEvent")->Get("ExtendedVertex",fRecoVertex);  ///> Get reconstructed vertex 
+  if(not get_ok){
+    Log("EventSelector Tool: Error retrieving Extended vertex from RecoEvent!",v_error,verbosity); 
+    return false;
+  }
+  fHaveRecoVertex = true;
+  return true;
+}
+
+bool EventSelector::LoadTDCData(){
+  if(fHaveTDCData) return true;
+  bool get_mrd;
+  if (fIsMC) get_mrd = m_data->Stores.at("ANNIEEvent")->Get("TDCData",TDCData_MC);   //Get MC version of MRD hits
+  else get_mrd = m_data->Stores.at("ANNIEEvent")->Get("TDCData",TDCData);            //Get data version of MRD hits
+  if (!get_mrd) {
+    Log("EventSelector Tool: Error retrieving TDCData, true from ANNIEEvent!",v_error,verbosity);
+    return false;
+  }
+  fHaveTDCData = true;
+  return true;
+}
+
 void EventSelector::Reset() {
   // Reset 
   fEventApplied = EventSelector::kFlagNone;
   fEventFlagged = EventSelector::kFlagNone;
   fEventCutStatus = true; 
+  for(int i_check=0; i_check<kNumChecks; i_check++) fCheckResult[i_check] = -1;
+  fHaveTrueVertices = false;
+  fHaveRecoVertex = false;
+  fHaveTDCData = false;
 } 
@@ -7,6 +7,8 @@
 
 #include <string>
 #include <iostream>
+#include <set>
+#include <vector>
 #include <TROOT.h>
 #include <TChain.h>
 #include <TFile.h>
@@ -51,7 +53,68 @@ class EventSelector: public Tool {
   } EventFlags_t;
 
  private:
- 	
+
+  /// \brief Checks the selection is built from
+  ///
+  /// Each check is evaluated at most once per event; the Veto and NoVeto
+  /// cuts share one check.
+  typedef enum CutChecks {
+   kCheckPromptTrig,
+   kCheckMCIsMuon,
+   kCheckMCIsElectron,
+   kCheckMCSingleRing,
+   kCheckMCMultiRing,
+   kCheckMCProjectedMRDHit,
+   kCheckMCEnergy,
+   kCheckMCNoPiK,
+   kCheckMCFV,
+   kCheckMCPMTVol,
+   kCheckMCMRD,
+   kCheckRecoMRD,
+   kCheckRecoFV,
+   kCheckRecoPMTVol,
+   kCheckNHit,
+   kCheckNoVeto,
+   kCheckPMTMRDCoinc,
+   kNumChecks
+  } CutChecks_t;
+
+  /// \brief One entry of the compiled selection
+  ///
+  /// Entries with applied==true are the configured cuts and set their flag
+  /// bit; the others are only evaluated to fill the RecoEvent store.
+  struct EventCut {
+    std::string name;
+    CutChecks_t check;
+    EventFlags_t flag;
+    bool applied;
+    bool flag_on_pass;     ///< the Veto cut flags events that pass the no-veto check
+    long n_checked = 0;
+    long n_cached = 0;     ///< checks answered by the result of an earlier cut
+    long n_flagged = 0;
+    double time = 0.;      ///< seconds spent in the check
+  };
+
+  /// \brief Build the ordered list of checks from the configuration
+  ///
+  /// Configured cuts come first, ordered from the cheapest to the most
+  /// expensive check, followed by the checks whose results are only
+  /// stored in RecoEvent.
+  void CompileCuts();
+
+  /// Evaluate a check (once per event), writing its result to RecoEvent
+  bool RunCheck(EventCut &cut, bool &pass);
+
+  /// Event objects fetched on first use and shared by all checks
+  bool LoadTrueVertices();
+  bool LoadRecoVertex();
+  bool LoadTDCData();
+
+  /// Whether (x,y,z) lies in the upright cylinder of radius^2 r2 and half height halfy
+  static bool InCylinder(double x, double y, double z, double r2, double halfy){
+    return (x*x+z*z <= r2) && (y <= halfy) && (y >= -halfy);
+  }
+
   /// Clear reconstruction info.
   void Reset();
 
@@ -210,6 +273,24 @@ class EventSelector: public Tool {
   bool fIsMC; 
 
   
+  bool fEarlyExit = false;
+
+  std::vector<EventCut> fCuts;     ///< compiled selection
+  int fCheckResult[kNumChecks];    ///< per event: -1 not evaluated, else 0/1
+  bool fHaveTrueVertices, fHaveRecoVertex, fHaveTDCData;
+  long fNumEvents = 0;
+  long fNumSelected = 0;
+
+  // Cut volumes, fixed for the job [cm]
+  double fFVRadius2;
+  double fFVHalfY = 50.;
+  double fFVMaxZ = 0.;
+  double fPMTVolRadius2;
+  double fPMTVolHalfY;
+  double fMrdStartZ, fMrdEndZ, fMrdHalfX, fMrdHalfY;
+  std::set<unsigned long> fMrdChankeys;    ///< channels of the MRD paddles
+  std::set<unsigned long> fVetoChankeys;   ///< channels of the veto paddles
+
   bool fSaveStatusToStore = true;
   /// \brief verbosity levels: if 'verbosity' < this level, the message type will be logged.
   int v_error=0;
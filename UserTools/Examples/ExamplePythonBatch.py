@@ -0,0 +1,18 @@
+#### my python batch script, called once per batch of events
+import Store
+import numpy as np
+
+def Initialise():
+    return 1
+
+def Finalise():
+    return 1
+
+def Execute(inputs, outputs):
+    # the arrays share memory with the buffers of the PythonScript tool, no copies are made
+    b = np.asarray(inputs['b'])
+    a = np.asarray(inputs['a'])
+    out = np.asarray(outputs['ab'])
+    out[:] = a*b
+    print('processed a batch of %d events' % len(b))
+    return 1
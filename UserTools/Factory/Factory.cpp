@@ -34,6 +34,7 @@ if (tool=="LAPPDBaselineSubtract") ret=new LAPPDBaselineSubtract;
 if (tool=="LAPPDSaveROOT") ret=new LAPPDSaveROOT;
 if (tool=="LAPPDFilter") ret=new LAPPDFilter;
 if (tool=="LAPPDIntegratePulse") ret=new LAPPDIntegratePulse;
+if (tool=="LAPPDProcessWaveforms") ret=new LAPPDProcessWaveforms;
 if (tool=="ADCCalibrator") ret=new ADCCalibrator;
 if (tool=="ADCHitFinder") ret=new ADCHitFinder;
 if (tool=="BeamChecker") ret=new BeamChecker;
@@ -66,6 +67,7 @@ if (tool=="HitCleaner") ret=new HitCleaner;
 if (tool=="HitResiduals") ret=new HitResiduals;
 if (tool=="MonitorReceive") ret=new MonitorReceive;
 if (tool=="MonitorSimReceive") ret=new MonitorSimReceive;
+if (tool=="MonitorSimStream") ret=new MonitorSimStream;
 if (tool=="DigitBuilderDoE") ret=new DigitBuilderDoE;
 if (tool=="EventSelectorDoE") ret=new EventSelectorDoE;
 if (tool=="MonitorMRDTime") ret=new MonitorMRDTime;
@@ -123,5 +125,8 @@ if (tool=="MonitorTrigger") ret=new MonitorTrigger;
 if (tool=="EventClassification") ret=new EventClassification;
 
 if (tool=="DataSummary") ret=new DataSummary;
+if (tool=="NativeEnergyReco") ret=new NativeEnergyReco;
+if (tool=="BenchmarkInput") ret=new BenchmarkInput;
+if (tool=="BenchmarkSuite") ret=new BenchmarkSuite;
 return ret;
 }
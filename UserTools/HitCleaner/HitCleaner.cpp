@@ -120,6 +120,7 @@ bool HitCleaner::Initialise(std::string configfile, DataModel &data){
   // vector of clusters
   fClusterList = new std::vector<RecoCluster*>;
   fHitCleaningClusters = new std::vector<RecoCluster*>;
+  fArena = m_data->Arena.NewPool("HitCleaner");
 
   //Set hit cleaner parameters in the RecoEvent store
   m_data->Stores.at("RecoEvent")->Set("HitCleaningParameters", fHitCleaningParam);
@@ -133,6 +134,10 @@ bool HitCleaner::Execute(){
   
   std::string name = "HitCleaner::Execute()";
   Log(name + ": Executing",v_error,verbosity);
+
+  // the clusters of the previous event are no longer needed
+  this->ReleaseClusters();
+  fArena->BeginEvent();
 	
   // print filtering parameters
   if(verbosity>v_message) this->PrintParameters();
@@ -200,6 +205,7 @@ bool HitCleaner::Execute(){
 }
 
 bool HitCleaner::Finalise(){
+  this->ReleaseClusters();
   //delete fHitCleaningParam; fHitCleaningParam = 0;      //Will be deleted by the store, don't manually delete
   delete fFilterAll; fFilterAll = 0;
   delete fFilterByPulseHeight; fFilterByPulseHeight = 0;
@@ -209,6 +215,9 @@ bool HitCleaner::Finalise(){
   delete fClusterList; fClusterList = 0;
   // for test
   delete fFilterByTruthInfo; fFilterByTruthInfo = 0;
+  fArena->Release();
+  Log("HitCleaner: "+std::to_string(fArena->GetStats().allocations)+" arena allocations, peak "
+      +std::to_string(fArena->GetStats().peak_event_bytes)+" bytes per event",v_message,verbosity);
   return true;
 }
 
@@ -424,11 +433,7 @@ std::vector<RecoDigit*>* HitCleaner::FilterByNeighbours(std::vector<RecoDigit*>*
     return fFilterByNeighbours;
   }
 
-  int* numNeighbours = new int[Ndigits];
-
-  for( int idigit=0; idigit<Ndigits; idigit++ ){
-    numNeighbours[idigit] = 0;
-  }
+  int* numNeighbours = fArena->CreateArray<int>(Ndigits);
 
   // count number of neighbours
   // ==========================
@@ -501,10 +506,6 @@ std::vector<RecoDigit*>* HitCleaner::FilterByNeighbours(std::vector<RecoDigit*>*
     }
   }
 
-  // delete array of neighbours
-  // ==========================
-  delete [] numNeighbours;
-
   // return vector of filtered digits
   // ================================
   if(verbosity>v_message) std::cout << name << "  filter by neighbours: " << fFilterByNeighbours->size() << std::endl;
@@ -546,12 +547,10 @@ std::vector<RecoDigit*>* HitCleaner::FilterByClusters(std::vector<RecoDigit*>* m
 std::vector<RecoCluster*>* HitCleaner::RecoClusters(std::vector<RecoDigit*>* myDigitList)
 {  
 
-  // delete cluster digits
-  // =====================
-  for(int i=0; i<int(vClusterDigitList.size()); i++ ){
-    delete (RecoClusterDigit*)(vClusterDigitList.at(i));
-  }
+  // the cluster digits of the last call are released with the arena
+  // ================================================================
   vClusterDigitList.clear();
+  vNdigitsCluster.clear();
 
   // clear vector clusters
   // =====================
@@ -561,7 +560,7 @@ std::vector<RecoCluster*>* HitCleaner::RecoClusters(std::vector<RecoDigit*>* myD
   // ===================
   for(int idigit=0; idigit<int(myDigitList->size()); idigit++ ){
     RecoDigit* recoDigit = (RecoDigit*)(myDigitList->at(idigit));
-    RecoClusterDigit* clusterDigit = new RecoClusterDigit(recoDigit);
+    RecoClusterDigit* clusterDigit = fArena->Create<RecoClusterDigit>(recoDigit);
     vClusterDigitList.push_back(clusterDigit);
   }
 
@@ -679,7 +678,7 @@ std::vector<RecoCluster*>* HitCleaner::RecoClusters(std::vector<RecoDigit*>* myD
       } 
 	//std::cout <<"vClusterDigitCollection.size() == "<<vClusterDigitCollection.size()<<std::endl;
       if( (int)vClusterDigitCollection.size()>=fMinClusterDigits ){
-        RecoCluster* cluster = new RecoCluster();
+        RecoCluster* cluster = fArena->Create<RecoCluster>();
         fClusterList->push_back(cluster);
 
         for(int jdigit=0; jdigit<int(vClusterDigitCollection.size()); jdigit++ ){
@@ -697,6 +696,17 @@ std::vector<RecoCluster*>* HitCleaner::RecoClusters(std::vector<RecoDigit*>* myD
   return fClusterList;
 }
 
+void HitCleaner::ReleaseClusters()
+{
+  // the cluster digits belong to the RecoDigit vector of the RecoEvent,
+  // RecoCluster would delete them when the arena destroys the clusters
+  for(int icluster=0; icluster<int(fClusterList->size()); icluster++){
+    fClusterList->at(icluster)->ClearDigits();
+  }
+  fClusterList->clear();
+  fHitCleaningClusters->clear();
+}
+
 std::vector<RecoDigit*>* HitCleaner::FilterByTruthInfo(std::vector<RecoDigit*>* DigitList)
 {
 	std::string name = " HitCleaner::FilterByTruthInfo(() ";
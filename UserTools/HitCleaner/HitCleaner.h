@@ -68,6 +68,7 @@ class HitCleaner: public Tool {
   std::vector<RecoDigit*>* FilterByClusters(std::vector<RecoDigit*>* digitlist);
   std::vector<RecoDigit*>* FilterByTruthInfo(std::vector<RecoDigit*>* digitlist); //use truth information. Only for testing the code
   std::vector<RecoCluster*>* RecoClusters(std::vector<RecoDigit*>* digitlist);
+  void ReleaseClusters();
 
 
  private:
@@ -105,6 +106,9 @@ class HitCleaner: public Tool {
   // Container for parameters
   std::map<std::string, double>* fHitCleaningParam = nullptr;
 
+  // per event objects (cluster digits, clusters, neighbour counts)
+  EventArena::Pool* fArena = nullptr;
+
   // internal containers
   std::vector<Double_t> vNdigitsCluster;  
   std::vector<RecoClusterDigit*> vClusterDigitList;
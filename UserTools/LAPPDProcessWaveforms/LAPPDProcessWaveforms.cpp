@@ -0,0 +1,324 @@
+#include "LAPPDProcessWaveforms.h"
+
+LAPPDProcessWaveforms::LAPPDProcessWaveforms():Tool(){}
+
+
+bool LAPPDProcessWaveforms::Initialise(std::string configfile, DataModel &data){
+
+  /////////////////// Usefull header ///////////////////////
+  if(configfile!="")  m_variables.Initialise(configfile); //loading config file
+  //m_variables.Print();
+
+  m_data= &data; //assigning transient data pointer
+  /////////////////////////////////////////////////////////////////
+
+  // stages to run, default: the full chain
+  doBaselineSubtract = true;
+  doFilter = true;
+  doFindPeak = true;
+  doIntegrate = true;
+  doCFD = true;
+  saveStageOutputs = false;
+  ProcessInputWavLabel = "RawLAPPDData";
+  verbosity = 1;
+  m_variables.Get("DoBaselineSubtract",doBaselineSubtract);
+  m_variables.Get("DoFilter",doFilter);
+  m_variables.Get("DoFindPeak",doFindPeak);
+  m_variables.Get("DoIntegratePulse",doIntegrate);
+  m_variables.Get("DoCFD",doCFD);
+  m_variables.Get("SaveStageOutputs",saveStageOutputs);
+  m_variables.Get("ProcessInputWavLabel",ProcessInputWavLabel);
+  m_variables.Get("verbosity",verbosity);
+  if(doCFD && !doFindPeak){
+    std::cout<<"LAPPDProcessWaveforms: The CFD stage needs the pulses of the peak finding stage, enabling DoFindPeak"<<std::endl;
+    doFindPeak = true;
+  }
+
+  // same configuration variables as the individual tools
+  m_variables.Get("Nsamples", DimSize);
+  m_variables.Get("SampleSize",Deltat);
+  m_variables.Get("LowBLfitrange", LowBLfitrange);
+  m_variables.Get("HiBLfitrange",HiBLfitrange);
+  m_variables.Get("CutoffFrequency", CutoffFrequency);
+  m_variables.Get("TotThreshold", TotThreshold);
+  m_variables.Get("MinimumTot", MinimumTot);
+  m_variables.Get("Deltat", PeakDeltat);
+  m_variables.Get("IntegLow",lowR);
+  m_variables.Get("IntegHi",hiR);
+  m_variables.Get("Fraction_CFD", Fraction_CFD);
+
+  // the stored intermediate results are announced like the individual tools do
+  if(saveStageOutputs && doBaselineSubtract) m_data->Stores["ANNIEEvent"]->Header->Set("isBLsubtracted",true);
+  if(saveStageOutputs && doFilter) m_data->Stores["ANNIEEvent"]->Header->Set("isFiltered",true);
+  if(doIntegrate) m_data->Stores["ANNIEEvent"]->Header->Set("isIntegrated",true);
+
+  // baseline fit: histogram and sine function are reused for every waveform
+  if(doBaselineSubtract){
+    hwav_raw = new TH1D("hwav_raw_process","hwav_raw_process",DimSize,0.,((double)DimSize)*100.);
+    hwav_raw->SetDirectory(0);
+    sinit = new TF1("sinit_process","([0]*sin([2]*x+[1]))",0,DimSize*Deltat);
+  }
+
+  // filter: FFT plans and the 4th order Butterworth response for every frequency bin
+  if(doFilter){
+    fft_forward = TVirtualFFT::FFT(1, &DimSize, "R2C M K");
+    fft_back = TVirtualFFT::FFT(1, &DimSize, "C2R M K");
+    TVirtualFFT::SetTransform(0);      //don't let other FFT users replace (and delete) the plans
+    filter_response.resize(DimSize);
+    for(int i=0;i<DimSize;i++){
+      float finput = i*1.0e10/DimSize;
+      float cutoff = CutoffFrequency;
+      filter_response[i] = (float) (1.0/(1+TMath::Power(finput/cutoff, 2*4)));
+    }
+    re_full.assign(DimSize,0.);
+    im_full.assign(DimSize,0.);
+  }
+
+  work.reserve(DimSize);
+
+  return true;
+}
+
+
+bool LAPPDProcessWaveforms::Execute(){
+
+  // get the input lappd data
+  std::map<int,vector<Waveform<double>>> rawlappddata;
+  bool testval = m_data->Stores["ANNIEEvent"]->Get(ProcessInputWavLabel,rawlappddata);
+  if(!testval){
+    std::cout<<"LAPPDProcessWaveforms: No "<<ProcessInputWavLabel<<" in the ANNIEEvent store!"<<std::endl;
+    return false;
+  }
+
+  // results
+  std::map<int,vector<double>> thecharge;
+  std::map<int,vector<LAPPDPulse>> SimpleRecoLAPPDPulses;
+  std::map<int,vector<LAPPDPulse>> CFDRecoLAPPDPulses;
+
+  // intermediate waveforms, only filled when requested
+  std::map<int,vector<Waveform<double>>> blsublappddata;
+  std::map<int,vector<Waveform<double>>> filteredlappddata;
+
+  map <int, vector<Waveform<double>>> :: iterator itr;
+  for (itr = rawlappddata.begin(); itr != rawlappddata.end(); ++itr){
+    int channelno = itr->first;
+    vector<Waveform<double>> &Vwavs = itr->second;
+
+    vector<double> acharge;
+    vector<LAPPDPulse> &simplepulses = SimpleRecoLAPPDPulses[channelno];
+    vector<LAPPDPulse> &cfdpulses = CFDRecoLAPPDPulses[channelno];
+
+    //loop over all Waveforms, all stages work on the same buffer
+    for(unsigned int i=0; i<Vwavs.size(); i++){
+
+      const std::vector<double> &samples = Vwavs[i].Samples();
+
+      // the charge is integrated from the input waveform, like LAPPDIntegratePulse does
+      if(doIntegrate){
+        // integrate the pulse from the low range to high range in units of mV*psec
+        double Qmvpsec = CalcIntegral(samples);
+        // convert to coulomb
+        double Qcoulomb = Qmvpsec/(1000.*50.*1e12);
+        //convert to number of electrons
+        double Qelectrons = Qcoulomb/(1.60217733e-19);
+        acharge.push_back(Qelectrons);
+      }
+
+      work.assign(samples.begin(),samples.end());
+
+      if(doBaselineSubtract){
+        SubtractSine(work);
+        if(saveStageOutputs) blsublappddata[channelno].push_back(Waveform<double>(Vwavs[i].GetStartTime(),work));
+      }
+
+      if(doFilter){
+        FilterWaveform(work);
+        if(saveStageOutputs) filteredlappddata[channelno].push_back(Waveform<double>(Vwavs[i].GetStartTime(),work));
+      }
+
+      if(doFindPeak){
+        FindPulses_TOT(work,wavpulses);
+        simplepulses.insert(simplepulses.end(),wavpulses.begin(),wavpulses.end());
+
+        // time every pulse on the waveform it was found on
+        if(doCFD){
+          for(unsigned int j=0; j<wavpulses.size(); j++){
+            double cfdtime = CFD_Discriminator1(work,wavpulses[j]);
+            cfdpulses.push_back(LAPPDPulse(0,channelno,(cfdtime/1000.),wavpulses[j].GetCharge(),wavpulses[j].GetPeak(),wavpulses[j].GetLowRange(),wavpulses[j].GetHiRange()));
+          }
+        }
+      }
+    }
+
+    if(doIntegrate) thecharge.insert(pair <int,vector<double>> (channelno,acharge));
+  }
+
+  // only the final results go to the store by default
+  if(doIntegrate) m_data->Stores["ANNIEEvent"]->Set("theCharges",thecharge);
+  if(doFindPeak) m_data->Stores["ANNIEEvent"]->Set("SimpleRecoLAPPDPulses",SimpleRecoLAPPDPulses);
+  if(doCFD) m_data->Stores["ANNIEEvent"]->Set("CFDRecoLAPPDPulses",CFDRecoLAPPDPulses);
+  if(saveStageOutputs){
+    if(doBaselineSubtract) m_data->Stores["ANNIEEvent"]->Set("BLsubtractedLAPPDData",blsublappddata);
+    if(doFilter) m_data->Stores["ANNIEEvent"]->Set("FiltLAPPDData",filteredlappddata);
+  }
+
+  return true;
+}
+
+
+bool LAPPDProcessWaveforms::Finalise(){
+
+  delete hwav_raw;
+  delete sinit;
+  delete fft_forward;
+  delete fft_back;
+
+  return true;
+}
+
+
+void LAPPDProcessWaveforms::SubtractSine(std::vector<double> &wav){
+
+  int nbins = wav.size();
+  if(nbins!=hwav_raw->GetNbinsX()) hwav_raw->SetBins(nbins,0.,((double)nbins)*100.);
+
+  for(int i=0; i<nbins; i++){
+    hwav_raw->SetBinContent(i+1,wav[i]);
+    hwav_raw->SetBinError(i+1,0.1);
+  }
+
+  // start every fit from the same parameters
+  sinit->SetParameter(0,0.4);
+  sinit->SetParameter(1,0.0);
+  sinit->SetParameter(2,0.00055);
+  sinit->SetParLimits(2,0.0003,0.0008);
+  sinit->SetParLimits(0,0.,1.0);
+
+  hwav_raw->Fit(sinit,"QNO","",LowBLfitrange,HiBLfitrange);
+
+  for(int j=0; j<nbins; j++){
+    wav[j] -= sinit->Eval(hwav_raw->GetBinCenter(j+1));
+  }
+}
+
+
+bool LAPPDProcessWaveforms::FilterWaveform(std::vector<double> &wav){
+
+  if((int)wav.size()!=DimSize){
+    if(!warned_size) std::cout<<"LAPPDProcessWaveforms: Waveform has "<<wav.size()<<" samples, but the filter is set up for Nsamples="<<DimSize<<". Not filtering these waveforms."<<std::endl;
+    warned_size = true;
+    return false;
+  }
+
+  fft_forward->SetPoints(wav.data());
+  fft_forward->Transform();
+  fft_forward->GetPointsComplex(re_full.data(),im_full.data());
+
+  // only the first DimSize/2+1 frequencies are independent for a real input
+  for(int i=0;i<=DimSize/2;i++) {
+    re_full[i] *= filter_response[i];
+    im_full[i] *= filter_response[i];
+  }
+
+  fft_back->SetPointsComplex(re_full.data(),im_full.data());
+  fft_back->Transform();
+  fft_back->GetPoints(wav.data());
+  for(int i=0;i<DimSize;i++) wav[i] /= DimSize;
+
+  return true;
+}
+
+
+void LAPPDProcessWaveforms::FindPulses_TOT(const std::vector<double> &wav, std::vector<LAPPDPulse> &thepulses){
+
+  thepulses.clear();
+
+  int npeaks=0;
+  double Q=0.;
+  double peak=0.;
+  double low=0.;
+  double hi=0.;
+  double tc=0;
+
+  bool pulsestarted=false;
+  double threshold = TotThreshold*2;
+  double pvol = 0;
+  int nbin = wav.size();
+  int length = 0;
+  int MinimumTotBin = (int)(MinimumTot/PeakDeltat);
+  for(int i=0;i<nbin;i++) {
+    pvol = TMath::Abs(wav[i]);
+
+    if(pvol>threshold) {
+      length++;
+      if(pvol>peak) peak = pvol;
+      Q+=(wav[i]);
+      if(!pulsestarted) low=(double)i;
+      pulsestarted=true;
+    }
+    else {
+      if(length<MinimumTotBin) {length=0; Q=0; pulsestarted=false; low=0; hi=0; peak=0;}
+      else {
+        npeaks++; length = 0; hi=(double)i;
+        thepulses.push_back(LAPPDPulse(0,0,tc,Q,peak,low,hi));
+        pulsestarted=false;
+        peak=0; Q=0; low=0; hi=0;
+      }
+    }
+  }
+}
+
+
+double LAPPDProcessWaveforms::CalcIntegral(const std::vector<double> &wav){
+
+  double sT=0.; // currently hard coded
+
+  int lowb = (lowR - sT)/Deltat;
+  int hib = (hiR - sT)/Deltat;
+
+  double tQ=0.;
+
+  if( (lowb>=0) && (hib<(int)wav.size()) ){
+    for(int i=lowb; i<hib; i++){
+      tQ+=((-wav[i])*Deltat);
+    }
+  } else std::cout<<"OUT OF RANGE!!!!";
+
+  return tQ;
+}
+
+
+double LAPPDProcessWaveforms::InterpolateInverted(const std::vector<double> &wav, double x){
+
+  // samples sit at the centers of 100 ps bins starting at 0, same as the histogram LAPPDcfd builds
+  int nbins = wav.size();
+  double u = x/100. - 0.5;
+  if(u <= 0.) return -wav[0];
+  int i = (int) u;
+  if(i >= nbins-1) return -wav[nbins-1];
+  double frac = u - i;
+  return -(wav[i] + frac*(wav[i+1]-wav[i]));
+}
+
+
+double LAPPDProcessWaveforms::CFD_Discriminator1(const std::vector<double> &wav, LAPPDPulse &pulse){
+
+  double amp = pulse.GetPeak();
+  double th = Fraction_CFD * amp;
+  double eps = 1e-2;
+  double xlow = (pulse.GetLowRange()-5)*100.;
+  double xhigh = (pulse.GetHiRange()+5)*100.;
+  double xmid;
+
+  if(wav.empty()) return 0.;
+
+  // gradually moving the high and low range of the search towards the point where the
+  // pulse crosses the threshold. Stop when the low and high range are closer than eps
+  while ((xhigh-xlow) >= eps ){
+    xmid = (xlow + xhigh)/2.;
+    if ((InterpolateInverted(wav,xmid)-th) > 0) xhigh = xmid;
+    else xlow = xmid;
+  }
+
+  return xlow;
+}
@@ -0,0 +1,92 @@
+#ifndef LAPPDProcessWaveforms_H
+#define LAPPDProcessWaveforms_H
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include "TVirtualFFT.h"
+#include "TH1D.h"
+#include "TF1.h"
+#include "TMath.h"
+#include "LAPPDPulse.h"
+
+#include "Tool.h"
+
+/**
+ * \class LAPPDProcessWaveforms
+ *
+ * Runs the LAPPD waveform chain (LAPPDBaselineSubtract -> LAPPDFilter -> LAPPDFindPeak -> LAPPDIntegratePulse -> LAPPDcfd)
+ * as a single tool. Every strip waveform is copied once into a work buffer and all enabled stages are applied to that buffer
+ * in place, so the intermediate waveform maps are only built and stored if requested for debugging (SaveStageOutputs).
+ * The fit function, FFT plans and filter response are set up once in Initialise.
+ */
+
+class LAPPDProcessWaveforms: public Tool {
+
+
+ public:
+
+  LAPPDProcessWaveforms();
+  bool Initialise(std::string configfile,DataModel &data);
+  bool Execute();
+  bool Finalise();
+
+
+ private:
+
+  void SubtractSine(std::vector<double> &wav);                                   ///< LAPPDBaselineSubtract stage
+  bool FilterWaveform(std::vector<double> &wav);                                 ///< LAPPDFilter stage
+  void FindPulses_TOT(const std::vector<double> &wav, std::vector<LAPPDPulse> &thepulses);   ///< LAPPDFindPeak stage
+  double CalcIntegral(const std::vector<double> &wav);                           ///< LAPPDIntegratePulse stage
+  double CFD_Discriminator1(const std::vector<double> &wav, LAPPDPulse &pulse);  ///< LAPPDcfd stage
+  double InterpolateInverted(const std::vector<double> &wav, double x);          ///< TH1::Interpolate of the inverted trace
+
+  //stages
+  bool doBaselineSubtract;
+  bool doFilter;
+  bool doFindPeak;
+  bool doIntegrate;
+  bool doCFD;
+  bool saveStageOutputs;
+  std::string ProcessInputWavLabel;
+  int verbosity;
+
+  //common parameters
+  int DimSize;
+  double Deltat;
+
+  //baseline subtraction
+  double LowBLfitrange;
+  double HiBLfitrange;
+  TH1D *hwav_raw = nullptr;
+  TF1 *sinit = nullptr;
+
+  //filter
+  double CutoffFrequency;
+  TVirtualFFT *fft_forward = nullptr;
+  TVirtualFFT *fft_back = nullptr;
+  std::vector<double> filter_response;
+  std::vector<double> re_full;
+  std::vector<double> im_full;
+  bool warned_size = false;
+
+  //peak finding
+  double TotThreshold;
+  double MinimumTot;
+  double PeakDeltat;
+
+  //integration
+  double lowR;
+  double hiR;
+
+  //cfd
+  double Fraction_CFD;
+
+  //work buffers, reused for every strip
+  std::vector<double> work;
+  std::vector<LAPPDPulse> wavpulses;
+
+};
+
+
+#endif
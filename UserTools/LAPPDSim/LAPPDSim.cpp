@@ -1,7 +1,7 @@
 #include "LAPPDSim.h"
 #include <unistd.h>
 
-LAPPDSim::LAPPDSim():Tool(),myTR(nullptr),_tf(nullptr),_event_counter(0),_file_number(0),_display_config(0),_is_artificial(false),_display(nullptr),_geom(nullptr),LAPPDWaveforms(nullptr)
+LAPPDSim::LAPPDSim():Tool(),myTR(nullptr),_tf(nullptr),_event_counter(0),_file_number(0),_display_config(0),_is_artificial(false),_display(nullptr),_response(nullptr),_geom(nullptr),LAPPDWaveforms(nullptr)
 {
 }
 
@@ -61,6 +61,11 @@ bool LAPPDSim::Initialise(std::string configfile, DataModel &data)
 	myTR = new TRandom3();
 	_tf = new TFile(pulsecharacteristicsFileChar, "READ");
 
+	//The LAPPDresponse class is used for the electronics simulation. Its response tables are built once here,
+	//only the pulses are cleared for every LAPPD.
+	_response = new LAPPDresponse();
+	_response->Initialise(_tf);
+
 	if (_display_config > 0)
 	{
 		_display = new LAPPDDisplay(outputFile, _display_config);
@@ -101,8 +106,8 @@ bool LAPPDSim::Execute()
   		std::map<unsigned long, Detector*>::iterator itDet;
 					for(itDet = LAPPDDetectors.begin(); itDet != LAPPDDetectors.end(); ++itDet){
 
-					LAPPDresponse response;
-					response.Initialise(_tf);
+					LAPPDresponse& response = *_response;
+					response.ClearPulses();
 					artificialHits.clear();
 					int detectorID = itDet->second->GetDetectorID();
 					Position LAPPDPosition = itDet->second->GetDetectorPosition();
@@ -207,9 +212,9 @@ bool LAPPDSim::Execute()
 				_display->MCTruthDrawing(_event_counter, actualTubeNo, mchits);
 			}
 
-			//Create an object of the LAPPDresponse class, which is used for the electronics simulation
-			LAPPDresponse response;
-			response.Initialise(_tf);
+			//Remove the pulses of the previous LAPPD from the LAPPDresponse object, which is used for the electronics simulation
+			LAPPDresponse& response = *_response;
+			response.ClearPulses();
 
 			//loop over the hits on each lappd
 			for (int j = 0; j < mchits.size(); j++)
@@ -301,6 +306,7 @@ bool LAPPDSim::Execute()
 
 bool LAPPDSim::Finalise()
 {
+	delete _response;
 	_tf->Close();
 	_display->~LAPPDDisplay();
 	return true;
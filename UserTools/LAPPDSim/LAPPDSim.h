@@ -39,6 +39,7 @@ class LAPPDSim: public Tool {
    int _display_config;
    bool _is_artificial;
    LAPPDDisplay* _display;
+   LAPPDresponse* _response;
    Geometry* _geom;
    std::map<unsigned long, Waveform<double> >* LAPPDWaveforms;
 
@@ -3,7 +3,6 @@
 #include "TString.h"
 #include "TFile.h"
 #include "TH1.h"
-#include "TF1.h"
 #include <vector>
 #include <iostream>
 #include <cmath>
@@ -41,7 +40,7 @@ LAPPDresponse::LAPPDresponse()
 }
 LAPPDresponse::~LAPPDresponse()
 {
-
+  delete mrand;
 }
 
 void LAPPDresponse::Initialise(TFile* tf){
@@ -60,7 +59,45 @@ void LAPPDresponse::Initialise(TFile* tf){
   //_pulseCluster = new LAPPDpulseCluster()  This is no longer needed, kept for reference for now
 
   // random numbers for generating noise
+  delete mrand;
   mrand = new TRandom3();
+
+  // lookup tables for the per-photon and per-sample evaluations
+  _templatetable.Build(_templatepulse);
+  _pulsewidthtable.Build(_pulsewidth);
+}
+
+void LAPPDresponse::ClearPulses()
+{
+  // keep the map entries (and their allocated pulse vectors) of the strips, only drop the pulses
+  for(auto& strip : LAPPDPulseCluster) strip.second.clear();
+}
+
+void LAPPDresponse::InterpolationTable::Build(TH1D* h)
+{
+  hist = h;
+  contents.clear();
+  if(h==nullptr) return;
+  TAxis* axis = h->GetXaxis();
+  // variable bin sizes cannot be indexed directly, use the histogram itself
+  if(axis->GetXbins()->GetSize()>0) return;
+  int nbins = h->GetNbinsX();
+  first_center = axis->GetBinCenter(1);
+  bin_width = axis->GetBinWidth(1);
+  contents.resize(nbins);
+  for(int i=0; i<nbins; i++) contents[i] = h->GetBinContent(i+1);
+}
+
+double LAPPDresponse::InterpolationTable::Eval(double x) const
+{
+  if(contents.empty()) return (hist) ? hist->Interpolate(x) : 0.;
+  // same conventions as TH1::Interpolate: constant outside the first/last bin center, linear in between
+  double u = (x - first_center)/bin_width;
+  if(u <= 0.) return contents.front();
+  int i = (int) u;
+  if(i >= (int) contents.size()-1) return contents.back();
+  double frac = u - i;
+  return contents[i] + frac*(contents[i+1]-contents[i]);
 }
 
 void LAPPDresponse::AddSinglePhotonTrace(double trans, double para, double time)
@@ -77,15 +114,10 @@ void LAPPDresponse::AddSinglePhotonTrace(double trans, double para, double time)
   //std::cout<<"THE PEAK "<<peak<<std::endl;
 
   // width of the charge sharing
-  double thesigma =  _pulsewidth->Interpolate(offcenter);
+  double thesigma =  _pulsewidthtable.Eval(offcenter);
 
   //std::cout << "/* message */" << '\n';std::cout<<"nearest stripnum: "<<neareststripnum<<" off center: "<<offcenter<<" thesigma "<<thesigma<<std::endl;
 
-  TF1* theChargeSpread = new TF1("theChargeSpread","gaus",-100,100);
-  theChargeSpread->SetParameter(0,peak);
-  theChargeSpread->SetParameter(1,0.0);
-  theChargeSpread->SetParameter(2,thesigma);
-
   // calculate distances and times in the parallel direction
   double leftdistance = fabs(-114.554 - para); // annode is 229.108 mm in parallel direction
   double rightdistance = fabs(114.554 - para);
@@ -102,7 +134,12 @@ void LAPPDresponse::AddSinglePhotonTrace(double trans, double para, double time)
 
     int wstrip = (neareststripnum-2)+i;
     double wtrans = this->StripCoordinate(wstrip);
-    double wspeak = theChargeSpread->Eval(trans-wtrans);
+
+    // gaussian charge spread (amplitude peak, mean 0, width thesigma) evaluated at the strip center
+    double dtrans = trans-wtrans;
+    double wspeak = 0.;
+    if(thesigma!=0.) wspeak = peak*exp(-0.5*(dtrans/thesigma)*(dtrans/thesigma));
+    else if(dtrans==0.) wspeak = peak;
 
     //signal has to be larger than 0.5 mV
     if( (wspeak>0.5) && (wstrip>0) && (wstrip<31) ) {
@@ -113,133 +150,61 @@ void LAPPDresponse::AddSinglePhotonTrace(double trans, double para, double time)
 
       //std::cout<<"which strip "<<wstrip<<" peakvalue"<<wspeak<<std::endl;
 
-
+      //add pulse to the (possibly new) vector at key, appended in place  SD
       LAPPDPulse pulse(tubeid, wstrip, (time + righttime)/1000., charge, wspeak, low, hi);  //SD
-      if(LAPPDPulseCluster.count(wstrip)==1){
-        std::vector<LAPPDPulse> tempVector;
-        tempVector = LAPPDPulseCluster.at(wstrip);
-        tempVector.push_back (pulse);
-        LAPPDPulseCluster.at(wstrip)=tempVector;
-        //add pulse to already existing vector at key  SD
-      }
-      else{
-        std::vector<LAPPDPulse> PulseVector ;
-        PulseVector.push_back (pulse);
-        LAPPDPulseCluster.insert (std::pair<int,vector<LAPPDPulse>>(wstrip,PulseVector) );//SD
-        //create vector at key and add pulse into that vector SD
-      }
+      LAPPDPulseCluster[wstrip].push_back(pulse);
 
       pulse.SetChannelID(-1.0*wstrip); //SD
       pulse.SetTime((time +lefttime)/1000.); //SD
-      if(LAPPDPulseCluster.count(-wstrip)==1){
-        std::vector<LAPPDPulse> tempVector;
-        tempVector = LAPPDPulseCluster.at(-wstrip);
-        tempVector.push_back (pulse);
-        LAPPDPulseCluster.at(-wstrip)=tempVector;
-        //add pulse to already existing vector at key  SD
-      }
-      else{
-        std::vector<LAPPDPulse> PulseVector ;
-        PulseVector.push_back (pulse);
-        LAPPDPulseCluster.insert (std::pair<int,vector<LAPPDPulse>>(-wstrip,PulseVector) );   //SD
-        //create vector at key and add pulse into that vector SD
-      }
+      LAPPDPulseCluster[-wstrip].push_back(pulse);
     }
   }
 
   //std::cout<<"Done Adding Pulse"<<std::endl;
-  delete theChargeSpread;
 }
 
 
 Waveform<double> LAPPDresponse::GetTrace(int CHnumber, double starttime, double samplesize, int numsamples, double thenoise)
 {
 
-  // parameters for the histogram of the scope trace
+  // the samples are taken at the centers of numsamples bins of width samplesize, the first centered on starttime
   double lowend = (starttime-(samplesize/2.));
   double upend = lowend + samplesize*((double)numsamples);
-  TString tracename;
-  tracename += "trace_";
-  tracename += CHnumber;
-  //tracename += "_";
-  //if(parity==1) tracename+="right";
-//  else tracename+="left";
-  //create said histogram
-
-  TH1D* trace = new TH1D(tracename,tracename,numsamples,lowend,upend);
-  Waveform<double> wav_trace;
-  //if there are no pulses on the strip, just generate white noise
-  if(LAPPDPulseCluster.count(CHnumber)==0) {   //SD
-    for(int j=0; j<numsamples; j++){
-
-      double mnoise = thenoise*(mrand->Rndm()-0.5);
-
-      trace->SetBinContent(j+1, mnoise);
+  double binwidth = (upend-lowend)/((double)numsamples);
 
-    }
+  // white noise is added once to every sample, whether or not there are pulses on the strip
+  _samples.assign(numsamples,0.);
+  for(int j=0; j<numsamples; j++){
+    _samples[j] = thenoise*(mrand->Rndm()-0.5);
   }
-  else{
 
-    //if there are pulses on the strip, loop over the N pulses on that strip
-	std::vector<LAPPDPulse> tempoVector = LAPPDPulseCluster.at(CHnumber);   //SD
-    for(int k=0; k<tempoVector.size(); k++){           //SD
-      //  for(int k=0; k<4; k++){
+  std::map<int, std::vector<LAPPDPulse> >::iterator strip = LAPPDPulseCluster.find(CHnumber);   //SD
+  if(strip!=LAPPDPulseCluster.end()){
 
+    //if there are pulses on the strip, loop over the N pulses on that strip
+    std::vector<LAPPDPulse>& pulses = strip->second;
+    for(unsigned int k=0; k<pulses.size(); k++){           //SD
 
-      //looks up the index number for pulse "k" on strip "CHnumber"
-      //int wPulse = _pulseCluster->GetPulseNum(CHnumber,k);
-      //gets the pulse with that index number
-      //LAPPDpulse* mpulse = _pulseCluster->GetPulse(wPulse);
       //peak value of the signal on that strip
-      //double peakv = mpulse->Getpeakvalue();
-      double peakv=tempoVector.at(k).GetPeak();
-      //arrival time of the pulse
-      //double ptime = mpulse->Getpulsetime();
-      double thetime=0;
-      double ptime= thetime;
-      //transit time of the pulse along the strip
-      double stime=tempoVector.at(k).GetTime()*1000.;
-      //looking at the signal to the left (parity=-1) or right (parity=1)?
-
-      //if(parity<0) stime = mpulse->Getlefttime();
-      //else stime = mpulse->Getrighttime();
-      //	 if(parity<0) stime=0.5;    //SD out
-      //     else stime = 0.3;    //SD out
-
-      //sum the pulse arrival time with transit time on the strip to determine
-      //when the signal will arrive
-      double tottime = ptime + stime;
-
-      //loop over number of samples
-
-      for(int j=0; j<numsamples; j++){
-
-        //get the global time when each sample is acquired
-        double bcent = trace->GetBinCenter(j+1);
-        double mbincontent=0.0;
-        double mnoise=0.0;
-
-        //only add the noise on ONCE
-        if(k==0) mnoise = thenoise*(mrand->Rndm()-0.5);
-        mbincontent+=mnoise;
-
-        //if the sample time actually falls in the window for when the pulse
-        //should arrive, evaluate the pulse value at that sample point
-        if( (bcent > tottime) && (bcent< tottime+3000) ) mbincontent+=(peakv*(_templatepulse->Interpolate(bcent-tottime)));
-
-        //add this on to the contributions to the trace from previous pulses
-        double obincontent = trace->GetBinContent(j+1);
-        trace->SetBinContent(j+1,obincontent+mbincontent);
-
+      double peakv=pulses[k].GetPeak();
+      //arrival time of the pulse (transit time along the strip included)
+      double tottime=pulses[k].GetTime()*1000.;
+
+      //only the samples in the window when the pulse arrives get a contribution,
+      //evaluate the pulse shape at those sample points and add it to the trace
+      int jfirst = (int) floor((tottime-lowend)/binwidth - 0.5);
+      int jlast = (int) ceil((tottime+3000-lowend)/binwidth - 0.5);
+      if(jfirst<0) jfirst = 0;
+      if(jlast>numsamples-1) jlast = numsamples-1;
+      for(int j=jfirst; j<=jlast; j++){
+        double bcent = lowend + (j+0.5)*binwidth;
+        if( (bcent > tottime) && (bcent< tottime+3000) ) _samples[j]+=(peakv*(_templatetable.Eval(bcent-tottime)));
       }
     }
   }
 
-  for (int i = 1; i <= numsamples; i++){
-      wav_trace.PushSample(trace->GetBinContent(i));
-  }
-
-  delete trace;
+  Waveform<double> wav_trace;
+  wav_trace.SetSamples(_samples);
   return wav_trace;
 }
 
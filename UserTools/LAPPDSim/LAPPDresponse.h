@@ -7,6 +7,7 @@
 #include "TH1.h"
 #include "TRandom3.h"
 #include <map>
+#include <vector>
 #include "Tool.h"
 #include "LAPPDPulse.h"
 #include "Waveform.h"
@@ -22,6 +23,8 @@ class LAPPDresponse {
 
   void Initialise(TFile* tf);
 
+  void ClearPulses();   //remove the pulses of the previous LAPPD, keeps the response tables
+
   void AddSinglePhotonTrace(double trans, double para, double time);
 
   Waveform<double> GetTrace(int CHnumber, double starttime, double samplesize, int numsamples, double thenoise);
@@ -50,10 +53,26 @@ class LAPPDresponse {
   TH1D** StripResponse_neg;
   TH1D** StripResponse_pos;
 
+  //flat copy of a uniformly binned TH1D, evaluates like TH1::Interpolate without the histogram lookups
+  struct InterpolationTable {
+    double first_center = 0.;
+    double bin_width = 1.;
+    std::vector<double> contents;
+    TH1D* hist = nullptr;       //fallback for variable bin sizes
+    void Build(TH1D* h);
+    double Eval(double x) const;
+  };
+
+  InterpolationTable _templatetable;      //pulse shape (time after pulse arrival in ps)
+  InterpolationTable _pulsewidthtable;    //charge sharing width vs. distance from strip center (mm)
+
+  //sample buffer reused by GetTrace
+  std::vector<double> _samples;
+
   //  LAPPDpulseCluster* _pulseCluster;
 
   //randomizer
-  TRandom3* mrand;
+  TRandom3* mrand = nullptr;
 
   //useful functions
   int FindNearestStrip(double trans);
@@ -1,8 +1,12 @@
 // standard library includes
 #include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <limits>
 
 // ToolAnalysis includes
 #include "LoadANNIEEvent.h"
+#include "EventTagTable.h"
 
 LoadANNIEEvent::LoadANNIEEvent():Tool() {}
 
@@ -17,6 +21,17 @@ bool LoadANNIEEvent::Initialise(std::string config_filename, DataModel &data) {
 
   m_variables.Get("verbose", verbosity_);
   m_variables.Get("EventOffset", offset_evnum);
+  m_variables.Get("ReadAhead", read_ahead_);
+  m_variables.Get("TagCuts", tag_cuts_);
+  if ( read_ahead_ < 0 ) read_ahead_ = 0;
+
+  std::string drop_keys;
+  m_variables.Get("DropKeys", drop_keys);
+  std::stringstream ss_keys(drop_keys);
+  std::string key;
+  while ( std::getline(ss_keys, key, ',') ) {
+    if ( !key.empty() ) drop_keys_.push_back(key);
+  }
 
   std::string input_list_filename;
   bool got_input_file_list = m_variables.Get("FileForListOfInputs",
@@ -45,6 +60,13 @@ bool LoadANNIEEvent::Initialise(std::string config_filename, DataModel &data) {
   m_data->CStore.Set("UserEvent",false);
 
   current_entry_ += offset_evnum;
+
+  file_has_selection_.assign(input_filenames_.size(), false);
+  selected_entries_.assign(input_filenames_.size(), std::vector<size_t>());
+  if ( !tag_cuts_.empty() ) {
+    if ( !ApplyTagCuts() ) return false;
+    SkipFilesWithoutSelectedEntries();
+  }
  
   return true;
 }
@@ -55,6 +77,11 @@ bool LoadANNIEEvent::Execute() {
   int stop_the_loop = -1;
   m_data->vars.Get("StopLoop", stop_the_loop);
   if ( stop_the_loop == 1 ) return false;
+  if ( current_file_ >= input_filenames_.size() ) {
+    Log("LoadANNIEEvent: no entries to load", v_warning, verbosity_);
+    m_data->vars.Set("StopLoop", 1);
+    return false;
+  }
 
   if (need_new_file_) {
     need_new_file_=false;
@@ -67,7 +94,12 @@ bool LoadANNIEEvent::Execute() {
       delete ProcessedFileStore;
     }
     // also close and cleanup the associated contained stores
-    if ( m_data->Stores.count("ANNIEEvent") ) {
+    if ( read_ahead_ > 0 && !entry_stores_.empty() ) {
+      // the current ANNIEEvent is one of the read-ahead stores
+      StopReader();
+      DeleteEntryStores();
+    }
+    else if ( m_data->Stores.count("ANNIEEvent") ) {
       auto* annie_event = m_data->Stores.at("ANNIEEvent");
       if (annie_event){
 //        annie_event->Close();
@@ -102,9 +134,29 @@ bool LoadANNIEEvent::Execute() {
     ProcessedFileStore->Get("ANNIEEvent",*theANNIEEvent);
     // set a pointer into the Stores map
     m_data->Stores["ANNIEEvent"]=theANNIEEvent;
+
+    if ( read_ahead_ > 0 ) {
+      // one store per entry in flight: the current one, read_ahead_ ready ones and one being read.
+      // Each holds its own stream of the file, so the reader never touches the current entry.
+      entry_stores_.push_back(theANNIEEvent);
+      for ( int i = 0; i < read_ahead_ + 1; i++ ) {
+        BoostStore* entry_store = new BoostStore(false, BOOST_STORE_MULTIEVENT_FORMAT);
+        ProcessedFileStore->Get("ANNIEEvent", *entry_store);
+        entry_stores_.push_back(entry_store);
+      }
+      free_stores_.assign(entry_stores_.begin(), entry_stores_.end());
+      current_store_ = nullptr;
+    }
     // get the number of entries
     m_data->Stores.at("ANNIEEvent")->Header->Get("TotalEntries",
       total_entries_in_file_);
+    current_entry_ = NextEntry(current_file_, current_entry_);
+    if ( current_entry_ >= total_entries_in_file_ ) {
+      Log("LoadANNIEEvent: Error: tag file of " + input_filenames_.at(current_file_)
+        + " has more entries than the file", v_error, verbosity_);
+      m_data->vars.Set("StopLoop", 1);
+      return false;
+    }
     
 /*
     // same for Orphan Store
@@ -131,18 +183,17 @@ bool LoadANNIEEvent::Execute() {
     " ANNIEEvent input file \"" + input_filenames_.at(current_file_)
     + '\"', 1, verbosity_);
  
-  if (current_entry_ != offset_evnum) m_data->Stores["ANNIEEvent"]->Delete();	//ensures that we can access pointers without problems
-
-  m_data->Stores["ANNIEEvent"]->GetEntry(current_entry_);  
-  ++current_entry_;
+  LoadEntry();
+  current_entry_ = NextEntry(current_file_, current_entry_ + 1);
   
   if ( current_entry_ >= total_entries_in_file_ ) {
     ++current_file_;
+    current_entry_ = 0u;
+    SkipFilesWithoutSelectedEntries();
     if ( current_file_ >= input_filenames_.size() ) {
       m_data->vars.Set("StopLoop", 1);
     }
     else {
-      current_entry_ = 0u;
       need_new_file_ = true;
     }
   }
@@ -153,5 +204,177 @@ bool LoadANNIEEvent::Execute() {
 
 
 bool LoadANNIEEvent::Finalise() {
+  StopReader();
+  // the last entry stays in the ANNIEEvent store for the Finalise of the following tools
+  DeleteEntryStores(true);
   return true;
 }
+
+
+void LoadANNIEEvent::LoadEntry() {
+
+  if ( read_ahead_ == 0 ) {
+    if (current_entry_ != offset_evnum) m_data->Stores["ANNIEEvent"]->Delete();	//ensures that we can access pointers without problems
+
+    m_data->Stores["ANNIEEvent"]->GetEntry(current_entry_);
+    DropKeys(m_data->Stores["ANNIEEvent"]);
+    return;
+  }
+
+  // restart the reader if it is not reading the requested entry next (first entry of a file or a UserEvent jump)
+  bool restart = !reader_thread_.joinable();
+  if ( !restart ) {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    size_t next_entry = next_read_entry_;
+    if ( !ready_stores_.empty() ) next_entry = ready_stores_.front().first;
+    else if ( entry_in_progress_ != std::numeric_limits<size_t>::max() ) next_entry = entry_in_progress_;
+    restart = ( next_entry != current_entry_ );
+  }
+  if ( restart ) {
+    Log("LoadANNIEEvent: starting read-ahead at entry " + std::to_string(current_entry_), v_debug, verbosity_);
+    StopReader();
+    StartReader(current_entry_);
+  }
+
+  BoostStore* entry_store = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(reader_mutex_);
+    reader_cv_.wait(lock, [this]{ return !ready_stores_.empty(); });
+    entry_store = ready_stores_.front().second;
+    ready_stores_.pop_front();
+    // the previous entry is no longer used by the chain, its store can be refilled
+    if ( current_store_ ) free_stores_.push_back(current_store_);
+  }
+  reader_cv_.notify_all();
+
+  current_store_ = entry_store;
+  m_data->Stores["ANNIEEvent"] = entry_store;
+}
+
+
+void LoadANNIEEvent::DropKeys(BoostStore* store) {
+  for ( const std::string& key : drop_keys_ ) {
+    if ( store->Has(key) ) store->Remove(key);
+  }
+}
+
+
+void LoadANNIEEvent::StartReader(size_t first_entry) {
+  next_read_entry_ = first_entry;
+  reader_file_ = current_file_;
+  stop_reader_ = false;
+  reader_thread_ = std::thread(&LoadANNIEEvent::ReaderLoop, this);
+}
+
+
+void LoadANNIEEvent::StopReader() {
+  {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    stop_reader_ = true;
+  }
+  reader_cv_.notify_all();
+  if ( reader_thread_.joinable() ) reader_thread_.join();
+  entry_in_progress_ = std::numeric_limits<size_t>::max();
+
+  // entries read ahead are discarded
+  for ( auto& ready : ready_stores_ ) free_stores_.push_back(ready.second);
+  ready_stores_.clear();
+}
+
+
+void LoadANNIEEvent::ReaderLoop() {
+
+  while ( true ) {
+    BoostStore* entry_store = nullptr;
+    size_t entry = 0;
+    {
+      std::unique_lock<std::mutex> lock(reader_mutex_);
+      reader_cv_.wait(lock, [this]{
+        return stop_reader_ || next_read_entry_ >= total_entries_in_file_ || !free_stores_.empty(); });
+      if ( stop_reader_ || next_read_entry_ >= total_entries_in_file_ ) return;
+      entry_store = free_stores_.front();
+      free_stores_.pop_front();
+      entry = next_read_entry_;
+      entry_in_progress_ = entry;
+      next_read_entry_ = NextEntry(reader_file_, entry + 1);
+    }
+
+    // reading and decompressing the entry happens outside the lock, the values stay
+    // serialised in the store until a tool calls Get
+    entry_store->Delete();
+    entry_store->GetEntry(entry);
+    DropKeys(entry_store);
+
+    {
+      std::lock_guard<std::mutex> lock(reader_mutex_);
+      ready_stores_.emplace_back(entry, entry_store);
+      entry_in_progress_ = std::numeric_limits<size_t>::max();
+    }
+    reader_cv_.notify_all();
+  }
+
+}
+
+
+void LoadANNIEEvent::DeleteEntryStores(bool keep_current) {
+  // keep_current: the store in m_data->Stores["ANNIEEvent"] is left to the DataModel
+  BoostStore* annie_event = m_data->Stores.count("ANNIEEvent") ? m_data->Stores.at("ANNIEEvent") : nullptr;
+  for ( BoostStore* entry_store : entry_stores_ ) {
+    if ( !keep_current || entry_store != annie_event ) delete entry_store;
+  }
+  entry_stores_.clear();
+  free_stores_.clear();
+  ready_stores_.clear();
+  current_store_ = nullptr;
+  if ( !keep_current ) m_data->Stores.erase("ANNIEEvent");
+}
+
+
+bool LoadANNIEEvent::ApplyTagCuts() {
+  // the tags of entry i of <file> are row i of <file>.tags
+  size_t total_rows = 0, total_selected = 0;
+  for ( size_t file = 0; file < input_filenames_.size(); file++ ) {
+    EventTagTable tags;
+    std::string tag_filename = input_filenames_.at(file) + ".tags";
+    if ( !tags.Read(tag_filename) ) {
+      Log("LoadANNIEEvent: Warning: no tag file " + tag_filename + ", reading all entries of "
+        + input_filenames_.at(file), v_warning, verbosity_);
+      continue;
+    }
+    EventTagCut cut;
+    std::string error;
+    if ( !cut.Parse(tag_cuts_, tags, error) ) {
+      Log("LoadANNIEEvent: Error: TagCuts on " + tag_filename + ": " + error, v_error, verbosity_);
+      return false;
+    }
+    file_has_selection_.at(file) = true;
+    for ( size_t row = 0; row < tags.GetNRows(); row++ ) {
+      if ( cut.Pass(tags, row) ) selected_entries_.at(file).push_back(row);
+    }
+    total_rows += tags.GetNRows();
+    total_selected += selected_entries_.at(file).size();
+  }
+  Log("LoadANNIEEvent: " + std::to_string(total_selected) + " of " + std::to_string(total_rows)
+    + " tagged entries pass TagCuts " + tag_cuts_, v_message, verbosity_);
+  return true;
+}
+
+
+size_t LoadANNIEEvent::NextEntry(size_t file, size_t entry) const {
+  // first entry >= entry to load, or the largest size_t if there is none
+  if ( !file_has_selection_.at(file) ) return entry;
+  const std::vector<size_t>& selected = selected_entries_.at(file);
+  std::vector<size_t>::const_iterator it = std::lower_bound(selected.begin(), selected.end(), entry);
+  if ( it == selected.end() ) return std::numeric_limits<size_t>::max();
+  return *it;
+}
+
+
+void LoadANNIEEvent::SkipFilesWithoutSelectedEntries() {
+  // files are not opened at all if no entry from current_entry_ on passes the tag selection
+  while ( current_file_ < input_filenames_.size()
+    && NextEntry(current_file_, current_entry_) == std::numeric_limits<size_t>::max() ) {
+    ++current_file_;
+    current_entry_ = 0u;
+  }
+}
@@ -3,6 +3,11 @@
 // standard library includes
 #include <string>
 #include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <limits>
 
 // ToolAnalysis includes
 #include "Tool.h"
@@ -17,6 +22,20 @@ class LoadANNIEEvent: public Tool {
     bool Finalise();
 
   private:
+
+    void LoadEntry();
+    void DropKeys(BoostStore* store);
+
+    // read-ahead mode
+    void StartReader(size_t first_entry);
+    void StopReader();
+    void ReaderLoop();
+    void DeleteEntryStores(bool keep_current = false);
+
+    // tag selection
+    bool ApplyTagCuts();
+    size_t NextEntry(size_t file, size_t entry) const;
+    void SkipFilesWithoutSelectedEntries();
   
     int v_error = 0;
     int v_warning = 1;
@@ -49,4 +68,35 @@ class LoadANNIEEvent: public Tool {
     bool need_new_file_;
 
     std::stringstream logmessage;
+
+    /// @brief Keys removed from every entry after reading (unused large objects)
+    std::vector<std::string> drop_keys_;
+
+    /// @brief Number of entries read by a background thread ahead of the current one, 0 = off
+    int read_ahead_ = 0;
+
+    /// @brief Multi-event stores of the current file used in read-ahead mode, each reads its own entry
+    std::vector<BoostStore*> entry_stores_;
+    /// @brief Store whose entry is currently in m_data->Stores["ANNIEEvent"]
+    BoostStore* current_store_ = nullptr;
+    /// @brief Entries read ahead, in entry order
+    std::deque<std::pair<size_t,BoostStore*>> ready_stores_;
+    /// @brief Stores the reader can fill next
+    std::deque<BoostStore*> free_stores_;
+    /// @brief Next entry the reader thread will read
+    size_t next_read_entry_ = 0;
+    /// @brief Entry the reader thread is reading now, or the largest size_t if none
+    size_t entry_in_progress_ = std::numeric_limits<size_t>::max();
+    std::thread reader_thread_;
+    std::mutex reader_mutex_;
+    std::condition_variable reader_cv_;
+    bool stop_reader_ = false;
+    /// @brief File the reader thread reads from
+    size_t reader_file_ = 0;
+
+    /// @brief Selection on the tag files written by SaveANNIEEvent, empty = read all entries
+    std::string tag_cuts_;
+    /// @brief Per input file: whether it has a tag selection, and the entries that pass it
+    std::vector<bool> file_has_selection_;
+    std::vector<std::vector<size_t>> selected_entries_;
 };
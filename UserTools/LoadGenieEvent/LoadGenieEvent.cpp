@@ -6,6 +6,8 @@
 #include "TVector3.h"
 #include "TLorentzVector.h"
 
+#include <fstream>
+
 #include "MRDspecs.hh"
 //using namespace genie;
 //using namespace genie::constants;
@@ -78,6 +80,14 @@ bool LoadGenieEvent::Initialise(std::string configfile, DataModel &data){
 	m_variables.Get("FileDir",filedir);
 	m_variables.Get("FilePattern",filepattern);
 	m_variables.Get("ManualFileMatching",manualmatch);
+	m_variables.Get("GenieCache",use_genie_cache);
+	m_variables.Get("MaxOpenFiles",max_open_files);
+	m_variables.Get("ReadCacheMB",read_cache_mb);
+	m_variables.Get("ReadAheadEntries",read_ahead_entries);
+	m_variables.Get("GenieEntryList",entry_list_file);
+	m_variables.Get("SaveGenieEntryList",save_entry_list_file);
+	if(max_open_files<1) max_open_files=1;
+	if(read_ahead_entries<1) read_ahead_entries=1;
 
 	// create a store for holding Genie information to pass to downstream Tools
 	// will be a single entry BoostStore containing a vector of single entry BoostStores
@@ -96,7 +106,15 @@ bool LoadGenieEvent::Initialise(std::string configfile, DataModel &data){
 		int numbytes = flux->Add(inputfiles.c_str());
 		Log("Tool LoadGenieEvent: Read "+to_string(numbytes)+" bytes loading TChain "+inputfiles,v_debug,verbosity);
 		Log("Tool LoadGenieEvent: Genie TChain has "+to_string(flux->GetEntries())+" entries",v_message,verbosity);
-		SetBranchAddresses();
+		SetBranchAddresses(flux,branches);
+	}
+	
+	// the genie cache is only used when following the entries requested by LoadWCSim
+	use_genie_cache = use_genie_cache && loadwcsimsource && !manualmatch;
+	if(use_genie_cache && entry_list_file!=""){
+		if(!LoadGenieEntryList(entry_list_file)){
+			Log("Tool LoadGenieEvent: Could not read GenieEntryList "+entry_list_file+", reading ahead without it",v_warning,verbosity);
+		}
 	}
 
 	if(manualmatch){
@@ -120,7 +138,7 @@ bool LoadGenieEvent::Initialise(std::string configfile, DataModel &data){
 		std::string inputfile = filedir+"/gntp."+wcsimfile+".ghep.root";
 		curf=TFile::Open(inputfile.c_str());
                 flux=(TChain*)curf->Get("gtree");
-                SetBranchAddresses();
+                SetBranchAddresses(flux,branches);
 		tchainentrynum = wcsimevnumber*500;
 	}
 	
@@ -147,12 +165,33 @@ bool LoadGenieEvent::Execute(){
 		// XXX WCSim currently only records the genie file name, but not absolute path!
 		// we still need to provide the path via config file!
 		if(filedir!="NA") inputfiles = filedir+"/"+inputfiles;
-		m_data->CStore.Get("GenieEntry",tchainentrynum);
+		get_ok = m_data->CStore.Get("GenieEntry",tchainentrynum);
 		if(!get_ok){
 			Log("Tool LoadGenieEvent: Failed to find GenieEntry in CStore",v_error,verbosity);
 			return false;
 		}
 		
+		if(use_genie_cache){
+			if(save_entry_list_file!="" && (requested_entries.empty() || requested_entries.back()!=std::make_pair(inputfiles,(unsigned long)tchainentrynum))){
+				requested_entries.emplace_back(inputfiles,tchainentrynum);   // delayed triggers request the same entry again
+			}
+			GenieFileHandle* handle = OpenGenieFile(inputfiles);
+			if(handle==nullptr) return false;
+			if(tchainentrynum>=(unsigned long)handle->tree->GetEntries()){
+				Log("Tool LoadGenieEvent: Reached end of file, returning",v_message,verbosity);
+				m_data->vars.Set("StopLoop",1);
+				return true;
+			}
+			// records before this entry are not needed any more, entries are requested in increasing order
+			handle->records.erase(handle->records.begin(),handle->records.lower_bound(tchainentrynum));
+			if(handle->records.count(tchainentrynum)==0 && !ReadAhead(inputfiles,handle,tchainentrynum)) return false;
+			currentfilestring = handle->file->GetName();
+			tchainentrynum++;
+			StoreGenieRecord(handle->records.at(tchainentrynum-1));
+			Log("Tool LoadGenieEvent: done",v_debug,verbosity);
+			return true;
+		}
+		
 		std::string curfname = ((curf) ? curf->GetName() : "");
 		// check if this is a new file
 		if(inputfiles!=curfname){
@@ -162,7 +201,7 @@ bool LoadGenieEvent::Execute(){
 			Log("Tool LoadGenieEvent: Loading new file "+inputfiles,v_debug,verbosity);
 			curf=TFile::Open(inputfiles.c_str());
 			flux=(TChain*)curf->Get("gtree");
-			SetBranchAddresses();
+			SetBranchAddresses(flux,branches);
 		}
 	}
 	
@@ -194,153 +233,310 @@ bool LoadGenieEvent::Execute(){
 	}
 	tchainentrynum++;
 	
+	FillGenieRecord(branches,genierecord);
+	StoreGenieRecord(genierecord);
+	
+	Log("Tool LoadGenieEvent: Clearing genieintx",v_debug,verbosity);
+	branches.genieintx->Clear(); // REQUIRED TO PREVENT MEMORY LEAK
+	
+	Log("Tool LoadGenieEvent: done",v_debug,verbosity);
+	return true;
+	
+#else
+	return true;
+#endif // LOADED_GENIE
+
+}
+
+bool LoadGenieEvent::Finalise(){
+	
+#if LOADED_GENIE==1
+	if(flux){
+		flux->ResetBranchAddresses();
+		if (not loadwcsimsource) delete flux;	//only need to delete in case it was created with "new" --> only in not-loadwcsimource case. Otherwise double-free corruption
+		flux=nullptr;
+	}
+	while(genie_files.size()) CloseGenieFile(genie_files.begin()->first);
+	if(save_entry_list_file!="") SaveGenieEntryList(save_entry_list_file);
+#endif
+	return true;
+}
+
+#if LOADED_GENIE==1
+
+void LoadGenieEvent::SetBranchAddresses(TTree* tree, GenieBranches &b){
+	Log("Tool LoadGenieEvent: Setting branch addresses",v_debug,verbosity);
+	// neutrino event information
+	tree->SetBranchAddress("gmcrec",&b.genieintx);
+	tree->GetBranch("gmcrec")->SetAutoDelete(kTRUE);
+	// input (BNB intx) event information
+	if(fluxver==0){   // rhatcher files
+		tree->SetBranchAddress("flux",&b.gnumipassthruentry);
+		tree->GetBranch("flux")->SetAutoDelete(kTRUE);
+	} else {          // zarko files
+		tree->Print();
+		tree->SetBranchAddress("numi",&b.gsimplenumientry);
+		tree->GetBranch("numi")->SetAutoDelete(kTRUE);
+		tree->SetBranchAddress("simple",&b.gsimpleentry);
+		tree->GetBranch("simple")->SetAutoDelete(kTRUE);
+		tree->SetBranchAddress("aux",&b.gsimpleauxinfo);
+		tree->GetBranch("aux")->SetAutoDelete(kTRUE);
+	}
+}
+
+GenieFileHandle* LoadGenieEvent::OpenGenieFile(std::string filename){
+	
+	auto it = genie_files.find(filename);
+	if(it!=genie_files.end()){
+		it->second->lastuse = ++file_use_counter;
+		return it->second;
+	}
+	
+	// keep at most max_open_files open, close the one used longest ago
+	while((int)genie_files.size()>=max_open_files){
+		auto oldest = genie_files.begin();
+		for(auto fit=genie_files.begin(); fit!=genie_files.end(); ++fit){
+			if(fit->second->lastuse < oldest->second->lastuse) oldest = fit;
+		}
+		CloseGenieFile(oldest->first);
+	}
+	
+	Log("Tool LoadGenieEvent: Loading new file "+filename,v_debug,verbosity);
+	TFile* file = TFile::Open(filename.c_str());
+	TTree* tree = (file && !file->IsZombie()) ? (TTree*)file->Get("gtree") : nullptr;
+	if(tree==nullptr){
+		Log("Tool LoadGenieEvent: Could not read gtree from "+filename,v_error,verbosity);
+		if(file) file->Close();
+		delete file;
+		return nullptr;
+	}
+	GenieFileHandle* handle = new GenieFileHandle;
+	handle->file = file;
+	handle->tree = tree;
+	handle->lastuse = ++file_use_counter;
+	SetBranchAddresses(tree,handle->branches);
+	// one read cache per file, learning the branches from the first entries read
+	tree->SetCacheSize((Long64_t)read_cache_mb*1024*1024);
+	tree->AddBranchToCache("*",kTRUE);
+	genie_files.emplace(filename,handle);
+	return handle;
+}
+
+void LoadGenieEvent::CloseGenieFile(std::string filename){
+	
+	auto it = genie_files.find(filename);
+	if(it==genie_files.end()) return;
+	GenieFileHandle* handle = it->second;
+	Log("Tool LoadGenieEvent: Closing genie file "+filename,v_debug,verbosity);
+	handle->tree->ResetBranchAddresses();
+	handle->file->Close();
+	delete handle->file;
+	delete handle;
+	genie_files.erase(it);
+}
+
+bool LoadGenieEvent::ReadAhead(std::string filename, GenieFileHandle* handle, unsigned long entry){
+	
+	// the entries to read, in increasing order: the next entries of the pre-scanned list if this
+	// file and entry are in it, otherwise the next read_ahead_entries entries of the file
+	std::vector<unsigned long> entries;
+	unsigned long nentries = handle->tree->GetEntries();
+	auto listed = genie_entry_list.find(filename);
+	if(listed!=genie_entry_list.end() && listed->second.count(entry)){
+		for(auto eit=listed->second.find(entry); eit!=listed->second.end() && (int)entries.size()<read_ahead_entries; ++eit){
+			if(*eit<nentries) entries.push_back(*eit);
+		}
+	} else {
+		for(unsigned long e=entry; e<nentries && (int)entries.size()<read_ahead_entries; e++) entries.push_back(e);
+	}
+	
+	Log("Tool LoadGenieEvent: Reading ahead "+to_string(entries.size())+" entries from entry "+to_string(entry)+" of "+filename,v_debug,verbosity);
+	handle->tree->SetCacheEntryRange(entries.front(),entries.back()+1);
+	for(unsigned long e : entries){
+		if(handle->records.count(e)) continue;
+		if(handle->tree->GetEntry(e)<=0){
+			Log("Tool LoadGenieEvent: Failed to read entry "+to_string(e)+" of "+filename,v_error,verbosity);
+			return false;
+		}
+		FillGenieRecord(handle->branches,handle->records[e]);
+		handle->branches.genieintx->Clear(); // REQUIRED TO PREVENT MEMORY LEAK
+	}
+	return true;
+}
+
+bool LoadGenieEvent::LoadGenieEntryList(std::string filename){
+	
+	// one "<genie file> <entry>" pair per line, as written by SaveGenieEntryList
+	std::ifstream listfile(filename.c_str());
+	if(!listfile.is_open()) return false;
+	std::string geniefile;
+	unsigned long entry;
+	unsigned long numentries=0;
+	while(listfile >> geniefile >> entry){
+		genie_entry_list[geniefile].insert(entry);
+		numentries++;
+	}
+	Log("Tool LoadGenieEvent: Read "+to_string(numentries)+" genie entries in "+to_string(genie_entry_list.size())+" files from "+filename,v_message,verbosity);
+	return true;
+}
+
+void LoadGenieEvent::SaveGenieEntryList(std::string filename){
+	
+	std::ofstream listfile(filename.c_str());
+	for(auto &requested : requested_entries) listfile << requested.first << " " << requested.second << std::endl;
+	if(!listfile.good()) Log("Tool LoadGenieEvent: Failed to write GenieEntryList "+filename,v_error,verbosity);
+}
+
+void LoadGenieEvent::FillGenieRecord(GenieBranches &b, GenieRecord &rec){
+	
 	// Expand out the neutrino event info
 	// =======================================================
 	
 	// header only contains the event number
-	genie::NtpMCRecHeader hdr = genieintx->hdr;
+	genie::NtpMCRecHeader hdr = b.genieintx->hdr;
 	unsigned int genie_event_num = hdr.ievent;
 	
 	// all neutrino intx details are in the event record
-	genie::EventRecord* gevtRec = genieintx->event;
+	genie::EventRecord* gevtRec = b.genieintx->event;
 	
 	if(fluxver==0){
 		// FLUXVER 0 - genie::flux::GNuMIFluxPassThroughInfo
 		// =================================================
 		// extract the target intx details from the GNuMIFluxPassThroughInfo object
-		parentpdg = gnumipassthruentry->ptype;
-		parentdecaymode = gnumipassthruentry->ndecay;
-		parentdecayvtx_x = gnumipassthruentry->vx;
-		parentdecayvtx_y = gnumipassthruentry->vy;
-		parentdecayvtx_z = gnumipassthruentry->vz;
-		parentdecaymom_x = gnumipassthruentry->pdpx;
-		parentdecaymom_y = gnumipassthruentry->pdpy;
-		parentdecaymom_z = gnumipassthruentry->pdpz;
-		parentprodmom_x = gnumipassthruentry->ppdxdz;
-		parentprodmom_y = gnumipassthruentry->ppdydz;
-		parentprodmom_z = gnumipassthruentry->pppz;
-		parentprodmedium = gnumipassthruentry->ppmedium; //Seems to be 0 all the time? Not registered in the materials table, numbers start at 5...
-		parentpdgattgtexit = gnumipassthruentry->tptype;
-		parenttgtexitmom_x = gnumipassthruentry->tpx;
-		parenttgtexitmom_y = gnumipassthruentry->tpy;
-		parenttgtexitmom_z = gnumipassthruentry->tpz;
-		pcodes = gnumipassthruentry->pcodes;	//pcodes = 0--> GEANT particle codes, 1--> converted PDG particle codes		
+		rec.parentpdg = b.gnumipassthruentry->ptype;
+		rec.parentdecaymode = b.gnumipassthruentry->ndecay;
+		rec.parentdecayvtx_x = b.gnumipassthruentry->vx;
+		rec.parentdecayvtx_y = b.gnumipassthruentry->vy;
+		rec.parentdecayvtx_z = b.gnumipassthruentry->vz;
+		rec.parentdecaymom_x = b.gnumipassthruentry->pdpx;
+		rec.parentdecaymom_y = b.gnumipassthruentry->pdpy;
+		rec.parentdecaymom_z = b.gnumipassthruentry->pdpz;
+		rec.parentprodmom_x = b.gnumipassthruentry->ppdxdz;
+		rec.parentprodmom_y = b.gnumipassthruentry->ppdydz;
+		rec.parentprodmom_z = b.gnumipassthruentry->pppz;
+		rec.parentprodmedium = b.gnumipassthruentry->ppmedium; //Seems to be 0 all the time? Not registered in the materials table, numbers start at 5...
+		rec.parentpdgattgtexit = b.gnumipassthruentry->tptype;
+		rec.parenttgtexitmom_x = b.gnumipassthruentry->tpx;
+		rec.parenttgtexitmom_y = b.gnumipassthruentry->tpy;
+		rec.parenttgtexitmom_z = b.gnumipassthruentry->tpz;
+		rec.pcodes = b.gnumipassthruentry->pcodes;	//pcodes = 0--> GEANT particle codes, 1--> converted PDG particle codes		
 
 		// convenience type conversions
-		parentdecayvtx = Position(parentdecayvtx_x,parentdecayvtx_y,parentdecayvtx_z);
-		parentdecaymom = Position(parentdecaymom_x,parentdecaymom_y,parentdecaymom_z);
-		parentprodmom = Position(parentprodmom_x,parentprodmom_y,parentprodmom_z);
-		parenttgtexitmom = Position(parenttgtexitmom_x,parenttgtexitmom_y,parenttgtexitmom_z);
-		//parenttypestring = (fluxstage==0) ? GnumiToString(parentpdg) : PdgToString(parentpdg);
-		//parenttypestringattgtexit = (fluxstage==0) ? 
-		parenttypestring = (pcodes==0) ? GnumiToString(parentpdg) : PdgToString(parentpdg);
-		parenttypestringattgtexit = (pcodes==0) ? 
-			GnumiToString(parentpdgattgtexit) : PdgToString(parentpdgattgtexit);
-		parentdecaystring = DecayTypeToString(parentdecaymode);
-		parentprodmediumstring = MediumToString(parentprodmedium);
+		rec.parentdecayvtx = Position(rec.parentdecayvtx_x,rec.parentdecayvtx_y,rec.parentdecayvtx_z);
+		rec.parentdecaymom = Position(rec.parentdecaymom_x,rec.parentdecaymom_y,rec.parentdecaymom_z);
+		rec.parentprodmom = Position(rec.parentprodmom_x,rec.parentprodmom_y,rec.parentprodmom_z);
+		rec.parenttgtexitmom = Position(rec.parenttgtexitmom_x,rec.parenttgtexitmom_y,rec.parenttgtexitmom_z);
+		//rec.parenttypestring = (fluxstage==0) ? GnumiToString(rec.parentpdg) : PdgToString(rec.parentpdg);
+		//rec.parenttypestringattgtexit = (fluxstage==0) ? 
+		rec.parenttypestring = (rec.pcodes==0) ? GnumiToString(rec.parentpdg) : PdgToString(rec.parentpdg);
+		rec.parenttypestringattgtexit = (rec.pcodes==0) ? 
+			GnumiToString(rec.parentpdgattgtexit) : PdgToString(rec.parentpdgattgtexit);
+		rec.parentdecaystring = DecayTypeToString(rec.parentdecaymode);
+		rec.parentprodmediumstring = MediumToString(rec.parentprodmedium);
 		
 	} else {
 		// FLUXVER 1 - genie::flux::GSimpleNtpEntry
 		// ========================================
 		// extract the target intx details from the GSimpleNtpNuMI object
 		Log("Tool LoadGenieEvent: Retrieving interaction info from GSimpleNtpNuMI object",v_debug,verbosity);
-		parentpdg = gsimplenumientry->ptype;
-		parentdecaymode = gsimplenumientry->ndecay;
-		parentdecayvtx_x = gsimplenumientry->vx;
-		parentdecayvtx_y = gsimplenumientry->vy;
-		parentdecayvtx_z = gsimplenumientry->vz;
-		parentdecaymom_x = gsimplenumientry->pdpx;
-		parentdecaymom_y = gsimplenumientry->pdpy;
-		parentdecaymom_z = gsimplenumientry->pdpz;
-		parentprodmom_x = gsimplenumientry->pppx/gsimplenumientry->pppz; // ??? is this ppdxdz?
-		parentprodmom_y = gsimplenumientry->pppy/gsimplenumientry->pppz;
-		parentprodmom_z = gsimplenumientry->pppz;
-		parentprodmedium = gsimplenumientry->ppmedium;
-		parentpdgattgtexit = gsimplenumientry->tptype;
-		parenttgtexitmom_x = gsimplenumientry->tpx;
-		parenttgtexitmom_y = gsimplenumientry->tpy;
-		parenttgtexitmom_z = gsimplenumientry->tpz;
+		rec.parentpdg = b.gsimplenumientry->ptype;
+		rec.parentdecaymode = b.gsimplenumientry->ndecay;
+		rec.parentdecayvtx_x = b.gsimplenumientry->vx;
+		rec.parentdecayvtx_y = b.gsimplenumientry->vy;
+		rec.parentdecayvtx_z = b.gsimplenumientry->vz;
+		rec.parentdecaymom_x = b.gsimplenumientry->pdpx;
+		rec.parentdecaymom_y = b.gsimplenumientry->pdpy;
+		rec.parentdecaymom_z = b.gsimplenumientry->pdpz;
+		rec.parentprodmom_x = b.gsimplenumientry->pppx/b.gsimplenumientry->pppz; // ??? is this ppdxdz?
+		rec.parentprodmom_y = b.gsimplenumientry->pppy/b.gsimplenumientry->pppz;
+		rec.parentprodmom_z = b.gsimplenumientry->pppz;
+		rec.parentprodmedium = b.gsimplenumientry->ppmedium;
+		rec.parentpdgattgtexit = b.gsimplenumientry->tptype;
+		rec.parenttgtexitmom_x = b.gsimplenumientry->tpx;
+		rec.parenttgtexitmom_y = b.gsimplenumientry->tpy;
+		rec.parenttgtexitmom_z = b.gsimplenumientry->tpz;
 		
 		// convenience type conversions
-		parentdecayvtx = Position(parentdecayvtx_x,parentdecayvtx_y,parentdecayvtx_z);
-		parentdecaymom = Position(parentdecaymom_x,parentdecaymom_y,parentdecaymom_z);
-		parentprodmom = Position(parentprodmom_x,parentprodmom_y,parentprodmom_z);
-		parenttgtexitmom = Position(parenttgtexitmom_x,parenttgtexitmom_y,parenttgtexitmom_z);
-		parenttypestring = PdgToString(parentpdg);
-		parenttypestringattgtexit = PdgToString(parentpdgattgtexit);
-		parentdecaystring = DecayTypeToString(parentdecaymode);
-		parentprodmediumstring = MediumToString(parentprodmedium);
+		rec.parentdecayvtx = Position(rec.parentdecayvtx_x,rec.parentdecayvtx_y,rec.parentdecayvtx_z);
+		rec.parentdecaymom = Position(rec.parentdecaymom_x,rec.parentdecaymom_y,rec.parentdecaymom_z);
+		rec.parentprodmom = Position(rec.parentprodmom_x,rec.parentprodmom_y,rec.parentprodmom_z);
+		rec.parenttgtexitmom = Position(rec.parenttgtexitmom_x,rec.parenttgtexitmom_y,rec.parenttgtexitmom_z);
+		rec.parenttypestring = PdgToString(rec.parentpdg);
+		rec.parenttypestringattgtexit = PdgToString(rec.parentpdgattgtexit);
+		rec.parentdecaystring = DecayTypeToString(rec.parentdecaymode);
+		rec.parentprodmediumstring = MediumToString(rec.parentprodmedium);
 		
 	}
 	
 	// neutrino interaction info
 	genie::Interaction* genieint = gevtRec->Summary();
 	//cout<<"scraping interaction info"<<endl;
-	GenieInfo thegenieinfo;
+	rec.genieinfo = GenieInfo();
+	GenieInfo &thegenieinfo = rec.genieinfo;
 	Log("Tool LoadGenieEvent: Filling GenieInfo struct",v_debug,verbosity);
 	GetGenieEntryInfo(gevtRec, genieint, thegenieinfo, (verbosity>v_debug));
 	
 	// retrieve info from the struct
-	IsQuasiElastic=thegenieinfo.eventtypes.at("IsQuasiElastic");
-	IsResonant=thegenieinfo.eventtypes.at("IsResonant");
-	IsDeepInelastic=thegenieinfo.eventtypes.at("IsDeepInelastic");
-	IsCoherent=thegenieinfo.eventtypes.at("IsCoherent");
-	IsDiffractive=thegenieinfo.eventtypes.at("IsDiffractive");
-	IsInverseMuDecay=thegenieinfo.eventtypes.at("IsInverseMuDecay");
-	IsIMDAnnihilation=thegenieinfo.eventtypes.at("IsIMDAnnihilation");
-	IsSingleKaon=thegenieinfo.eventtypes.at("IsSingleKaon");
-	IsNuElectronElastic=thegenieinfo.eventtypes.at("IsNuElectronElastic");
-	IsEM=thegenieinfo.eventtypes.at("IsEM");
-	IsWeakCC=thegenieinfo.eventtypes.at("IsWeakCC");
-	IsWeakNC=thegenieinfo.eventtypes.at("IsWeakNC");
-	IsMEC=thegenieinfo.eventtypes.at("IsMEC");
-	interactiontypestring=thegenieinfo.interactiontypestring;
-	neutcode=thegenieinfo.neutinteractioncode; // currently disabled to prevent excessive verbosity
-	
-	eventq2=thegenieinfo.Q2;
-	eventEnu=thegenieinfo.probeenergy;
-	neutrinopdg=thegenieinfo.probepdg;
-	muonenergy=thegenieinfo.fsleptonenergy;
-	muonangle=thegenieinfo.fslangle;
-	
-	nuIntxVtx_X=thegenieinfo.Intx_x; // cm
-	nuIntxVtx_Y=thegenieinfo.Intx_y; // cm
-	nuIntxVtx_Z=thegenieinfo.Intx_z; // cm
-	nuIntxVtx_T=thegenieinfo.Intx_t; // ns
+	rec.IsQuasiElastic=thegenieinfo.eventtypes.at("IsQuasiElastic");
+	rec.IsResonant=thegenieinfo.eventtypes.at("IsResonant");
+	rec.IsDeepInelastic=thegenieinfo.eventtypes.at("IsDeepInelastic");
+	rec.IsCoherent=thegenieinfo.eventtypes.at("IsCoherent");
+	rec.IsDiffractive=thegenieinfo.eventtypes.at("IsDiffractive");
+	rec.IsInverseMuDecay=thegenieinfo.eventtypes.at("IsInverseMuDecay");
+	rec.IsIMDAnnihilation=thegenieinfo.eventtypes.at("IsIMDAnnihilation");
+	rec.IsSingleKaon=thegenieinfo.eventtypes.at("IsSingleKaon");
+	rec.IsNuElectronElastic=thegenieinfo.eventtypes.at("IsNuElectronElastic");
+	rec.IsEM=thegenieinfo.eventtypes.at("IsEM");
+	rec.IsWeakCC=thegenieinfo.eventtypes.at("IsWeakCC");
+	rec.IsWeakNC=thegenieinfo.eventtypes.at("IsWeakNC");
+	rec.IsMEC=thegenieinfo.eventtypes.at("IsMEC");
+	rec.interactiontypestring=thegenieinfo.interactiontypestring;
+	rec.neutcode=thegenieinfo.neutinteractioncode; // currently disabled to prevent excessive verbosity
+	
+	rec.eventq2=thegenieinfo.Q2;
+	rec.eventEnu=thegenieinfo.probeenergy;
+	rec.neutrinopdg=thegenieinfo.probepdg;
+	rec.muonenergy=thegenieinfo.fsleptonenergy;
+	rec.muonangle=thegenieinfo.fslangle;
+	
+	rec.nuIntxVtx_X=thegenieinfo.Intx_x; // cm
+	rec.nuIntxVtx_Y=thegenieinfo.Intx_y; // cm
+	rec.nuIntxVtx_Z=thegenieinfo.Intx_z; // cm
+	rec.nuIntxVtx_T=thegenieinfo.Intx_t; // ns
 	// check in tank
-	if( ( sqrt( pow(nuIntxVtx_X, 2) + pow(nuIntxVtx_Z-MRDSpecs::tank_start-MRDSpecs::tank_radius,2) )
+	if( ( sqrt( pow(rec.nuIntxVtx_X, 2) + pow(rec.nuIntxVtx_Z-MRDSpecs::tank_start-MRDSpecs::tank_radius,2) )
 		  < MRDSpecs::tank_radius ) && 
-		  ( abs(nuIntxVtx_Y-MRDSpecs::tank_yoffset) < MRDSpecs::tank_halfheight) ){
-		isintank=true;
-	} else { isintank=false; }
+		  ( abs(rec.nuIntxVtx_Y-MRDSpecs::tank_yoffset) < MRDSpecs::tank_halfheight) ){
+		rec.isintank=true;
+	} else { rec.isintank=false; }
 	// check in fiducial volume
-	if( isintank &&
-	  ( sqrt (pow(nuIntxVtx_X, 2) + pow(nuIntxVtx_Z-MRDSpecs::tank_start-MRDSpecs::tank_radius,2)) 
+	if( rec.isintank &&
+	  ( sqrt (pow(rec.nuIntxVtx_X, 2) + pow(rec.nuIntxVtx_Z-MRDSpecs::tank_start-MRDSpecs::tank_radius,2)) 
 	  < MRDSpecs::fidcutradius ) && 
-	  ( abs(nuIntxVtx_Y-MRDSpecs::tank_yoffset) < MRDSpecs::fidcuty ) && 
-	  ( (nuIntxVtx_Z-MRDSpecs::tank_start-MRDSpecs::tank_radius) < MRDSpecs::fidcutz) ){
-		isinfiducialvol=true;
-	} else { isinfiducialvol = false; }
+	  ( abs(rec.nuIntxVtx_Y-MRDSpecs::tank_yoffset) < MRDSpecs::fidcuty ) && 
+	  ( (rec.nuIntxVtx_Z-MRDSpecs::tank_start-MRDSpecs::tank_radius) < MRDSpecs::fidcutz) ){
+		rec.isinfiducialvol=true;
+	} else { rec.isinfiducialvol = false; }
 	
-	fsleptonname = std::string(thegenieinfo.fsleptonname);
+	rec.fsleptonname = std::string(thegenieinfo.fsleptonname);
 	// this data does not appear to be populated...
 	// Edit: Maybe due to the numbers for the exclusive tag being evaluated before Final State Interactions
 	// Compare e.g. documentation here: https://internal.dunescience.org/doxygen/classgenie_1_1XclsTag.html
 	/*
-	numfsprotons = thegenieinfo.numfsprotons = genieint->ExclTag().NProtons();
-	numfsneutrons = thegenieinfo.numfsneutrons = genieint->ExclTag().NNeutrons();
-	numfspi0 = thegenieinfo.numfspi0 = genieint->ExclTag().NPi0();
-	numfspiplus = thegenieinfo.numfspiplus = genieint->ExclTag().NPiPlus();
-	numfspiminus = thegenieinfo.numfspiminus = genieint->ExclTag().NPiMinus();
+	rec.numfsprotons = thegenieinfo.numfsprotons = genieint->ExclTag().NProtons();
+	rec.numfsneutrons = thegenieinfo.numfsneutrons = genieint->ExclTag().NNeutrons();
+	rec.numfspi0 = thegenieinfo.numfspi0 = genieint->ExclTag().NPi0();
+	rec.numfspiplus = thegenieinfo.numfspiplus = genieint->ExclTag().NPiPlus();
+	rec.numfspiminus = thegenieinfo.numfspiminus = genieint->ExclTag().NPiMinus();
 	*/
 	//The following is more cumbersome, but seems to work (we count the number of final state particles by hand)
-	numfsprotons = 0;
-	numfsneutrons = 0;
-	numfspi0 = 0;
-	numfspiplus= 0;
-	numfspiminus = 0;
-	numfskplus = 0;
-	numfskminus = 0;	
+	rec.numfsprotons = 0;
+	rec.numfsneutrons = 0;
+	rec.numfspi0 = 0;
+	rec.numfspiplus= 0;
+	rec.numfspiminus = 0;
+	rec.numfskplus = 0;
+	rec.numfskminus = 0;	
 
 	TObjArrayIter iter(gevtRec);
 	genie::GHepParticle * p = 0;
@@ -353,130 +549,89 @@ bool LoadGenieEvent::Execute(){
 		
 		if (status != genie::kIStStableFinalState) continue;
 		
-		if (pdgc == genie::kPdgNeutron) numfsneutrons++;
-		else if (pdgc == genie::kPdgProton) numfsprotons++;
-		else if (pdgc == genie::kPdgPiP) numfspiplus++;
-		else if (pdgc == genie::kPdgPiM) numfspiminus++;
-		else if (pdgc == genie::kPdgPi0) numfspi0++;
-		else if (pdgc == genie::kPdgKP) numfskplus++;
-		else if (pdgc == genie::kPdgKM) numfskminus++;
+		if (pdgc == genie::kPdgNeutron) rec.numfsneutrons++;
+		else if (pdgc == genie::kPdgProton) rec.numfsprotons++;
+		else if (pdgc == genie::kPdgPiP) rec.numfspiplus++;
+		else if (pdgc == genie::kPdgPiM) rec.numfspiminus++;
+		else if (pdgc == genie::kPdgPi0) rec.numfspi0++;
+		else if (pdgc == genie::kPdgKP) rec.numfskplus++;
+		else if (pdgc == genie::kPdgKM) rec.numfskminus++;
 	}
 	
+}
 
+void LoadGenieEvent::StoreGenieRecord(const GenieRecord &rec){
+	
 	Log("Tool LoadGenieEvent: Passing information to the GenieEvent store",v_debug,verbosity);
 	// Update the Store with all the current event information
 	// =======================================================
 	geniestore->Set("file",currentfilestring);
 	geniestore->Set("fluxver",fluxver);
 	geniestore->Set("evtnum",tchainentrynum);
-	geniestore->Set("ParentPdg",parentpdg);
-	geniestore->Set("ParentTypeString",parenttypestring);
-	geniestore->Set("ParentDecayMode",parentdecaymode);
-	geniestore->Set("ParentDecayString",parentdecaystring);
-	geniestore->Set("ParentDecayVtx",parentdecayvtx);
-	geniestore->Set("ParentDecayVtx_X",parentdecayvtx_x);
-	geniestore->Set("ParentDecayVtx_Y",parentdecayvtx_y);
-	geniestore->Set("ParentDecayVtx_Z",parentdecayvtx_z);
-	geniestore->Set("ParentDecayMom",parentdecaymom);
-	geniestore->Set("ParentDecayMom_X",parentdecaymom_x);
-	geniestore->Set("ParentDecayMom_Y",parentdecaymom_y);
-	geniestore->Set("ParentDecayMom_Z",parentdecaymom_z);
-	geniestore->Set("ParentProdMom",parentprodmom);
-	geniestore->Set("ParentProdMom_X",parentprodmom_x);
-	geniestore->Set("ParentProdMom_Y",parentprodmom_y);
-	geniestore->Set("ParentProdMom_Z",parentprodmom_z);
-	geniestore->Set("ParentProdMedium",parentprodmedium);
-	geniestore->Set("ParentProdMediumString",parentprodmediumstring);
-	geniestore->Set("ParentPdgAtTgtExit",parentpdgattgtexit);
-	geniestore->Set("ParentTypeAtTgtExitString",parenttypestringattgtexit);
-	geniestore->Set("ParentTgtExitMom",parenttgtexitmom);
-	geniestore->Set("ParentTgtExitMom_X",parenttgtexitmom_x);
-	geniestore->Set("ParentTgtExitMom_Y",parenttgtexitmom_y);
-	geniestore->Set("ParentTgtExitMom_Z",parenttgtexitmom_z);
-	
-	geniestore->Set("IsQuasiElastic",IsQuasiElastic);
-	geniestore->Set("IsResonant",IsResonant);
-	geniestore->Set("IsDeepInelastic",IsDeepInelastic);
-	geniestore->Set("IsCoherent",IsCoherent);
-	geniestore->Set("IsDiffractive",IsDiffractive);
-	geniestore->Set("IsInverseMuDecay",IsInverseMuDecay);
-	geniestore->Set("IsIMDAnnihilation",IsIMDAnnihilation);
-	geniestore->Set("IsSingleKaon",IsSingleKaon);
-	geniestore->Set("IsNuElectronElastic",IsNuElectronElastic);
-	geniestore->Set("IsEM",IsEM);
-	geniestore->Set("IsWeakCC",IsWeakCC);
-	geniestore->Set("IsWeakNC",IsWeakNC);
-	geniestore->Set("IsMEC",IsMEC);
-	geniestore->Set("InteractionTypeString",interactiontypestring);
-	geniestore->Set("NeutCode",neutcode);
-	geniestore->Set("NuIntxVtx_X",nuIntxVtx_X);
-	geniestore->Set("NuIntxVtx_Y",nuIntxVtx_Y);
-	geniestore->Set("NuIntxVtx_Z",nuIntxVtx_Z);
-	geniestore->Set("NuIntxVtx_T",nuIntxVtx_T);
-	geniestore->Set("NuVtxInTank",isintank);
-	geniestore->Set("NuVtxInFidVol",isinfiducialvol);
-	geniestore->Set("EventQ2",eventq2);
-	geniestore->Set("NeutrinoEnergy",eventEnu);
-	geniestore->Set("NeutrinoPDG",neutrinopdg);
-	geniestore->Set("MuonEnergy",muonenergy);
-	geniestore->Set("MuonAngle",muonangle);
-	geniestore->Set("FSLeptonName",fsleptonname);
-	geniestore->Set("NumFSProtons",numfsprotons);
-	geniestore->Set("NumFSNeutrons",numfsneutrons);
-	geniestore->Set("NumFSPi0",numfspi0);
-	geniestore->Set("NumFSPiPlus",numfspiplus);
-	geniestore->Set("NumFSPiMinus",numfspiminus);
-	geniestore->Set("NumFSKPlus",numfskplus);
-	geniestore->Set("NumFSKMinus",numfskminus);
-	geniestore->Set("GenieInfo",thegenieinfo);
+	geniestore->Set("ParentPdg",rec.parentpdg);
+	geniestore->Set("ParentTypeString",rec.parenttypestring);
+	geniestore->Set("ParentDecayMode",rec.parentdecaymode);
+	geniestore->Set("ParentDecayString",rec.parentdecaystring);
+	geniestore->Set("ParentDecayVtx",rec.parentdecayvtx);
+	geniestore->Set("ParentDecayVtx_X",rec.parentdecayvtx_x);
+	geniestore->Set("ParentDecayVtx_Y",rec.parentdecayvtx_y);
+	geniestore->Set("ParentDecayVtx_Z",rec.parentdecayvtx_z);
+	geniestore->Set("ParentDecayMom",rec.parentdecaymom);
+	geniestore->Set("ParentDecayMom_X",rec.parentdecaymom_x);
+	geniestore->Set("ParentDecayMom_Y",rec.parentdecaymom_y);
+	geniestore->Set("ParentDecayMom_Z",rec.parentdecaymom_z);
+	geniestore->Set("ParentProdMom",rec.parentprodmom);
+	geniestore->Set("ParentProdMom_X",rec.parentprodmom_x);
+	geniestore->Set("ParentProdMom_Y",rec.parentprodmom_y);
+	geniestore->Set("ParentProdMom_Z",rec.parentprodmom_z);
+	geniestore->Set("ParentProdMedium",rec.parentprodmedium);
+	geniestore->Set("ParentProdMediumString",rec.parentprodmediumstring);
+	geniestore->Set("ParentPdgAtTgtExit",rec.parentpdgattgtexit);
+	geniestore->Set("ParentTypeAtTgtExitString",rec.parenttypestringattgtexit);
+	geniestore->Set("ParentTgtExitMom",rec.parenttgtexitmom);
+	geniestore->Set("ParentTgtExitMom_X",rec.parenttgtexitmom_x);
+	geniestore->Set("ParentTgtExitMom_Y",rec.parenttgtexitmom_y);
+	geniestore->Set("ParentTgtExitMom_Z",rec.parenttgtexitmom_z);
+	
+	geniestore->Set("IsQuasiElastic",rec.IsQuasiElastic);
+	geniestore->Set("IsResonant",rec.IsResonant);
+	geniestore->Set("IsDeepInelastic",rec.IsDeepInelastic);
+	geniestore->Set("IsCoherent",rec.IsCoherent);
+	geniestore->Set("IsDiffractive",rec.IsDiffractive);
+	geniestore->Set("IsInverseMuDecay",rec.IsInverseMuDecay);
+	geniestore->Set("IsIMDAnnihilation",rec.IsIMDAnnihilation);
+	geniestore->Set("IsSingleKaon",rec.IsSingleKaon);
+	geniestore->Set("IsNuElectronElastic",rec.IsNuElectronElastic);
+	geniestore->Set("IsEM",rec.IsEM);
+	geniestore->Set("IsWeakCC",rec.IsWeakCC);
+	geniestore->Set("IsWeakNC",rec.IsWeakNC);
+	geniestore->Set("IsMEC",rec.IsMEC);
+	geniestore->Set("InteractionTypeString",rec.interactiontypestring);
+	geniestore->Set("NeutCode",rec.neutcode);
+	geniestore->Set("NuIntxVtx_X",rec.nuIntxVtx_X);
+	geniestore->Set("NuIntxVtx_Y",rec.nuIntxVtx_Y);
+	geniestore->Set("NuIntxVtx_Z",rec.nuIntxVtx_Z);
+	geniestore->Set("NuIntxVtx_T",rec.nuIntxVtx_T);
+	geniestore->Set("NuVtxInTank",rec.isintank);
+	geniestore->Set("NuVtxInFidVol",rec.isinfiducialvol);
+	geniestore->Set("EventQ2",rec.eventq2);
+	geniestore->Set("NeutrinoEnergy",rec.eventEnu);
+	geniestore->Set("NeutrinoPDG",rec.neutrinopdg);
+	geniestore->Set("MuonEnergy",rec.muonenergy);
+	geniestore->Set("MuonAngle",rec.muonangle);
+	geniestore->Set("FSLeptonName",rec.fsleptonname);
+	geniestore->Set("NumFSProtons",rec.numfsprotons);
+	geniestore->Set("NumFSNeutrons",rec.numfsneutrons);
+	geniestore->Set("NumFSPi0",rec.numfspi0);
+	geniestore->Set("NumFSPiPlus",rec.numfspiplus);
+	geniestore->Set("NumFSPiMinus",rec.numfspiminus);
+	geniestore->Set("NumFSKPlus",rec.numfskplus);
+	geniestore->Set("NumFSKMinus",rec.numfskminus);
+	geniestore->Set("GenieInfo",rec.genieinfo);
 	//geniestore->Set("TheGenieInfoPtr",&thegenieinfo,false);
 	//intptr_t thegenieinfoptr = reinterpret_cast<intptr_t>(&thegenieinfo);
 	//m_data->CStore.Set("TheGenieInfoPtr2",thegenieinfoptr);
 	
-	Log("Tool LoadGenieEvent: Clearing genieintx",v_debug,verbosity);
-	genieintx->Clear(); // REQUIRED TO PREVENT MEMORY LEAK
-	
-	Log("Tool LoadGenieEvent: done",v_debug,verbosity);
-	return true;
-	
-#else
-	return true;
-#endif // LOADED_GENIE
-
-}
-
-bool LoadGenieEvent::Finalise(){
-	
-#if LOADED_GENIE==1
-	if(flux){
-		flux->ResetBranchAddresses();
-		if (not loadwcsimsource) delete flux;	//only need to delete in case it was created with "new" --> only in not-loadwcsimource case. Otherwise double-free corruption
-		flux=nullptr;
-	}
-#endif
-	return true;
-}
-
-#if LOADED_GENIE==1
-
-void LoadGenieEvent::SetBranchAddresses(){
-	Log("Tool LoadGenieEvent: Setting branch addresses",v_debug,verbosity);
-	// neutrino event information
-	flux->SetBranchAddress("gmcrec",&genieintx);
-	flux->GetBranch("gmcrec")->SetAutoDelete(kTRUE);
-	// input (BNB intx) event information
-	if(fluxver==0){   // rhatcher files
-		flux->SetBranchAddress("flux",&gnumipassthruentry);
-		flux->GetBranch("flux")->SetAutoDelete(kTRUE);
-	} else {          // zarko files
-		flux->Print();
-		flux->SetBranchAddress("numi",&gsimplenumientry);
-		flux->GetBranch("numi")->SetAutoDelete(kTRUE);
-		flux->SetBranchAddress("simple",&gsimpleentry);
-		flux->GetBranch("simple")->SetAutoDelete(kTRUE);
-		flux->SetBranchAddress("aux",&gsimpleauxinfo);
-		flux->GetBranch("aux")->SetAutoDelete(kTRUE);
-	}
 }
 
 void LoadGenieEvent::GetGenieEntryInfo(genie::EventRecord* gevtRec, genie::Interaction* genieint, GenieInfo &thegenieinfo, bool printneutrinoevent){
@@ -3,6 +3,9 @@
 
 #include <string>
 #include <iostream>
+#include <map>
+#include <set>
+#include <vector>
 
 #include "Tool.h"
 #include "GenieInfo.h"
@@ -25,71 +28,23 @@
 #include <TParticlePDG.h>
 #include <Interaction/Interaction.h>
 // other
-#endif  // LOADED_GENIE==1
+#include <TFile.h>
+#include <TTree.h>
+#include <TChain.h>
 
-class LoadGenieEvent: public Tool {
-	
-	public:
-	
-	LoadGenieEvent();
-	bool Initialise(std::string configfile,DataModel &data);
-	bool Execute();
-	bool Finalise();
-	
-	// verbosity levels: if 'verbosity' < this level, the message type will be logged.
-	int verbosity;
-	int v_error=0;
-	int v_warning=1;
-	int v_message=2;
-	int v_debug=3;
-	std::string logmessage;
-	int get_ok;
-	
-	private:
-	
-#if LOADED_GENIE==1
-	// function to load the branch addresses
-	void SetBranchAddresses();
-
-	// function to fill the info into the handy genieinfostruct
-	void GetGenieEntryInfo(genie::EventRecord* gevtRec, genie::Interaction* genieint,
-	  GenieInfo& thegenieinfo, bool printneutrinoevent=false);
-	// type conversion functions:
-	std::map<int,std::string> pdgcodetoname;
-	std::map<int,std::string> decaymap;
-	std::map<int,std::string> gnumicodetoname;
-	std::map<int,std::string> mediummap;
-	std::map<int,std::string>* GenerateGnumiMap();
-	std::map<int,std::string>* GeneratePdgMap();
-	std::map<int,std::string>* GenerateDecayMap();
-	std::map<int,std::string>* GenerateMediumMap();
-	std::string GnumiToString(int code);
-	std::string PdgToString(int code);
-	std::string DecayTypeToString(int code);
-	std::string MediumToString(int code);
-	
-	BoostStore* geniestore = nullptr;
-	int fluxstage;
-	std::string filedir, filepattern;
-	bool loadwcsimsource;
-	TChain* flux = nullptr;
-	TFile* curf = nullptr;       // keep track of file changes
-	TFile* curflast = nullptr;
-	genie::NtpMCEventRecord* genieintx = nullptr; // = new genie::NtpMCEventRecord;
-//	// for fluxver 0 files
+// branch objects of a gtree
+struct GenieBranches {
+	genie::NtpMCEventRecord* genieintx = nullptr;
+	// for fluxver 0 files
 	genie::flux::GNuMIFluxPassThroughInfo* gnumipassthruentry  = nullptr;
 	// for fluxver 1 files
 	genie::flux::GSimpleNtpEntry* gsimpleentry = nullptr;
 	genie::flux::GSimpleNtpAux* gsimpleauxinfo = nullptr;
 	genie::flux::GSimpleNtpNuMI* gsimplenumientry = nullptr;
-	
-	// genie file variables
-	int fluxver;                         // 0 = old flux, 1 = new flux
-	std::string currentfilestring;
-	unsigned long local_entry=0;           // 
-	unsigned int tchainentrynum=0;         // 
-	bool manualmatch=1;			//to be used when GENIE information is not stored properly in file	
+};
 
+// everything passed to the GenieInfo store for one genie entry
+struct GenieRecord {
 	// common input/output variables to both Robert/Zarko filesets
 	int parentpdg;
 	std::string parenttypestring;
@@ -151,6 +106,103 @@ class LoadGenieEvent: public Tool {
 	int numfskplus;
 	int numfskminus;	
 
+	GenieInfo genieinfo;
+};
+
+// an open genie file of the GenieCache pool, with the records read ahead but not used yet
+struct GenieFileHandle {
+	TFile* file = nullptr;
+	TTree* tree = nullptr;
+	GenieBranches branches;
+	unsigned long lastuse = 0;
+	std::map<unsigned long,GenieRecord> records;
+};
+#endif  // LOADED_GENIE==1
+
+class LoadGenieEvent: public Tool {
+	
+	public:
+	
+	LoadGenieEvent();
+	bool Initialise(std::string configfile,DataModel &data);
+	bool Execute();
+	bool Finalise();
+	
+	// verbosity levels: if 'verbosity' < this level, the message type will be logged.
+	int verbosity;
+	int v_error=0;
+	int v_warning=1;
+	int v_message=2;
+	int v_debug=3;
+	std::string logmessage;
+	int get_ok;
+	
+	private:
+	
+#if LOADED_GENIE==1
+	// function to load the branch addresses
+	void SetBranchAddresses(TTree* tree, GenieBranches &b);
+
+	// extract the current entry of the branch objects, and pass a record to the GenieInfo store
+	void FillGenieRecord(GenieBranches &b, GenieRecord &rec);
+	void StoreGenieRecord(const GenieRecord &rec);
+
+	// GenieCache: pool of open genie files with read caches, records are read ahead in sorted entry order
+	GenieFileHandle* OpenGenieFile(std::string filename);
+	void CloseGenieFile(std::string filename);
+	bool ReadAhead(std::string filename, GenieFileHandle* handle, unsigned long entry);
+	bool LoadGenieEntryList(std::string filename);
+	void SaveGenieEntryList(std::string filename);
+
+	// function to fill the info into the handy genieinfostruct
+	void GetGenieEntryInfo(genie::EventRecord* gevtRec, genie::Interaction* genieint,
+	  GenieInfo& thegenieinfo, bool printneutrinoevent=false);
+	// type conversion functions:
+	std::map<int,std::string> pdgcodetoname;
+	std::map<int,std::string> decaymap;
+	std::map<int,std::string> gnumicodetoname;
+	std::map<int,std::string> mediummap;
+	std::map<int,std::string>* GenerateGnumiMap();
+	std::map<int,std::string>* GeneratePdgMap();
+	std::map<int,std::string>* GenerateDecayMap();
+	std::map<int,std::string>* GenerateMediumMap();
+	std::string GnumiToString(int code);
+	std::string PdgToString(int code);
+	std::string DecayTypeToString(int code);
+	std::string MediumToString(int code);
+	
+	BoostStore* geniestore = nullptr;
+	int fluxstage;
+	std::string filedir, filepattern;
+	bool loadwcsimsource;
+	TChain* flux = nullptr;
+	TFile* curf = nullptr;       // keep track of file changes
+	TFile* curflast = nullptr;
+	GenieBranches branches;
+	
+	// genie file variables
+	int fluxver;                         // 0 = old flux, 1 = new flux
+	std::string currentfilestring;
+	unsigned long local_entry=0;           // 
+	unsigned int tchainentrynum=0;         // 
+	bool manualmatch=1;			//to be used when GENIE information is not stored properly in file	
+
+	// current genie entry
+	GenieRecord genierecord;
+
+	// GenieCache settings and state
+	bool use_genie_cache = false;
+	int max_open_files = 4;
+	int read_cache_mb = 30;
+	int read_ahead_entries = 100;
+	std::string entry_list_file = "";
+	std::string save_entry_list_file = "";
+	unsigned long file_use_counter = 0;
+	std::map<std::string,GenieFileHandle*> genie_files;
+	std::map<std::string,std::set<unsigned long>> genie_entry_list;   // pre-scanned entries needed per file
+	std::vector<std::pair<std::string,unsigned long>> requested_entries;
+
+
 #endif   // LOADED_GENIE==1
 	
 };
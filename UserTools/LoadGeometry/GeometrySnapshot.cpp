@@ -0,0 +1,200 @@
+#include "GeometrySnapshot.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+  const char SnapshotMagic[8] = {'A','N','N','I','E','G','E','O'};
+  const uint32_t SnapshotHeaderSize = 40;
+
+  // appends the fields of a record to a byte buffer
+  class SnapshotWriter {
+   public:
+    explicit SnapshotWriter(std::string &buffer) : buf(buffer) {}
+    template<typename T> SnapshotWriter& operator&(T &value){
+      buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+      return *this;
+    }
+    SnapshotWriter& operator&(std::string &value){
+      uint32_t length = value.size();
+      buf.append(reinterpret_cast<const char*>(&length), sizeof(length));
+      buf.append(value);
+      return *this;
+    }
+   private:
+    std::string &buf;
+  };
+
+  // reads the fields of a record from a mapped buffer, stops at the end of the buffer
+  class SnapshotReader {
+   public:
+    SnapshotReader(const char *data, std::size_t size) : pos(data), end(data+size), ok(true) {}
+    template<typename T> SnapshotReader& operator&(T &value){
+      if(!Take(sizeof(T))) return *this;
+      std::memcpy(&value, pos-sizeof(T), sizeof(T));
+      return *this;
+    }
+    SnapshotReader& operator&(std::string &value){
+      uint32_t length = 0;
+      *this & length;
+      if(!Take(length)) return *this;
+      value.assign(pos-length, length);
+      return *this;
+    }
+    bool Good() const { return ok; }
+    bool AtEnd() const { return pos==end; }
+   private:
+    bool Take(std::size_t n){
+      if(!ok || static_cast<std::size_t>(end-pos) < n){ ok = false; return false; }
+      pos += n;
+      return true;
+    }
+    const char *pos;
+    const char *end;
+    bool ok;
+  };
+
+  template<typename Record> void WriteRecords(SnapshotWriter &writer, std::vector<Record> &records){
+    uint64_t count = records.size();
+    writer & count;
+    for(auto &record : records) record.serialize(writer);
+  }
+
+  template<typename Record> bool ReadRecords(SnapshotReader &reader, std::vector<Record> &records){
+    uint64_t count = 0;
+    reader & count;
+    if(!reader.Good()) return false;
+    records.clear();
+    records.reserve(count < 100000 ? count : 100000);
+    for(uint64_t i=0; i<count && reader.Good(); i++){
+      records.emplace_back();
+      records.back().serialize(reader);
+    }
+    return reader.Good();
+  }
+
+}
+
+void GeometrySnapshot::Clear(){
+  detector = DetectorGeoRecord();
+  mrd.clear();
+  tankpmts.clear();
+  gains.clear();
+  aux.clear();
+  lappds.clear();
+}
+
+uint64_t GeometrySnapshot::Checksum(const char *data, std::size_t size, uint64_t hash){
+  const unsigned char *bytes = reinterpret_cast<const unsigned char*>(data);
+  for(std::size_t i=0; i<size; i++){
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+uint64_t GeometrySnapshot::SourceChecksum(const std::vector<std::string> &files, int lappd_channel_count){
+  uint32_t version = FORMAT_VERSION;
+  uint64_t hash = Checksum(reinterpret_cast<const char*>(&version), sizeof(version));
+  hash = Checksum(reinterpret_cast<const char*>(&lappd_channel_count), sizeof(lappd_channel_count), hash);
+  for(const std::string &file : files){
+    std::ifstream in(file.c_str(), std::ios::binary);
+    std::stringstream content;
+    content << in.rdbuf();
+    std::string bytes = content.str();
+    uint64_t size = bytes.size();
+    // include the size so content cannot move between files unnoticed
+    hash = Checksum(reinterpret_cast<const char*>(&size), sizeof(size), hash);
+    hash = Checksum(bytes.data(), bytes.size(), hash);
+  }
+  return hash;
+}
+
+bool GeometrySnapshot::Write(std::string filename, uint64_t source_checksum){
+  std::string payload;
+  SnapshotWriter writer(payload);
+  detector.serialize(writer);
+  WriteRecords(writer, mrd);
+  WriteRecords(writer, tankpmts);
+  WriteRecords(writer, gains);
+  WriteRecords(writer, aux);
+  WriteRecords(writer, lappds);
+
+  uint32_t version = FORMAT_VERSION;
+  uint32_t header_size = SnapshotHeaderSize;
+  uint64_t payload_size = payload.size();
+  uint64_t payload_checksum = Checksum(payload.data(), payload.size());
+
+  // jobs sharing the snapshot file should never see a partly written file
+  std::string tmpname = filename + ".tmp" + std::to_string(getpid());
+  std::ofstream out(tmpname.c_str(), std::ios::binary | std::ios::trunc);
+  if(!out.is_open()) return false;
+  out.write(SnapshotMagic, sizeof(SnapshotMagic));
+  out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  out.write(reinterpret_cast<const char*>(&header_size), sizeof(header_size));
+  out.write(reinterpret_cast<const char*>(&source_checksum), sizeof(source_checksum));
+  out.write(reinterpret_cast<const char*>(&payload_size), sizeof(payload_size));
+  out.write(reinterpret_cast<const char*>(&payload_checksum), sizeof(payload_checksum));
+  out.write(payload.data(), payload.size());
+  out.close();
+  if(!out.good() || std::rename(tmpname.c_str(), filename.c_str())!=0){
+    std::remove(tmpname.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool GeometrySnapshot::Read(std::string filename, uint64_t source_checksum, std::string &error){
+  Clear();
+  int fd = open(filename.c_str(), O_RDONLY);
+  if(fd<0){ error = "cannot open file"; return false; }
+  struct stat st;
+  if(fstat(fd, &st)!=0 || st.st_size < (off_t)SnapshotHeaderSize){
+    close(fd);
+    error = "file too short";
+    return false;
+  }
+  std::size_t size = st.st_size;
+  void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(mapped==MAP_FAILED){ error = "cannot map file"; return false; }
+  const char *data = static_cast<const char*>(mapped);
+
+  bool ok = false;
+  uint32_t version = 0, header_size = 0;
+  uint64_t file_source_checksum = 0, payload_size = 0, payload_checksum = 0;
+  std::memcpy(&version, data+8, sizeof(version));
+  std::memcpy(&header_size, data+12, sizeof(header_size));
+  std::memcpy(&file_source_checksum, data+16, sizeof(file_source_checksum));
+  std::memcpy(&payload_size, data+24, sizeof(payload_size));
+  std::memcpy(&payload_checksum, data+32, sizeof(payload_checksum));
+
+  if(std::memcmp(data, SnapshotMagic, sizeof(SnapshotMagic))!=0) error = "not a geometry snapshot";
+  else if(version!=FORMAT_VERSION || header_size!=SnapshotHeaderSize) error = "snapshot format version "+std::to_string(version)+" is not "+std::to_string(FORMAT_VERSION);
+  else if(file_source_checksum!=source_checksum) error = "geometry source files changed";
+  else if(payload_size!=size-SnapshotHeaderSize) error = "truncated snapshot";
+  else if(Checksum(data+SnapshotHeaderSize, payload_size)!=payload_checksum) error = "snapshot checksum mismatch";
+  else {
+    SnapshotReader reader(data+SnapshotHeaderSize, payload_size);
+    detector.serialize(reader);
+    ok = reader.Good()
+      && ReadRecords(reader, mrd)
+      && ReadRecords(reader, tankpmts)
+      && ReadRecords(reader, gains)
+      && ReadRecords(reader, aux)
+      && ReadRecords(reader, lappds)
+      && reader.AtEnd();
+    if(!ok) error = "corrupt snapshot payload";
+  }
+
+  munmap(mapped, size);
+  if(!ok) Clear();
+  return ok;
+}
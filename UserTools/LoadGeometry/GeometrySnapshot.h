@@ -0,0 +1,142 @@
+#ifndef GeometrySnapshot_H
+#define GeometrySnapshot_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+/**
+ * Parsed content of the LoadGeometry CSV files. One record holds the values of one data line
+ * that are used to build the Detector/Channel/Paddle objects and the electronics maps, so
+ * replaying the records through LoadGeometry gives exactly the same Geometry as parsing the CSVs.
+ * Each record lists its fields once in serialize(), which is used both to write and to read a snapshot.
+ * Adding, removing or reordering a field requires increasing GeometrySnapshot::FORMAT_VERSION.
+ */
+
+struct DetectorGeoRecord {
+  int geometry_version = 0;
+  double tank_xcenter = 0.0, tank_ycenter = 0.0, tank_zcenter = 0.0;
+  double tank_radius = 0.0, tank_halfheight = 0.0, pmt_enclosed_radius = 0.0, pmt_enclosed_halfheight = 0.0;
+  double mrd_width = 0.0, mrd_height = 0.0, mrd_depth = 0.0, mrd_start = 0.0;
+
+  template<class Archive> void serialize(Archive & ar){
+    ar & geometry_version;
+    ar & tank_xcenter; ar & tank_ycenter; ar & tank_zcenter;
+    ar & tank_radius; ar & tank_halfheight; ar & pmt_enclosed_radius; ar & pmt_enclosed_halfheight;
+    ar & mrd_width; ar & mrd_height; ar & mrd_depth; ar & mrd_start;
+  }
+};
+
+struct MRDGeoRecord {
+  int detector_num = 0, channel_num = 0, detector_system = 0, orientation = 0, layer = 0, side = 0, num = 0;
+  int rack = 0, TDC_slot = 0, TDC_channel = 0, hv_crate = 0, hv_slot = 0, hv_channel = 0;
+  double x_center = 0.0, y_center = 0.0, z_center = 0.0, x_width = 0.0, y_width = 0.0, z_width = 0.0;
+  std::string PMT_type = "default";
+
+  template<class Archive> void serialize(Archive & ar){
+    ar & detector_num; ar & channel_num; ar & detector_system; ar & orientation; ar & layer; ar & side; ar & num;
+    ar & rack; ar & TDC_slot; ar & TDC_channel; ar & hv_crate; ar & hv_slot; ar & hv_channel;
+    ar & x_center; ar & y_center; ar & z_center; ar & x_width; ar & y_width; ar & z_width;
+    ar & PMT_type;
+  }
+};
+
+struct TankPMTGeoRecord {
+  int detector_num = 0, channel_num = 0, signal_crate = 0, signal_slot = 0, signal_channel = 0;
+  int mt_crate = 0, mt_slot = 0, mt_channel = 0, hv_crate = 0, hv_slot = 0, hv_channel = 0;
+  double x_pos = 0.0, y_pos = 0.0, z_pos = 0.0, x_dir = 0.0, y_dir = 0.0, z_dir = 0.0;
+  std::string detector_tank_location = "default", PMT_type = "default", detector_status = "default";
+
+  template<class Archive> void serialize(Archive & ar){
+    ar & detector_num; ar & channel_num; ar & signal_crate; ar & signal_slot; ar & signal_channel;
+    ar & mt_crate; ar & mt_slot; ar & mt_channel; ar & hv_crate; ar & hv_slot; ar & hv_channel;
+    ar & x_pos; ar & y_pos; ar & z_pos; ar & x_dir; ar & y_dir; ar & z_dir;
+    ar & detector_tank_location; ar & PMT_type; ar & detector_status;
+  }
+};
+
+struct TankPMTGainRecord {
+  int channelkey = -9999;
+  double SPECharge = -9999.;
+
+  template<class Archive> void serialize(Archive & ar){
+    ar & channelkey; ar & SPECharge;
+  }
+};
+
+struct AuxChannelGeoRecord {
+  int channel_num = 0, signal_crate = 0, signal_slot = 0, signal_channel = 0;
+  std::string channel_type = "NA";
+
+  template<class Archive> void serialize(Archive & ar){
+    ar & channel_num; ar & signal_crate; ar & signal_slot; ar & signal_channel;
+    ar & channel_type;
+  }
+};
+
+struct LAPPDGeoRecord {
+  int detector_num = 0, channel_strip_side = 0, channel_strip_num = 0;
+  unsigned int channel_signal_crate = 0, channel_signal_card = 0, channel_signal_channel = 0;
+  unsigned int channel_level2_crate = 0, channel_level2_card = 0, channel_level2_channel = 0;
+  unsigned int channel_hv_crate = 0, channel_hv_card = 0, channel_hv_channel = 0, channel_num = 0;
+  double detector_position_x = 0.0, detector_position_y = 0.0, detector_position_z = 0.0;
+  double detector_direction_x = 0.0, detector_direction_y = 0.0, detector_direction_z = 0.0;
+  double channel_position_x = 0.0, channel_position_y = 0.0, channel_position_z = 0.0;
+  std::string detector_type = "default", detector_status = "default", channel_status = "default";
+
+  template<class Archive> void serialize(Archive & ar){
+    ar & detector_num; ar & channel_strip_side; ar & channel_strip_num;
+    ar & channel_signal_crate; ar & channel_signal_card; ar & channel_signal_channel;
+    ar & channel_level2_crate; ar & channel_level2_card; ar & channel_level2_channel;
+    ar & channel_hv_crate; ar & channel_hv_card; ar & channel_hv_channel; ar & channel_num;
+    ar & detector_position_x; ar & detector_position_y; ar & detector_position_z;
+    ar & detector_direction_x; ar & detector_direction_y; ar & detector_direction_z;
+    ar & channel_position_x; ar & channel_position_y; ar & channel_position_z;
+    ar & detector_type; ar & detector_status; ar & channel_status;
+  }
+};
+
+/**
+ * \class GeometrySnapshot
+ *
+ * Binary snapshot of the parsed geometry CSV files, written once by LoadGeometry and memory-mapped on later starts.
+ * Values are stored in the byte order of the host. File layout:
+ *   0  char[8]  magic "ANNIEGEO"
+ *   8  uint32   format version (FORMAT_VERSION)
+ *   12 uint32   header size in bytes (40)
+ *   16 uint64   checksum of the source CSV files and LAPPDChannelCount the snapshot was made from
+ *   24 uint64   payload size in bytes
+ *   32 uint64   checksum of the payload
+ *   40          payload: detector record, then for MRD, tank PMT, gain, auxiliary and LAPPD records a uint64 count
+ *               followed by the records. Strings are stored as uint32 length + characters.
+ * A snapshot is only used if magic, version, both checksums and the size match; otherwise the CSVs are parsed again.
+ */
+
+class GeometrySnapshot {
+
+ public:
+
+  static const uint32_t FORMAT_VERSION = 1;
+
+  void Clear();
+
+  /// FNV-1a checksum of the source files' contents and the LAPPD channel count. Paths and timestamps are not
+  /// included, so a copied geometry directory still matches its snapshot.
+  uint64_t SourceChecksum(const std::vector<std::string> &files, int lappd_channel_count);
+
+  bool Write(std::string filename, uint64_t source_checksum);                      ///< Write atomically (temporary file + rename)
+  bool Read(std::string filename, uint64_t source_checksum, std::string &error);   ///< Map and validate the file, fill the records
+
+  static uint64_t Checksum(const char *data, std::size_t size, uint64_t hash=14695981039346656037ULL);
+
+  DetectorGeoRecord detector;
+  std::vector<MRDGeoRecord> mrd;
+  std::vector<TankPMTGeoRecord> tankpmts;
+  std::vector<TankPMTGainRecord> gains;
+  std::vector<AuxChannelGeoRecord> aux;
+  std::vector<LAPPDGeoRecord> lappds;
+
+};
+
+#endif
@@ -24,6 +24,8 @@ bool LoadGeometry::Initialise(std::string configfile, DataModel &data){
   m_variables.Get("LAPPDGeoFile", fLAPPDGeoFile);
   m_variables.Get("DetectorGeoFile", fDetectorGeoFile);
   m_variables.Get("LAPPDChannelCount", LAPPD_channel_count);
+  fGeometrySnapshotFile = "";
+  m_variables.Get("GeometrySnapshotFile", fGeometrySnapshotFile);
 
   //Check files exist
   if(!this->FileExists(fDetectorGeoFile)){
@@ -70,23 +72,54 @@ bool LoadGeometry::Initialise(std::string configfile, DataModel &data){
   AuxChannelNumToTypeMap = new std::map<int,std::string>;
   LAPPDCrateSpaceToChannelNumMap = new std::map<std::vector<unsigned int>,int>;
 
-  //Initialize the geometry using the geometry CSV file entries
-  this->InitializeGeometry();
+  //Use the binary snapshot of the parsed CSV files if it was made from the
+  //same files, otherwise parse the CSV files and write a new snapshot
+  bool snapshot_loaded = false;
+  uint64_t source_checksum = 0;
+  if(fGeometrySnapshotFile!=""){
+    source_checksum = snapshot.SourceChecksum({fDetectorGeoFile,fFACCMRDGeoFile,fTankPMTGeoFile,
+                                               fTankPMTGainFile,fAuxChannelFile,fLAPPDGeoFile},LAPPD_channel_count);
+    if(this->FileExists(fGeometrySnapshotFile)){
+      std::string snapshot_error;
+      snapshot_loaded = snapshot.Read(fGeometrySnapshotFile,source_checksum,snapshot_error);
+      if(!snapshot_loaded) Log("LoadGeometry tool: Not using geometry snapshot "+fGeometrySnapshotFile+" ("+snapshot_error+"), parsing the CSV files",v_warning,verbosity);
+    }
+  }
+
+  if(snapshot_loaded){
+    Log("LoadGeometry tool: Loading geometry from snapshot "+fGeometrySnapshotFile,v_message,verbosity);
+    this->LoadFromSnapshot();
+  } else {
+    record_snapshot = (fGeometrySnapshotFile!="");
+
+    //Initialize the geometry using the geometry CSV file entries
+    this->InitializeGeometry();
 
-  //Load MRD Geometry Detector/Channel Information
-  this->LoadFACCMRDDetectors();
+    //Load MRD Geometry Detector/Channel Information
+    this->LoadFACCMRDDetectors();
 
-  //Load TankPMT Geometry Detector/Channel Information
-  this->LoadTankPMTDetectors();
+    //Load TankPMT Geometry Detector/Channel Information
+    this->LoadTankPMTDetectors();
 
-  //Load TankPMT charge to PE conversion 
-  this->LoadTankPMTGains();
+    //Load TankPMT charge to PE conversion 
+    this->LoadTankPMTGains();
 
-  //Load auxiliary and spare channels
-  this->LoadAuxiliaryChannels();
+    //Load auxiliary and spare channels
+    this->LoadAuxiliaryChannels();
 
-  //Load LAPPD Geometry Information
-  this->LoadLAPPDs();
+    //Load LAPPD Geometry Information
+    this->LoadLAPPDs();
+
+    if(record_snapshot && AnnieGeometry!=nullptr){
+      if(snapshot.Write(fGeometrySnapshotFile,source_checksum)){
+        Log("LoadGeometry tool: Wrote geometry snapshot "+fGeometrySnapshotFile,v_message,verbosity);
+      } else {
+        Log("LoadGeometry tool: Could not write geometry snapshot "+fGeometrySnapshotFile,v_warning,verbosity);
+      }
+    }
+    record_snapshot = false;
+  }
+  snapshot.Clear();
 
   m_data->Stores.at("ANNIEEvent")->Header->Set("AnnieGeometry",AnnieGeometry,true);
 
@@ -122,17 +155,8 @@ void LoadGeometry::InitializeGeometry(){
   std::vector<std::string> DetectorLegendEntries;
   boost::split(DetectorLegendEntries,DetectorLegend, boost::is_any_of(","), boost::token_compress_on);
 
-  //Initialize at zero; will be set later after channels are loaded
-  int numtankpmts = 0;
-  int numlappds = 0;
-  int nummrdpmts = 0;
-  int numvetopmts = 0;
-
   //Initialize data that will be fed to Geometry (units in meters)
-  int geometry_version = 0;
-  double tank_xcenter = 0.0,tank_ycenter = 0.0,tank_zcenter = 0.0;
-  double tank_radius = 0.0,tank_halfheight = 0.0, pmt_enclosed_radius = 0.0, pmt_enclosed_halfheight = 0.0;
-  double mrd_width = 0.0,mrd_height = 0.0,mrd_depth = 0.0,mrd_start = 0.0;
+  DetectorGeoRecord rec;
 
   std::string line = "default";
   ifstream myfile(fDetectorGeoFile.c_str());
@@ -155,43 +179,78 @@ void LoadGeometry::InitializeGeometry(){
         double dvalue = 0.0;
         if(DetectorLegendEntries.at(i) == "geometry_version") ivalue = std::stoi(DataEntries.at(i));
         else dvalue = std::stod(DataEntries.at(i));
-        if (DetectorLegendEntries.at(i) == "geometry_version") geometry_version = ivalue;
-        if (DetectorLegendEntries.at(i) == "tank_xcenter") tank_xcenter = dvalue;
-        if (DetectorLegendEntries.at(i) == "tank_ycenter") tank_ycenter = dvalue;
-        if (DetectorLegendEntries.at(i) == "tank_zcenter") tank_zcenter = dvalue;
-        if (DetectorLegendEntries.at(i) == "tank_radius") tank_radius = dvalue;
-        if (DetectorLegendEntries.at(i) == "tank_halfheight") tank_halfheight = dvalue;
-        if (DetectorLegendEntries.at(i) == "pmt_enclosed_radius") pmt_enclosed_radius = dvalue;
-        if (DetectorLegendEntries.at(i) == "pmt_enclosed_halfheight") pmt_enclosed_halfheight = dvalue;
-        if (DetectorLegendEntries.at(i) == "mrd_width") mrd_width = dvalue;
-        if (DetectorLegendEntries.at(i) == "mrd_height") mrd_height = dvalue;
-        if (DetectorLegendEntries.at(i) == "mrd_depth") mrd_depth = dvalue;
-        if (DetectorLegendEntries.at(i) == "mrd_start") mrd_start = dvalue;
+        if (DetectorLegendEntries.at(i) == "geometry_version") rec.geometry_version = ivalue;
+        if (DetectorLegendEntries.at(i) == "tank_xcenter") rec.tank_xcenter = dvalue;
+        if (DetectorLegendEntries.at(i) == "tank_ycenter") rec.tank_ycenter = dvalue;
+        if (DetectorLegendEntries.at(i) == "tank_zcenter") rec.tank_zcenter = dvalue;
+        if (DetectorLegendEntries.at(i) == "tank_radius") rec.tank_radius = dvalue;
+        if (DetectorLegendEntries.at(i) == "tank_halfheight") rec.tank_halfheight = dvalue;
+        if (DetectorLegendEntries.at(i) == "pmt_enclosed_radius") rec.pmt_enclosed_radius = dvalue;
+        if (DetectorLegendEntries.at(i) == "pmt_enclosed_halfheight") rec.pmt_enclosed_halfheight = dvalue;
+        if (DetectorLegendEntries.at(i) == "mrd_width") rec.mrd_width = dvalue;
+        if (DetectorLegendEntries.at(i) == "mrd_height") rec.mrd_height = dvalue;
+        if (DetectorLegendEntries.at(i) == "mrd_depth") rec.mrd_depth = dvalue;
+        if (DetectorLegendEntries.at(i) == "mrd_start") rec.mrd_start = dvalue;
       }
     }
-    Position tank_center(tank_xcenter, tank_ycenter, tank_zcenter);
-    // Initialize the Geometry
-    AnnieGeometry = new Geometry(geometry_version,
-                                 tank_center,
-                                 tank_radius,
-                                 tank_halfheight,
-                                 pmt_enclosed_radius,
-                                 pmt_enclosed_halfheight,
-                                 mrd_width,
-                                 mrd_height,
-                                 mrd_depth,
-                                 mrd_start,
-                                 numtankpmts,
-                                 nummrdpmts,
-                                 numvetopmts,
-                                 numlappds,
-                                 geostatus::FULLY_OPERATIONAL);
+    if(record_snapshot) snapshot.detector = rec;
+    this->AddDetectorRecord(rec);
   } else {
     Log("LoadGeometry tool: Something went wrong opening a file!!!",v_error,verbosity);
   }
   myfile.close();
 }
 
+void LoadGeometry::AddDetectorRecord(const DetectorGeoRecord &rec){
+  //Initialize at zero; will be set later after channels are loaded
+  int numtankpmts = 0;
+  int numlappds = 0;
+  int nummrdpmts = 0;
+  int numvetopmts = 0;
+
+  Position tank_center(rec.tank_xcenter, rec.tank_ycenter, rec.tank_zcenter);
+  // Initialize the Geometry
+  AnnieGeometry = new Geometry(rec.geometry_version,
+                               tank_center,
+                               rec.tank_radius,
+                               rec.tank_halfheight,
+                               rec.pmt_enclosed_radius,
+                               rec.pmt_enclosed_halfheight,
+                               rec.mrd_width,
+                               rec.mrd_height,
+                               rec.mrd_depth,
+                               rec.mrd_start,
+                               numtankpmts,
+                               nummrdpmts,
+                               numvetopmts,
+                               numlappds,
+                               geostatus::FULLY_OPERATIONAL);
+}
+
+void LoadGeometry::LoadFromSnapshot(){
+  //Same order as the CSV loading in Initialise
+  this->AddDetectorRecord(snapshot.detector);
+  for (const MRDGeoRecord &rec : snapshot.mrd){
+    if(not this->AddMRDRecord(rec)) std::cerr<<"Faild to add Detector to Geometry!"<<std::endl;
+  }
+  for (const TankPMTGeoRecord &rec : snapshot.tankpmts){
+    if(not this->AddTankPMTRecord(rec)) std::cerr<<"Failed to add Tank PMT Detector to Geometry!"<<std::endl;
+  }
+  for (const TankPMTGainRecord &rec : snapshot.gains){
+    ChannelNumToTankPMTSPEChargeMap->emplace(rec.channelkey,rec.SPECharge);
+  }
+  for (const AuxChannelGeoRecord &rec : snapshot.aux){
+    if(not this->AddAuxChannelRecord(rec)) std::cerr<<"Failed to add Aux Channel to Crate Space/Channel Key Map!"<<std::endl;
+  }
+  detector_num_store = 100000;
+  counter = 0;
+  for (const LAPPDGeoRecord &rec : snapshot.lappds){
+    if(not this->AddLAPPDRecord(rec)) std::cerr<<"Faild to add Detector to Geometry!"<<std::endl;
+  }
+  Log("LoadGeometry tool: Loaded "+std::to_string(snapshot.mrd.size())+" FACC/MRD, "+std::to_string(snapshot.tankpmts.size())
+      +" tank PMT, "+std::to_string(snapshot.aux.size())+" auxiliary and "+std::to_string(snapshot.lappds.size())+" LAPPD channels from snapshot",v_message,verbosity);
+}
+
 void LoadGeometry::LoadFACCMRDDetectors(){
   //First, get the MRD file data key
   Log("LoadGeometry tool: Now loading FACC/MRD detectors",v_message,verbosity);
@@ -230,12 +289,11 @@ void LoadGeometry::LoadFACCMRDDetectors(){
 bool LoadGeometry::ParseMRDDataEntry(std::vector<std::string> SpecLine,
         std::vector<std::string> MRDLegendEntries){
   //Parse the line for information needed to fill the detector & channel classes
-  int detector_num = 0,channel_num = 0,detector_system = 0,orientation = 0,layer = 0,side = 0,num = 0,
-      rack = 0,TDC_slot = 0,TDC_channel = 0,discrim_slot = 0,discrim_ch = 0,
+  MRDGeoRecord rec;
+  int discrim_slot = 0,discrim_ch = 0,
       patch_panel_row = 0,patch_panel_col = 0,amp_slot = 0,amp_channel = 0,
-      hv_crate = 0,hv_slot = 0,hv_channel = 0,nominal_HV,polarity = 0;
-  double x_center = 0.0,y_center = 0.0,z_center = 0.0,x_width = 0.0,y_width = 0.0,z_width = 0.0;
-  std::string PMT_type = "default",cable_label = "default",paddle_label = "default";
+      nominal_HV,polarity = 0;
+  std::string cable_label = "default",paddle_label = "default";
 
   //Search for Legend entry.  Fill value type if found.
   Log("LoadGeometry tool: parsing data line into variables",v_debug,verbosity);
@@ -262,44 +320,49 @@ bool LoadGeometry::ParseMRDDataEntry(std::vector<std::string> SpecLine,
       }
     }
     //Integers
-    if (MRDLegendEntries.at(i) == "detector_num") detector_num = ivalue;
-    if (MRDLegendEntries.at(i) == "channel_num") channel_num = ivalue;
-    if (MRDLegendEntries.at(i) == "detector_system") detector_system = ivalue;
-    if (MRDLegendEntries.at(i) == "orientation") orientation = ivalue;
-    if (MRDLegendEntries.at(i) == "layer") layer = ivalue;
-    if (MRDLegendEntries.at(i) == "side") side = ivalue;
-    if (MRDLegendEntries.at(i) == "num") num = ivalue;
-    if (MRDLegendEntries.at(i) == "rack") rack = ivalue;
-    if (MRDLegendEntries.at(i) == "TDC_slot") TDC_slot = ivalue;
-    if (MRDLegendEntries.at(i) == "TDC_channel") TDC_channel = ivalue;
+    if (MRDLegendEntries.at(i) == "detector_num") rec.detector_num = ivalue;
+    if (MRDLegendEntries.at(i) == "channel_num") rec.channel_num = ivalue;
+    if (MRDLegendEntries.at(i) == "detector_system") rec.detector_system = ivalue;
+    if (MRDLegendEntries.at(i) == "orientation") rec.orientation = ivalue;
+    if (MRDLegendEntries.at(i) == "layer") rec.layer = ivalue;
+    if (MRDLegendEntries.at(i) == "side") rec.side = ivalue;
+    if (MRDLegendEntries.at(i) == "num") rec.num = ivalue;
+    if (MRDLegendEntries.at(i) == "rack") rec.rack = ivalue;
+    if (MRDLegendEntries.at(i) == "TDC_slot") rec.TDC_slot = ivalue;
+    if (MRDLegendEntries.at(i) == "TDC_channel") rec.TDC_channel = ivalue;
     if (MRDLegendEntries.at(i) == "discrim_slot") discrim_slot = ivalue;
     if (MRDLegendEntries.at(i) == "discrim_ch") discrim_ch = ivalue;
     if (MRDLegendEntries.at(i) == "patch_panel_row") patch_panel_row = ivalue;
     if (MRDLegendEntries.at(i) == "patch_panel_col") patch_panel_col = ivalue;
     if (MRDLegendEntries.at(i) == "amp_slot") amp_slot = ivalue;
     if (MRDLegendEntries.at(i) == "amp_channel") amp_channel = ivalue;
-    if (MRDLegendEntries.at(i) == "hv_crate") hv_crate = ivalue;
-    if (MRDLegendEntries.at(i) == "hv_slot") hv_slot = ivalue;
-    if (MRDLegendEntries.at(i) == "hv_channel") hv_channel = ivalue;
+    if (MRDLegendEntries.at(i) == "hv_crate") rec.hv_crate = ivalue;
+    if (MRDLegendEntries.at(i) == "hv_slot") rec.hv_slot = ivalue;
+    if (MRDLegendEntries.at(i) == "hv_channel") rec.hv_channel = ivalue;
     if (MRDLegendEntries.at(i) == "nominal_HV") nominal_HV = ivalue;
     if (MRDLegendEntries.at(i) == "polarity") polarity = ivalue;
     //Doubles
-    if (MRDLegendEntries.at(i) == "x_center") x_center = dvalue;
-    if (MRDLegendEntries.at(i) == "y_center") y_center = dvalue;
-    if (MRDLegendEntries.at(i) == "z_center") z_center = dvalue;
-    if (MRDLegendEntries.at(i) == "x_width") x_width = dvalue;
-    if (MRDLegendEntries.at(i) == "y_width") y_width = dvalue;
-    if (MRDLegendEntries.at(i) == "z_width") z_width = dvalue;
+    if (MRDLegendEntries.at(i) == "x_center") rec.x_center = dvalue;
+    if (MRDLegendEntries.at(i) == "y_center") rec.y_center = dvalue;
+    if (MRDLegendEntries.at(i) == "z_center") rec.z_center = dvalue;
+    if (MRDLegendEntries.at(i) == "x_width") rec.x_width = dvalue;
+    if (MRDLegendEntries.at(i) == "y_width") rec.y_width = dvalue;
+    if (MRDLegendEntries.at(i) == "z_width") rec.z_width = dvalue;
     //Strings
-    if (MRDLegendEntries.at(i) == "PMT_type") PMT_type = svalue;
+    if (MRDLegendEntries.at(i) == "PMT_type") rec.PMT_type = svalue;
     if (MRDLegendEntries.at(i) == "paddle_label") paddle_label = svalue;
     if (MRDLegendEntries.at(i) == "cable_label") cable_label = svalue;
   }
 
+  if(record_snapshot) snapshot.mrd.push_back(rec);
+  return this->AddMRDRecord(rec);
+}
+
+bool LoadGeometry::AddMRDRecord(const MRDGeoRecord &rec){
   // Parse whether this is an MRD or Veto Paddle
   std::string dettype = "unknown";
-  if (detector_system == 0) dettype = "Veto";
-  else if (detector_system == 1) dettype = "MRD";
+  if (rec.detector_system == 0) dettype = "Veto";
+  else if (rec.detector_system == 1) dettype = "MRD";
   //FIXME Need the direction of the MRD PMT
   //FIXME: things that are not loaded in with the default det/channel format:
   //  - discrim_slot, discrim_ch
@@ -308,68 +371,68 @@ bool LoadGeometry::ParseMRDDataEntry(std::vector<std::string> SpecLine,
   //  - cable_label, paddle_label
   //
   if(verbosity>4) std::cout << "Filling a FACC/MRD data line into Detector/Channel classes" << std::endl;
-  Detector adet(detector_num,
+  Detector adet(rec.detector_num,
                 dettype,
                 "MRD", //Change to orientation for PaddleDetector class?
-                Position( x_center/100.,
-                          y_center/100.,
-                          z_center/100.),
+                Position( rec.x_center/100.,
+                          rec.y_center/100.,
+                          rec.z_center/100.),
                 Direction(0.,
                           0.,
                           0.),
-                PMT_type,
+                rec.PMT_type,
                 detectorstatus::ON,
                 0.);
 
   int MRD_x, MRD_y, MRD_z;
   // orientation 0=horizontal, 1=vertical
-  MRD_x = (orientation) ? num  : side;
-  MRD_y = (orientation) ? side : num;
+  MRD_x = (rec.orientation) ? rec.num  : rec.side;
+  MRD_y = (rec.orientation) ? rec.side : rec.num;
   // veto layers are both cabled as z=0, with the layers differentiated by x=0, x=1
   // in practice of course, both span the same x, but are offset in z.
-  if(layer>0) MRD_z = layer;
-  else        MRD_z = side;
+  if(rec.layer>0) MRD_z = rec.layer;
+  else        MRD_z = rec.side;
 
-  Paddle apad( detector_num,
+  Paddle apad( rec.detector_num,
                MRD_x,
                MRD_y,
                MRD_z,
-               orientation,
-               Position( x_center/100.,
-                         y_center/100.,
-                         z_center/100.),
-               std::pair<double,double>{x_center/100.-(x_width/200.), x_center/100.+(x_width/200.)},
-               std::pair<double,double>{y_center/100.-(y_width/200.), y_center/100.+(y_width/200.)},
-               std::pair<double,double>{z_center/100.-(z_width/200.), z_center/100.+(z_width/200.)});
+               rec.orientation,
+               Position( rec.x_center/100.,
+                         rec.y_center/100.,
+                         rec.z_center/100.),
+               std::pair<double,double>{rec.x_center/100.-(rec.x_width/200.), rec.x_center/100.+(rec.x_width/200.)},
+               std::pair<double,double>{rec.y_center/100.-(rec.y_width/200.), rec.y_center/100.+(rec.y_width/200.)},
+               std::pair<double,double>{rec.z_center/100.-(rec.z_width/200.), rec.z_center/100.+(rec.z_width/200.)});
   
-  Channel pmtchannel( channel_num,
+  Channel pmtchannel( rec.channel_num,
                       Position(0,0,0.),
                       -1, // stripside
                       -1, // stripnum
-                      rack,
-                      TDC_slot,
-                      TDC_channel,
+                      rec.rack,
+                      rec.TDC_slot,
+                      rec.TDC_channel,
                       -1,                 // TDC has no level 2 signal handling
                       -1,
                       -1,
-                      hv_crate,
-                      hv_slot,
-                      hv_channel,
+                      rec.hv_crate,
+                      rec.hv_slot,
+                      rec.hv_channel,
                       channelstatus::ON);
 
   // Add this channel to the geometry
-  if(verbosity>4) cout<<"Adding channel "<<channel_num<<" to detector "<<detector_num<<endl;
+  if(verbosity>4) cout<<"Adding channel "<<rec.channel_num<<" to detector "<<rec.detector_num<<endl;
   adet.AddChannel(pmtchannel);
 
   // Also add this channel to the electronics map
-  std::vector<int> crate_map{rack,TDC_slot,TDC_channel};
+  std::vector<int> crate_map{rec.rack,rec.TDC_slot,rec.TDC_channel};
   if(MRDCrateSpaceToChannelNumMap->count(crate_map)==0){
-    MRDCrateSpaceToChannelNumMap->emplace(crate_map, channel_num);
+    MRDCrateSpaceToChannelNumMap->emplace(crate_map, rec.channel_num);
   } else {
     Log("LoadGeometry Tool: ERROR: Tried assigning an MRD channel_num to a crate space already defined!!! ",v_error, verbosity);
   }
-  if(MRDChannelNumToCrateSpaceMap->count(channel_num)==0){
-    MRDChannelNumToCrateSpaceMap->emplace(channel_num, crate_map);
+  if(MRDChannelNumToCrateSpaceMap->count(rec.channel_num)==0){
+    MRDChannelNumToCrateSpaceMap->emplace(rec.channel_num, crate_map);
   } else {
     Log("LoadGeometry Tool: ERROR: Tried assigning an MRD crate space to a channel number already defined!!! ",v_error, verbosity);
   }
@@ -377,7 +440,7 @@ bool LoadGeometry::ParseMRDDataEntry(std::vector<std::string> SpecLine,
   if(verbosity>5) cout<<"Adding detector to Geometry"<<endl;
   AnnieGeometry->AddDetector(adet);
   if(verbosity>4) cout<<"Adding paddle to Geometry"<<endl;
-  AnnieGeometry->SetDetectorPaddle(detector_num, apad);
+  AnnieGeometry->SetDetectorPaddle(rec.detector_num, apad);
   return true;
 }
 
@@ -420,8 +483,7 @@ bool LoadGeometry::ParseAuxChannelDataEntry(std::vector<std::string> SpecLine,
         std::vector<std::string> AuxChannelLegendEntries){
 
   //Parse the line for information needed to fill the Tdetector & channel classes
-  int channel_num = 0, signal_crate = 0,signal_slot = 0,signal_channel = 0;
-  std::string channel_type = "NA";
+  AuxChannelGeoRecord rec;
 
   //Search for Legend entry.  Fill value type if found.
   Log("LoadGeometry tool: parsing Auxiliary channel line into variables",v_debug,verbosity);
@@ -442,27 +504,32 @@ bool LoadGeometry::ParseAuxChannelDataEntry(std::vector<std::string> SpecLine,
     }
 
     //Integers
-    if (AuxChannelLegendEntries.at(i) == "channel_num") channel_num = ivalue;
-    if (AuxChannelLegendEntries.at(i) == "signal_crate") signal_crate = ivalue;
-    if (AuxChannelLegendEntries.at(i) == "signal_slot") signal_slot = ivalue;
-    if (AuxChannelLegendEntries.at(i) == "signal_channel") signal_channel = ivalue;
+    if (AuxChannelLegendEntries.at(i) == "channel_num") rec.channel_num = ivalue;
+    if (AuxChannelLegendEntries.at(i) == "signal_crate") rec.signal_crate = ivalue;
+    if (AuxChannelLegendEntries.at(i) == "signal_slot") rec.signal_slot = ivalue;
+    if (AuxChannelLegendEntries.at(i) == "signal_channel") rec.signal_channel = ivalue;
     //Strings
-    if (AuxChannelLegendEntries.at(i) == "channel_type") channel_type = svalue;
+    if (AuxChannelLegendEntries.at(i) == "channel_type") rec.channel_type = svalue;
   }
 
+  if(record_snapshot) snapshot.aux.push_back(rec);
+  return this->AddAuxChannelRecord(rec);
+}
+
+bool LoadGeometry::AddAuxChannelRecord(const AuxChannelGeoRecord &rec){
   // Also add this channel to the Tank PMT crate space electronics map
-  std::vector<int> crate_map{signal_crate,signal_slot,signal_channel};
+  std::vector<int> crate_map{rec.signal_crate,rec.signal_slot,rec.signal_channel};
   if(AuxCrateSpaceToChannelNumMap->count(crate_map)==0){
-    AuxCrateSpaceToChannelNumMap->emplace(crate_map, channel_num);
+    AuxCrateSpaceToChannelNumMap->emplace(crate_map, rec.channel_num);
   } else {
     Log("LoadGeometry Tool: ERROR: Tried assigning an Auxiliary Channel channel_num to a crate space already defined!!! ",v_error, verbosity);
-    Log("LoadGeometry Tool: ERROR DETAILS: Signal Crate = "+std::to_string(signal_crate)+", Signal Slot = "+std::to_string(signal_slot)+", Signal Channel = "+std::to_string(signal_channel),v_error,verbosity);
+    Log("LoadGeometry Tool: ERROR DETAILS: Signal Crate = "+std::to_string(rec.signal_crate)+", Signal Slot = "+std::to_string(rec.signal_slot)+", Signal Channel = "+std::to_string(rec.signal_channel),v_error,verbosity);
   }
-  if(AuxChannelNumToTypeMap->count(channel_num)==0){
-    AuxChannelNumToTypeMap->emplace(channel_num, channel_type);
+  if(AuxChannelNumToTypeMap->count(rec.channel_num)==0){
+    AuxChannelNumToTypeMap->emplace(rec.channel_num, rec.channel_type);
   } else {
     Log("LoadGeometry Tool: ERROR: Tried assigning an Auxiliary Channel Type to a channel already defined!!! ",v_error, verbosity);
-    Log("LoadGeometry Tool: ERROR DETAILS: Signal Type = "+ channel_type +", channel key = "+std::to_string(channel_num),v_error,verbosity);
+    Log("LoadGeometry Tool: ERROR DETAILS: Signal Type = "+ rec.channel_type +", channel key = "+std::to_string(rec.channel_num),v_error,verbosity);
   }
 
   return true;
@@ -508,11 +575,9 @@ bool LoadGeometry::ParseTankPMTDataEntry(std::vector<std::string> SpecLine,
         std::vector<std::string> TankPMTLegendEntries){
 
   //Parse the line for information needed to fill the Tdetector & channel classes
-  int detector_num = 0,channel_num = 0,panel_number = 0,signal_crate = 0,signal_slot = 0,signal_channel = 0,
-      mt_crate = 0, mt_slot = 0, mt_channel = 0, hv_crate = 0,hv_slot = 0,hv_channel = 0,nominal_HV = 0,
-      sb_num = 0, sb_channel = 0;
-  double x_pos = 0.0,y_pos = 0.0,z_pos = 0.0,x_dir = 0.0,y_dir = 0.0,z_dir = 0.0;
-  std::string detector_tank_location = "default",PMT_type = "default",cable_label = "default",detector_status = "default";
+  TankPMTGeoRecord rec;
+  int panel_number = 0,nominal_HV = 0,sb_num = 0, sb_channel = 0;
+  std::string cable_label = "default";
 
   //Search for Legend entry.  Fill value type if found.
   Log("LoadGeometry tool: parsing data line into variables",v_debug,verbosity);
@@ -540,99 +605,104 @@ bool LoadGeometry::ParseTankPMTDataEntry(std::vector<std::string> SpecLine,
     }
 
     //Integers
-    if (TankPMTLegendEntries.at(i) == "detector_num") detector_num = ivalue;
-    if (TankPMTLegendEntries.at(i) == "channel_num") channel_num = ivalue;
+    if (TankPMTLegendEntries.at(i) == "detector_num") rec.detector_num = ivalue;
+    if (TankPMTLegendEntries.at(i) == "channel_num") rec.channel_num = ivalue;
     if (TankPMTLegendEntries.at(i) == "panel_number") panel_number = ivalue;
     if (TankPMTLegendEntries.at(i) == "sb_num") sb_num = ivalue;
     if (TankPMTLegendEntries.at(i) == "sb_channel") sb_channel = ivalue;
-    if (TankPMTLegendEntries.at(i) == "signal_crate") signal_crate = ivalue;
-    if (TankPMTLegendEntries.at(i) == "signal_slot") signal_slot = ivalue;
-    if (TankPMTLegendEntries.at(i) == "signal_channel") signal_channel = ivalue;
-    if (TankPMTLegendEntries.at(i) == "mt_crate") mt_crate = ivalue;
-    if (TankPMTLegendEntries.at(i) == "mt_slot") mt_slot = ivalue;
-    if (TankPMTLegendEntries.at(i) == "mt_channel") mt_channel = ivalue;
-    if (TankPMTLegendEntries.at(i) == "hv_crate") hv_crate = ivalue;
-    if (TankPMTLegendEntries.at(i) == "hv_slot") hv_slot = ivalue;
-    if (TankPMTLegendEntries.at(i) == "hv_channel") hv_channel = ivalue;
+    if (TankPMTLegendEntries.at(i) == "signal_crate") rec.signal_crate = ivalue;
+    if (TankPMTLegendEntries.at(i) == "signal_slot") rec.signal_slot = ivalue;
+    if (TankPMTLegendEntries.at(i) == "signal_channel") rec.signal_channel = ivalue;
+    if (TankPMTLegendEntries.at(i) == "mt_crate") rec.mt_crate = ivalue;
+    if (TankPMTLegendEntries.at(i) == "mt_slot") rec.mt_slot = ivalue;
+    if (TankPMTLegendEntries.at(i) == "mt_channel") rec.mt_channel = ivalue;
+    if (TankPMTLegendEntries.at(i) == "hv_crate") rec.hv_crate = ivalue;
+    if (TankPMTLegendEntries.at(i) == "hv_slot") rec.hv_slot = ivalue;
+    if (TankPMTLegendEntries.at(i) == "hv_channel") rec.hv_channel = ivalue;
     if (TankPMTLegendEntries.at(i) == "nominal_HV") nominal_HV = ivalue;
     //Doubles
-    if (TankPMTLegendEntries.at(i) == "x_pos") x_pos = dvalue;
-    if (TankPMTLegendEntries.at(i) == "y_pos") y_pos = dvalue;
-    if (TankPMTLegendEntries.at(i) == "z_pos") z_pos = dvalue;
-    if (TankPMTLegendEntries.at(i) == "x_dir") x_dir = dvalue;
-    if (TankPMTLegendEntries.at(i) == "y_dir") y_dir = dvalue;
-    if (TankPMTLegendEntries.at(i) == "z_dir") z_dir = dvalue;
+    if (TankPMTLegendEntries.at(i) == "x_pos") rec.x_pos = dvalue;
+    if (TankPMTLegendEntries.at(i) == "y_pos") rec.y_pos = dvalue;
+    if (TankPMTLegendEntries.at(i) == "z_pos") rec.z_pos = dvalue;
+    if (TankPMTLegendEntries.at(i) == "x_dir") rec.x_dir = dvalue;
+    if (TankPMTLegendEntries.at(i) == "y_dir") rec.y_dir = dvalue;
+    if (TankPMTLegendEntries.at(i) == "z_dir") rec.z_dir = dvalue;
     //Strings
-    if (TankPMTLegendEntries.at(i) == "detector_tank_location") detector_tank_location = svalue;
-    if (TankPMTLegendEntries.at(i) == "PMT_type") PMT_type = svalue;
+    if (TankPMTLegendEntries.at(i) == "detector_tank_location") rec.detector_tank_location = svalue;
+    if (TankPMTLegendEntries.at(i) == "PMT_type") rec.PMT_type = svalue;
     if (TankPMTLegendEntries.at(i) == "cable_label") cable_label = svalue;
-    if (TankPMTLegendEntries.at(i) == "detector_status") detector_status = svalue;
+    if (TankPMTLegendEntries.at(i) == "detector_status") rec.detector_status = svalue;
   }
 
+  if(record_snapshot) snapshot.tankpmts.push_back(rec);
+  return this->AddTankPMTRecord(rec);
+}
+
+bool LoadGeometry::AddTankPMTRecord(const TankPMTGeoRecord &rec){
   //Parse out the Detector Status for filling into Detector class
   detectorstatus detstatus = detectorstatus::OFF;
   channelstatus chanstatus = channelstatus::OFF;
-  if(detector_status == "ON"){
+  if(rec.detector_status == "ON"){
     detstatus = detectorstatus::ON;
     chanstatus = channelstatus::ON;
   }
-  else if(detector_status == "OFF"){
+  else if(rec.detector_status == "OFF"){
     detstatus = detectorstatus::OFF;
     chanstatus = channelstatus::OFF;
   }
-  else if(detector_status == "UNSTABLE"){
+  else if(rec.detector_status == "UNSTABLE"){
     detstatus = detectorstatus::UNSTABLE;
     chanstatus = channelstatus::UNSTABLE;
   }
   else {
     Log("LoadGeometry Tool: Undefined status of Tank PMT detector",v_error,verbosity);
-    if (verbosity > v_error) std::cout << "channel_num is " << channel_num << std::endl;
+    if (verbosity > v_error) std::cout << "channel_num is " << rec.channel_num << std::endl;
   }
 
   //FIXME: things that are not loaded in with the default det/channel format:
   //      - panel_number
 
   if(verbosity>4) std::cout << "Filling a Tank PMT data line into Detector/Channel classes" << std::endl;
-  Detector adet(detector_num,
+  Detector adet(rec.detector_num,
                 "Tank",
-                detector_tank_location,
-                Position( x_pos,
-                          y_pos,
-                          z_pos),
-                Direction(x_dir,
-                          y_dir,
-                          z_dir),
-                PMT_type,
+                rec.detector_tank_location,
+                Position( rec.x_pos,
+                          rec.y_pos,
+                          rec.z_pos),
+                Direction(rec.x_dir,
+                          rec.y_dir,
+                          rec.z_dir),
+                rec.PMT_type,
                 detstatus,
                 0.);
 
-  Channel pmtchannel( channel_num,
+  Channel pmtchannel( rec.channel_num,
                       Position(0,0,0.),
                       -1, // stripside
                       -1, // stripnum
-                      signal_crate,
-                      signal_slot,
-                      signal_channel,
-                      mt_crate,
-                      mt_slot,
-                      mt_channel,
-                      hv_crate,
-                      hv_slot,
-                      hv_channel,
+                      rec.signal_crate,
+                      rec.signal_slot,
+                      rec.signal_channel,
+                      rec.mt_crate,
+                      rec.mt_slot,
+                      rec.mt_channel,
+                      rec.hv_crate,
+                      rec.hv_slot,
+                      rec.hv_channel,
                       chanstatus); //channel status same as detector status here
 
   // Also add this channel to the Tank PMT electronics map
-  std::vector<int> crate_map{signal_crate,signal_slot,signal_channel};
+  std::vector<int> crate_map{rec.signal_crate,rec.signal_slot,rec.signal_channel};
   if(TankPMTCrateSpaceToChannelNumMap->count(crate_map)==0){
-    TankPMTCrateSpaceToChannelNumMap->emplace(crate_map, channel_num);
-    ChannelNumToTankPMTCrateSpaceMap->emplace(channel_num,crate_map);
+    TankPMTCrateSpaceToChannelNumMap->emplace(crate_map, rec.channel_num);
+    ChannelNumToTankPMTCrateSpaceMap->emplace(rec.channel_num,crate_map);
   } else {
     Log("LoadGeometry Tool: ERROR: Tried assigning a Tank PMT channel_num to a crate space already defined!!! ",v_error, verbosity);
-    Log("LoadGeometry Tool: ERROR DETAILS: Signal Crate = "+std::to_string(signal_crate)+", Signal Slot = "+std::to_string(signal_slot)+", Signal Channel = "+std::to_string(signal_channel),v_error,verbosity);
+    Log("LoadGeometry Tool: ERROR DETAILS: Signal Crate = "+std::to_string(rec.signal_crate)+", Signal Slot = "+std::to_string(rec.signal_slot)+", Signal Channel = "+std::to_string(rec.signal_channel),v_error,verbosity);
   }
 
   // Add this channel to the geometry
-  if(verbosity>4) cout<<"Adding channel "<<channel_num<<" to detector "<<detector_num<<endl;
+  if(verbosity>4) cout<<"Adding channel "<<rec.channel_num<<" to detector "<<rec.detector_num<<endl;
   adet.AddChannel(pmtchannel);
   if(verbosity>5) cout<<"Adding detector to Geometry"<<endl;
   AnnieGeometry->AddDetector(adet);
@@ -682,12 +752,7 @@ void LoadGeometry::LoadLAPPDs(){
 bool LoadGeometry::ParseLAPPDDataEntry(std::vector<std::string> SpecLine,
         std::vector<std::string> LAPPDLegendEntries){
   //Parse the line for information needed to fill the detector & channel classes
-   int detector_num = 0,channel_strip_side = 0,channel_strip_num = 0;
-   unsigned int channel_signal_crate = 0,channel_signal_card = 0,channel_signal_channel = 0,channel_level2_crate = 0,channel_level2_card = 0,channel_level2_channel = 0,channel_hv_crate = 0,
-   channel_hv_card = 0,channel_hv_channel = 0,channel_num = 0;
-   double detector_position_x = 0.0,detector_position_y = 0.0,detector_position_z = 0.0,detector_direction_x = 0.0,detector_direction_y = 0.0,detector_direction_z = 0.0,
-   channel_position_x = 0.0,channel_position_y = 0.0,channel_position_z = 0.0;
-   std::string detector_type = "default",detector_status = "default",channel_status = "default";
+  LAPPDGeoRecord rec;
   //Search for Legend entry.  Fill value type if found.
   Log("LoadGeometry tool: parsing data line into variables",v_debug,verbosity);
   for (unsigned int i=0; i<SpecLine.size(); i++){
@@ -720,111 +785,116 @@ bool LoadGeometry::ParseLAPPDDataEntry(std::vector<std::string> SpecLine,
       }
     }
     //Integers
-    if (LAPPDLegendEntries.at(i) == "detector_num") detector_num = ivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_strip_side") channel_strip_side = ivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_strip_num") channel_strip_num = ivalue;
+    if (LAPPDLegendEntries.at(i) == "detector_num") rec.detector_num = ivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_strip_side") rec.channel_strip_side = ivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_strip_num") rec.channel_strip_num = ivalue;
 
     //Unsigned Integers
-    if (LAPPDLegendEntries.at(i) == "channel_signal_crate") channel_signal_crate = uivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_signal_card") channel_signal_card = uivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_signal_channel") channel_signal_channel = uivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_level2_crate") channel_level2_crate = uivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_level2_card") channel_level2_card = uivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_level2_channel") channel_level2_channel = uivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_hv_crate") channel_hv_crate = uivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_hv_card") channel_hv_card = uivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_hv_channel") channel_hv_channel = uivalue;
-    if (LAPPDLegendEntries.at(i) == "channel_num") channel_num = uivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_signal_crate") rec.channel_signal_crate = uivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_signal_card") rec.channel_signal_card = uivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_signal_channel") rec.channel_signal_channel = uivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_level2_crate") rec.channel_level2_crate = uivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_level2_card") rec.channel_level2_card = uivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_level2_channel") rec.channel_level2_channel = uivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_hv_crate") rec.channel_hv_crate = uivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_hv_card") rec.channel_hv_card = uivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_hv_channel") rec.channel_hv_channel = uivalue;
+    if (LAPPDLegendEntries.at(i) == "channel_num") rec.channel_num = uivalue;
 
     //Doubles
-    if (LAPPDLegendEntries.at(i) == "detector_position_x") detector_position_x = dvalue;
-    if (LAPPDLegendEntries.at(i) == "detector_position_y") detector_position_y = dvalue;
-    if (LAPPDLegendEntries.at(i) == "detector_position_z") detector_position_z = dvalue;
-    if (LAPPDLegendEntries.at(i) == "detector_direction_x") detector_direction_x = dvalue;
-    if (LAPPDLegendEntries.at(i) == "detector_direction_y") detector_direction_y = dvalue;
-    if (LAPPDLegendEntries.at(i) == "detector_direction_z") detector_direction_z = dvalue;
-    if (LAPPDLegendEntries.at(i) == "channel_position_x") channel_position_x = dvalue;
-    if (LAPPDLegendEntries.at(i) == "channel_position_y") channel_position_y = dvalue;
-    if (LAPPDLegendEntries.at(i) == "channel_position_z") channel_position_z = dvalue;
+    if (LAPPDLegendEntries.at(i) == "detector_position_x") rec.detector_position_x = dvalue;
+    if (LAPPDLegendEntries.at(i) == "detector_position_y") rec.detector_position_y = dvalue;
+    if (LAPPDLegendEntries.at(i) == "detector_position_z") rec.detector_position_z = dvalue;
+    if (LAPPDLegendEntries.at(i) == "detector_direction_x") rec.detector_direction_x = dvalue;
+    if (LAPPDLegendEntries.at(i) == "detector_direction_y") rec.detector_direction_y = dvalue;
+    if (LAPPDLegendEntries.at(i) == "detector_direction_z") rec.detector_direction_z = dvalue;
+    if (LAPPDLegendEntries.at(i) == "channel_position_x") rec.channel_position_x = dvalue;
+    if (LAPPDLegendEntries.at(i) == "channel_position_y") rec.channel_position_y = dvalue;
+    if (LAPPDLegendEntries.at(i) == "channel_position_z") rec.channel_position_z = dvalue;
 
     //Strings
-    if (LAPPDLegendEntries.at(i) == "detector_type") detector_type = svalue;
-    if (LAPPDLegendEntries.at(i) == "detector_status") detector_status = svalue;
-    if (LAPPDLegendEntries.at(i) == "channel_status") channel_status = svalue;
+    if (LAPPDLegendEntries.at(i) == "detector_type") rec.detector_type = svalue;
+    if (LAPPDLegendEntries.at(i) == "detector_status") rec.detector_status = svalue;
+    if (LAPPDLegendEntries.at(i) == "channel_status") rec.channel_status = svalue;
   }
 
+  if(record_snapshot) snapshot.lappds.push_back(rec);
+  return this->AddLAPPDRecord(rec);
+}
+
+bool LoadGeometry::AddLAPPDRecord(const LAPPDGeoRecord &rec){
   if(verbosity>4) std::cout << "Filling a LAPPD data line into Detector/Channel classes" << std::endl;
-  if(detector_num != detector_num_store){
+  if(rec.detector_num != detector_num_store){
   detectorstatus detstat = detectorstatus::OFF;
-  if(detector_status == "OFF"){
+  if(rec.detector_status == "OFF"){
     detstat = detectorstatus::OFF;
     }
-    else if(detector_status == "ON"){
+    else if(rec.detector_status == "ON"){
       detstat = detectorstatus::ON;
     }
-    else if(detector_status == "UNSTABLE"){
+    else if(rec.detector_status == "UNSTABLE"){
       detstat = detectorstatus::UNSTABLE;
     }
     else{
       std::cerr << "The chosen detector status isn't available!!!" << std::endl;
     }
   //TODO Somewhere it has to be stated that the units are in [m] for LAPPDs for now
-  adet = new Detector(464+detector_num,
+  adet = new Detector(464+rec.detector_num,
                 "LAPPD",
                 "Barrel",
-                Position(detector_position_x,
-                        detector_position_y,
-                        detector_position_z),
-                Direction(detector_direction_x,
-                          detector_direction_y,
-                          detector_direction_z),
-                detector_type,
+                Position(rec.detector_position_x,
+                        rec.detector_position_y,
+                        rec.detector_position_z),
+                Direction(rec.detector_direction_x,
+                          rec.detector_direction_y,
+                          rec.detector_direction_z),
+                rec.detector_type,
                 detstat,
                 0.);
-  detector_num_store = detector_num;
+  detector_num_store = rec.detector_num;
   }
 
   channelstatus channelstat = channelstatus::OFF;
-  if(channel_status == "OFF"){
+  if(rec.channel_status == "OFF"){
       channelstat = channelstatus::OFF;
       }
-  else if(channel_status == "ON"){
+  else if(rec.channel_status == "ON"){
       channelstat = channelstatus::ON;
         }
-  else if(channel_status == "UNSTABLE"){
+  else if(rec.channel_status == "UNSTABLE"){
       channelstat = channelstatus::UNSTABLE;
       }
   else{
   std::cerr << "The chosen channel status isn't available!!!" << std::endl;
       }
-  Channel lappdchannel(464+channel_num,
-                      Position(channel_position_x,
-                               channel_position_y,
-                               channel_position_z),
-                      channel_strip_side,
-                      channel_strip_num,
-                      channel_signal_crate,
-                      channel_signal_card,
-                      channel_signal_channel,
-                      channel_level2_crate,
-                      channel_level2_card,
-                      channel_level2_channel,
-                      channel_hv_crate,
-                      channel_hv_card,
-                      channel_hv_channel,
+  Channel lappdchannel(464+rec.channel_num,
+                      Position(rec.channel_position_x,
+                               rec.channel_position_y,
+                               rec.channel_position_z),
+                      rec.channel_strip_side,
+                      rec.channel_strip_num,
+                      rec.channel_signal_crate,
+                      rec.channel_signal_card,
+                      rec.channel_signal_channel,
+                      rec.channel_level2_crate,
+                      rec.channel_level2_card,
+                      rec.channel_level2_channel,
+                      rec.channel_hv_crate,
+                      rec.channel_hv_card,
+                      rec.channel_hv_channel,
                       channelstat);
 
   // Also add this channel to the Tank PMT electronics map
-  std::vector<unsigned int> crate_map{channel_signal_crate,channel_signal_card,channel_signal_channel};
+  std::vector<unsigned int> crate_map{rec.channel_signal_crate,rec.channel_signal_card,rec.channel_signal_channel};
   if(LAPPDCrateSpaceToChannelNumMap->count(crate_map)==0){
-    LAPPDCrateSpaceToChannelNumMap->emplace(crate_map, channel_num);
+    LAPPDCrateSpaceToChannelNumMap->emplace(crate_map, rec.channel_num);
   } else {
     Log("LoadGeometry Tool: ERROR: Tried assigning a Tank PMT channel_num to a crate space already defined!!! ",v_error, verbosity);
   }
 
   // Add this channel to the detector
   if(adet != nullptr){
-  if(verbosity>4) cout<<"Adding channel "<<channel_num<<" to LAPPD "<<detector_num<<endl;
+  if(verbosity>4) cout<<"Adding channel "<<rec.channel_num<<" to LAPPD "<<rec.detector_num<<endl;
   adet->AddChannel(lappdchannel);
   }
   counter++;
@@ -885,6 +955,12 @@ void LoadGeometry::LoadTankPMTGains(){
       channelkey = std::stoi(DataEntries.at(0));
       SPECharge= std::stod(DataEntries.at(1));
       ChannelNumToTankPMTSPEChargeMap->emplace(channelkey,SPECharge);
+      if(record_snapshot){
+        TankPMTGainRecord gain;
+        gain.channelkey = channelkey;
+        gain.SPECharge = SPECharge;
+        snapshot.gains.push_back(gain);
+      }
     }
   }
   return;
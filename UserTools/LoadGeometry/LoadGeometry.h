@@ -6,6 +6,7 @@
 
 #include "Tool.h"
 #include "Geometry.h"
+#include "GeometrySnapshot.h"
 #include <boost/algorithm/string.hpp>
 
 class LoadGeometry: public Tool {
@@ -37,6 +38,14 @@ class LoadGeometry: public Tool {
                                std::vector<std::string> AuxChannelLegendEntries);
   void LoadTankPMTGains();
 
+  //Build the geometry from parsed CSV lines; used by both the CSV parsing and the snapshot
+  void AddDetectorRecord(const DetectorGeoRecord &rec);
+  bool AddMRDRecord(const MRDGeoRecord &rec);
+  bool AddTankPMTRecord(const TankPMTGeoRecord &rec);
+  bool AddAuxChannelRecord(const AuxChannelGeoRecord &rec);
+  bool AddLAPPDRecord(const LAPPDGeoRecord &rec);
+  void LoadFromSnapshot();
+
   Geometry* AnnieGeometry;
 
 
@@ -52,6 +61,11 @@ class LoadGeometry: public Tool {
   std::string fAuxChannelFile;
   std::string fLAPPDGeoFile;
   std::string fDetectorGeoFile;
+  std::string fGeometrySnapshotFile;
+
+  //Parsed CSV lines are recorded here while a new snapshot is being made
+  GeometrySnapshot snapshot;
+  bool record_snapshot = false;
 
   //Labels used in Geometry files to mark the legend and data entries
   std::string LegendLineLabel = "LEGEND_LINE";
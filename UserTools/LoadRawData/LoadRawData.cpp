@@ -1,5 +1,11 @@
 #include "LoadRawData.h"
 
+#include <cstdio>
+#include <regex>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 LoadRawData::LoadRawData():Tool(){}
 
 
@@ -19,7 +25,29 @@ bool LoadRawData::Initialise(std::string configfile, DataModel &data){
   m_variables.Get("DummyRunInfo",DummyRunInfo);
 
   m_data= &data; //assigning transient data pointer
+
+  bool ResumeFromCheckpoint = true;
+  m_variables.Get("InputDirectory",InputDirectory);
+  m_variables.Get("InputFilePattern",InputFilePattern);
+  m_variables.Get("FileSettleSeconds",FileSettleSeconds);
+  m_variables.Get("PollSeconds",PollSeconds);
+  m_variables.Get("MaxIdleSeconds",MaxIdleSeconds);
+  m_variables.Get("CheckpointFile",CheckpointFile);
+  m_variables.Get("CheckpointEntries",CheckpointEntries);
+  m_variables.Get("CheckpointSeconds",CheckpointSeconds);
+  m_variables.Get("ResumeFromCheckpoint",ResumeFromCheckpoint);
   
+  if(Mode=="Online"){
+    if(InputDirectory==""){
+      Log("LoadRawData tool: ERROR Online mode needs an InputDirectory to watch",v_error,verbosity);
+      return false;
+    }
+    Log("LoadRawData tool: Running in online mode, reading new "+InputFilePattern+" part files from "+InputDirectory,v_message,verbosity);
+  } else if(CheckpointFile!=""){
+    Log("LoadRawData tool: Checkpoints are only written in online mode, CheckpointFile ignored",v_warning,verbosity);
+    CheckpointFile = "";
+  }
+
   if(Mode=="FileList"){
     if(verbosity>v_warning){
       std::cout << "LoadRawData tool: Running in file list mode. " <<
@@ -52,6 +80,19 @@ bool LoadRawData::Initialise(std::string configfile, DataModel &data){
   TrigEntriesCompleted = false;
 
   m_data->CStore.Set("FileProcessingComplete",false);
+  m_data->CStore.Set("WaitingForRawData",false);
+
+  //Tools downstream save their state into the Checkpoint store when SaveCheckpoint is set, and restore it
+  //in Initialise when ResumeFromCheckpoint is set, so LoadRawData has to be the first of them
+  bool resumed = false;
+  m_data->CStore.Set("CheckpointFile",CheckpointFile);
+  m_data->CStore.Set("SaveCheckpoint",false);
+  if(CheckpointFile!=""){
+    m_data->Stores["Checkpoint"] = new BoostStore(false,0);
+    if(ResumeFromCheckpoint) resumed = this->LoadCheckpoint();
+    LastCheckpoint = time(nullptr);
+  }
+  m_data->CStore.Set("ResumeFromCheckpoint",resumed);
   return true;
 }
 
@@ -59,6 +100,14 @@ bool LoadRawData::Initialise(std::string configfile, DataModel &data){
 bool LoadRawData::Execute(){
   m_data->CStore.Set("NewRawDataEntryAccessed",false);
   m_data->CStore.Set("NewRawDataFileAccessed",false);
+  m_data->CStore.Set("WaitingForRawData",false);
+  if(RestorePauseFlags){
+    m_data->CStore.Set("PauseTankDecoding",TankPaused);
+    m_data->CStore.Set("PauseMRDDecoding",MRDPaused);
+    m_data->CStore.Set("PauseCTCDecoding",CTCPaused);
+    RestorePauseFlags = false;
+  }
+  if(CheckpointFile!="") this->UpdateCheckpoint();
 
   //Check if we've reached the end of our file list or single file 
   bool ProcessingComplete = false;
@@ -113,6 +162,39 @@ bool LoadRawData::Execute(){
     FileCompleted = false;
   } 
   
+  else if (Mode == "Online"){
+    if(CurrentFile=="NONE"){
+      std::string NextFile = this->FindNextOnlineFile();
+      if(NextFile==""){
+        if(IdleSince==0) IdleSince = time(nullptr);
+        if(MaxIdleSeconds>0 && difftime(time(nullptr),IdleSince)>MaxIdleSeconds){
+          Log("LoadRawData Tool: No new raw data file for "+to_string(MaxIdleSeconds)+" s.  Ending toolchain after this loop.",v_message, verbosity);
+          m_data->vars.Set("StopLoop",1);
+          m_data->CStore.Set("FileProcessingComplete",true);
+          return true;
+        }
+        //Tools downstream skip this loop instead of treating the missing entry as the end of the data
+        Log("LoadRawData tool: Waiting for the next raw data file in "+InputDirectory,v_debug,verbosity);
+        m_data->CStore.Set("WaitingForRawData",true);
+        sleep(PollSeconds);
+        return true;
+      }
+      IdleSince = 0;
+      CurrentFile = NextFile;
+      m_data->CStore.Set("NewRawDataFileAccessed",true);
+    }
+    //Also reopens the file of a checkpoint, at the entries it was stopped
+    if(!FileLoaded){
+      Log("LoadRawData tool: Loading raw data file "+CurrentFile,v_message,verbosity);
+      RawData->Initialise(CurrentFile.c_str());
+      if(verbosity>4) RawData->Print(false);
+      this->LoadPMTMRDData();
+      this->LoadTriggerData();
+      this->LoadRunInformation();
+      FileLoaded = true;
+    }
+  }
+
   else if (Mode == "Processing"){
     std::string State;
     m_data->CStore.Get("State",State);
@@ -225,12 +307,21 @@ bool LoadRawData::Execute(){
     
   m_data->CStore.Set("NewRawDataEntryAccessed",true);
   m_data->CStore.Set("FileCompleted",FileCompleted);
+  EntriesSinceCheckpoint+=1;
   Log("LoadRawData tool: execution loop complete.",v_debug,verbosity);
   return true;
 }
 
 
 bool LoadRawData::Finalise(){
+  //The tools downstream have already added their state in the last loop
+  if(CheckpointPending) this->SaveCheckpointFile();
+  if(CheckpointFile!=""){
+    Log("LoadRawData tool: Wrote "+to_string(NumCheckpoints)+" checkpoints to "+CheckpointFile,v_message,verbosity);
+    m_data->Stores["Checkpoint"]->Delete();
+    delete m_data->Stores["Checkpoint"];
+    m_data->Stores.erase("Checkpoint");
+  }
   RawData->Close();
   RawData->Delete();
   delete RawData;
@@ -395,6 +486,13 @@ bool LoadRawData::InitializeNewFile(){
     m_data->vars.Set("StopLoop",1);
     EndOfProcessing = true;
   }
+  if (Mode == "Online"){
+    LastFileCode = this->RawFileCode(CurrentFile);
+    CurrentFile = "NONE";
+    FileLoaded = false;
+    FileCompleted = false;
+    Log("LoadRawData Tool: Raw file parsed. Looking for the next part file.",v_message, verbosity);
+  }
   //No need to stop the loop in continous mode
   if (Mode == "Continous"){
     Log("MRDDataDecoder Tool: Full raw file parsed. Waiting until next raw file is available.",v_message,verbosity);
@@ -430,8 +528,10 @@ void LoadRawData::GetNextDataEntries(){
     }
   }
 
-  //Get next TrigData Entry
-  if(BuildType == "TankAndMRDAndCTC" && !TrigEntriesCompleted && !CTCPaused){
+  //Get next TrigData Entry, unless TriggerDataDecoder still holds back words of the last one
+  bool CTCHeld = false;
+  m_data->CStore.Get("HoldCTCData",CTCHeld);
+  if(BuildType == "TankAndMRDAndCTC" && !TrigEntriesCompleted && !CTCPaused && !CTCHeld){
     Log("LoadRawData Tool: Procesing TrigData Entry "+to_string(TrigEntryNum)+"/"+to_string(trigtotalentries),v_debug, verbosity);
     TrigData->GetEntry(TrigEntryNum);
     TrigData->Get("TrigData",*Tdata);
@@ -440,3 +540,127 @@ void LoadRawData::GetNextDataEntries(){
   }
   return;
 }
+
+long LoadRawData::RawFileCode(std::string filename){
+  static const std::regex expression(".*R([0-9]+)S([0-9]+)[pP]([0-9]+)$");
+  std::smatch submatches;
+  if(!std::regex_match(filename,submatches,expression)) return -1;
+  //Same ordering as OrganizeRunParts: run, then subrun, then part
+  return std::stol(submatches[1])*1000000L + (std::stol(submatches[2])+1)*1000L + std::stol(submatches[3]);
+}
+
+std::string LoadRawData::FindNextOnlineFile(){
+  DIR* dir = opendir(InputDirectory.c_str());
+  if(dir==nullptr){
+    Log("LoadRawData tool: ERROR cannot read input directory "+InputDirectory,v_error,verbosity);
+    return "";
+  }
+  std::map<long,std::string> NewFiles;
+  struct dirent* entry;
+  while((entry = readdir(dir))!=nullptr){
+    std::string filename = entry->d_name;
+    if(filename.compare(0,InputFilePattern.size(),InputFilePattern)!=0) continue;
+    long code = this->RawFileCode(filename);
+    if(code>LastFileCode) NewFiles.emplace(code,InputDirectory+"/"+filename);
+  }
+  closedir(dir);
+  if(NewFiles.empty()) return "";
+
+  //A part is complete once the DAQ has started a later one, or when it has not been written to for a while
+  std::string NextFile = NewFiles.begin()->second;
+  if(NewFiles.size()>1) return NextFile;
+  struct stat filestat;
+  if(stat(NextFile.c_str(),&filestat)!=0) return "";
+  if(difftime(time(nullptr),filestat.st_mtime)<FileSettleSeconds) return "";
+  return NextFile;
+}
+
+void LoadRawData::UpdateCheckpoint(){
+  m_data->CStore.Set("SaveCheckpoint",false);
+  if(CheckpointPending) this->SaveCheckpointFile();
+
+  time_t now = time(nullptr);
+  if(EntriesSinceCheckpoint==0) return;
+  if(EntriesSinceCheckpoint<CheckpointEntries && difftime(now,LastCheckpoint)<CheckpointSeconds) return;
+
+  //The snapshot is taken before anything is read in this loop, so every tool saves its state
+  //as it was at the end of the last loop.  It is written at the start of the next loop.
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  Checkpoint->Delete();
+  Checkpoint->Set("CheckpointVersion",1);
+  Checkpoint->Set("RawDataFile",CurrentFile);
+  Checkpoint->Set("LastFileCode",LastFileCode);
+  Checkpoint->Set("FileCompleted",FileCompleted);
+  Checkpoint->Set("TankEntryNum",TankEntryNum);
+  Checkpoint->Set("MRDEntryNum",MRDEntryNum);
+  Checkpoint->Set("TrigEntryNum",TrigEntryNum);
+  Checkpoint->Set("TankEntriesCompleted",TankEntriesCompleted);
+  Checkpoint->Set("MRDEntriesCompleted",MRDEntriesCompleted);
+  Checkpoint->Set("TrigEntriesCompleted",TrigEntriesCompleted);
+  bool paused = false;
+  m_data->CStore.Get("PauseTankDecoding",paused);
+  Checkpoint->Set("PauseTankDecoding",paused);
+  paused = false;
+  m_data->CStore.Get("PauseMRDDecoding",paused);
+  Checkpoint->Set("PauseMRDDecoding",paused);
+  paused = false;
+  m_data->CStore.Get("PauseCTCDecoding",paused);
+  Checkpoint->Set("PauseCTCDecoding",paused);
+
+  m_data->CStore.Set("SaveCheckpoint",true);
+  CheckpointPending = true;
+  EntriesSinceCheckpoint = 0;
+  LastCheckpoint = now;
+}
+
+void LoadRawData::SaveCheckpointFile(){
+  //Written to a temporary file first, so a crash while writing leaves the previous checkpoint intact
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  std::string TempFile = CheckpointFile+".tmp";
+  Checkpoint->Save(TempFile);
+  if(std::rename(TempFile.c_str(),CheckpointFile.c_str())!=0){
+    Log("LoadRawData tool: ERROR could not write checkpoint "+CheckpointFile,v_error,verbosity);
+  } else {
+    NumCheckpoints+=1;
+    Log("LoadRawData tool: Checkpoint written at "+CurrentFile+", PMT entry "+to_string(TankEntryNum)+
+        ", MRD entry "+to_string(MRDEntryNum)+", CTC entry "+to_string(TrigEntryNum),v_message,verbosity);
+  }
+  Checkpoint->Delete();
+  CheckpointPending = false;
+}
+
+bool LoadRawData::LoadCheckpoint(){
+  std::ifstream test(CheckpointFile.c_str());
+  if(!test.good()){
+    Log("LoadRawData tool: No checkpoint "+CheckpointFile+" found, starting from the first raw file",v_message,verbosity);
+    return false;
+  }
+  test.close();
+
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  Checkpoint->Initialise(CheckpointFile);
+  int version = 0;
+  Checkpoint->Get("CheckpointVersion",version);
+  if(version!=1){
+    Log("LoadRawData tool: ERROR checkpoint "+CheckpointFile+" is not readable, starting from the first raw file",v_error,verbosity);
+    Checkpoint->Delete();
+    return false;
+  }
+  Checkpoint->Get("RawDataFile",CurrentFile);
+  Checkpoint->Get("LastFileCode",LastFileCode);
+  Checkpoint->Get("FileCompleted",FileCompleted);
+  Checkpoint->Get("TankEntryNum",TankEntryNum);
+  Checkpoint->Get("MRDEntryNum",MRDEntryNum);
+  Checkpoint->Get("TrigEntryNum",TrigEntryNum);
+  Checkpoint->Get("TankEntriesCompleted",TankEntriesCompleted);
+  Checkpoint->Get("MRDEntriesCompleted",MRDEntriesCompleted);
+  Checkpoint->Get("TrigEntriesCompleted",TrigEntriesCompleted);
+  //The decoders reset the pause flags in their Initialise, so they are set again in the first Execute
+  Checkpoint->Get("PauseTankDecoding",TankPaused);
+  Checkpoint->Get("PauseMRDDecoding",MRDPaused);
+  Checkpoint->Get("PauseCTCDecoding",CTCPaused);
+  RestorePauseFlags = true;
+  Log("LoadRawData tool: Resuming from checkpoint at "+CurrentFile+", PMT entry "+to_string(TankEntryNum)+
+      ", MRD entry "+to_string(MRDEntryNum)+", CTC entry "+to_string(TrigEntryNum),v_message,verbosity);
+  return true;
+}
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <iostream>
+#include <ctime>
 
 #include "Tool.h"
 #include "CardData.h"
@@ -33,6 +34,10 @@ class LoadRawData: public Tool {
   void LoadRunInformation();
   void GetNextDataEntries();
   bool InitializeNewFile(); 
+  std::string FindNextOnlineFile();   ///< Oldest raw part file in InputDirectory newer than the last processed one, "" if none is complete yet
+  void UpdateCheckpoint();           ///< Write the snapshot of the last loop, and start a new one if it is time
+  void SaveCheckpointFile();
+  bool LoadCheckpoint();
 
  private:
 
@@ -43,6 +48,27 @@ class LoadRawData: public Tool {
   std::string Mode;
   std::string InputFile;
   std::vector<std::string> OrganizeRunParts(std::string InputFile); //Parses all run files in InputFile and returns a vector of file paths organized by part
+  long RawFileCode(std::string filename); //run/subrun/part of a raw file name as one sortable number, -1 if the name does not match
+
+  //Online mode: new part files are picked up from InputDirectory as the DAQ writes them
+  std::string InputDirectory;
+  std::string InputFilePattern = "RAWData";
+  int FileSettleSeconds = 60;   //the newest part file is only read once it has not changed for this long
+  int PollSeconds = 10;         //wait between directory scans when no file is ready
+  int MaxIdleSeconds = 0;       //stop the toolchain after waiting this long for a new file, 0: never
+  long LastFileCode = -1;       //code of the last file that was fully processed
+  bool FileLoaded = false;
+  time_t IdleSince = 0;
+
+  //Checkpointing: the decoding and building state of all tools is saved in the Checkpoint store
+  std::string CheckpointFile;
+  int CheckpointEntries = 1000;  //loops with new entries between checkpoints
+  int CheckpointSeconds = 300;
+  int EntriesSinceCheckpoint = 0;
+  time_t LastCheckpoint = 0;
+  bool CheckpointPending = false;
+  bool RestorePauseFlags = false;
+  int NumCheckpoints = 0;
 
 
   int FileNum = 0;
@@ -25,6 +25,10 @@ bool MRDDataDecoder::Initialise(std::string configfile, DataModel &data){
   m_data->CStore.Set("NewMRDDataAvailable",false);
 
   m_data->CStore.Set("PauseMRDDecoding",false);
+
+  bool ResumeFromCheckpoint = false;
+  m_data->CStore.Get("ResumeFromCheckpoint",ResumeFromCheckpoint);
+  if(ResumeFromCheckpoint) this->LoadCheckpoint();
   Log("MRDDataDecoder Tool: Initialized successfully",v_message,verbosity);
   return true;
 }
@@ -33,6 +37,13 @@ bool MRDDataDecoder::Initialise(std::string configfile, DataModel &data){
 bool MRDDataDecoder::Execute(){
   m_data->CStore.Set("NewMRDDataAvailable",false);
 
+  bool CheckpointRequested = false;
+  m_data->CStore.Get("SaveCheckpoint",CheckpointRequested);
+  if(CheckpointRequested) this->SaveCheckpoint();
+  bool WaitingForRawData = false;
+  m_data->CStore.Get("WaitingForRawData",WaitingForRawData);
+  if(WaitingForRawData) return true;
+
   bool NewEntryAvailable;
   m_data->CStore.Get("NewRawDataEntryAccessed",NewEntryAvailable);
   if(!NewEntryAvailable){ //Something went wrong processing raw data.  Stop and save what's left
@@ -136,3 +147,37 @@ bool MRDDataDecoder::Finalise(){
   Log("MRDDataDecoder tool exitting",v_message,verbosity);
   return true;
 }
+
+void MRDDataDecoder::SaveCheckpoint(){
+  //The decoded MRD events live in the CStore until ANNIEEventBuilder has built them
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  std::map<uint64_t, std::vector<std::pair<unsigned long, int> > > Events;
+  std::map<uint64_t, std::string> TriggerTypes;
+  std::map<uint64_t, int> BeamLoopback;
+  std::map<uint64_t, int> CosmicLoopback;
+  m_data->CStore.Get("MRDEvents",Events);
+  m_data->CStore.Get("MRDEventTriggerTypes",TriggerTypes);
+  m_data->CStore.Get("MRDBeamLoopback",BeamLoopback);
+  m_data->CStore.Get("MRDCosmicLoopback",CosmicLoopback);
+  Checkpoint->Set("MRDEvents",Events);
+  Checkpoint->Set("MRDEventTriggerTypes",TriggerTypes);
+  Checkpoint->Set("MRDBeamLoopback",BeamLoopback);
+  Checkpoint->Set("MRDCosmicLoopback",CosmicLoopback);
+}
+
+void MRDDataDecoder::LoadCheckpoint(){
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  std::map<uint64_t, std::vector<std::pair<unsigned long, int> > > Events;
+  std::map<uint64_t, std::string> TriggerTypes;
+  std::map<uint64_t, int> BeamLoopback;
+  std::map<uint64_t, int> CosmicLoopback;
+  if(!Checkpoint->Get("MRDEvents",Events)) return;
+  Checkpoint->Get("MRDEventTriggerTypes",TriggerTypes);
+  Checkpoint->Get("MRDBeamLoopback",BeamLoopback);
+  Checkpoint->Get("MRDCosmicLoopback",CosmicLoopback);
+  m_data->CStore.Set("MRDEvents",Events);
+  m_data->CStore.Set("MRDEventTriggerTypes",TriggerTypes);
+  m_data->CStore.Set("MRDBeamLoopback",BeamLoopback);
+  m_data->CStore.Set("MRDCosmicLoopback",CosmicLoopback);
+  Log("MRDDataDecoder Tool: Resumed with "+to_string(Events.size())+" MRD events waiting to be built",v_message,verbosity);
+}
@@ -34,6 +34,8 @@ class MRDDataDecoder: public Tool {
   bool Initialise(std::string configfile,DataModel &data); ///< Initialise Function for setting up Tool resources. @param configfile The path and name of the dynamic configuration file to read in. @param data A reference to the transient data class used to pass information between Tools.
   bool Execute(); ///< Execute function used to perform Tool purpose.
   bool Finalise(); ///< Finalise function used to clean up resources.
+  void SaveCheckpoint();   ///< Add the MRD events waiting to be built to the Checkpoint store (LoadRawData Online mode)
+  void LoadCheckpoint();
 
  private:
 
@@ -36,6 +36,26 @@ bool MonitorMRDTime::Initialise(std::string configfile, DataModel &data){
   m_variables.Get("DrawSingle",draw_single);
   m_variables.Get("verbose",verbosity);
 
+  //multi-resolution history for long time frames (default: off, read daily ROOT files)
+  use_history = false;
+  history_levels = "60,600,3600,86400";
+  history_max_points = 500;
+  history_min_timeframe = 6.;
+  history_backfill_days = 0.;
+  m_variables.Get("UseHistory",use_history);
+  m_variables.Get("HistoryLevels",history_levels);
+  m_variables.Get("HistoryMaxPoints",history_max_points);
+  m_variables.Get("HistoryMinTimeFrame",history_min_timeframe);
+  m_variables.Get("HistoryBackfillDays",history_backfill_days);
+
+  //asynchronous rendering of the plots in a separate thread (default: off, draw within Execute)
+  async_render = false;
+  render_queue_size = 8;
+  m_variables.Get("AsyncRender",async_render);
+  m_variables.Get("RenderQueueSize",render_queue_size);
+  if (render_queue_size < 1) render_queue_size = 1;
+  if (async_render) ROOT::EnableThreadSafety();
+
   if (verbosity > 1) std::cout <<"Tool MonitorMRDTime: Initialising...."<<std::endl;
 
   //Update frequency specifies the frequency at which the File Log Histogram is updated
@@ -223,6 +243,22 @@ bool MonitorMRDTime::Initialise(std::string configfile, DataModel &data){
 
   ReadInConfiguration();
 
+  //-------------------------------------------------------
+  //----------Open multi-resolution history----------------
+  //-------------------------------------------------------
+
+  if (use_history) InitializeHistory();
+
+  //-------------------------------------------------------
+  //----------Start render thread (if enabled)-------------
+  //-------------------------------------------------------
+
+  if (async_render){
+    render_queue = new AsyncRenderQueue<MonitorMRDTimeSnapshot>();
+    render_queue->Start([this](const std::string &plot_type, const MonitorMRDTimeSnapshot &snapshot){RenderSnapshot(plot_type,snapshot);},render_queue_size);
+    if (verbosity > 1) std::cout <<"MonitorMRDTime: Rendering plots asynchronously, render queue size "<<render_queue_size<<std::endl;
+  }
+
   //-------------------------------------------------------
   //------Setup time variables for periodic updates--------
   //-------------------------------------------------------
@@ -277,8 +313,12 @@ bool MonitorMRDTime::Execute(){
    	if (verbosity > 1) std::cout<<"MRDMonitorTime: New data file available."<<std::endl;
 
     //Setting print to false is necessary in order for it to work properly
-    m_data->Stores["CCData"]->Get("FileData",MRDdata);
-    MRDdata->Print(false);
+    MRDstream = nullptr;
+    if (m_data->Stores["CCData"]->Has("StreamData")) m_data->Stores["CCData"]->Get("StreamData",MRDstream);
+    else {
+      m_data->Stores["CCData"]->Get("FileData",MRDdata);
+      MRDdata->Print(false);
+    }
     bool_mrddata = true;
 
     //Read in information from MRD file store, fill into the storing containers (vectors)
@@ -290,10 +330,10 @@ bool MonitorMRDTime::Execute(){
     WriteToFile();
 
     //Plot plots only associated to current file
-    DrawLastFilePlots();
+    PublishLastFilePlots();
 
     //Draw customly defined plots
-    UpdateMonitorPlots(config_timeframes, config_endtime_long, config_label, config_plottypes);
+    PublishMonitorPlots();
 
    }else {
 
@@ -307,7 +347,7 @@ bool MonitorMRDTime::Execute(){
 
    // if force_update is specified, the plots will be updated no matter whether there has been a new file or not
 
-   if (force_update) UpdateMonitorPlots(config_timeframes, config_endtime_long, config_label, config_plottypes);
+   if (force_update) PublishMonitorPlots();
 
   //-------------------------------------------------------------
   //---Has enough time passed for updating File history plot?----
@@ -315,9 +355,7 @@ bool MonitorMRDTime::Execute(){
 
   if(duration>=period_update){
     last=current;
-    DrawFileHistory(current_stamp,24.,"current_24h",1);     //show 24h history of MRD files
-    PrintFileTimeStamp(current_stamp,24.,"current_24h");
-    DrawFileHistory(current_stamp,2.,"current_2h",3);     //show 2h history of MRD files
+    PublishFileHistory();
   }
 
   
@@ -336,11 +374,26 @@ bool MonitorMRDTime::Finalise(){
 
   //if (bool_mrddata) MRDdata->Delete();
 
+  //render the plots still waiting in the queue before deleting the objects they use
+  if (render_queue){
+    render_queue->Stop(true);
+    if (verbosity > 1) std::cout <<"MonitorMRDTime: Render queue: "<<render_queue->GetNumPublished()<<" snapshots published, "<<render_queue->GetNumRendered()<<" rendered, "<<render_queue->GetNumReplaced()<<" replaced by newer snapshots, "<<render_queue->GetNumDropped()<<" dropped"<<std::endl;
+    delete render_queue;
+    render_queue = nullptr;
+  }
+
   //delete all the pointer to objects that are still active
 
   //timing pointers
   delete Epoch;
 
+  //monitoring history
+  if (history) {
+    history->Close();
+    delete history;
+    history = nullptr;
+  }
+
   //other objects
   delete label_cr1;
   delete label_cr2;
@@ -528,7 +581,8 @@ void MonitorMRDTime::ReadInData(){
   if (verbosity > 1) std::cout <<"MonitorMRDTime: ReadInData..."<<std::endl;
   t_file_end = 0;
   int total_number_entries;  
-  MRDdata->Header->Get("TotalEntries",total_number_entries);
+  if (MRDstream) total_number_entries = MRDstream->size();
+  else MRDdata->Header->Get("TotalEntries",total_number_entries);
   if (verbosity > 1) std::cout <<"MonitorMRDTime: MRDdata file total entries: "<<total_number_entries<<std::endl;
   int count=0;
 
@@ -538,8 +592,11 @@ void MonitorMRDTime::ReadInData(){
     std::vector<int> tdc_file_times_single;
 
     //get MRDout data
-    MRDdata->GetEntry(i_event);
-    MRDdata->Get("Data",MRDout);
+    if (MRDstream) MRDout = MRDstream->at(i_event);
+    else {
+      MRDdata->GetEntry(i_event);
+      MRDdata->Get("Data",MRDout);
+    }
 
     //get event time
     boost::posix_time::ptime eventtime;
@@ -624,6 +681,9 @@ void MonitorMRDTime::WriteToFile(){
 
   if (verbosity > 2) std::cout <<"MonitorMRDTime: WriteToFile..."<<std::endl;
 
+  //the render thread reads the same files/history in asynchronous mode
+  std::lock_guard<std::mutex> file_lock(monitoring_file_mutex);
+
   std::string file_start_date = convertTimeStamp_to_Date(t_file_start);
   std::stringstream root_filename;
   root_filename << path_monitoring << "MRD_" << file_start_date <<".root";
@@ -797,6 +857,14 @@ void MonitorMRDTime::WriteToFile(){
   t->Write("",TObject::kOverwrite);           //prevent ROOT from making endless keys for the same tree when updating the tree
   f->Close();
 
+  //update the rollups of the monitoring history incrementally with the new entry
+  if (history){
+    std::vector<std::vector<double>> channel_values{*tdc,*rms,*rate,std::vector<double>(channelcount->begin(),channelcount->end())};
+    std::vector<double> scalar_values{rate_cosmic,rate_beam,rate_noloopback,rate_normalhit,rate_doublehit,rate_zerohits,double(nevents),
+                                      double(n_cosmic),double(n_beam),double(n_noloopback),double(n_normalhits),double(n_doublehits),double(n_zerohits)};
+    if (!history->Add(t_start,t_end,channel_values,scalar_values)) std::cout <<"ERROR (MonitorMRDTime): WriteToFile: Could not add entry to monitoring history"<<std::endl;
+  }
+
   delete crate;
   delete slot;
   delete channel;
@@ -810,7 +878,9 @@ void MonitorMRDTime::WriteToFile(){
 
 }
 
-void MonitorMRDTime::ReadFromFile(ULong64_t timestamp_end, double time_frame){
+void MonitorMRDTime::ReadFromFile(ULong64_t timestamp_end, double time_frame, bool allow_history){
+
+  std::lock_guard<std::mutex> file_lock(monitoring_file_mutex);
 
   //-------------------------------------------------------
   //------------------ReadFromFile-------------------------
@@ -829,11 +899,26 @@ void MonitorMRDTime::ReadFromFile(ULong64_t timestamp_end, double time_frame){
   doublehitrate_plot.clear();
   zerohitsrate_plot.clear();
   nevents_plot.clear();
+  cosmiccount_plot.clear();
+  beamcount_plot.clear();
+  noloopbackcount_plot.clear();
+  normalhitcount_plot.clear();
+  doublehitcount_plot.clear();
+  zerohitscount_plot.clear();
   labels_timeaxis.clear();
 
   //take the end time and calculate the start time with the given time_frame
   ULong64_t timestamp_start = timestamp_end - time_frame*MIN_to_HOUR*SEC_to_MIN*MSEC_to_SEC;
 
+  //long time frames are read from the pre-aggregated rollups instead of scanning the daily files
+  if (history && allow_history && time_frame >= history_min_timeframe){
+    ReadFromHistory(timestamp_start,timestamp_end);
+    readfromfile_tend = timestamp_end;
+    readfromfile_timeframe = time_frame;
+    readfromfile_history = true;
+    return;
+  }
+
   boost::posix_time::ptime starttime = *Epoch + boost::posix_time::time_duration(int(timestamp_start/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(timestamp_start/MSEC_to_SEC/SEC_to_MIN)%60,int(timestamp_start/MSEC_to_SEC/1000.)%60,timestamp_start%1000);
   struct tm starttime_tm = boost::posix_time::to_tm(starttime);
   boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(timestamp_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(timestamp_end/MSEC_to_SEC/SEC_to_MIN)%60,int(timestamp_end/MSEC_to_SEC/1000.)%60,timestamp_end%1000);
@@ -953,6 +1038,14 @@ void MonitorMRDTime::ReadFromFile(ULong64_t timestamp_end, double time_frame){
             doublehitrate_plot.push_back(rate_doublehit);
             zerohitsrate_plot.push_back(rate_zerohits);
             nevents_plot.push_back(nevents);
+            //the entries of the daily files cover one data file without gaps
+            double entry_seconds = (t_end-t_start)/MSEC_to_SEC;
+            cosmiccount_plot.push_back(rate_cosmic*entry_seconds);
+            beamcount_plot.push_back(rate_beam*entry_seconds);
+            noloopbackcount_plot.push_back(rate_noloopback*entry_seconds);
+            normalhitcount_plot.push_back(rate_normalhit*entry_seconds);
+            doublehitcount_plot.push_back(rate_doublehit*entry_seconds);
+            zerohitscount_plot.push_back(rate_zerohits*entry_seconds);
             boost::posix_time::ptime boost_tend = *Epoch+boost::posix_time::time_duration(int(t_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(t_end/MSEC_to_SEC/SEC_to_MIN)%60,int(t_end/MSEC_to_SEC/1000.)%60,t_end%1000);
             struct tm label_timestamp = boost::posix_time::to_tm(boost_tend);
             TDatime datime_timestamp(1900+label_timestamp.tm_year,label_timestamp.tm_mon+1,label_timestamp.tm_mday,label_timestamp.tm_hour,label_timestamp.tm_min,label_timestamp.tm_sec);
@@ -983,6 +1076,104 @@ void MonitorMRDTime::ReadFromFile(ULong64_t timestamp_end, double time_frame){
   //set the readfromfile time variables to make sure data is not read twice for the same time window
   readfromfile_tend = timestamp_end;
   readfromfile_timeframe = time_frame;
+  readfromfile_history = false;
+
+}
+
+void MonitorMRDTime::InitializeHistory(){
+
+  //-------------------------------------------------------
+  //------------------InitializeHistory--------------------
+  //-------------------------------------------------------
+
+  history = new MonitoringHistory();
+  history->AddChannelVariable("tdc",MonitoringHistory::kMean);
+  history->AddChannelVariable("rms",MonitoringHistory::kMean);
+  history->AddChannelVariable("rate",MonitoringHistory::kMean);
+  history->AddChannelVariable("channelcount",MonitoringHistory::kSum);
+  history->AddScalarVariable("rate_cosmic",MonitoringHistory::kMean);
+  history->AddScalarVariable("rate_beam",MonitoringHistory::kMean);
+  history->AddScalarVariable("rate_noloopback",MonitoringHistory::kMean);
+  history->AddScalarVariable("rate_normalhit",MonitoringHistory::kMean);
+  history->AddScalarVariable("rate_doublehit",MonitoringHistory::kMean);
+  history->AddScalarVariable("rate_zerohits",MonitoringHistory::kMean);
+  history->AddScalarVariable("nevents",MonitoringHistory::kSum);
+  history->AddScalarVariable("count_cosmic",MonitoringHistory::kSum);
+  history->AddScalarVariable("count_beam",MonitoringHistory::kSum);
+  history->AddScalarVariable("count_noloopback",MonitoringHistory::kSum);
+  history->AddScalarVariable("count_normalhit",MonitoringHistory::kSum);
+  history->AddScalarVariable("count_doublehit",MonitoringHistory::kSum);
+  history->AddScalarVariable("count_zerohits",MonitoringHistory::kSum);
+
+  std::stringstream ss_levels(history_levels);
+  std::string level_str;
+  while (std::getline(ss_levels,level_str,',')){
+    double level_sec = std::stod(level_str);
+    if (level_sec > 0.) history->AddLevel((uint64_t) (level_sec*MSEC_to_SEC));
+  }
+
+  std::string history_prefix = path_monitoring+"MRD_history";
+  if (!history->Open(history_prefix,num_active_slots*num_channels)){
+    std::cout <<"ERROR (MonitorMRDTime): Could not open monitoring history "<<history_prefix<<". Continue reading the daily monitoring files."<<std::endl;
+    delete history;
+    history = nullptr;
+    return;
+  }
+
+  //Fill an empty history from the already existing daily monitoring files
+  if (history->IsEmpty() && history_backfill_days > 0.){
+    if (verbosity > 1) std::cout <<"MonitorMRDTime: InitializeHistory: Backfilling monitoring history with the last "<<history_backfill_days<<" days"<<std::endl;
+    boost::posix_time::time_duration now_duration(boost::posix_time::second_clock::local_time() - *Epoch);
+    ReadFromFile(now_duration.total_milliseconds(),history_backfill_days*HOUR_to_DAY,false);
+    for (unsigned int i_entry = 0; i_entry < tstart_plot.size(); i_entry++){
+      std::vector<std::vector<double>> channel_values{tdc_plot.at(i_entry),rms_plot.at(i_entry),rate_plot.at(i_entry),std::vector<double>(channelcount_plot.at(i_entry).begin(),channelcount_plot.at(i_entry).end())};
+      std::vector<double> scalar_values{cosmicrate_plot.at(i_entry),beamrate_plot.at(i_entry),noloopbackrate_plot.at(i_entry),normalhitrate_plot.at(i_entry),doublehitrate_plot.at(i_entry),zerohitsrate_plot.at(i_entry),double(nevents_plot.at(i_entry)),
+                                        cosmiccount_plot.at(i_entry),beamcount_plot.at(i_entry),noloopbackcount_plot.at(i_entry),normalhitcount_plot.at(i_entry),doublehitcount_plot.at(i_entry),zerohitscount_plot.at(i_entry)};
+      history->Add(tstart_plot.at(i_entry),tend_plot.at(i_entry),channel_values,scalar_values);
+    }
+    readfromfile_tend = 0;
+    readfromfile_timeframe = 0.;
+  }
+
+}
+
+void MonitorMRDTime::ReadFromHistory(ULong64_t timestamp_start, ULong64_t timestamp_end){
+
+  //-------------------------------------------------------
+  //------------------ReadFromHistory----------------------
+  //-------------------------------------------------------
+
+  std::vector<MonitoringHistoryPoint> points;
+  int level = history->Query(timestamp_start,timestamp_end,history_max_points,points);
+  if (verbosity > 2 && level >= 0) std::cout <<"MonitorMRDTime: ReadFromHistory: Using "<<history->GetLevelWidth(level)/MSEC_to_SEC<<" s rollups, "<<points.size()<<" points"<<std::endl;
+
+  for (unsigned int i_point = 0; i_point < points.size(); i_point++){
+    MonitoringHistoryPoint &point = points.at(i_point);
+    ULong64_t t_end = point.t_end;
+    tdc_plot.push_back(point.channel_values.at(0));
+    rms_plot.push_back(point.channel_values.at(1));
+    rate_plot.push_back(point.channel_values.at(2));
+    channelcount_plot.push_back(std::vector<int>(point.channel_values.at(3).begin(),point.channel_values.at(3).end()));
+    tstart_plot.push_back(point.t_start);
+    tend_plot.push_back(t_end);
+    cosmicrate_plot.push_back(point.scalar_values.at(0));
+    beamrate_plot.push_back(point.scalar_values.at(1));
+    noloopbackrate_plot.push_back(point.scalar_values.at(2));
+    normalhitrate_plot.push_back(point.scalar_values.at(3));
+    doublehitrate_plot.push_back(point.scalar_values.at(4));
+    zerohitsrate_plot.push_back(point.scalar_values.at(5));
+    nevents_plot.push_back(int(point.scalar_values.at(6)));
+    cosmiccount_plot.push_back(point.scalar_values.at(7));
+    beamcount_plot.push_back(point.scalar_values.at(8));
+    noloopbackcount_plot.push_back(point.scalar_values.at(9));
+    normalhitcount_plot.push_back(point.scalar_values.at(10));
+    doublehitcount_plot.push_back(point.scalar_values.at(11));
+    zerohitscount_plot.push_back(point.scalar_values.at(12));
+    boost::posix_time::ptime boost_tend = *Epoch+boost::posix_time::time_duration(int(t_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(t_end/MSEC_to_SEC/SEC_to_MIN)%60,int(t_end/MSEC_to_SEC/1000.)%60,t_end%1000);
+    struct tm label_timestamp = boost::posix_time::to_tm(boost_tend);
+    TDatime datime_timestamp(1900+label_timestamp.tm_year,label_timestamp.tm_mon+1,label_timestamp.tm_mday,label_timestamp.tm_hour,label_timestamp.tm_min,label_timestamp.tm_sec);
+    labels_timeaxis.push_back(datime_timestamp);
+  }
 
 }
 
@@ -1597,9 +1788,9 @@ void MonitorMRDTime::DrawFileHistory(ULong64_t timestamp_end, double time_frame,
   //Creates a plot showing the time stamps for all the files within the last time_frame mins
   //The plot is updated with the update_frequency specified in the configuration file (default: 5 mins)
 
-  if (timestamp_end != readfromfile_tend || time_frame != readfromfile_timeframe) ReadFromFile(timestamp_end, time_frame);
+  if (timestamp_end != readfromfile_tend || time_frame != readfromfile_timeframe || readfromfile_history) ReadFromFile(timestamp_end, time_frame, false);
 
-  timestamp_end += utc_to_t;
+  timestamp_end += plot_utc_to_t;
   ULong64_t timestamp_start = timestamp_end - time_frame*MSEC_to_SEC*SEC_to_MIN*MIN_to_HOUR;
 
   canvas_logfile_mrd->cd();
@@ -1609,8 +1800,8 @@ void MonitorMRDTime::DrawFileHistory(ULong64_t timestamp_end, double time_frame,
 
   std::vector<TLine*> file_markers;
   for (unsigned int i_file = 0; i_file < tend_plot.size(); i_file++){
-   if ((tend_plot.at(i_file)+utc_to_t)>=timestamp_start && (tend_plot.at(i_file)+utc_to_t)<=timestamp_end){
-      TLine *line_file = new TLine((tend_plot.at(i_file)+utc_to_t)/MSEC_to_SEC,0.,(tend_plot.at(i_file)+utc_to_t)/MSEC_to_SEC,1.);
+   if ((tend_plot.at(i_file)+plot_utc_to_t)>=timestamp_start && (tend_plot.at(i_file)+plot_utc_to_t)<=timestamp_end){
+      TLine *line_file = new TLine((tend_plot.at(i_file)+plot_utc_to_t)/MSEC_to_SEC,0.,(tend_plot.at(i_file)+plot_utc_to_t)/MSEC_to_SEC,1.);
       line_file->SetLineColor(1);
       line_file->SetLineStyle(1);
       line_file->SetLineWidth(_linewidth);
@@ -1686,6 +1877,110 @@ void MonitorMRDTime::PrintFileTimeStamp(ULong64_t timestamp_end, double time_fra
 }
 
 
+std::shared_ptr<MonitorMRDTimeSnapshot> MonitorMRDTime::MakeSnapshot(){
+
+  //-------------------------------------------------------
+  //------------------MakeSnapshot-------------------------
+  //-------------------------------------------------------
+
+  std::shared_ptr<MonitorMRDTimeSnapshot> snapshot(new MonitorMRDTimeSnapshot);
+  snapshot->t_file_start = t_file_start;
+  snapshot->t_file_end = t_file_end;
+  snapshot->utc_to_t = utc_to_t;
+  snapshot->current_stamp = current_stamp;
+  return snapshot;
+
+}
+
+void MonitorMRDTime::PublishLastFilePlots(){
+
+  //-------------------------------------------------------
+  //------------------PublishLastFilePlots-----------------
+  //-------------------------------------------------------
+
+  std::shared_ptr<MonitorMRDTimeSnapshot> snapshot = MakeSnapshot();
+  snapshot->tdc_file = tdc_file;
+  snapshot->timestamp_file = timestamp_file;
+  snapshot->tdc_file_times = tdc_file_times;
+
+  if (render_queue) render_queue->Publish("LastFile",snapshot);
+  else RenderSnapshot("LastFile",*snapshot);
+
+}
+
+void MonitorMRDTime::PublishMonitorPlots(){
+
+  //-------------------------------------------------------
+  //------------------PublishMonitorPlots------------------
+  //-------------------------------------------------------
+
+  if (!render_queue) {
+    RenderSnapshot("MonitorPlots",*MakeSnapshot());
+    return;
+  }
+
+  //one plot type per configured time frame, such that a pending update of one time frame is only replaced by a newer update of the same time frame
+  for (unsigned int i_time = 0; i_time < config_timeframes.size(); i_time++){
+    std::shared_ptr<MonitorMRDTimeSnapshot> snapshot = MakeSnapshot();
+    snapshot->config_index = i_time;
+    render_queue->Publish("TimeFrame_"+std::to_string(i_time),snapshot);
+  }
+
+}
+
+void MonitorMRDTime::PublishFileHistory(){
+
+  //-------------------------------------------------------
+  //------------------PublishFileHistory-------------------
+  //-------------------------------------------------------
+
+  if (render_queue) render_queue->Publish("FileHistory",MakeSnapshot());
+  else RenderSnapshot("FileHistory",*MakeSnapshot());
+
+}
+
+void MonitorMRDTime::RenderSnapshot(const std::string &plot_type, const MonitorMRDTimeSnapshot &snapshot){
+
+  //-------------------------------------------------------
+  //------------------RenderSnapshot-----------------------
+  //-------------------------------------------------------
+
+  if (verbosity > 2) std::cout <<"MonitorMRDTime: RenderSnapshot ("<<plot_type<<")"<<std::endl;
+
+  plot_file_start = snapshot.t_file_start;
+  plot_file_end = snapshot.t_file_end;
+  plot_utc_to_t = snapshot.utc_to_t;
+
+  if (plot_type == "LastFile"){
+
+    plot_tdc_file = snapshot.tdc_file;
+    plot_timestamp_file = snapshot.timestamp_file;
+    plot_tdc_file_times = snapshot.tdc_file_times;
+    DrawLastFilePlots();
+
+  } else if (plot_type == "FileHistory"){
+
+    DrawFileHistory(snapshot.current_stamp,24.,"current_24h",1);     //show 24h history of MRD files
+    PrintFileTimeStamp(snapshot.current_stamp,24.,"current_24h");
+    DrawFileHistory(snapshot.current_stamp,2.,"current_2h",3);     //show 2h history of MRD files
+
+  } else if (snapshot.config_index < 0){
+
+    UpdateMonitorPlots(config_timeframes, config_endtime_long, config_label, config_plottypes);
+
+  } else if (snapshot.config_index < (int) config_timeframes.size()){
+
+    int i_time = snapshot.config_index;
+    std::vector<double> timeFrames{config_timeframes.at(i_time)};
+    std::vector<ULong64_t> endTimes{config_endtime_long.at(i_time)};
+    std::vector<std::string> fileLabels{config_label.at(i_time)};
+    std::vector<std::vector<std::string>> plotTypes{config_plottypes.at(i_time)};
+    UpdateMonitorPlots(timeFrames, endTimes, fileLabels, plotTypes);
+
+  }
+
+}
+
 void MonitorMRDTime::DrawLastFilePlots(){
 
   //-------------------------------------------------------
@@ -1702,17 +1997,17 @@ void MonitorMRDTime::DrawLastFilePlots(){
   DrawScatterPlotsTrigger();
 
   //Draw hitmap plots
-  DrawHitMap(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  DrawHitMap(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
 
   //Draw TDC histogram plot
   DrawTDCHistogram();
 
   //Draw rate plots in 2D (complementary to hitmap plots), both in electronics and in physical space
-  DrawRatePlotElectronics(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
-  DrawRatePlotPhysical(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  DrawRatePlotElectronics(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  DrawRatePlotPhysical(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
 
   //Draw pie charts showing the event/trigger type distribution
-  DrawPieChart(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  DrawPieChart(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
 
 }
 
@@ -1727,10 +2022,10 @@ void MonitorMRDTime::UpdateMonitorPlots(std::vector<double> timeFrames, std::vec
   for (unsigned int i_time = 0; i_time < timeFrames.size(); i_time++){
 
     ULong64_t zero = 0;
-    if (endTimes.at(i_time) == zero) endTimes.at(i_time) = t_file_end;        //set 0 for t_file_end since we did not know what that was at the beginning of initialise
+    if (endTimes.at(i_time) == zero) endTimes.at(i_time) = plot_file_end;        //set 0 for t_file_end since we did not know what that was at the beginning of initialise
     /*std::cout << (endTimes.at(i_time) == zero) << std::endl;
     std::cout << (endTimes.at(i_time) == 0) << std::endl;
-    std::cout <<t_file_end<<std::endl;*/
+    std::cout <<plot_file_end<<std::endl;*/
 
     for (unsigned int i_plot = 0; i_plot < plotTypes.at(i_time).size(); i_plot++){
 
@@ -1761,9 +2056,9 @@ void MonitorMRDTime::DrawScatterPlots(){
 
   for (int i_channel=0; i_channel<num_active_slots*num_channels;i_channel++){
     if (hist_scatter.at(i_channel)->GetEntries()>0) hist_scatter.at(i_channel)->Reset();
-    hist_scatter.at(i_channel)->SetBins(n_bins_scatter,0,t_file_end/MSEC_to_SEC-t_file_start/MSEC_to_SEC,n_bins_scatter,0,200);
-    for (unsigned int i_entry=0; i_entry<tdc_file.at(i_channel).size(); i_entry++){
-      hist_scatter.at(i_channel)->Fill((timestamp_file.at(i_channel).at(i_entry)-t_file_start)/MSEC_to_SEC,tdc_file.at(i_channel).at(i_entry));
+    hist_scatter.at(i_channel)->SetBins(n_bins_scatter,0,plot_file_end/MSEC_to_SEC-plot_file_start/MSEC_to_SEC,n_bins_scatter,0,200);
+    for (unsigned int i_entry=0; i_entry<plot_tdc_file.at(i_channel).size(); i_entry++){
+      hist_scatter.at(i_channel)->Fill((plot_timestamp_file.at(i_channel).at(i_entry)-plot_file_start)/MSEC_to_SEC,plot_tdc_file.at(i_channel).at(i_entry));
     }
   }
   
@@ -1823,7 +2118,7 @@ void MonitorMRDTime::DrawScatterPlots(){
     //add histograms to the canvas
     canvas_scatter->cd();
     if (i_channel%CH_per_CANVAS == 0) {
-      hist_scatter.at(i_channel)->GetXaxis()->SetTimeOffset(t_file_start+utc_to_t/MSEC_to_SEC);
+      hist_scatter.at(i_channel)->GetXaxis()->SetTimeOffset(plot_file_start+plot_utc_to_t/MSEC_to_SEC);
       hist_scatter.at(i_channel)->Draw();
     } else {
       hist_scatter.at(i_channel)->Draw("same");
@@ -1838,7 +2133,7 @@ void MonitorMRDTime::DrawScatterPlots(){
       //save single channel scatter plots as well
       canvas_scatter_single->Clear();
       canvas_scatter_single->cd();
-      hist_scatter.at(i_channel)->GetXaxis()->SetTimeOffset(t_file_start+utc_to_t/MSEC_to_SEC);
+      hist_scatter.at(i_channel)->GetXaxis()->SetTimeOffset(plot_file_start+plot_utc_to_t/MSEC_to_SEC);
       hist_scatter.at(i_channel)->Draw();
       std::stringstream ss_ch_scatter_single;
       ss_ch_scatter_single<<outpath<<"MRDScatter_lastFile_Cr"<<crate<<"_Sl"<<slot<<"_Ch"<<channel<<"."<<img_extension;
@@ -1858,7 +2153,7 @@ void MonitorMRDTime::DrawScatterPlotsTrigger(){
   //Data is simply taken from the vectors already storing the information from the current file
   //This version of the function only plots the TDC scatter plot of the trigger loopback channel
 
-  boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(t_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(t_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(t_file_end/MSEC_to_SEC/1000.)%60,t_file_end%1000);
+  boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(plot_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(plot_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(plot_file_end/MSEC_to_SEC/1000.)%60,plot_file_end%1000);
   struct tm endtime_tm = boost::posix_time::to_tm(endtime);
   std::stringstream end_time;
   end_time << endtime_tm.tm_year+1900<<"/"<<endtime_tm.tm_mon+1<<"/"<<endtime_tm.tm_mday<<"-"<<endtime_tm.tm_hour<<":"<<endtime_tm.tm_min<<":"<<endtime_tm.tm_sec;
@@ -1871,9 +2166,9 @@ void MonitorMRDTime::DrawScatterPlotsTrigger(){
     std::vector<unsigned int> CrateSlotChannel{crate,slot,channel};
     int total_ch = CrateSlotChannel_to_TotalChannel[CrateSlotChannel];
     if (hist_scatter.at(total_ch)->GetEntries()>0) hist_scatter.at(total_ch)->Reset();
-    hist_scatter.at(total_ch)->SetBins(n_bins_scatter,0,t_file_end/MSEC_to_SEC-t_file_start/MSEC_to_SEC,n_bins_scatter,0,1000);    //show whole TDC acq window from 0 ... 1000 TDC units
-    for (unsigned int i_entry=0; i_entry<tdc_file.at(total_ch).size(); i_entry++){
-      hist_scatter.at(total_ch)->Fill((timestamp_file.at(total_ch).at(i_entry)-t_file_start)/MSEC_to_SEC,tdc_file.at(total_ch).at(i_entry));
+    hist_scatter.at(total_ch)->SetBins(n_bins_scatter,0,plot_file_end/MSEC_to_SEC-plot_file_start/MSEC_to_SEC,n_bins_scatter,0,1000);    //show whole TDC acq window from 0 ... 1000 TDC units
+    for (unsigned int i_entry=0; i_entry<plot_tdc_file.at(total_ch).size(); i_entry++){
+      hist_scatter.at(total_ch)->Fill((plot_timestamp_file.at(total_ch).at(i_entry)-plot_file_start)/MSEC_to_SEC,plot_tdc_file.at(total_ch).at(i_entry));
     }
   }
   
@@ -1891,7 +2186,7 @@ void MonitorMRDTime::DrawScatterPlotsTrigger(){
 
     if (i_trigger == 0){
       ss_ch_scatter << "Trigger TDC "<<end_time.str()<<" (last File)";
-      hist_scatter.at(total_ch)->GetXaxis()->SetTimeOffset((t_file_start+utc_to_t)/MSEC_to_SEC);
+      hist_scatter.at(total_ch)->GetXaxis()->SetTimeOffset((plot_file_start+plot_utc_to_t)/MSEC_to_SEC);
       hist_scatter.at(total_ch)->SetTitle(ss_ch_scatter.str().c_str());
       hist_scatter.at(total_ch)->Draw();
     }
@@ -1910,7 +2205,7 @@ void MonitorMRDTime::DrawScatterPlotsTrigger(){
 
 void MonitorMRDTime::DrawTDCHistogram(){
 
-  boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(t_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(t_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(t_file_end/MSEC_to_SEC/1000.)%60,t_file_end%1000);
+  boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(plot_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(plot_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(plot_file_end/MSEC_to_SEC/1000.)%60,plot_file_end%1000);
   struct tm endtime_tm = boost::posix_time::to_tm(endtime);
   std::stringstream end_time;
   end_time << endtime_tm.tm_year+1900<<"/"<<endtime_tm.tm_mon+1<<"/"<<endtime_tm.tm_mday<<"-"<<endtime_tm.tm_hour<<":"<<endtime_tm.tm_min<<":"<<endtime_tm.tm_sec;
@@ -1924,14 +2219,14 @@ void MonitorMRDTime::DrawTDCHistogram(){
   for (int i_channel = 0; i_channel < num_active_slots*num_channels; i_channel++){
       if (TotalChannel_to_Crate[i_channel] == loopback_crate.at(0) && TotalChannel_to_Slot[i_channel] == loopback_slot.at(0) && TotalChannel_to_Channel[i_channel] == loopback_channel.at(0)) continue; //Omit cosmic loopback signal
       if (TotalChannel_to_Crate[i_channel] == loopback_crate.at(1) && TotalChannel_to_Slot[i_channel] == loopback_slot.at(1) && TotalChannel_to_Channel[i_channel] == loopback_channel.at(1)) continue; //Omit beam loopback signal
-    for (unsigned int i_tdc = 0; i_tdc < tdc_file.at(i_channel).size(); i_tdc++){
-      hist_tdc->Fill(tdc_file.at(i_channel).at(i_tdc));
+    for (unsigned int i_tdc = 0; i_tdc < plot_tdc_file.at(i_channel).size(); i_tdc++){
+      hist_tdc->Fill(plot_tdc_file.at(i_channel).at(i_tdc));
     }
   }
 
   
-  for (unsigned int i_entry=0; i_entry < tdc_file_times.size(); i_entry++){
-   std::sort(tdc_file_times.at(i_entry).begin(),tdc_file_times.at(i_entry).end());
+  for (unsigned int i_entry=0; i_entry < plot_tdc_file_times.size(); i_entry++){
+   std::sort(plot_tdc_file_times.at(i_entry).begin(),plot_tdc_file_times.at(i_entry).end());
   }
 
   int tdc_start=0;
@@ -1940,8 +2235,8 @@ void MonitorMRDTime::DrawTDCHistogram(){
   int n_channels = 0;
   int tdc_current = 0;
 
-  for (unsigned int i_entry = 0; i_entry < tdc_file_times.size(); i_entry++){
-   std::vector<int> tdc_times = tdc_file_times.at(i_entry);
+  for (unsigned int i_entry = 0; i_entry < plot_tdc_file_times.size(); i_entry++){
+   std::vector<int> tdc_times = plot_tdc_file_times.at(i_entry);
    for (unsigned int i_tdc=0; i_tdc < tdc_times.size(); i_tdc++){
      if (i_tdc == 0) {
 	tdc_start = tdc_times.at(0);
@@ -2728,15 +3023,15 @@ void MonitorMRDTime::DrawPieChart(ULong64_t timestamp_end, double time_frame, st
   int nevents_zerohits = 0;
   int nevents_doublehits = 0;
 
-  for (unsigned int i_file = 0; i_file < rate_plot.size(); i_file++){
+  //sum the stored counts: rate*(t_end-t_start) overcounts history points that span gaps in the data
+  for (unsigned int i_file = 0; i_file < cosmiccount_plot.size(); i_file++){
 
-    ULong64_t current_timeframe = (tend_plot.at(i_file)-tstart_plot.at(i_file))/MSEC_to_SEC;
-    nevents_cosmic += cosmicrate_plot.at(i_file)*current_timeframe;
-    nevents_beam += beamrate_plot.at(i_file)*current_timeframe;
-    nevents_noloopback += noloopbackrate_plot.at(i_file)*current_timeframe;
-    nevents_normal += normalhitrate_plot.at(i_file)*current_timeframe;
-    nevents_zerohits += zerohitsrate_plot.at(i_file)*current_timeframe;
-    nevents_doublehits += doublehitrate_plot.at(i_file)*current_timeframe;
+    nevents_cosmic += cosmiccount_plot.at(i_file);
+    nevents_beam += beamcount_plot.at(i_file);
+    nevents_noloopback += noloopbackcount_plot.at(i_file);
+    nevents_normal += normalhitcount_plot.at(i_file);
+    nevents_zerohits += zerohitscount_plot.at(i_file);
+    nevents_doublehits += doublehitcount_plot.at(i_file);
 
   }
 
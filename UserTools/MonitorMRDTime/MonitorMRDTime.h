@@ -5,6 +5,8 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
 
 #include "Tool.h"
 #include "MRDOut.h"
@@ -36,10 +38,29 @@
 #include "TH2Poly.h"
 #include "TPie.h"
 #include "TPieSlice.h"
+#include "MonitoringHistory.h"
+#include "AsyncRenderQueue.h"
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/date_time/gregorian/gregorian.hpp>
 
+/**
+ * \struct MonitorMRDTimeSnapshot
+ *
+ * Immutable copy of the data needed to draw one plot type of MonitorMRDTime, handed from Execute to the render thread.
+ * The per-channel TDC data of the last file is only filled for the "LastFile" plot type.
+ */
+struct MonitorMRDTimeSnapshot{
+  ULong64_t t_file_start = 0;
+  ULong64_t t_file_end = 0;
+  ULong64_t utc_to_t = 0;
+  long current_stamp = 0;
+  int config_index = -1;          //entry of the plot configuration to draw, -1 for all entries
+  std::vector<std::vector<int>> tdc_file;
+  std::vector<std::vector<ULong64_t>> timestamp_file;
+  std::vector<std::vector<int>> tdc_file_times;
+};
+
 class MonitorMRDTime: public Tool {
 
  public:
@@ -54,7 +75,9 @@ class MonitorMRDTime: public Tool {
   void InitializeVectors();
   void ReadInData();
   void WriteToFile();
-  void ReadFromFile(ULong64_t timestamp_end, double time_frame);
+  void ReadFromFile(ULong64_t timestamp_end, double time_frame, bool allow_history=true);
+  void InitializeHistory();
+  void ReadFromHistory(ULong64_t timestamp_start, ULong64_t timestamp_end);
   
   void DrawLastFilePlots();
   void UpdateMonitorPlots(std::vector<double> timeFrames, std::vector<ULong64_t> endTimes, std::vector<std::string> fileLabels, std::vector<std::vector<std::string>> plotTypes);
@@ -70,6 +93,13 @@ class MonitorMRDTime: public Tool {
   void PrintFileTimeStamp(ULong64_t timestamp_end, double time_frame, std::string file_ending);
   void DrawPieChart(ULong64_t timestamp_end, double time_frame, std::string file_ending);
 
+  //plot publishing functions (drawing either directly or in the render thread)
+  std::shared_ptr<MonitorMRDTimeSnapshot> MakeSnapshot();
+  void PublishLastFilePlots();
+  void PublishMonitorPlots();
+  void PublishFileHistory();
+  void RenderSnapshot(const std::string &plot_type, const MonitorMRDTimeSnapshot &snapshot);
+
   //helper functions
   std::string convertTimeStamp_to_Date(ULong64_t timestamp);
   bool does_file_exist(std::string filename);
@@ -78,6 +108,7 @@ class MonitorMRDTime: public Tool {
 
   //define MRD stores that contain the data
   BoostStore* MRDdata;
+  std::vector<MRDOut>* MRDstream = nullptr;   //entries streamed by MonitorReceive (Mode Stream) instead of a file
   MRDOut MRDout;
   bool bool_mrddata;
 
@@ -104,6 +135,13 @@ class MonitorMRDTime: public Tool {
   bool draw_single;
   std::string plot_configuration;
   int verbosity;
+  bool use_history;
+  std::string history_levels;
+  int history_max_points;
+  double history_min_timeframe;
+  double history_backfill_days;
+  bool async_render;
+  int render_queue_size;
 
   //define variables that contain the configuration option for the plots
   std::vector<double> config_timeframes;
@@ -126,6 +164,7 @@ class MonitorMRDTime: public Tool {
   std::stringstream title_time; 
   ULong64_t readfromfile_tend;
   double readfromfile_timeframe;
+  bool readfromfile_history = false;
 
   //variables to convert times
   double MSEC_to_SEC = 1000.;
@@ -193,6 +232,27 @@ class MonitorMRDTime: public Tool {
   std::vector<double> doublehitrate_plot;
   std::vector<double> zerohitsrate_plot;
   std::vector<int> nevents_plot;
+  std::vector<double> cosmiccount_plot;
+  std::vector<double> beamcount_plot;
+  std::vector<double> noloopbackcount_plot;
+  std::vector<double> normalhitcount_plot;
+  std::vector<double> doublehitcount_plot;
+  std::vector<double> zerohitscount_plot;
+
+  //multi-resolution history of the monitoring variables (rollups of the mrdmonitor_tree entries)
+  MonitoringHistory *history = nullptr;
+
+  //asynchronous rendering: render thread, lock for the monitoring files/history shared by WriteToFile and ReadFromFile
+  AsyncRenderQueue<MonitorMRDTimeSnapshot> *render_queue = nullptr;
+  std::mutex monitoring_file_mutex;
+
+  //data of the last file as seen by the draw functions (set from the published snapshot)
+  std::vector<std::vector<int>> plot_tdc_file;
+  std::vector<std::vector<ULong64_t>> plot_timestamp_file;
+  std::vector<std::vector<int>> plot_tdc_file_times;
+  ULong64_t plot_file_start = 0;
+  ULong64_t plot_file_end = 0;
+  ULong64_t plot_utc_to_t = 21600000;
 
   //labels, lines, etc.
   TPaveText *label_cr1 = nullptr;
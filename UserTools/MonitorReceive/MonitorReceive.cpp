@@ -16,19 +16,40 @@ bool MonitorReceive::Initialise(std::string configfile, DataModel &data){
   m_variables.Get("OutPath",outpath);
   m_data->CStore.Set("OutPath",outpath);
 
-  MonitorReceiver= new zmq::socket_t(*m_data->context, ZMQ_SUB);
-  MonitorReceiver->setsockopt(ZMQ_SUBSCRIBE, "", 0);
+  std::string mode="DataFile";
+  m_variables.Get("Mode",mode);
+  m_variables.Get("verbose",verbosity);
+  stream_mode = (mode=="Stream");
+  m_variables.Get("StreamAddress",stream_address);
+  m_variables.Get("StreamBatchEntries",stream_batch_entries);
+  m_variables.Get("StreamBatchSeconds",stream_batch_seconds);
+  m_variables.Get("MaxQueuedEntries",max_queued_entries);
+  if (stream_batch_entries<1) stream_batch_entries=1;
+  if (max_queued_entries<stream_batch_entries) max_queued_entries=stream_batch_entries;
+
+  MonitorReceiver=0;
+  if (stream_mode){
+    // the receiver thread owns the socket, the sources are passed to it as endpoints
+    stop_stream=false;
+    if (stream_address!="") stream_endpoints.push_back(stream_address);
+    stream_thread = std::thread(&MonitorReceive::StreamLoop,this);
+    Log("MonitorReceive: Streaming mode, batches of up to "+std::to_string(stream_batch_entries)+" entries or "+std::to_string(stream_batch_seconds)+" s",v_message,verbosity);
+  } else {
+    MonitorReceiver= new zmq::socket_t(*m_data->context, ZMQ_SUB);
+    MonitorReceiver->setsockopt(ZMQ_SUBSCRIBE, "", 0);
  
-  items[0].socket = *MonitorReceiver;
-  items[0].fd = 0;
-  items[0].events = ZMQ_POLLIN;
-  items[0].revents =0;
-  
+    items[0].socket = *MonitorReceiver;
+    items[0].fd = 0;
+    items[0].events = ZMQ_POLLIN;
+    items[0].revents =0;
+  }
 
-  sources=UpdateMonitorSources();
+  if (stream_mode && stream_address!="") sources=1;
+  else sources=UpdateMonitorSources();
  
   last= boost::posix_time::ptime(boost::posix_time::second_clock::local_time());
   period =boost::posix_time::time_duration(0,0,1,0);
+  last_batch=last;
 
   m_data->Stores["CCData"]=new BoostStore(false,0);
   m_data->Stores["PMTData"]=new BoostStore(false,0);
@@ -45,6 +66,7 @@ bool MonitorReceive::Initialise(std::string configfile, DataModel &data){
 
 bool MonitorReceive::Execute(){
 
+  if (stream_mode) return ExecuteStream();
 
   boost::posix_time::ptime current(boost::posix_time::second_clock::local_time());
   boost::posix_time::time_duration duration(current - last);
@@ -198,6 +220,15 @@ bool MonitorReceive::Execute(){
 
 bool MonitorReceive::Finalise(){
 
+  if (stream_mode){
+    {
+      std::lock_guard<std::mutex> lock(stream_mutex);
+      stop_stream=true;
+    }
+    if (stream_thread.joinable()) stream_thread.join();
+    Log("MonitorReceive: Received "+std::to_string(stream_received)+" streamed entries in "+std::to_string(stream_batches)+" batches, dropped "+std::to_string(stream_dropped)+" (queue full), "+std::to_string(stream_bad)+" not readable",v_message,verbosity);
+  }
+
   delete MonitorReceiver;
   MonitorReceiver=0;
 
@@ -275,7 +306,11 @@ int MonitorReceive::UpdateMonitorSources(){
       service->Get("ip",ip);
       service->Get("remote_port",port);
       std::string tmp="tcp://"+ ip +":"+port;
-      MonitorReceiver->connect(tmp.c_str());
+      if (stream_mode){
+        std::lock_guard<std::mutex> lock(stream_mutex);
+        stream_endpoints.push_back(tmp);
+      }
+      else MonitorReceiver->connect(tmp.c_str());
       //      MonitorReceiver->setsockopt(ZMQ_SUBSCRIBE, "", 0);
       //std::cout<<type<<" = "<<tmp<<std::endl;
     }  
@@ -290,3 +325,149 @@ int MonitorReceive::UpdateMonitorSources(){
   
   return connections.size();
 }
+
+
+bool MonitorReceive::ExecuteStream(){
+
+  boost::posix_time::ptime current(boost::posix_time::second_clock::local_time());
+  if (stream_address=="" && current-last>period){
+    last=current;
+    sources=UpdateMonitorSources();
+  }
+
+  m_data->CStore.Set("HasCCData",false);
+  m_data->CStore.Set("HasPMTData",false);
+  m_data->CStore.Set("HasTrigData",false);
+
+  std::string State="Wait";
+  m_data->CStore.Set("State",State);
+
+  // at the end of the data (StreamEndOfData, set by MonitorSimStream) the open batch is handed over without waiting
+  bool end_of_data=false;
+  m_data->CStore.Get("StreamEndOfData",end_of_data);
+  if (end_of_data && end_of_data_time.is_not_a_date_time()) end_of_data_time=current;
+
+  // take a batch once one type has enough entries, or when the oldest entries have waited long enough
+  std::vector<std::vector<CardData>> pmt;
+  std::vector<MRDOut> mrd;
+  std::vector<TriggerData> trig;
+  {
+    std::lock_guard<std::mutex> lock(stream_mutex);
+    size_t queued = std::max(stream_pmt.size(),std::max(stream_mrd.size(),stream_trig.size()));
+    bool full = (queued >= (size_t)stream_batch_entries);
+    bool timeout = (queued>0 && (end_of_data || current-last_batch >= boost::posix_time::seconds(stream_batch_seconds)));
+    if (full || timeout){
+      while (!stream_pmt.empty() && pmt.size()<(size_t)stream_batch_entries){ pmt.push_back(std::move(stream_pmt.front())); stream_pmt.pop_front(); }
+      while (!stream_mrd.empty() && mrd.size()<(size_t)stream_batch_entries){ mrd.push_back(std::move(stream_mrd.front())); stream_mrd.pop_front(); }
+      while (!stream_trig.empty() && trig.size()<(size_t)stream_batch_entries){ trig.push_back(std::move(stream_trig.front())); stream_trig.pop_front(); }
+    }
+  }
+  if (pmt.empty() && mrd.empty() && trig.empty()){
+    // messages still in flight arrive within a second, after that everything has been handed over
+    if (end_of_data && current-end_of_data_time >= boost::posix_time::seconds(1)) m_data->CStore.Set("StreamDrained",true);
+    usleep(100000);
+    return true;
+  }
+  last_batch=current;
+  stream_batches++;
+  Log("MonitorReceive: Streamed batch with "+std::to_string(pmt.size())+" PMT, "+std::to_string(mrd.size())+" MRD and "+std::to_string(trig.size())+" trigger entries",v_debug,verbosity);
+
+  // the batch takes the place of a data file; the MRD entries are handed over as a vector instead of a file store
+  m_data->Stores["CCData"]->Delete();
+  m_data->Stores["PMTData"]->Delete();
+  m_data->Stores["TrigData"]->Delete();
+
+  if (!mrd.empty()){
+    std::vector<MRDOut>* MRDStream = new std::vector<MRDOut>();
+    MRDStream->swap(mrd);
+    m_data->Stores["CCData"]->Set("StreamData",MRDStream,false);   // deleted by the next Delete of the store
+    m_data->CStore.Set("HasCCData",true);
+  }
+  if (!pmt.empty()){
+    std::map<int,std::vector<CardData>> CardData_Map;
+    for (size_t i_entry=0; i_entry<pmt.size(); i_entry++) CardData_Map.emplace(i_entry,std::move(pmt.at(i_entry)));
+    m_data->Stores["PMTData"]->Set("CardDataMap",CardData_Map);
+    m_data->CStore.Set("HasPMTData",true);
+  }
+  if (!trig.empty()){
+    std::map<int,TriggerData> TrigData_Map;
+    for (size_t i_trig=0; i_trig<trig.size(); i_trig++) TrigData_Map.emplace(i_trig,std::move(trig.at(i_trig)));
+    m_data->Stores["TrigData"]->Set("TrigDataMap",TrigData_Map);
+    m_data->CStore.Set("HasTrigData",true);
+  }
+
+  State="DataFile";
+  m_data->CStore.Set("State",State);
+
+  return true;
+}
+
+
+void MonitorReceive::StreamLoop(){
+
+  zmq::socket_t StreamReceiver(*m_data->context, ZMQ_SUB);
+  StreamReceiver.setsockopt(ZMQ_SUBSCRIBE, "", 0);
+  zmq::pollitem_t stream_items[1];
+  stream_items[0].socket = StreamReceiver;
+  stream_items[0].fd = 0;
+  stream_items[0].events = ZMQ_POLLIN;
+  stream_items[0].revents = 0;
+
+  while (true){
+    {
+      std::lock_guard<std::mutex> lock(stream_mutex);
+      if (stop_stream) break;
+      for (size_t i=0; i<stream_endpoints.size(); i++) StreamReceiver.connect(stream_endpoints.at(i).c_str());
+      stream_endpoints.clear();
+    }
+
+    zmq::poll(&stream_items[0], 1, 100);
+    if (!(stream_items[0].revents & ZMQ_POLLIN)) continue;
+
+    zmq::message_t frame;
+    StreamReceiver.recv(&frame);
+    std::string type = MonitorStream::GetType(frame);
+    int more=0;
+    size_t more_size=sizeof(more);
+    StreamReceiver.getsockopt(ZMQ_RCVMORE, &more, &more_size);
+
+    // deserialise outside of the lock; messages of the file hand-off are read and skipped
+    std::vector<std::vector<CardData>> pmt;
+    std::vector<MRDOut> mrd;
+    std::vector<TriggerData> trig;
+    unsigned long bad=0;
+    while (more){
+      StreamReceiver.recv(&frame);
+      StreamReceiver.getsockopt(ZMQ_RCVMORE, &more, &more_size);
+      try{
+        if (type==MonitorStream::PMTType){
+          std::vector<CardData> entry;
+          MonitorStream::Unpack(frame,entry);
+          pmt.push_back(std::move(entry));
+        } else if (type==MonitorStream::MRDType){
+          MRDOut entry;
+          MonitorStream::Unpack(frame,entry);
+          mrd.push_back(std::move(entry));
+        } else if (type==MonitorStream::TrigType){
+          TriggerData entry;
+          MonitorStream::Unpack(frame,entry);
+          trig.push_back(std::move(entry));
+        }
+      } catch (std::exception &e){
+        bad++;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(stream_mutex);
+    stream_bad+=bad;
+    stream_received+=pmt.size()+mrd.size()+trig.size();
+    for (size_t i=0; i<pmt.size(); i++) stream_pmt.push_back(std::move(pmt.at(i)));
+    for (size_t i=0; i<mrd.size(); i++) stream_mrd.push_back(std::move(mrd.at(i)));
+    for (size_t i=0; i<trig.size(); i++) stream_trig.push_back(std::move(trig.at(i)));
+    // monitoring wants the newest data, so a full queue drops its oldest entries
+    while (stream_pmt.size()>(size_t)max_queued_entries){ stream_pmt.pop_front(); stream_dropped++; }
+    while (stream_mrd.size()>(size_t)max_queued_entries){ stream_mrd.pop_front(); stream_dropped++; }
+    while (stream_trig.size()>(size_t)max_queued_entries){ stream_trig.pop_front(); stream_dropped++; }
+  }
+
+}
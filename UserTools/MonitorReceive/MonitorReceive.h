@@ -3,8 +3,12 @@
 
 #include <string>
 #include <iostream>
+#include <deque>
+#include <thread>
+#include <mutex>
 
 #include "Tool.h"
+#include "MonitorStream.h"
 
 #include "boost/date_time/gregorian/gregorian.hpp"
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -26,6 +30,9 @@ class MonitorReceive: public Tool {
 
  private:
 
+  bool ExecuteStream();
+  void StreamLoop();
+
   int sources;
   zmq::socket_t* MonitorReceiver;
   boost::posix_time::ptime last;
@@ -37,6 +44,33 @@ class MonitorReceive: public Tool {
   BoostStore* PMTData;
   BoostStore* TrigData;
   std::vector<std::string> loaded_files;
+
+  // Stream mode: a receiver thread deserialises the entries published by the DAQ (see MonitorStream.h)
+  // into bounded queues, Execute hands them to the monitoring tools in batches
+  bool stream_mode=false;
+  std::string stream_address;            ///< publisher to connect to, otherwise the MonitorData services
+  int stream_batch_entries=1000;         ///< entries per type handed over in one Execute
+  int stream_batch_seconds=10;           ///< hand over a partial batch after this time
+  int max_queued_entries=20000;          ///< per type, the oldest entries are dropped beyond
+  int verbosity=1;
+  std::thread stream_thread;
+  std::mutex stream_mutex;
+  bool stop_stream=false;
+  std::vector<std::string> stream_endpoints;   ///< to be connected by the receiver thread
+  std::deque<std::vector<CardData>> stream_pmt;
+  std::deque<MRDOut> stream_mrd;
+  std::deque<TriggerData> stream_trig;
+  unsigned long stream_received=0;
+  unsigned long stream_dropped=0;
+  unsigned long stream_bad=0;
+  unsigned long stream_batches=0;
+  boost::posix_time::ptime last_batch;
+  boost::posix_time::ptime end_of_data_time;   ///< when StreamEndOfData was first seen
+
+  int v_error=0;
+  int v_warning=1;
+  int v_message=2;
+  int v_debug=3;
 };
 
 
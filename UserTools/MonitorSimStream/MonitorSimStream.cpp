@@ -0,0 +1,196 @@
+#include "MonitorSimStream.h"
+
+MonitorSimStream::MonitorSimStream():Tool(){}
+
+
+bool MonitorSimStream::Initialise(std::string configfile, DataModel &data){
+
+  /////////////////// Usefull header ///////////////////////
+  if(configfile!="")  m_variables.Initialise(configfile); //loading config file
+  //m_variables.Print();
+
+  m_data= &data; //assigning transient data pointer
+  /////////////////////////////////////////////////////////////////
+
+  std::string file_list;
+  m_variables.Get("FileList",file_list);
+  m_variables.Get("StreamPort",port);
+  m_variables.Get("EntriesPerMessage",entries_per_message);
+  m_variables.Get("MessagesPerExecute",messages_per_execute);
+  m_variables.Get("StartDelay",start_delay);
+  int stop_flag = 1;
+  m_variables.Get("StopWhenDone",stop_flag);
+  stop_when_done = (stop_flag!=0);
+  m_variables.Get("StopTimeout",stop_timeout);
+  m_variables.Get("verbose",verbosity);
+  if (entries_per_message<1) entries_per_message=1;
+  if (messages_per_execute<1) messages_per_execute=1;
+
+  ifstream file_sim(file_list);
+  while(!file_sim.eof()){
+    std::string string_temp;
+    file_sim >> string_temp;
+    if (string_temp!="") vec_filename.push_back(string_temp);
+  }
+  file_sim.close();
+  if (vec_filename.empty()){
+    Log("MonitorSimStream: Error: No raw data files in FileList "+file_list,v_error,verbosity);
+    return false;
+  }
+
+  Publisher = new zmq::socket_t(*m_data->context, ZMQ_PUB);
+  std::string address = "tcp://*:"+std::to_string(port);
+  Publisher->bind(address.c_str());
+  start_time = boost::posix_time::ptime(boost::posix_time::second_clock::local_time());
+  Log("MonitorSimStream: Publishing "+std::to_string(vec_filename.size())+" raw data files on "+address,v_message,verbosity);
+
+  return true;
+}
+
+
+bool MonitorSimStream::Execute(){
+
+  // PUB sockets drop messages until a subscriber is connected
+  boost::posix_time::ptime current(boost::posix_time::second_clock::local_time());
+  if (current-start_time < boost::posix_time::seconds(start_delay)) return true;
+
+  for (int i_message=0; i_message<messages_per_execute; i_message++){
+    if (indata==nullptr && !OpenNextFile()){
+      // MonitorReceive hands over its open batch and sets StreamDrained before the toolchain is stopped
+      if (end_time.is_not_a_date_time()){
+        end_time=current;
+        m_data->CStore.Set("StreamEndOfData",true);
+        Log("MonitorSimStream: All files sent",v_message,verbosity);
+      }
+      bool drained=false;
+      m_data->CStore.Get("StreamDrained",drained);
+      if (stop_when_done && (drained || current-end_time >= boost::posix_time::seconds(stop_timeout))) m_data->vars.Set("StopLoop",1);
+      return true;
+    }
+    int sent = PublishPMT() + PublishMRD() + PublishTrig();
+    if (sent==0) CloseFile();
+  }
+
+  return true;
+}
+
+
+bool MonitorSimStream::Finalise(){
+
+  CloseFile();
+  delete Publisher;
+  Publisher = nullptr;
+  Log("MonitorSimStream: Sent "+std::to_string(entries_sent)+" entries in "+std::to_string(messages_sent)+" messages",v_message,verbosity);
+
+  return true;
+}
+
+
+bool MonitorSimStream::OpenNextFile(){
+
+  if (i_file >= (int)vec_filename.size()) return false;
+  std::string datapath = vec_filename.at(i_file);
+  i_file++;
+  Log("MonitorSimStream: Publishing entries of "+datapath,v_message,verbosity);
+
+  indata = new BoostStore(false,0);
+  indata->Initialise(datapath);
+  pmt_entries = mrd_entries = trig_entries = 0;
+  pmt_next = mrd_next = trig_next = 0;
+  if (indata->Has("PMTData")){
+    PMTData = new BoostStore(false,2);
+    indata->Get("PMTData",*PMTData);
+    PMTData->Header->Get("TotalEntries",pmt_entries);
+  }
+  if (indata->Has("CCData")){
+    MRDData = new BoostStore(false,2);
+    indata->Get("CCData",*MRDData);
+    MRDData->Header->Get("TotalEntries",mrd_entries);
+  }
+  if (indata->Has("TrigData")){
+    TrigData = new BoostStore(false,2);
+    indata->Get("TrigData",*TrigData);
+    TrigData->Header->Get("TotalEntries",trig_entries);
+  }
+
+  return true;
+}
+
+
+void MonitorSimStream::CloseFile(){
+
+  if (PMTData!=nullptr) {PMTData->Close(); PMTData->Delete(); delete PMTData; PMTData = nullptr;}
+  if (MRDData!=nullptr) {MRDData->Close(); MRDData->Delete(); delete MRDData; MRDData = nullptr;}
+  if (TrigData!=nullptr) {TrigData->Close(); TrigData->Delete(); delete TrigData; TrigData = nullptr;}
+  if (indata!=nullptr) {indata->Close(); indata->Delete(); delete indata; indata = nullptr;}
+
+}
+
+
+int MonitorSimStream::PublishPMT(){
+
+  if (pmt_next >= pmt_entries) return 0;
+  zmq::message_t frame;
+  MonitorStream::TypeFrame(MonitorStream::PMTType,frame);
+  Publisher->send(frame,ZMQ_SNDMORE);
+  int sent = 0;
+  while (sent < entries_per_message && pmt_next < pmt_entries){
+    std::vector<CardData> entry;
+    PMTData->GetEntry(pmt_next);
+    PMTData->Get("CardData",entry);
+    pmt_next++;
+    sent++;
+    MonitorStream::Pack(entry,frame);
+    bool last = (sent==entries_per_message || pmt_next==pmt_entries);
+    Publisher->send(frame,last ? 0 : ZMQ_SNDMORE);
+  }
+  entries_sent += sent;
+  messages_sent++;
+  return sent;
+}
+
+
+int MonitorSimStream::PublishMRD(){
+
+  if (mrd_next >= mrd_entries) return 0;
+  zmq::message_t frame;
+  MonitorStream::TypeFrame(MonitorStream::MRDType,frame);
+  Publisher->send(frame,ZMQ_SNDMORE);
+  int sent = 0;
+  while (sent < entries_per_message && mrd_next < mrd_entries){
+    MRDOut entry;
+    MRDData->GetEntry(mrd_next);
+    MRDData->Get("Data",entry);
+    mrd_next++;
+    sent++;
+    MonitorStream::Pack(entry,frame);
+    bool last = (sent==entries_per_message || mrd_next==mrd_entries);
+    Publisher->send(frame,last ? 0 : ZMQ_SNDMORE);
+  }
+  entries_sent += sent;
+  messages_sent++;
+  return sent;
+}
+
+
+int MonitorSimStream::PublishTrig(){
+
+  if (trig_next >= trig_entries) return 0;
+  zmq::message_t frame;
+  MonitorStream::TypeFrame(MonitorStream::TrigType,frame);
+  Publisher->send(frame,ZMQ_SNDMORE);
+  int sent = 0;
+  while (sent < entries_per_message && trig_next < trig_entries){
+    TriggerData entry;
+    TrigData->GetEntry(trig_next);
+    TrigData->Get("TrigData",entry);
+    trig_next++;
+    sent++;
+    MonitorStream::Pack(entry,frame);
+    bool last = (sent==entries_per_message || trig_next==trig_entries);
+    Publisher->send(frame,last ? 0 : ZMQ_SNDMORE);
+  }
+  entries_sent += sent;
+  messages_sent++;
+  return sent;
+}
@@ -0,0 +1,70 @@
+#ifndef MonitorSimStream_H
+#define MonitorSimStream_H
+
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "Tool.h"
+#include "MonitorStream.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+/**
+ * \class MonitorSimStream
+ *
+ * Stand-in for the DAQ side of the streaming monitoring path. Replays the PMTData, CCData and TrigData
+ * entries of a list of raw data files as ZMQ multipart messages (see MonitorStream.h) on a PUB socket,
+ * so that MonitorReceive in Mode Stream can be run and tested without the DAQ.
+ */
+class MonitorSimStream: public Tool {
+
+
+ public:
+
+  MonitorSimStream();
+  bool Initialise(std::string configfile,DataModel &data);
+  bool Execute();
+  bool Finalise();
+
+
+ private:
+
+  bool OpenNextFile();
+  void CloseFile();
+  int PublishPMT();
+  int PublishMRD();
+  int PublishTrig();
+
+  std::vector<std::string> vec_filename;
+  int i_file = 0;
+  int port = 5566;
+  int entries_per_message = 100;
+  int messages_per_execute = 1;
+  int start_delay = 1;          ///< seconds before the first message, for the subscribers to connect
+  bool stop_when_done = true;
+  int stop_timeout = 30;        ///< seconds to wait for MonitorReceive to report StreamDrained
+  int verbosity = 1;
+
+  zmq::socket_t* Publisher = nullptr;
+  boost::posix_time::ptime start_time;
+  boost::posix_time::ptime end_time;   ///< when the last file was sent
+
+  BoostStore* indata = nullptr;
+  BoostStore* PMTData = nullptr;
+  BoostStore* MRDData = nullptr;
+  BoostStore* TrigData = nullptr;
+  long pmt_entries = 0, mrd_entries = 0, trig_entries = 0;
+  long pmt_next = 0, mrd_next = 0, trig_next = 0;
+  unsigned long entries_sent = 0;
+  unsigned long messages_sent = 0;
+
+  int v_error=0;
+  int v_warning=1;
+  int v_message=2;
+  int v_debug=3;
+
+};
+
+
+#endif
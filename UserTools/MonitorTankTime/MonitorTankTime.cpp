@@ -2,6 +2,16 @@
 
 MonitorTankTime::MonitorTankTime():Tool(){}
 
+MonitorTankTimeSnapshot::~MonitorTankTimeSnapshot(){
+  for (unsigned int i_channel = 0; i_channel < hist_freq.size(); i_channel++) delete hist_freq.at(i_channel);
+  for (unsigned int i_channel = 0; i_channel < hist_temp.size(); i_channel++) delete hist_temp.at(i_channel);
+  delete hist_BRF;
+  delete hist_RWM;
+  delete hist_temp_BRF;
+  delete hist_temp_RWM;
+  delete hist_vme;
+}
+
 
 bool MonitorTankTime::Initialise(std::string configfile, DataModel &data){
 
@@ -39,6 +49,25 @@ bool MonitorTankTime::Initialise(std::string configfile, DataModel &data){
   m_variables.Get("DrawSingle",draw_single);
   m_variables.Get("verbose",verbosity);
 
+  //multi-resolution history for long time frames (default: off, read daily ROOT files)
+  use_history = false;
+  history_levels = "60,600,3600,86400";
+  history_max_points = 500;
+  history_min_timeframe = 6.;
+  history_backfill_days = 0.;
+  m_variables.Get("UseHistory",use_history);
+  m_variables.Get("HistoryLevels",history_levels);
+  m_variables.Get("HistoryMaxPoints",history_max_points);
+  m_variables.Get("HistoryMinTimeFrame",history_min_timeframe);
+  m_variables.Get("HistoryBackfillDays",history_backfill_days);
+
+  //asynchronous rendering of the plots in a separate thread (default: off, draw within Execute)
+  async_render = false;
+  render_queue_size = 8;
+  m_variables.Get("AsyncRender",async_render);
+  m_variables.Get("RenderQueueSize",render_queue_size);
+  if (render_queue_size < 1) render_queue_size = 1;
+
   if (verbosity > 2) std::cout <<"MonitorTankTime: Outpath (temporary): "<<outpath_temp<<std::endl;
   if (outpath_temp == "fromStore") m_data->CStore.Get("OutPath",outpath);
   else outpath = outpath_temp;
@@ -190,8 +219,16 @@ bool MonitorTankTime::Initialise(std::string configfile, DataModel &data){
   //----------Initialize configuration/hists---------------
   //-------------------------------------------------------
 
+  if (async_render) ROOT::EnableThreadSafety();
   ReadInConfiguration();
   InitializeHists();
+  if (use_history) InitializeHistory();
+
+  if (async_render){
+    render_queue = new AsyncRenderQueue<MonitorTankTimeSnapshot>();
+    render_queue->Start([this](const std::string &plot_type, const MonitorTankTimeSnapshot &snapshot){RenderSnapshot(plot_type,snapshot);},render_queue_size);
+    Log("MonitorTankTime: Rendering plots asynchronously, render queue size "+std::to_string(render_queue_size),v_message,verbosity);
+  }
   //omit warning messages from ROOT: 1001 - info messages, 2001 - warnings, 3001 - errors
   gROOT->ProcessLine("gErrorIgnoreLevel = 3001;");
   
@@ -251,10 +288,10 @@ bool MonitorTankTime::Execute(){
     WriteToFile();
 
     //draw last file plots
-    DrawLastFilePlots();
+    PublishLastFilePlots();
 
     //Draw customly defined plots
-    UpdateMonitorPlots(config_timeframes, config_endtime_long, config_label, config_plottypes);
+    PublishMonitorPlots();
 
   } else {
    	Log("MonitorTankTime: State not recognized: "+State,v_debug,verbosity);
@@ -267,7 +304,7 @@ bool MonitorTankTime::Execute(){
   
   // if force_update is specified, the plots will be updated no matter whether there has been a new file or not
  
-  if (force_update) UpdateMonitorPlots(config_timeframes, config_endtime_long, config_label, config_plottypes);
+  if (force_update) PublishMonitorPlots();
 
   //-------------------------------------------------------
   //-----------Has enough time passed for update?----------
@@ -277,9 +314,7 @@ bool MonitorTankTime::Execute(){
     Log("MonitorTankTime: "+std::to_string(update_frequency)+" mins passed... Updating file history plot.",v_message,verbosity);
 
     last=current;
-    DrawFileHistory(current_stamp,24.,"current_24h",1);     //show 24h history of Tank files
-    PrintFileTimeStamp(current_stamp,24.,"current_24h");
-    DrawFileHistory(current_stamp,2.,"current_2h",3);
+    PublishFileHistory();
 
   }
   
@@ -296,6 +331,14 @@ bool MonitorTankTime::Finalise(){
 
   Log("Tool MonitorTankTime: Finalising ....",v_message,verbosity);
 
+  //render the plots still waiting in the queue before deleting the objects they use
+  if (render_queue){
+    render_queue->Stop(true);
+    Log("MonitorTankTime: Render queue: "+std::to_string(render_queue->GetNumPublished())+" snapshots published, "+std::to_string(render_queue->GetNumRendered())+" rendered, "+std::to_string(render_queue->GetNumReplaced())+" replaced by newer snapshots, "+std::to_string(render_queue->GetNumDropped())+" dropped",v_message,verbosity);
+    delete render_queue;
+    render_queue = nullptr;
+  }
+
   //delete all histograms/canvases/other objects that were created
 
   //help objects
@@ -365,6 +408,17 @@ bool MonitorTankTime::Finalise(){
   delete hChannels_temp_BRF;
   delete hist_vme;
   delete hist_vme_cluster;
+  if (async_render){
+    for (unsigned int i_channel = 0; i_channel < intake_hChannels_temp.size(); i_channel++){
+      delete intake_hChannels_temp.at(i_channel);
+      delete intake_hChannels_freq.at(i_channel);
+    }
+    delete intake_hChannels_RWM;
+    delete intake_hChannels_BRF;
+    delete intake_hChannels_temp_RWM;
+    delete intake_hChannels_temp_BRF;
+    delete intake_hist_vme;
+  }
   delete hist_vme_cluster_20;
 
   for (int i_crate = 0; i_crate < (int) hist_hitmap.size(); i_crate++){
@@ -397,6 +451,12 @@ bool MonitorTankTime::Finalise(){
     delete canvas_Channels_temp.at(i_channel);
     delete canvas_Channels_freq.at(i_channel);
   }
+
+  if (history) {
+    history->Close();
+    delete history;
+    history = nullptr;
+  }
   
 
   return true;
@@ -949,6 +1009,40 @@ void MonitorTankTime::InitializeHists(){
   leg_sigma->SetLineColor(0);
   leg_rate->SetLineColor(0);
 
+  //histograms filled by LoopThroughDecodedEvents: the drawn histograms themselves in synchronous mode,
+  //private copies in asynchronous mode so that the render thread never sees half-filled histograms
+  for (unsigned int i_channel = 0; i_channel < hChannels_temp.size(); i_channel++){
+    if (async_render){
+      TH1F *intake_temp = (TH1F*) hChannels_temp.at(i_channel)->Clone((std::string(hChannels_temp.at(i_channel)->GetName())+"_intake").c_str());
+      TH1I *intake_freq = (TH1I*) hChannels_freq.at(i_channel)->Clone((std::string(hChannels_freq.at(i_channel)->GetName())+"_intake").c_str());
+      intake_temp->SetDirectory(0);
+      intake_freq->SetDirectory(0);
+      intake_hChannels_temp.push_back(intake_temp);
+      intake_hChannels_freq.push_back(intake_freq);
+    } else {
+      intake_hChannels_temp.push_back(hChannels_temp.at(i_channel));
+      intake_hChannels_freq.push_back(hChannels_freq.at(i_channel));
+    }
+  }
+  if (async_render){
+    intake_hChannels_BRF = (TH1I*) hChannels_BRF->Clone("hChannels_BRF_intake");
+    intake_hChannels_RWM = (TH1I*) hChannels_RWM->Clone("hChannels_RWM_intake");
+    intake_hChannels_temp_BRF = (TH1F*) hChannels_temp_BRF->Clone("hChannels_temp_BRF_intake");
+    intake_hChannels_temp_RWM = (TH1F*) hChannels_temp_RWM->Clone("hChannels_temp_RWM_intake");
+    intake_hist_vme = (TH1F*) hist_vme->Clone("hist_vme_intake");
+    intake_hChannels_BRF->SetDirectory(0);
+    intake_hChannels_RWM->SetDirectory(0);
+    intake_hChannels_temp_BRF->SetDirectory(0);
+    intake_hChannels_temp_RWM->SetDirectory(0);
+    intake_hist_vme->SetDirectory(0);
+  } else {
+    intake_hChannels_BRF = hChannels_BRF;
+    intake_hChannels_RWM = hChannels_RWM;
+    intake_hChannels_temp_BRF = hChannels_temp_BRF;
+    intake_hChannels_temp_RWM = hChannels_temp_RWM;
+    intake_hist_vme = hist_vme;
+  }
+
 }
 
 void MonitorTankTime::LoopThroughDecodedEvents(std::map<uint64_t, std::map<std::vector<int>, std::vector<uint16_t>>> finishedPMTWaves){
@@ -1005,27 +1099,27 @@ void MonitorTankTime::LoopThroughDecodedEvents(std::map<uint64_t, std::map<std::
       if (map_crateslot_to_slot.find(CrateSlot) == map_crateslot_to_slot.end()){
         if (uCrateNum == Crate_BRF && uSlotNum == Slot_BRF){    //Assume that BRF and RWM are in same VME slot
           if (ChannelID == int(Channel_BRF)) {
-		hChannels_BRF->Reset();
+		intake_hChannels_BRF->Reset();
 		for (int i_buffer =0; i_buffer < num_samples; i_buffer++){
-			hChannels_BRF->Fill(awaveform.at(i_buffer));
+			intake_hChannels_BRF->Fill(awaveform.at(i_buffer));
 		}
-		double BRF_mean = hChannels_BRF->GetMean();
-		double BRF_sigma = hChannels_BRF->GetRMS();
-		hChannels_temp_BRF->SetBins(num_samples,0,num_samples);
+		double BRF_mean = intake_hChannels_BRF->GetMean();
+		double BRF_sigma = intake_hChannels_BRF->GetRMS();
+		intake_hChannels_temp_BRF->SetBins(num_samples,0,num_samples);
 		for (int i_buffer=0; i_buffer < num_samples; i_buffer++){
-			hChannels_temp_BRF->SetBinContent(i_buffer,(awaveform.at(i_buffer)-BRF_mean)*conversion_ADC_Volt);
+			intake_hChannels_temp_BRF->SetBinContent(i_buffer,(awaveform.at(i_buffer)-BRF_mean)*conversion_ADC_Volt);
 		}
 	  }
           else if (ChannelID == int(Channel_RWM)) {
-		hChannels_RWM->Reset();
+		intake_hChannels_RWM->Reset();
 		for (int i_buffer =0; i_buffer < num_samples; i_buffer++){
-			hChannels_RWM->Fill(awaveform.at(i_buffer));
+			intake_hChannels_RWM->Fill(awaveform.at(i_buffer));
 		}
-		double RWM_mean = hChannels_RWM->GetMean();
-		double RWM_sigma = hChannels_RWM->GetRMS();
-		hChannels_temp_RWM->SetBins(num_samples,0,num_samples);
+		double RWM_mean = intake_hChannels_RWM->GetMean();
+		double RWM_sigma = intake_hChannels_RWM->GetRMS();
+		intake_hChannels_temp_RWM->SetBins(num_samples,0,num_samples);
 		for (int i_buffer=0; i_buffer < num_samples; i_buffer++){
-			hChannels_temp_RWM->SetBinContent(i_buffer,(awaveform.at(i_buffer)-RWM_mean)*conversion_ADC_Volt);
+			intake_hChannels_temp_RWM->SetBinContent(i_buffer,(awaveform.at(i_buffer)-RWM_mean)*conversion_ADC_Volt);
 		}
 	}
         }
@@ -1036,9 +1130,9 @@ void MonitorTankTime::LoopThroughDecodedEvents(std::map<uint64_t, std::map<std::
         
         int i_slot = map_crateslot_to_slot[CrateSlot];
         int i_channel = i_slot*num_channels_tank+ChannelID-1;
-        hChannels_freq.at(i_channel)->Reset();
-        hChannels_temp.at(i_channel)->Reset();
-        hChannels_temp.at(i_channel)->SetBins(num_samples,0,num_samples);
+        intake_hChannels_freq.at(i_channel)->Reset();
+        intake_hChannels_temp.at(i_channel)->Reset();
+        intake_hChannels_temp.at(i_channel)->SetBins(num_samples,0,num_samples);
         ped_file_temp.at(i_channel) = 0.;
         sigma_file_temp.at(i_channel) = 0.;
         rate_file_temp.at(i_channel) = 0.;
@@ -1049,45 +1143,45 @@ void MonitorTankTime::LoopThroughDecodedEvents(std::map<uint64_t, std::map<std::
       } else {
       int i_slot = map_crateslot_to_slot[CrateSlot];
       int i_channel = i_slot*num_channels_tank+ChannelID-1;
-      hChannels_freq.at(i_channel)->Reset();            //only show the most recent plot for each PMT
-      hChannels_temp.at(i_channel)->Reset();            //only show the most recent plot for each PMT
-      hChannels_temp.at(i_channel)->SetBins(num_samples,0,num_samples);
+      intake_hChannels_freq.at(i_channel)->Reset();            //only show the most recent plot for each PMT
+      intake_hChannels_temp.at(i_channel)->Reset();            //only show the most recent plot for each PMT
+      intake_hChannels_temp.at(i_channel)->SetBins(num_samples,0,num_samples);
 
       //Fill frequency histograms
       for (int i_buffer = 0; i_buffer < num_samples; i_buffer++){
-        hChannels_freq.at(i_channel)->Fill(awaveform.at(i_buffer));
+        intake_hChannels_freq.at(i_channel)->Fill(awaveform.at(i_buffer));
       }
 
       //fit pedestal values with Gaussian
       TF1 *fgaus = new TF1("fgaus","gaus",minimum_adc,maximum_adc);
-      fgaus->SetParameter(1,hChannels_freq.at(i_channel)->GetMean());
-      fgaus->SetParameter(2,hChannels_freq.at(i_channel)->GetRMS());
-      TFitResultPtr gaussFitResult = hChannels_freq.at(i_channel)->Fit("fgaus","Q");
+      fgaus->SetParameter(1,intake_hChannels_freq.at(i_channel)->GetMean());
+      fgaus->SetParameter(2,intake_hChannels_freq.at(i_channel)->GetRMS());
+      TFitResultPtr gaussFitResult = intake_hChannels_freq.at(i_channel)->Fit("fgaus","Q");
       Int_t gaussFitResultInt = gaussFitResult;
       if (gaussFitResultInt == 0){            //status variable 0 means the fit was ok
-        //TF1 *gaus = (TF1*) hChannels_freq.at(i_channel)->GetFunction("gaus");
+        //TF1 *gaus = (TF1*) intake_hChannels_freq.at(i_channel)->GetFunction("gaus");
         //std::stringstream ss_gaus;
         //ss_gaus<<"gaus_"<<i_timestamp<<"_"<<i_channel;
         //gaus->SetName(ss_gaus.str().c_str());
         bool out_of_bounds = ((fgaus->GetParameter(1) < 300.) || (fgaus->GetParameter(1) > 400.) ||  (channels_sigma.at(i_channel) > 5.) || (channels_sigma.at(i_channel) < 0.5));
         bool sudden_change = (fabs(fgaus->GetParameter(1) - channels_mean.at(i_channel)) > 10 || fabs(fgaus->GetParameter(2)-channels_sigma.at(i_channel)) > 0.2);
         if (out_of_bounds || sudden_change) {	//if fit results are unphysical OR indicate a bad fit, use RMS & Mean instead
-	  channels_mean.at(i_channel) = hChannels_freq.at(i_channel)->GetMean();
-	  channels_sigma.at(i_channel) = hChannels_freq.at(i_channel)->GetRMS();
+	  channels_mean.at(i_channel) = intake_hChannels_freq.at(i_channel)->GetMean();
+	  channels_sigma.at(i_channel) = intake_hChannels_freq.at(i_channel)->GetRMS();
 	} else {
           channels_mean.at(i_channel) = fgaus->GetParameter(1);
           channels_sigma.at(i_channel) = fgaus->GetParameter(2);
         }
       }else {     //if fit failed, use RMS & Mean instead
-        channels_mean.at(i_channel) = hChannels_freq.at(i_channel)->GetMean();
-	channels_sigma.at(i_channel) = hChannels_freq.at(i_channel)->GetRMS();
+        channels_mean.at(i_channel) = intake_hChannels_freq.at(i_channel)->GetMean();
+	channels_sigma.at(i_channel) = intake_hChannels_freq.at(i_channel)->GetRMS();
       }
 
       delete fgaus;
 
       //fill buffer plots
       for (int i_buffer = 0; i_buffer < num_samples; i_buffer++){
-        hChannels_temp.at(i_channel)->SetBinContent(i_buffer,(awaveform.at(i_buffer)-channels_mean.at(i_channel))*conversion_ADC_Volt);
+        intake_hChannels_temp.at(i_channel)->SetBinContent(i_buffer,(awaveform.at(i_buffer)-channels_mean.at(i_channel))*conversion_ADC_Volt);
       }
       
       //Evaluate rates
@@ -1098,7 +1192,7 @@ void MonitorTankTime::LoopThroughDecodedEvents(std::map<uint64_t, std::map<std::
 		Log("MonitorTankTime tool: Found waveform entry > sigma: waveform = "+std::to_string(awaveform.at(i_buffer))+", mean+5sigma = "+std::to_string(channels_mean[i_channel]+5*channels_sigma[i_channel]),v_debug,verbosity);
 		sum++;
 		channels_pmt_time.at(i_channel).push_back(i_buffer*2);
-		hist_vme->Fill(i_buffer*2);
+		intake_hist_vme->Fill(i_buffer*2);
       	}
       }
       channels_rate.at(i_channel) = sum;	//actually this is just the number of signal counts, convert to a rate later on
@@ -1132,6 +1226,9 @@ void MonitorTankTime::WriteToFile(){
 
   Log("MonitorTankTime: WriteToFile",v_message,verbosity);
 
+  //the render thread reads the same files/history in asynchronous mode
+  std::lock_guard<std::mutex> file_lock(monitoring_file_mutex);
+
   //-------------------------------------------------------
   //------------------WriteToFile -------------------------
   //-------------------------------------------------------
@@ -1280,6 +1377,13 @@ void MonitorTankTime::WriteToFile(){
   t->Write("",TObject::kOverwrite);           //prevent ROOT from making endless keys for the same tree when updating the tree
   f->Close();
 
+  //update the rollups of the monitoring history incrementally with the new entry
+  if (history){
+    std::vector<std::vector<double>> channel_values{*ped,*sigma,*rate,std::vector<double>(channelcount->begin(),channelcount->end())};
+    std::vector<double> scalar_values;
+    if (!history->Add(t_start,t_end,channel_values,scalar_values)) Log("ERROR (MonitorTankTime): WriteToFile: Could not add entry to monitoring history",v_error,verbosity);
+  }
+
   delete crate;
   delete slot;
   delete channel;
@@ -1293,10 +1397,12 @@ void MonitorTankTime::WriteToFile(){
 
 }
 
-void MonitorTankTime::ReadFromFile(ULong64_t timestamp_end, double time_frame){
+void MonitorTankTime::ReadFromFile(ULong64_t timestamp_end, double time_frame, bool allow_history){
   
   Log("MonitorTankTime: ReadFromFile",v_message,verbosity);
 
+  std::lock_guard<std::mutex> file_lock(monitoring_file_mutex);
+
   //-------------------------------------------------------
   //------------------ReadFromFile ------------------------
   //-------------------------------------------------------
@@ -1312,6 +1418,15 @@ void MonitorTankTime::ReadFromFile(ULong64_t timestamp_end, double time_frame){
   //take the end time and calculate the start time with the given time_frame
   ULong64_t timestamp_start = timestamp_end - time_frame*MIN_to_HOUR*SEC_to_MIN*MSEC_to_SEC;
 
+  //long time frames are read from the pre-aggregated rollups instead of scanning the daily files
+  if (history && allow_history && time_frame >= history_min_timeframe){
+    ReadFromHistory(timestamp_start,timestamp_end);
+    readfromfile_tend = timestamp_end;
+    readfromfile_timeframe = time_frame;
+    readfromfile_history = true;
+    return;
+  }
+
   boost::posix_time::ptime starttime = *Epoch + boost::posix_time::time_duration(int(timestamp_start/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(timestamp_start/MSEC_to_SEC/SEC_to_MIN)%60,int(timestamp_start/MSEC_to_SEC/1000.)%60,timestamp_start%1000);
   struct tm starttime_tm = boost::posix_time::to_tm(starttime);
   boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(timestamp_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(timestamp_end/MSEC_to_SEC/SEC_to_MIN)%60,int(timestamp_end/MSEC_to_SEC/1000.)%60,timestamp_end%1000);
@@ -1441,6 +1556,228 @@ void MonitorTankTime::ReadFromFile(ULong64_t timestamp_end, double time_frame){
   //Set the readfromfile time variables to make sure data is not read twice for the same time window
   readfromfile_tend = timestamp_end;
   readfromfile_timeframe = time_frame;
+  readfromfile_history = false;
+
+}
+
+void MonitorTankTime::InitializeHistory(){
+
+  Log("MonitorTankTime: InitializeHistory",v_message,verbosity);
+
+  //-------------------------------------------------------
+  //------------------InitializeHistory -------------------
+  //-------------------------------------------------------
+
+  history = new MonitoringHistory();
+  history->AddChannelVariable("ped",MonitoringHistory::kMean);
+  history->AddChannelVariable("sigma",MonitoringHistory::kMean);
+  history->AddChannelVariable("rate",MonitoringHistory::kMean);
+  history->AddChannelVariable("channelcount",MonitoringHistory::kSum);
+
+  std::stringstream ss_levels(history_levels);
+  std::string level_str;
+  while (std::getline(ss_levels,level_str,',')){
+    double level_sec = std::stod(level_str);
+    if (level_sec > 0.) history->AddLevel((uint64_t) (level_sec*MSEC_to_SEC));
+  }
+
+  std::string history_prefix = path_monitoring+"PMT_history";
+  if (!history->Open(history_prefix,num_active_slots*num_channels_tank)){
+    Log("ERROR (MonitorTankTime): Could not open monitoring history "+history_prefix+". Continue reading the daily monitoring files.",v_error,verbosity);
+    delete history;
+    history = nullptr;
+    return;
+  }
+
+  //Fill an empty history from the already existing daily monitoring files
+  if (history->IsEmpty() && history_backfill_days > 0.){
+    Log("MonitorTankTime: InitializeHistory: Backfilling monitoring history with the last "+std::to_string(history_backfill_days)+" days",v_message,verbosity);
+    boost::posix_time::time_duration now_duration(boost::posix_time::second_clock::local_time() - *Epoch);
+    ReadFromFile(now_duration.total_milliseconds(),history_backfill_days*HOUR_to_DAY,false);
+    std::vector<double> scalar_values;
+    for (unsigned int i_entry = 0; i_entry < tstart_plot.size(); i_entry++){
+      std::vector<std::vector<double>> channel_values{ped_plot.at(i_entry),sigma_plot.at(i_entry),rate_plot.at(i_entry),std::vector<double>(channelcount_plot.at(i_entry).begin(),channelcount_plot.at(i_entry).end())};
+      history->Add(tstart_plot.at(i_entry),tend_plot.at(i_entry),channel_values,scalar_values);
+    }
+    readfromfile_tend = 0;
+    readfromfile_timeframe = 0.;
+  }
+
+}
+
+void MonitorTankTime::ReadFromHistory(ULong64_t timestamp_start, ULong64_t timestamp_end){
+
+  Log("MonitorTankTime: ReadFromHistory",v_message,verbosity);
+
+  //-------------------------------------------------------
+  //------------------ReadFromHistory ---------------------
+  //-------------------------------------------------------
+
+  std::vector<MonitoringHistoryPoint> points;
+  int level = history->Query(timestamp_start,timestamp_end,history_max_points,points);
+  if (level >= 0) Log("MonitorTankTime: ReadFromHistory: Using "+std::to_string(history->GetLevelWidth(level)/MSEC_to_SEC)+" s rollups, "+std::to_string(points.size())+" points",v_debug,verbosity);
+
+  for (unsigned int i_point = 0; i_point < points.size(); i_point++){
+    MonitoringHistoryPoint &point = points.at(i_point);
+    ULong64_t t_end = point.t_end;
+    ped_plot.push_back(point.channel_values.at(0));
+    sigma_plot.push_back(point.channel_values.at(1));
+    rate_plot.push_back(point.channel_values.at(2));
+    channelcount_plot.push_back(std::vector<int>(point.channel_values.at(3).begin(),point.channel_values.at(3).end()));
+    tstart_plot.push_back(point.t_start);
+    tend_plot.push_back(t_end);
+    boost::posix_time::ptime boost_tend = *Epoch+boost::posix_time::time_duration(int(t_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(t_end/MSEC_to_SEC/SEC_to_MIN)%60,int(t_end/MSEC_to_SEC/1000.)%60,t_end%1000);
+    struct tm label_timestamp = boost::posix_time::to_tm(boost_tend);
+    TDatime datime_timestamp(1900+label_timestamp.tm_year,label_timestamp.tm_mon+1,label_timestamp.tm_mday,label_timestamp.tm_hour,label_timestamp.tm_min,label_timestamp.tm_sec);
+    labels_timeaxis.push_back(datime_timestamp);
+  }
+
+}
+
+std::shared_ptr<MonitorTankTimeSnapshot> MonitorTankTime::MakeSnapshot(){
+
+  //-------------------------------------------------------
+  //------------------MakeSnapshot ------------------------
+  //-------------------------------------------------------
+
+  std::shared_ptr<MonitorTankTimeSnapshot> snapshot(new MonitorTankTimeSnapshot);
+  snapshot->t_file_start = t_file_start;
+  snapshot->t_file_end = t_file_end;
+  snapshot->utc_to_t = utc_to_t;
+  snapshot->current_stamp = current_stamp;
+  return snapshot;
+
+}
+
+void MonitorTankTime::PublishLastFilePlots(){
+
+  Log("MonitorTankTime: PublishLastFilePlots",v_message,verbosity);
+
+  //-------------------------------------------------------
+  //------------------PublishLastFilePlots ----------------
+  //-------------------------------------------------------
+
+  std::shared_ptr<MonitorTankTimeSnapshot> snapshot = MakeSnapshot();
+  snapshot->fifo1 = fifo1;
+  snapshot->fifo2 = fifo2;
+  snapshot->channels_times = channels_times;
+
+  if (!render_queue) {
+    RenderSnapshot("LastFile",*snapshot);
+    return;
+  }
+
+  //hand over copies of the last file histograms, the intake histograms are refilled with the next file
+  for (unsigned int i_channel = 0; i_channel < intake_hChannels_temp.size(); i_channel++){
+    TH1F *snapshot_temp = (TH1F*) intake_hChannels_temp.at(i_channel)->Clone();
+    TH1I *snapshot_freq = (TH1I*) intake_hChannels_freq.at(i_channel)->Clone();
+    snapshot_temp->SetDirectory(0);
+    snapshot_freq->SetDirectory(0);
+    snapshot->hist_temp.push_back(snapshot_temp);
+    snapshot->hist_freq.push_back(snapshot_freq);
+  }
+  snapshot->hist_BRF = (TH1I*) intake_hChannels_BRF->Clone();
+  snapshot->hist_RWM = (TH1I*) intake_hChannels_RWM->Clone();
+  snapshot->hist_temp_BRF = (TH1F*) intake_hChannels_temp_BRF->Clone();
+  snapshot->hist_temp_RWM = (TH1F*) intake_hChannels_temp_RWM->Clone();
+  snapshot->hist_vme = (TH1F*) intake_hist_vme->Clone();
+  snapshot->hist_BRF->SetDirectory(0);
+  snapshot->hist_RWM->SetDirectory(0);
+  snapshot->hist_temp_BRF->SetDirectory(0);
+  snapshot->hist_temp_RWM->SetDirectory(0);
+  snapshot->hist_vme->SetDirectory(0);
+  intake_hist_vme->Reset();           //VME histogram only shows the hits of the last file
+
+  render_queue->Publish("LastFile",snapshot);
+
+}
+
+void MonitorTankTime::PublishMonitorPlots(){
+
+  Log("MonitorTankTime: PublishMonitorPlots",v_message,verbosity);
+
+  //-------------------------------------------------------
+  //------------------PublishMonitorPlots -----------------
+  //-------------------------------------------------------
+
+  if (!render_queue) {
+    RenderSnapshot("MonitorPlots",*MakeSnapshot());
+    return;
+  }
+
+  //one plot type per configured time frame, such that a pending update of one time frame is only replaced by a newer update of the same time frame
+  for (unsigned int i_time = 0; i_time < config_timeframes.size(); i_time++){
+    std::shared_ptr<MonitorTankTimeSnapshot> snapshot = MakeSnapshot();
+    snapshot->config_index = i_time;
+    render_queue->Publish("TimeFrame_"+std::to_string(i_time),snapshot);
+  }
+
+}
+
+void MonitorTankTime::PublishFileHistory(){
+
+  Log("MonitorTankTime: PublishFileHistory",v_message,verbosity);
+
+  //-------------------------------------------------------
+  //------------------PublishFileHistory ------------------
+  //-------------------------------------------------------
+
+  if (!render_queue) RenderSnapshot("FileHistory",*MakeSnapshot());
+  else render_queue->Publish("FileHistory",MakeSnapshot());
+
+}
+
+void MonitorTankTime::RenderSnapshot(const std::string &plot_type, const MonitorTankTimeSnapshot &snapshot){
+
+  Log("MonitorTankTime: RenderSnapshot ("+plot_type+")",v_debug,verbosity);
+
+  //-------------------------------------------------------
+  //------------------RenderSnapshot ----------------------
+  //-------------------------------------------------------
+
+  plot_file_start = snapshot.t_file_start;
+  plot_file_end = snapshot.t_file_end;
+  plot_utc_to_t = snapshot.utc_to_t;
+
+  if (plot_type == "LastFile"){
+
+    plot_fifo1 = snapshot.fifo1;
+    plot_fifo2 = snapshot.fifo2;
+    plot_channels_times = snapshot.channels_times;
+
+    //in asynchronous mode, install the histograms of the snapshot in the drawn histograms
+    for (unsigned int i_channel = 0; i_channel < snapshot.hist_temp.size() && i_channel < hChannels_temp.size(); i_channel++){
+      CopyHistogram(snapshot.hist_temp.at(i_channel),hChannels_temp.at(i_channel));
+      CopyHistogram(snapshot.hist_freq.at(i_channel),hChannels_freq.at(i_channel));
+    }
+    if (snapshot.hist_BRF) CopyHistogram(snapshot.hist_BRF,hChannels_BRF);
+    if (snapshot.hist_RWM) CopyHistogram(snapshot.hist_RWM,hChannels_RWM);
+    if (snapshot.hist_temp_BRF) CopyHistogram(snapshot.hist_temp_BRF,hChannels_temp_BRF);
+    if (snapshot.hist_temp_RWM) CopyHistogram(snapshot.hist_temp_RWM,hChannels_temp_RWM);
+    if (snapshot.hist_vme) CopyHistogram(snapshot.hist_vme,hist_vme);
+
+    DrawLastFilePlots();
+
+  } else if (plot_type == "FileHistory"){
+
+    DrawFileHistory(snapshot.current_stamp,24.,"current_24h",1);     //show 24h history of Tank files
+    PrintFileTimeStamp(snapshot.current_stamp,24.,"current_24h");
+    DrawFileHistory(snapshot.current_stamp,2.,"current_2h",3);
+
+  } else if (snapshot.config_index < 0){
+
+    UpdateMonitorPlots(config_timeframes, config_endtime_long, config_label, config_plottypes);
+
+  } else if (snapshot.config_index < (int) config_timeframes.size()){
+
+    int i_time = snapshot.config_index;
+    std::vector<double> timeFrames{config_timeframes.at(i_time)};
+    std::vector<ULong64_t> endTimes{config_endtime_long.at(i_time)};
+    std::vector<std::string> fileLabels{config_label.at(i_time)};
+    std::vector<std::vector<std::string>> plotTypes{config_plottypes.at(i_time)};
+    UpdateMonitorPlots(timeFrames, endTimes, fileLabels, plotTypes);
+
+  }
 
 }
 
@@ -1465,19 +1802,19 @@ void MonitorTankTime::DrawLastFilePlots(){
   DrawVMEHistogram();
 
   //Draw ped plots plots
-  DrawPedPlotElectronics(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
-  //DrawPedPlotPhysical(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  DrawPedPlotElectronics(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  //DrawPedPlotPhysical(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
 
   //Draw ped Sigma plots
-  DrawSigmaPlotElectronics(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
-  //DrawSigmaPlotPhysical(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  DrawSigmaPlotElectronics(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  //DrawSigmaPlotPhysical(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
 
   //Draw rate plots
-  DrawRatePlotElectronics(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
-  //DrawRatePlotPhysical(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  DrawRatePlotElectronics(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  //DrawRatePlotPhysical(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
 
   //Draw hitmap plots
-  DrawHitMap(t_file_end,(t_file_end-t_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
+  DrawHitMap(plot_file_end,(plot_file_end-plot_file_start)/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR,"lastFile");
 
 }
 
@@ -1499,7 +1836,7 @@ void MonitorTankTime::UpdateMonitorPlots(std::vector<double> timeFrames, std::ve
   for (unsigned int i_time = 0; i_time < timeFrames.size(); i_time++){
 
     ULong64_t zero = 0;
-    if (endTimes.at(i_time) == zero) endTimes.at(i_time) = t_file_end;        //set 0 for t_file_end since we did not know what that was at the beginning of initialise
+    if (endTimes.at(i_time) == zero) endTimes.at(i_time) = plot_file_end;        //set 0 for t_file_end since we did not know what that was at the beginning of initialise
 
 
     for (unsigned int i_plot = 0; i_plot < plotTypes.at(i_time).size(); i_plot++){
@@ -2568,7 +2905,7 @@ void MonitorTankTime::DrawBufferPlots(){
 
   Log("MonitorTankTime: DrawBufferPlots",v_message,verbosity);
 
-  boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(t_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(t_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(t_file_end/MSEC_to_SEC/1000.)%60,t_file_end%1000);
+  boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(plot_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(plot_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(plot_file_end/MSEC_to_SEC/1000.)%60,plot_file_end%1000);
   struct tm endtime_tm = boost::posix_time::to_tm(endtime);
   std::stringstream end_time;
   end_time << endtime_tm.tm_year+1900<<"/"<<endtime_tm.tm_mon+1<<"/"<<endtime_tm.tm_mday<<"-"<<endtime_tm.tm_hour<<":"<<endtime_tm.tm_min<<":"<<endtime_tm.tm_sec;
@@ -2658,7 +2995,7 @@ void MonitorTankTime::DrawADCFreqPlots(){
 
   Log("MonitorTankTime: DrawADCFreqPlots",v_message,verbosity);
 
-  boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(t_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(t_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(t_file_end/MSEC_to_SEC/1000.)%60,t_file_end%1000);
+  boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(plot_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(plot_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(plot_file_end/MSEC_to_SEC/1000.)%60,plot_file_end%1000);
   struct tm endtime_tm = boost::posix_time::to_tm(endtime);
   std::stringstream end_time;
   end_time << endtime_tm.tm_year+1900<<"/"<<endtime_tm.tm_mon+1<<"/"<<endtime_tm.tm_mday<<"-"<<endtime_tm.tm_hour<<":"<<endtime_tm.tm_min<<":"<<endtime_tm.tm_sec;
@@ -2750,7 +3087,7 @@ void MonitorTankTime::DrawFIFOPlots(){
   //------------------DrawFIFOPlots -----------------------
   //-------------------------------------------------------
 
-  boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(t_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(t_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(t_file_end/MSEC_to_SEC/1000.)%60,t_file_end%1000);
+  boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(plot_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(plot_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(plot_file_end/MSEC_to_SEC/1000.)%60,plot_file_end%1000);
   struct tm endtime_tm = boost::posix_time::to_tm(endtime);
   std::stringstream end_time;
   end_time << endtime_tm.tm_year+1900<<"/"<<endtime_tm.tm_mon+1<<"/"<<endtime_tm.tm_mday<<"-"<<endtime_tm.tm_hour<<":"<<endtime_tm.tm_min<<":"<<endtime_tm.tm_sec;
@@ -2760,9 +3097,9 @@ void MonitorTankTime::DrawFIFOPlots(){
   int min_fifo1 = 99999;
   int min_fifo2 = 99999;
 
-  for (unsigned int i_card = 0; i_card < fifo1.size(); i_card++){
+  for (unsigned int i_card = 0; i_card < plot_fifo1.size(); i_card++){
     int i_crate,i_slot;
-    CardIDToElectronicsSpace(fifo1.at(i_card),i_crate,i_slot);
+    CardIDToElectronicsSpace(plot_fifo1.at(i_card),i_crate,i_slot);
     for (int i_ch=0; i_ch < num_channels_tank; i_ch++){
       int x = i_slot;
       int y = num_channels_tank + (3-i_crate)*num_channels_tank-i_ch;
@@ -2770,9 +3107,9 @@ void MonitorTankTime::DrawFIFOPlots(){
     }
   }
 
-  for (unsigned int i_card = 0; i_card < fifo2.size(); i_card++){
+  for (unsigned int i_card = 0; i_card < plot_fifo2.size(); i_card++){
     int i_crate,i_slot;
-    CardIDToElectronicsSpace(fifo2.at(i_card),i_crate,i_slot);
+    CardIDToElectronicsSpace(plot_fifo2.at(i_card),i_crate,i_slot);
     for (int i_ch=0; i_ch < num_channels_tank; i_ch++){
       int x = i_slot;
       int y = num_channels_tank + (3-i_crate)*num_channels_tank-i_ch;
@@ -2912,7 +3249,7 @@ void MonitorTankTime::DrawVMEHistogram(){
   //------------------DrawVMEHistogram---------------------
   //-------------------------------------------------------
 
-    boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(t_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(t_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(t_file_end/MSEC_to_SEC/1000.)%60,t_file_end%1000);
+    boost::posix_time::ptime endtime = *Epoch + boost::posix_time::time_duration(int(plot_file_end/MSEC_to_SEC/SEC_to_MIN/MIN_to_HOUR),int(plot_file_end/MSEC_to_SEC/SEC_to_MIN)%60,int(plot_file_end/MSEC_to_SEC/1000.)%60,plot_file_end%1000);
   struct tm endtime_tm = boost::posix_time::to_tm(endtime);
   std::stringstream end_time;
   end_time << endtime_tm.tm_year+1900<<"/"<<endtime_tm.tm_mon+1<<"/"<<endtime_tm.tm_mday<<"-"<<endtime_tm.tm_hour<<":"<<endtime_tm.tm_min<<":"<<endtime_tm.tm_sec;
@@ -2935,12 +3272,12 @@ void MonitorTankTime::DrawVMEHistogram(){
   canvas_vme->Clear();
   std::vector<int> coinc_times_all;
 
-  for (int i_ev = 0; i_ev < (int) channels_times.size(); i_ev++){
+  for (int i_ev = 0; i_ev < (int) plot_channels_times.size(); i_ev++){
 
     int num_pmts = 0;
     std::vector<std::vector<int>> temp_times;
     //std::cout <<"i_ev: "<<i_ev<<std::endl;
-    std::vector<std::vector<int>> channels_pmt_times = channels_times.at(i_ev);
+    std::vector<std::vector<int>> channels_pmt_times = plot_channels_times.at(i_ev);
     for (int i_ch = 0; i_ch < (int) channels_pmt_times.size(); i_ch++){
       std::vector<int> temp_times_single;
       std::vector<int> ch_hits = channels_pmt_times.at(i_ch);
@@ -3057,9 +3394,9 @@ void MonitorTankTime::DrawFileHistory(ULong64_t timestamp_end, double time_frame
   //Creates a plot showing the time stamps for all the files within the last time_frame mins
   //The plot is updated with the update_frequency specified in the configuration file (default: 5 mins)
 
-  if (timestamp_end != readfromfile_tend || time_frame != readfromfile_timeframe) ReadFromFile(timestamp_end, time_frame);
+  if (timestamp_end != readfromfile_tend || time_frame != readfromfile_timeframe || readfromfile_history) ReadFromFile(timestamp_end, time_frame, false);
 
-  timestamp_end += utc_to_t;
+  timestamp_end += plot_utc_to_t;
 
   ULong64_t timestamp_start = timestamp_end - time_frame*MSEC_to_SEC*SEC_to_MIN*MIN_to_HOUR;
   std::stringstream ss_timeframe;
@@ -3077,7 +3414,7 @@ void MonitorTankTime::DrawFileHistory(ULong64_t timestamp_end, double time_frame
 
   std::vector<TLine*> file_markers;
   for (unsigned int i_file = 0; i_file < tend_plot.size(); i_file++){
-    TLine *line_file = new TLine((tend_plot.at(i_file)+utc_to_t)/MSEC_to_SEC,0.,(tend_plot.at(i_file)+utc_to_t)/MSEC_to_SEC,1.);
+    TLine *line_file = new TLine((tend_plot.at(i_file)+plot_utc_to_t)/MSEC_to_SEC,0.,(tend_plot.at(i_file)+plot_utc_to_t)/MSEC_to_SEC,1.);
     line_file->SetLineColor(1);
     line_file->SetLineStyle(1);
     line_file->SetLineWidth(_linewidth);
@@ -3163,6 +3500,23 @@ void MonitorTankTime::CardIDToElectronicsSpace(int CardID,
   return;
 }
 
+void MonitorTankTime::CopyHistogram(TH1 *source, TH1 *target){
+
+  //copy bin contents, entries and attached fit functions, but keep name/title/style of the target histogram
+  target->Reset();
+  target->SetBins(source->GetNbinsX(),source->GetXaxis()->GetXmin(),source->GetXaxis()->GetXmax());
+  for (int i_bin = 0; i_bin <= source->GetNbinsX()+1; i_bin++){
+    target->SetBinContent(i_bin,source->GetBinContent(i_bin));
+  }
+  target->SetEntries(source->GetEntries());
+  target->GetListOfFunctions()->Delete();
+  TIter next_function(source->GetListOfFunctions());
+  while (TObject *function = next_function()){
+    target->GetListOfFunctions()->Add(function->Clone());
+  }
+
+}
+
 std::string MonitorTankTime::convertTimeStamp_to_Date(ULong64_t timestamp){
 
   //format of date is YYYY_MM-DD
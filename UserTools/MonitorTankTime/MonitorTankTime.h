@@ -4,6 +4,8 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <mutex>
 
 #include "Tool.h"
 #include <Store.h>
@@ -36,6 +38,32 @@
 #include "TLatex.h"
 #include "TText.h"
 #include "TTree.h"
+#include "MonitoringHistory.h"
+#include "AsyncRenderQueue.h"
+
+/**
+ * \struct MonitorTankTimeSnapshot
+ *
+ * Immutable copy of the data needed to draw one plot type of MonitorTankTime, handed from Execute to the render thread.
+ * The live histograms are clones owned by the snapshot and only filled for the "LastFile" plot type in asynchronous mode.
+ */
+struct MonitorTankTimeSnapshot{
+  ~MonitorTankTimeSnapshot();
+  long t_file_start = 0;
+  long t_file_end = 0;
+  ULong64_t utc_to_t = 0;
+  long current_stamp = 0;
+  int config_index = -1;          //entry of the plot configuration to draw, -1 for all entries
+  std::vector<int> fifo1, fifo2;
+  std::vector<std::vector<std::vector<int>>> channels_times;
+  std::vector<TH1I*> hist_freq;
+  std::vector<TH1F*> hist_temp;
+  TH1I *hist_BRF = nullptr;
+  TH1I *hist_RWM = nullptr;
+  TH1F *hist_temp_BRF = nullptr;
+  TH1F *hist_temp_RWM = nullptr;
+  TH1F *hist_vme = nullptr;
+};
 
 
 
@@ -62,7 +90,9 @@ class MonitorTankTime: public Tool {
   void InitializeHists(); ///< Function to initialize all histograms and canvases
   void LoopThroughDecodedEvents(std::map<uint64_t, std::map<std::vector<int>, std::vector<uint16_t>>> finishedPMTWaves);
   void WriteToFile();
-  void ReadFromFile(ULong64_t timestamp_end, double time_frame);
+  void ReadFromFile(ULong64_t timestamp_end, double time_frame, bool allow_history=true);
+  void InitializeHistory(); ///< Open the multi-resolution monitoring history and backfill it from the daily ROOT files if requested
+  void ReadFromHistory(ULong64_t timestamp_start, ULong64_t timestamp_end); ///< Fill the *_plot containers from the rollups of the monitoring history
 
   //Draw functions
   void DrawLastFilePlots();
@@ -84,10 +114,18 @@ class MonitorTankTime: public Tool {
   void DrawFileHistory(ULong64_t timestamp_end, double time_frame, std::string file_ending, int _linewidth);
   void PrintFileTimeStamp(ULong64_t timestamp_end, double time_frame, std::string file_ending);
 
+  //plot publishing functions (drawing either directly or in the render thread)
+  std::shared_ptr<MonitorTankTimeSnapshot> MakeSnapshot();
+  void PublishLastFilePlots();    ///< Publish the plots of the last file
+  void PublishMonitorPlots();     ///< Publish the customly defined time frame plots
+  void PublishFileHistory();      ///< Publish the file history plots
+  void RenderSnapshot(const std::string &plot_type, const MonitorTankTimeSnapshot &snapshot);   ///< Draw one plot type from a snapshot, runs in the render thread in asynchronous mode
+
   //helper functions
   std::string convertTimeStamp_to_Date(ULong64_t timestamp);
   bool does_file_exist(std::string filename);
   void CardIDToElectronicsSpace(int CardID, int &CrateNum, int &SlotNum);
+  void CopyHistogram(TH1 *source, TH1 *target);
 
 
  private:
@@ -107,6 +145,13 @@ class MonitorTankTime: public Tool {
   int verbosity;
   std::string signal_channels;
   std::string disabled_channels;
+  bool use_history;
+  std::string history_levels;
+  int history_max_points;
+  double history_min_timeframe;
+  double history_backfill_days;
+  bool async_render;
+  int render_queue_size;
 
   //define variables that contain the configuration option for the plots
   std::vector<double> config_timeframes;
@@ -135,6 +180,7 @@ class MonitorTankTime: public Tool {
   long current_stamp, current_utc;
   ULong64_t readfromfile_tend;
   double readfromfile_timeframe;
+  bool readfromfile_history = false;
 
 
   //variables to convert times
@@ -195,6 +241,20 @@ class MonitorTankTime: public Tool {
   std::vector<ULong64_t> tstart_plot;
   std::vector<ULong64_t> tend_plot;
 
+  //multi-resolution history of the monitoring variables (rollups of the tankmonitor_tree entries)
+  MonitoringHistory *history = nullptr;
+
+  //asynchronous rendering: render thread, lock for the monitoring files/history shared by WriteToFile and ReadFromFile
+  AsyncRenderQueue<MonitorTankTimeSnapshot> *render_queue = nullptr;
+  std::mutex monitoring_file_mutex;
+
+  //data of the last file as seen by the draw functions (set from the published snapshot)
+  long plot_file_start = 0;
+  long plot_file_end = 0;
+  ULong64_t plot_utc_to_t = 21600000;
+  std::vector<int> plot_fifo1, plot_fifo2;
+  std::vector<std::vector<std::vector<int>>> plot_channels_times;
+
 
   //histograms to display the current VME properties
   TH2F *h2D_ped = nullptr;        //define 2D histograms to show the current rates, pedestal values, sigma values
@@ -211,6 +271,13 @@ class MonitorTankTime: public Tool {
   TH1I* hChannels_RWM = nullptr;
   TH1F* hChannels_temp_BRF = nullptr;
   TH1F* hChannels_temp_RWM = nullptr;
+  std::vector<TH1F*> intake_hChannels_temp;   //histograms filled by LoopThroughDecodedEvents, identical to the ones above
+  std::vector<TH1I*> intake_hChannels_freq;   //unless the plots are rendered asynchronously
+  TH1I* intake_hChannels_BRF = nullptr;
+  TH1I* intake_hChannels_RWM = nullptr;
+  TH1F* intake_hChannels_temp_BRF = nullptr;
+  TH1F* intake_hChannels_temp_RWM = nullptr;
+  TH1F* intake_hist_vme = nullptr;
   std::vector<TH1F*> hist_hitmap;
   std::vector<TH1F*> hist_hitmap_slot;
   std::map<unsigned int,std::vector<TBox*>> vector_box_inactive_hitmap;
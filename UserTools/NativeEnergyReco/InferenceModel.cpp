@@ -0,0 +1,229 @@
+#include "InferenceModel.h"
+
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+  const size_t DenseBlockRows = 16;
+
+  bool Expect(std::istream &in, const std::string &word, std::string &error){
+    std::string token;
+    in >> token;
+    if(token!=word){
+      error = "expected '"+word+"' but found '"+token+"'";
+      return false;
+    }
+    return true;
+  }
+
+}
+
+InferenceModel* InferenceModel::FromFile(std::string filename, std::string &error){
+
+  std::ifstream in(filename.c_str());
+  if(!in.is_open()){
+    error = "cannot open "+filename;
+    return nullptr;
+  }
+
+  int version = 0;
+  std::string type;
+  if(!Expect(in,"ANNIEMODEL",error)) return nullptr;
+  in >> version;
+  if(version!=1){
+    error = "unsupported model format version "+std::to_string(version);
+    return nullptr;
+  }
+  if(!Expect(in,"type",error)) return nullptr;
+  in >> type;
+
+  InferenceModel *model = nullptr;
+  if(type=="treeensemble") model = new TreeEnsembleModel();
+  else if(type=="dense") model = new DenseNetworkModel();
+  else {
+    error = "unknown model type "+type;
+    return nullptr;
+  }
+
+  size_t ninputs = 0;
+  bool ok = Expect(in,"inputs",error);
+  if(ok) in >> ninputs;
+  model->input_names.resize(ninputs);
+  model->input_offsets.resize(ninputs);
+  model->input_scales.resize(ninputs);
+  for(size_t i=0; ok && i<ninputs; i++){
+    in >> model->input_names[i] >> model->input_offsets[i] >> model->input_scales[i];
+  }
+  ok = ok && in.good() && model->ReadModel(in,error);
+  if(ok && in.fail()) { error = "unexpected end of file"; ok = false; }
+
+  if(!ok){
+    if(error=="") error = "cannot parse "+filename;
+    delete model;
+    return nullptr;
+  }
+  return model;
+}
+
+
+bool TreeEnsembleModel::ReadModel(std::istream &in, std::string &error){
+
+  size_t ntrees = 0;
+  if(!Expect(in,"base",error)) return false;
+  in >> base;
+  if(!Expect(in,"learning_rate",error)) return false;
+  in >> learning_rate;
+  if(!Expect(in,"trees",error)) return false;
+  in >> ntrees;
+
+  nodes.clear();
+  roots.clear();
+  roots.reserve(ntrees);
+  for(size_t t=0; t<ntrees && in.good(); t++){
+    size_t nnodes = 0;
+    if(!Expect(in,"tree",error)) return false;
+    in >> nnodes;
+    int32_t first = nodes.size();
+    roots.push_back(first);
+    for(size_t n=0; n<nnodes; n++){
+      Node node;
+      double value = 0.;
+      in >> node.feature >> node.threshold >> node.left >> node.right >> value;
+      if(node.feature<0){
+        node.threshold = value;
+        node.left = node.right = -1;
+      } else {
+        if(node.feature>=(int32_t)input_names.size() || node.left<0 || node.right<0
+           || node.left>=(int32_t)nnodes || node.right>=(int32_t)nnodes){
+          error = "invalid node "+std::to_string(n)+" in tree "+std::to_string(t);
+          return false;
+        }
+        node.left += first;
+        node.right += first;
+      }
+      nodes.push_back(node);
+    }
+  }
+  return true;
+}
+
+
+void TreeEnsembleModel::Predict(const double *rows, size_t nrows, size_t stride, const std::vector<int> &columns, double *out){
+
+  const size_t ninputs = input_names.size();
+  features.resize(nrows*ninputs);
+  for(size_t r=0; r<nrows; r++){
+    const double *row = rows + r*stride;
+    for(size_t i=0; i<ninputs; i++)
+      features[r*ninputs+i] = static_cast<float>((row[columns[i]]-input_offsets[i])/input_scales[i]);
+    out[r] = base;
+  }
+
+  // tree by tree, so one tree stays in cache for the whole block
+  const Node *pnodes = nodes.data();
+  for(int32_t root : roots){
+    for(size_t r=0; r<nrows; r++){
+      const float *x = &features[r*ninputs];
+      const Node *node = pnodes + root;
+      while(node->feature>=0){
+        node = pnodes + ((x[node->feature] <= node->threshold) ? node->left : node->right);
+      }
+      out[r] += learning_rate*node->threshold;
+    }
+  }
+}
+
+
+bool DenseNetworkModel::ReadModel(std::istream &in, std::string &error){
+
+  size_t nlayers = 0;
+  if(!Expect(in,"layers",error)) return false;
+  in >> nlayers;
+
+  layers.clear();
+  size_t expected_in = input_names.size();
+  for(size_t l=0; l<nlayers && in.good(); l++){
+    Layer layer;
+    std::string activation;
+    if(!Expect(in,"layer",error)) return false;
+    in >> layer.nin >> layer.nout >> activation;
+    if(layer.nin!=expected_in){
+      error = "layer "+std::to_string(l)+" has "+std::to_string(layer.nin)+" inputs, expected "+std::to_string(expected_in);
+      return false;
+    }
+    if(activation=="relu") layer.activation = relu;
+    else if(activation=="linear") layer.activation = linear;
+    else if(activation=="sigmoid") layer.activation = sigmoid;
+    else if(activation=="tanh") layer.activation = tanh_act;
+    else {
+      error = "unknown activation "+activation;
+      return false;
+    }
+    layer.weights.resize(layer.nin*layer.nout);
+    layer.biases.resize(layer.nout);
+    double value = 0.;
+    for(float &w : layer.weights){ in >> value; w = value; }
+    for(float &b : layer.biases){ in >> value; b = value; }
+    expected_in = layer.nout;
+    layers.push_back(layer);
+  }
+  if(layers.empty() || layers.back().nout!=1){
+    error = "the network must have one output";
+    return false;
+  }
+  return true;
+}
+
+
+void DenseNetworkModel::Forward(const Layer &layer, const float *in, size_t nrows, float *out){
+
+  const size_t nin = layer.nin;
+  const size_t nout = layer.nout;
+  const float *weights = layer.weights.data();
+  const float *biases = layer.biases.data();
+
+  for(size_t r0=0; r0<nrows; r0+=DenseBlockRows){
+    const size_t r1 = std::min(nrows, r0+DenseBlockRows);
+    for(size_t r=r0; r<r1; r++)
+      std::copy(biases, biases+nout, out+r*nout);
+    // each weight row is used for all rows of the block; the inner loop is contiguous and vectorises
+    for(size_t i=0; i<nin; i++){
+      const float *wrow = weights + i*nout;
+      for(size_t r=r0; r<r1; r++){
+        const float xi = in[r*nin+i];
+        float *orow = out + r*nout;
+        for(size_t j=0; j<nout; j++) orow[j] += xi*wrow[j];
+      }
+    }
+  }
+
+  float *end = out + nrows*nout;
+  switch(layer.activation){
+    case relu:     for(float *o=out; o<end; o++) *o = (*o > 0.f) ? *o : 0.f; break;
+    case sigmoid:  for(float *o=out; o<end; o++) *o = 1.f/(1.f+std::exp(-*o)); break;
+    case tanh_act: for(float *o=out; o<end; o++) *o = std::tanh(*o); break;
+    case linear:   break;
+  }
+}
+
+
+void DenseNetworkModel::Predict(const double *rows, size_t nrows, size_t stride, const std::vector<int> &columns, double *out){
+
+  const size_t ninputs = input_names.size();
+  buffer_in.resize(nrows*ninputs);
+  for(size_t r=0; r<nrows; r++){
+    const double *row = rows + r*stride;
+    for(size_t i=0; i<ninputs; i++)
+      buffer_in[r*ninputs+i] = static_cast<float>((row[columns[i]]-input_offsets[i])/input_scales[i]);
+  }
+
+  for(const Layer &layer : layers){
+    buffer_out.resize(nrows*layer.nout);
+    Forward(layer, buffer_in.data(), nrows, buffer_out.data());
+    buffer_in.swap(buffer_out);
+  }
+
+  for(size_t r=0; r<nrows; r++) out[r] = buffer_in[r];
+}
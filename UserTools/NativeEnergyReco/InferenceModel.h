@@ -0,0 +1,123 @@
+#ifndef InferenceModel_H
+#define InferenceModel_H
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <stdint.h>
+
+/**
+ * \class InferenceModel
+ *
+ * Regression model exported from python by export_models.py and evaluated in C++.
+ * A model file is a text file:
+ *   ANNIEMODEL 1
+ *   type treeensemble | dense
+ *   inputs <n>
+ *   <name> <offset> <scale>           n lines, the model sees (x-offset)/scale
+ *   ...model specific part, see TreeEnsembleModel and DenseNetworkModel
+ * Numbers are written with 17 significant digits, so the parameters are exact.
+ */
+
+class InferenceModel {
+
+ public:
+
+  virtual ~InferenceModel(){}
+
+  /// Read a model file, returns nullptr and sets error if the file is not a valid model
+  static InferenceModel* FromFile(std::string filename, std::string &error);
+
+  /// Predict nrows rows. Row r starts at rows+r*stride and input i of the model is column columns[i] of the row.
+  virtual void Predict(const double *rows, size_t nrows, size_t stride, const std::vector<int> &columns, double *out) = 0;
+
+  std::vector<std::string> input_names;
+  std::vector<double> input_offsets;
+  std::vector<double> input_scales;
+
+ protected:
+
+  virtual bool ReadModel(std::istream &in, std::string &error) = 0;
+
+};
+
+/**
+ * \class TreeEnsembleModel
+ *
+ * Gradient boosted regression trees (sklearn GradientBoostingRegressor):
+ *   base <initial prediction>
+ *   learning_rate <value>
+ *   trees <n>
+ *   tree <nnodes>                     n times, followed by nnodes lines
+ *   <feature> <threshold> <left> <right> <value>    feature -1 marks a leaf, children are indices within the tree
+ * The nodes of all trees are kept in one flat array. Like sklearn, inputs are converted to float before
+ * comparing with the threshold and the trees are summed in order, so the result equals predict() exactly.
+ */
+
+class TreeEnsembleModel : public InferenceModel {
+
+ public:
+
+  void Predict(const double *rows, size_t nrows, size_t stride, const std::vector<int> &columns, double *out);
+
+ protected:
+
+  bool ReadModel(std::istream &in, std::string &error);
+
+ private:
+
+  struct Node {
+    double threshold;   // value of the leaf if feature<0
+    int32_t feature;
+    int32_t left;       // absolute node index
+    int32_t right;
+  };
+
+  double base = 0.;
+  double learning_rate = 1.;
+  std::vector<Node> nodes;
+  std::vector<int32_t> roots;
+  std::vector<float> features;   // converted inputs of the current block, row-major
+
+};
+
+/**
+ * \class DenseNetworkModel
+ *
+ * Fully connected network (keras Sequential of Dense layers):
+ *   layers <n>
+ *   layer <nin> <nout> <relu|linear|sigmoid|tanh>   n times, each followed by
+ *   nin*nout weights, row-major [in][out] as in keras, then nout biases
+ * Evaluated in float like keras, several rows at a time so each weight row is loaded once per block.
+ * Results agree with keras within float rounding (summation order differs).
+ */
+
+class DenseNetworkModel : public InferenceModel {
+
+ public:
+
+  void Predict(const double *rows, size_t nrows, size_t stride, const std::vector<int> &columns, double *out);
+
+ protected:
+
+  bool ReadModel(std::istream &in, std::string &error);
+
+ private:
+
+  enum Activation { linear, relu, sigmoid, tanh_act };
+
+  struct Layer {
+    size_t nin, nout;
+    Activation activation;
+    std::vector<float> weights;
+    std::vector<float> biases;
+  };
+
+  void Forward(const Layer &layer, const float *in, size_t nrows, float *out);
+
+  std::vector<Layer> layers;
+  std::vector<float> buffer_in, buffer_out;
+
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "NativeEnergyReco.h"
+
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <limits>
+#include <cstdlib>
+#include <chrono>
+
+NativeEnergyReco::NativeEnergyReco():Tool(){}
+
+
+bool NativeEnergyReco::Initialise(std::string configfile, DataModel &data){
+
+  /////////////////// Usefull header ///////////////////////
+  if(configfile!="")  m_variables.Initialise(configfile); //loading config file
+  //m_variables.Print();
+
+  m_data= &data; //assigning transient data pointer
+  /////////////////////////////////////////////////////////////////
+
+  std::string model_list;
+  m_variables.Get("verbosity",verbosity);
+  m_variables.Get("InputFile",input_file);
+  m_variables.Get("OutputFile",output_file);
+  m_variables.Get("ModelList",model_list);
+  m_variables.Get("BatchSize",batch_size);
+  m_variables.Get("OutputPrecision",output_precision);
+  if(batch_size<1) batch_size=1;
+
+  // one model per line: <output column name> <model file>
+  std::ifstream list(model_list.c_str());
+  if(!list.is_open()){
+    Log("NativeEnergyReco Error: cannot open ModelList "+model_list,v_error,verbosity);
+    return false;
+  }
+  std::string line;
+  while(std::getline(list,line)){
+    if(line.empty() || line[0]=='#') continue;
+    std::stringstream ss(line);
+    std::string name, file, error;
+    if(!(ss >> name >> file)) continue;
+    InferenceModel *model = InferenceModel::FromFile(file,error);
+    if(!model){
+      Log("NativeEnergyReco Error: model "+file+": "+error,v_error,verbosity);
+      return false;
+    }
+    Log("NativeEnergyReco: loaded "+file+" ("+std::to_string(model->input_names.size())+" inputs) for "+name,v_message,verbosity);
+    model_outputs.push_back(name);
+    models.push_back(model);
+  }
+  if(models.empty()){
+    Log("NativeEnergyReco Error: no models in "+model_list,v_error,verbosity);
+    return false;
+  }
+
+  return true;
+}
+
+
+bool NativeEnergyReco::Execute(){
+
+  if(done) return true;
+  done = true;
+
+  std::ifstream in(input_file.c_str());
+  std::ofstream out(output_file.c_str());
+  if(!in.is_open() || !out.is_open()){
+    Log("NativeEnergyReco Error: cannot open "+input_file+" or "+output_file,v_error,verbosity);
+    return false;
+  }
+
+  std::string header;
+  std::getline(in,header);
+  std::vector<std::string> columns = ParseHeader(header);
+  const size_t ncsv = columns.size();
+  for(const std::string &name : model_outputs) columns.push_back(name);
+  const size_t stride = columns.size();
+
+  // resolve the model inputs, the first column of a name wins like in pandas
+  std::map<std::string,int> column_index;
+  for(size_t c=0; c<columns.size(); c++) column_index.emplace(columns[c],c);
+  std::vector<std::vector<int> > model_columns(models.size());
+  for(size_t m=0; m<models.size(); m++){
+    for(const std::string &name : models[m]->input_names){
+      auto it = column_index.find(name);
+      if(it==column_index.end() || it->second>=(int)(ncsv+m)){
+        Log("NativeEnergyReco Error: input "+name+" of "+model_outputs[m]+" is not available",v_error,verbosity);
+        return false;
+      }
+      model_columns[m].push_back(it->second);
+    }
+  }
+
+  out << header;
+  for(const std::string &name : model_outputs) out << "," << name;
+  out << "\n";
+  out.precision(output_precision);
+
+  std::vector<std::string> lines(batch_size);
+  std::vector<double> block(batch_size*stride);
+  std::vector<double> prediction(batch_size);
+  size_t nrows_total = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  while(in.good()){
+    size_t nrows = 0;
+    while(nrows<(size_t)batch_size && std::getline(in,lines[nrows])){
+      if(lines[nrows].empty()) continue;
+      ParseRow(lines[nrows], &block[nrows*stride], ncsv);
+      nrows++;
+    }
+    if(nrows==0) break;
+
+    for(size_t m=0; m<models.size(); m++){
+      models[m]->Predict(block.data(), nrows, stride, model_columns[m], prediction.data());
+      for(size_t r=0; r<nrows; r++) block[r*stride+ncsv+m] = prediction[r];
+    }
+
+    for(size_t r=0; r<nrows; r++){
+      out << lines[r];
+      for(size_t m=0; m<models.size(); m++) out << "," << block[r*stride+ncsv+m];
+      out << "\n";
+    }
+    nrows_total += nrows;
+  }
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  Log("NativeEnergyReco: evaluated "+std::to_string(nrows_total)+" events in "+std::to_string(seconds)+" s, output in "+output_file,v_message,verbosity);
+
+  return true;
+}
+
+
+bool NativeEnergyReco::Finalise(){
+
+  for(InferenceModel *model : models) delete model;
+  models.clear();
+
+  return true;
+}
+
+
+std::vector<std::string> NativeEnergyReco::ParseHeader(const std::string &line){
+
+  // same column names as pandas.read_csv, which the python scripts and the exported models use
+  std::vector<std::string> names;
+  std::map<std::string,int> seen;
+  std::stringstream ss(line);
+  std::string name;
+  while(std::getline(ss,name,',')){
+    if(!name.empty() && name.back()=='\r') name.pop_back();
+    if(name.empty()) name = "Unnamed: "+std::to_string(names.size());
+    int count = seen[name]++;
+    if(count>0) name += "."+std::to_string(count);
+    names.push_back(name);
+  }
+  return names;
+}
+
+
+void NativeEnergyReco::ParseRow(const std::string &line, double *row, size_t ncolumns){
+
+  const char *p = line.c_str();
+  for(size_t c=0; c<ncolumns; c++){
+    char *end = nullptr;
+    double value = std::strtod(p,&end);
+    if(end==p) value = std::numeric_limits<double>::quiet_NaN();
+    row[c] = value;
+    // next field
+    p = end;
+    while(*p && *p!=',') p++;
+    if(*p==',') p++;
+  }
+}
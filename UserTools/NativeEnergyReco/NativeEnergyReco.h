@@ -0,0 +1,55 @@
+#ifndef NativeEnergyReco_H
+#define NativeEnergyReco_H
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <limits>
+
+#include "Tool.h"
+#include "InferenceModel.h"
+
+/**
+ * \class NativeEnergyReco
+ *
+ * Evaluates the track length DNN and the energy BDTs in C++, replacing the python prediction scripts
+ * of DNNTrackLength and EnergyReco. Reads the csv file of FindTrackLengthInWater (or any csv with a header),
+ * evaluates the models of ModelList in order in blocks of BatchSize rows and writes the input rows with
+ * one extra column per model. A model can use the outputs of the models before it as inputs.
+ */
+
+class NativeEnergyReco: public Tool {
+
+
+ public:
+
+  NativeEnergyReco();
+  bool Initialise(std::string configfile,DataModel &data);
+  bool Execute();
+  bool Finalise();
+
+
+ private:
+
+  std::vector<std::string> ParseHeader(const std::string &line);
+  void ParseRow(const std::string &line, double *row, size_t ncolumns);
+
+  std::string input_file;
+  std::string output_file;
+  int batch_size = 256;
+  int output_precision = std::numeric_limits<double>::max_digits10;
+  int verbosity = 1;
+
+  std::vector<std::string> model_outputs;
+  std::vector<InferenceModel*> models;
+  bool done = false;
+
+  int v_error=0;
+  int v_warning=1;
+  int v_message=2;
+  int v_debug=3;
+
+};
+
+
+#endif
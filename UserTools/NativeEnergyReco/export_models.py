@@ -0,0 +1,105 @@
+##### Export the trained EnergyReco BDTs and the DNNTrackLength network to the text format read by NativeEnergyReco
+#
+# BDT (sklearn GradientBoostingRegressor pickled by BDT_*EnergyReco_train.py):
+#   python3 export_models.py bdt finalized_BDTmodel_forMuonEnergy.sav MuonEnergyBDT.model \
+#       DNNRecoLength/600 TrueTrackLengthInMrd diffDirAbs recoDWallR recoDWallZ totalLAPPDs/200 totalPMTs/200 vtxX/150 vtxY/200 vtxZ/150
+#   the inputs are the csv columns in the order used for training, "/x" divides the column by x like the python scripts
+#
+# DNN (keras weights saved by DNNFindTrackLengthInWater_Keras_train.py):
+#   python3 export_models.py dnn weights_bets.hdf5 DNNTrackLength.model data_forRecoLength.csv --train-rows 1000
+#   rebuilds the network of DNNFindTrackLengthInWater_Keras_pred.py (2203 inputs, 25, 25, 1, relu) and the
+#   StandardScaler fitted on the first --train-rows rows of the csv
+
+import sys
+import argparse
+import pickle
+import numpy as np
+
+def write_inputs(out, names, offsets, scales):
+    out.write('inputs %d\n' % len(names))
+    for name, offset, scale in zip(names, offsets, scales):
+        out.write('%s %.17g %.17g\n' % (name, offset, scale))
+
+def export_bdt(args):
+    model = pickle.load(open(args.model, 'rb'))
+    names, scales = [], []
+    for spec in args.inputs:
+        name, _, scale = spec.partition('/')
+        names.append(name)
+        scales.append(float(scale) if scale else 1.)
+
+    X0 = np.zeros((1, len(names)))
+    if hasattr(model, '_raw_predict_init'):
+        base = model._raw_predict_init(X0)[0, 0]
+    elif hasattr(model, '_init_decision_function'):
+        base = model._init_decision_function(X0)[0, 0]
+    else:
+        base = model.init_.predict(X0)[0]
+
+    with open(args.output, 'w') as out:
+        out.write('ANNIEMODEL 1\ntype treeensemble\n')
+        write_inputs(out, names, [0.]*len(names), scales)
+        out.write('base %.17g\nlearning_rate %.17g\ntrees %d\n' % (base, model.learning_rate, model.estimators_.shape[0]))
+        for estimator in model.estimators_[:, 0]:
+            tree = estimator.tree_
+            out.write('tree %d\n' % tree.node_count)
+            for n in range(tree.node_count):
+                leaf = tree.children_left[n] < 0
+                out.write('%d %.17g %d %d %.17g\n' % (-1 if leaf else tree.feature[n], tree.threshold[n],
+                          tree.children_left[n], tree.children_right[n], tree.value[n, 0, 0]))
+
+    print('exported %d trees with %d inputs to %s' % (model.estimators_.shape[0], len(names), args.output))
+
+def export_dnn(args):
+    import pandas as pd
+    from sklearn import preprocessing
+    from tensorflow.keras.models import Sequential
+    from tensorflow.keras.layers import Dense
+
+    data = pd.read_csv(args.csv)
+    names = list(data.columns[:args.nfeatures])
+    scaler = preprocessing.StandardScaler()
+    scaler.fit(np.array(data)[:args.train_rows, :args.nfeatures])
+
+    units = [int(u) for u in args.layers.split(',')]
+    model = Sequential()
+    model.add(Dense(units[0], input_dim=args.nfeatures, kernel_initializer='normal', activation=args.activation))
+    for u in units[1:]:
+        model.add(Dense(u, kernel_initializer='normal', activation=args.activation))
+    model.load_weights(args.model)
+
+    with open(args.output, 'w') as out:
+        out.write('ANNIEMODEL 1\ntype dense\n')
+        write_inputs(out, names, scaler.mean_, scaler.scale_)
+        out.write('layers %d\n' % len(model.layers))
+        for layer in model.layers:
+            kernel, bias = layer.get_weights()
+            out.write('layer %d %d %s\n' % (kernel.shape[0], kernel.shape[1], layer.get_config()['activation']))
+            out.write(' '.join('%.9g' % w for w in kernel.reshape(-1)) + '\n')
+            out.write(' '.join('%.9g' % b for b in bias) + '\n')
+
+    print('exported %d layers with %d inputs to %s' % (len(model.layers), args.nfeatures, args.output))
+
+parser = argparse.ArgumentParser()
+sub = parser.add_subparsers(dest='kind')
+bdt = sub.add_parser('bdt')
+bdt.add_argument('model')
+bdt.add_argument('output')
+bdt.add_argument('inputs', nargs='+')
+dnn = sub.add_parser('dnn')
+dnn.add_argument('model')
+dnn.add_argument('output')
+dnn.add_argument('csv')
+dnn.add_argument('--train-rows', type=int, default=1000)
+dnn.add_argument('--nfeatures', type=int, default=2203)
+dnn.add_argument('--layers', default='25,25,1')
+dnn.add_argument('--activation', default='relu')
+args = parser.parse_args()
+
+if args.kind == 'bdt':
+    export_bdt(args)
+elif args.kind == 'dnn':
+    export_dnn(args)
+else:
+    parser.print_help()
+    sys.exit(1)
@@ -36,6 +36,10 @@ bool PMTDataDecoder::Initialise(std::string configfile, DataModel &data){
   FinishedPMTWaves = new std::map<uint64_t, std::map<std::vector<int>, std::vector<uint16_t> > >; 
 
   m_data->CStore.Set("PauseTankDecoding",false);
+
+  bool ResumeFromCheckpoint = false;
+  m_data->CStore.Get("ResumeFromCheckpoint",ResumeFromCheckpoint);
+  if(ResumeFromCheckpoint) this->LoadCheckpoint();
   std::cout << "PMTDataDecoder Tool: Initialized successfully" << std::endl;
   return true;
 }
@@ -46,6 +50,13 @@ bool PMTDataDecoder::Execute(){
   NewWavesBuilt = false;
   //Set in CStore that there's currently no new tank data available
   m_data->CStore.Set("NewTankPMTDataAvailable",false);
+
+  bool CheckpointRequested = false;
+  m_data->CStore.Get("SaveCheckpoint",CheckpointRequested);
+  if(CheckpointRequested) this->SaveCheckpoint();
+  bool WaitingForRawData = false;
+  m_data->CStore.Get("WaitingForRawData",WaitingForRawData);
+  if(WaitingForRawData) return true;
  
   //******** PROCESSING DATA IN MONITORING MODE  ********** 
   if (Mode == "Monitoring"){
@@ -548,3 +559,26 @@ void PMTDataDecoder::AddSamplesToWaveBank(int CardID, int ChannelID,
   }
   return;
 }
+
+void PMTDataDecoder::SaveCheckpoint(){
+  //Waves still being built and triggers not complete yet; SyncCounters are not used for building
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  Checkpoint->Set("PMTSequenceMap",SequenceMap);
+  Checkpoint->Set("PMTTriggerTimeBank",TriggerTimeBank);
+  Checkpoint->Set("PMTWaveBank",WaveBank);
+  Checkpoint->Set("PMTInProgressTankEvents",*FinishedPMTWaves);
+  Checkpoint->Set("PMTCurrentRunNum",CurrentRunNum);
+  Checkpoint->Set("PMTCurrentSubrunNum",CurrentSubrunNum);
+}
+
+void PMTDataDecoder::LoadCheckpoint(){
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  Checkpoint->Get("PMTSequenceMap",SequenceMap);
+  Checkpoint->Get("PMTTriggerTimeBank",TriggerTimeBank);
+  Checkpoint->Get("PMTWaveBank",WaveBank);
+  Checkpoint->Get("PMTInProgressTankEvents",*FinishedPMTWaves);
+  Checkpoint->Get("PMTCurrentRunNum",CurrentRunNum);
+  Checkpoint->Get("PMTCurrentSubrunNum",CurrentSubrunNum);
+  Log("PMTDataDecoder Tool: Resumed with "+to_string(WaveBank.size())+" waves and "+
+      to_string(FinishedPMTWaves->size())+" triggers in progress",v_message,verbosity);
+}
@@ -56,6 +56,8 @@ class PMTDataDecoder: public Tool {
   void AddSamplesToWaveBank(int CardID, int ChannelID, std::vector<uint16_t> WaveSlice);
   bool CheckIfCardNextInSequence(CardData aCardData);
   void BuildReadyEvents();
+  void SaveCheckpoint();   ///< Add the decoding state to the Checkpoint store (LoadRawData Online mode)
+  void LoadCheckpoint();
 
 
  private:
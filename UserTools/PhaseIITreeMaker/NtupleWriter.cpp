@@ -0,0 +1,157 @@
+#include "NtupleWriter.h"
+
+#include <exception>
+
+NtupleWriter::NtupleWriter(){}
+
+NtupleWriter::~NtupleWriter(){
+  Stop();
+}
+
+int NtupleWriter::AddTree(TTree* tree){
+  trees.emplace_back();
+  trees.back().tree = tree;
+  return trees.size()-1;
+}
+
+void NtupleWriter::Start(bool async_write, int entries_per_basket, int baskets_per_tree){
+  if(started) return;
+  async = async_write;
+  basket_entries = (entries_per_basket>0) ? entries_per_basket : 1;
+  if(baskets_per_tree<1) baskets_per_tree = 1;
+
+  for(size_t i=0; i<trees.size(); i++){
+    TreeColumns &columns = trees.at(i);
+    for(size_t c=0; c<columns.columns.size(); c++) columns.columns.at(c)->Branch(columns.tree,async);
+    if(!async) continue;
+    for(int b=0; b<baskets_per_tree; b++){
+      Basket* basket = new Basket();
+      basket->tree = i;
+      basket->rows.reserve(basket_entries*columns.row_size);
+      basket->vector_data.resize(columns.n_vectors);
+      basket->vector_ends.resize(columns.n_vectors);
+      for(size_t v=0; v<columns.n_vectors; v++) basket->vector_ends.at(v).reserve(basket_entries);
+      columns.baskets.emplace_back(basket);
+      columns.free_baskets.push_back(basket);
+    }
+  }
+
+  if(async){
+    stop_writer = false;
+    writer_thread = std::thread(&NtupleWriter::WriterLoop,this);
+  }
+  started = true;
+}
+
+void NtupleWriter::Fill(int tree){
+  TreeColumns &columns = trees.at(tree);
+  entries_filled++;
+  if(!async){
+    columns.tree->Fill();
+    return;
+  }
+
+  if(columns.current==nullptr){
+    // back-pressure: wait until the writer gives a basket of this tree back
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    if(columns.free_baskets.empty()){
+      producer_waits++;
+      queue_cv.wait(lock,[&columns]{ return !columns.free_baskets.empty(); });
+    }
+    columns.current = columns.free_baskets.back();
+    columns.free_baskets.pop_back();
+  }
+
+  Basket &basket = *columns.current;
+  basket.rows.resize((basket.entries+1)*columns.row_size);
+  char* row = basket.rows.data()+basket.entries*columns.row_size;
+  for(size_t c=0; c<columns.columns.size(); c++) columns.columns.at(c)->Copy(basket,row);
+  basket.entries++;
+
+  if(basket.entries>=basket_entries){
+    Submit(columns.current);
+    columns.current = nullptr;
+  }
+}
+
+void NtupleWriter::Submit(Basket* basket){
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    full_baskets.push_back(basket);
+  }
+  queue_cv.notify_all();
+}
+
+bool NtupleWriter::Stop(){
+  if(!started) return true;
+  started = false;
+  if(!async) return true;
+
+  for(size_t i=0; i<trees.size(); i++){
+    TreeColumns &columns = trees.at(i);
+    if(columns.current==nullptr) continue;
+    if(columns.current->entries>0) Submit(columns.current);
+    else {
+      // the writer thread gives baskets back to the same free list
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      columns.free_baskets.push_back(columns.current);
+    }
+    columns.current = nullptr;
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    stop_writer = true;
+  }
+  queue_cv.notify_all();
+  if(writer_thread.joinable()) writer_thread.join();
+
+  return writer_error=="";
+}
+
+void NtupleWriter::WriterLoop(){
+
+  while(true){
+    Basket* basket = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      queue_cv.wait(lock,[this]{ return stop_writer || !full_baskets.empty(); });
+      if(full_baskets.empty()) return;  // stop requested and everything written
+      basket = full_baskets.front();
+      full_baskets.pop_front();
+    }
+
+    // after an error the baskets are still given back, so Fill never waits forever
+    if(writer_error=="") WriteBasket(*basket);
+    basket->Clear();
+
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      trees.at(basket->tree).free_baskets.push_back(basket);
+      baskets_written++;
+    }
+    queue_cv.notify_all();
+  }
+
+}
+
+void NtupleWriter::WriteBasket(Basket &basket){
+
+  TreeColumns &columns = trees.at(basket.tree);
+  try{
+    for(size_t entry=0; entry<basket.entries; entry++){
+      const char* row = basket.rows.data()+entry*columns.row_size;
+      for(size_t c=0; c<columns.columns.size(); c++) columns.columns.at(c)->Load(basket,entry,row);
+      if(columns.tree->Fill()<0){
+        writer_error = std::string("TTree::Fill failed for ")+columns.tree->GetName();
+        return;
+      }
+    }
+  }
+  catch(std::exception &e){
+    writer_error = std::string("failed to fill ")+columns.tree->GetName()+": "+e.what();
+  }
+  catch(...){
+    writer_error = std::string("failed to fill ")+columns.tree->GetName();
+  }
+
+}
@@ -0,0 +1,163 @@
+#ifndef NtupleWriter_H
+#define NtupleWriter_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <stdint.h>
+
+#include "TTree.h"
+
+/**
+ * \class NtupleWriter
+ *
+ * Output engine of PhaseIITreeMaker. The tool registers the branches it wants to write per tree in
+ * Initialise, as columns bound to its branch variables; groups that are not configured are never
+ * registered and cost nothing per event. Fill(tree) takes the current values of the columns of that tree.
+ *
+ * In synchronous mode the TTree branches point at the tool variables and Fill calls TTree::Fill directly.
+ * In asynchronous mode Fill only copies the values into the column buffers of a basket of entries; full
+ * baskets are handed to a writer thread, which owns the TTrees from then on and does the TTree::Fill,
+ * compression and file writing. The baskets are recycled, and Fill waits when all baskets of a tree
+ * are queued (back-pressure), so memory stays bounded. Stop() writes the partial baskets and joins the
+ * thread; only after it the trees may be used again from the calling thread.
+ */
+class NtupleWriter{
+
+ public:
+
+  NtupleWriter();
+  ~NtupleWriter();
+
+  int AddTree(TTree* tree);   ///< Returns the index of the tree for the Add and Fill calls
+
+  /// Scalar branch with a ROOT leaf list, like TTree::Branch(name,&value,leaflist)
+  template<class T> void AddScalar(int tree, const std::string &name, T* value, const std::string &leaflist){
+    TreeColumns &columns = trees.at(tree);
+    columns.columns.emplace_back(new ScalarColumn<T>(name,value,leaflist,columns.row_size));
+    columns.row_size += sizeof(T);
+  }
+
+  /// std::vector branch, like TTree::Branch(name,&values)
+  template<class T> void AddVector(int tree, const std::string &name, std::vector<T>* values){
+    TreeColumns &columns = trees.at(tree);
+    columns.columns.emplace_back(new VectorColumn<T>(name,values,columns.n_vectors));
+    columns.n_vectors++;
+  }
+
+  /// Create the branches and, in asynchronous mode, start the writer thread
+  void Start(bool async, int basket_entries, int baskets_per_tree);
+  void Fill(int tree);
+  bool Stop();   ///< Write everything still buffered and stop the writer. False if writing failed.
+
+  const std::string& GetError() const {return writer_error;}
+  unsigned long GetNumEntries() const {return entries_filled;}
+  unsigned long GetNumBaskets() const {return baskets_written;}
+  unsigned long GetNumWaits() const {return producer_waits;}
+
+ private:
+
+  NtupleWriter(const NtupleWriter&) = delete;
+  NtupleWriter& operator=(const NtupleWriter&) = delete;
+
+  /// Values of basket_entries entries of one tree: the scalars row by row, the vectors concatenated
+  struct Basket{
+    int tree = 0;
+    size_t entries = 0;
+    std::vector<char> rows;
+    std::vector<std::vector<char>> vector_data;
+    std::vector<std::vector<uint32_t>> vector_ends;   // number of elements up to the end of each entry
+    void Clear(){
+      entries = 0;
+      rows.clear();
+      for(size_t i=0; i<vector_data.size(); i++){ vector_data[i].clear(); vector_ends[i].clear(); }
+    }
+  };
+
+  class Column{
+   public:
+    virtual ~Column(){}
+    virtual void Branch(TTree* tree, bool async) = 0;         ///< async: bind the branch to the writer side copy
+    virtual void Copy(Basket &basket, char* row) = 0;         ///< append the current value to the basket
+    virtual void Load(const Basket &basket, size_t entry, const char* row) = 0;   ///< set the writer side copy to an entry
+  };
+
+  template<class T> class ScalarColumn : public Column{
+   public:
+    ScalarColumn(const std::string &name, T* value, const std::string &leaflist, size_t offset) :
+      name(name), leaflist(leaflist), value(value), offset(offset) {
+      static_assert(sizeof(T)<=sizeof(slot),"NtupleWriter: scalar branches must be basic types");
+      std::memset(slot,0,sizeof(slot));
+    }
+    // the slot is wider than T and zeroed, so a leaf list wider than the variable reads zeros, not a neighbour
+    void Branch(TTree* tree, bool async){tree->Branch(name.c_str(),async ? static_cast<void*>(slot) : static_cast<void*>(value),leaflist.c_str());}
+    void Copy(Basket &basket, char* row){std::memcpy(row+offset,value,sizeof(T));}
+    void Load(const Basket &basket, size_t entry, const char* row){std::memcpy(slot,row+offset,sizeof(T));}
+   private:
+    std::string name;
+    std::string leaflist;
+    T* value;
+    size_t offset;
+    uint64_t slot[2];
+  };
+
+  template<class T> class VectorColumn : public Column{
+   public:
+    VectorColumn(const std::string &name, std::vector<T>* values, size_t index) : name(name), values(values), index(index) {}
+    void Branch(TTree* tree, bool async){tree->Branch(name.c_str(),async ? &copy : values);}
+    void Copy(Basket &basket, char* row){
+      std::vector<char> &data = basket.vector_data[index];
+      const char* begin = reinterpret_cast<const char*>(values->data());
+      data.insert(data.end(),begin,begin+values->size()*sizeof(T));
+      basket.vector_ends[index].push_back(data.size()/sizeof(T));
+    }
+    void Load(const Basket &basket, size_t entry, const char* row){
+      const std::vector<uint32_t> &ends = basket.vector_ends[index];
+      uint32_t begin = (entry>0) ? ends[entry-1] : 0;
+      copy.resize(ends[entry]-begin);
+      if(!copy.empty()) std::memcpy(copy.data(),basket.vector_data[index].data()+begin*sizeof(T),copy.size()*sizeof(T));
+    }
+   private:
+    std::string name;
+    std::vector<T>* values;
+    size_t index;
+    std::vector<T> copy;
+  };
+
+  struct TreeColumns{
+    TTree* tree = nullptr;
+    std::vector<std::unique_ptr<Column>> columns;
+    size_t row_size = 0;
+    size_t n_vectors = 0;
+    std::vector<std::unique_ptr<Basket>> baskets;   // all baskets of the tree, owned here
+    std::vector<Basket*> free_baskets;
+    Basket* current = nullptr;                       // basket being filled by the tool
+  };
+
+  void Submit(Basket* basket);
+  void WriterLoop();
+  void WriteBasket(Basket &basket);
+
+  std::vector<TreeColumns> trees;
+  bool async = false;
+  bool started = false;
+  size_t basket_entries = 1000;
+
+  std::thread writer_thread;
+  std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+  std::deque<Basket*> full_baskets;
+  bool stop_writer = false;
+  std::string writer_error;            ///< first error of the writer thread
+
+  unsigned long entries_filled = 0;
+  unsigned long baskets_written = 0;
+  unsigned long producer_waits = 0;    ///< Fill calls that had to wait for a free basket
+};
+
+#endif
@@ -27,12 +27,21 @@ bool PhaseIITreeMaker::Initialise(std::string configfile, DataModel &data){
   m_variables.Get("MRDClusterProcessing",MRDClusterProcessing);
   m_variables.Get("TriggerProcessing",TriggerProcessing);
 
+  int async_flag = 0;
+  m_variables.Get("AsyncWrite",async_flag);
+  AsyncWrite = (async_flag!=0);
+  m_variables.Get("BasketEntries",BasketEntries);
+  m_variables.Get("BasketsPerTree",BasketsPerTree);
+
   std::string output_filename;
   m_variables.Get("OutputFile", output_filename);
   fOutput_tfile = new TFile(output_filename.c_str(), "recreate");
   fPhaseIITankClusterTree = new TTree("phaseIITankClusterTree", "ANNIE Phase II Tank Cluster Tree");
   fPhaseIIMRDClusterTree = new TTree("phaseIIMRDClusterTree", "ANNIE Phase II MRD Cluster Tree");
   fPhaseIITrigTree = new TTree("phaseIITriggerTree", "ANNIE Phase II Ntuple Trigger Tree");
+  fTankClusterTreeIndex = fNtupleWriter.AddTree(fPhaseIITankClusterTree);
+  fMRDClusterTreeIndex = fNtupleWriter.AddTree(fPhaseIIMRDClusterTree);
+  fTrigTreeIndex = fNtupleWriter.AddTree(fPhaseIITrigTree);
 
   m_data->CStore.Get("AuxChannelNumToTypeMap",AuxChannelNumToTypeMap);
   m_data->CStore.Get("ChannelNumToTankPMTSPEChargeMap",ChannelKeyToSPEMap);
@@ -44,238 +53,246 @@ bool PhaseIITreeMaker::Initialise(std::string configfile, DataModel &data){
   }
  
   if(TankClusterProcessing){
-    fPhaseIITankClusterTree->Branch("runNumber",&fRunNumber,"runNumber/I");
-    fPhaseIITankClusterTree->Branch("subrunNumber",&fSubrunNumber,"subrunNumber/I");
-    fPhaseIITankClusterTree->Branch("runType",&fRunType,"runType/I");
-    fPhaseIITankClusterTree->Branch("startTime",&fStartTime,"startTime/l");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"runNumber",&fRunNumber,"runNumber/I");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"subrunNumber",&fSubrunNumber,"subrunNumber/I");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"runType",&fRunType,"runType/I");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"startTime",&fStartTime,"startTime/l");
 
     //Some lower level information to save
-    fPhaseIITankClusterTree->Branch("eventNumber",&fEventNumber,"eventNumber/I");
-    fPhaseIITankClusterTree->Branch("eventTimeTank",&fEventTimeTank,"eventTimeTank/l");
-    fPhaseIITankClusterTree->Branch("clusterNumber",&fClusterNumber,"clusterNumber/I");
-    fPhaseIITankClusterTree->Branch("clusterTime",&fClusterTime,"clusterTime/D");
-    fPhaseIITankClusterTree->Branch("clusterCharge",&fClusterCharge,"clusterCharge/D");
-    fPhaseIITankClusterTree->Branch("clusterPE",&fClusterPE,"clusterPE/D");
-    fPhaseIITankClusterTree->Branch("clusterMaxPE",&fClusterMaxPE,"clusterMaxPE/D");
-    fPhaseIITankClusterTree->Branch("clusterChargePointX",&fClusterChargePointX,"clusterChargePointX/D");
-    fPhaseIITankClusterTree->Branch("clusterChargePointY",&fClusterChargePointY,"clusterChargePointY/D");
-    fPhaseIITankClusterTree->Branch("clusterChargePointZ",&fClusterChargePointZ,"clusterChargePointZ/D");
-    fPhaseIITankClusterTree->Branch("clusterChargeBalance",&fClusterChargeBalance,"clusterChargeBalance/D");
-    fPhaseIITankClusterTree->Branch("clusterHits",&fClusterHits,"clusterHits/i");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"eventNumber",&fEventNumber,"eventNumber/I");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"eventTimeTank",&fEventTimeTank,"eventTimeTank/l");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"clusterNumber",&fClusterNumber,"clusterNumber/I");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"clusterTime",&fClusterTime,"clusterTime/D");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"clusterCharge",&fClusterCharge,"clusterCharge/D");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"clusterPE",&fClusterPE,"clusterPE/D");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"clusterMaxPE",&fClusterMaxPE,"clusterMaxPE/D");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"clusterChargePointX",&fClusterChargePointX,"clusterChargePointX/D");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"clusterChargePointY",&fClusterChargePointY,"clusterChargePointY/D");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"clusterChargePointZ",&fClusterChargePointZ,"clusterChargePointZ/D");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"clusterChargeBalance",&fClusterChargeBalance,"clusterChargeBalance/D");
+    fNtupleWriter.AddScalar(fTankClusterTreeIndex,"clusterHits",&fClusterHits,"clusterHits/i");
     if(TankHitInfo_fill){
-      fPhaseIITankClusterTree->Branch("filter",&fIsFiltered);
-      fPhaseIITankClusterTree->Branch("hitX",&fHitX);
-      fPhaseIITankClusterTree->Branch("hitY",&fHitY);
-      fPhaseIITankClusterTree->Branch("hitZ",&fHitZ);
-      fPhaseIITankClusterTree->Branch("hitT",&fHitT);
-      fPhaseIITankClusterTree->Branch("hitQ",&fHitQ);
-      fPhaseIITankClusterTree->Branch("hitPE",&fHitPE);
-      fPhaseIITankClusterTree->Branch("hitType", &fHitType);
-      fPhaseIITankClusterTree->Branch("hitDetID", &fHitDetID);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"filter",&fIsFiltered);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"hitX",&fHitX);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"hitY",&fHitY);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"hitZ",&fHitZ);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"hitT",&fHitT);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"hitQ",&fHitQ);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"hitPE",&fHitPE);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"hitType", &fHitType);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"hitDetID", &fHitDetID);
     }
     //SiPM Pulse Info; load into both trees for now...
     if(SiPMPulseInfo_fill){
-      fPhaseIITankClusterTree->Branch("SiPMhitQ",&fSiPMHitQ);
-      fPhaseIITankClusterTree->Branch("SiPMhitT",&fSiPMHitT);
-      fPhaseIITankClusterTree->Branch("SiPMhitAmplitude",&fSiPMHitAmplitude);
-      fPhaseIITankClusterTree->Branch("SiPMNum",&fSiPMNum);
-      fPhaseIITankClusterTree->Branch("SiPM1NPulses",&fSiPM1NPulses,"SiPM1NPulses/I");
-      fPhaseIITankClusterTree->Branch("SiPM2NPulses",&fSiPM2NPulses,"SiPM2NPulses/I");
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"SiPMhitQ",&fSiPMHitQ);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"SiPMhitT",&fSiPMHitT);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"SiPMhitAmplitude",&fSiPMHitAmplitude);
+      fNtupleWriter.AddVector(fTankClusterTreeIndex,"SiPMNum",&fSiPMNum);
+      fNtupleWriter.AddScalar(fTankClusterTreeIndex,"SiPM1NPulses",&fSiPM1NPulses,"SiPM1NPulses/I");
+      fNtupleWriter.AddScalar(fTankClusterTreeIndex,"SiPM2NPulses",&fSiPM2NPulses,"SiPM2NPulses/I");
     }
   } 
 
   if(MRDClusterProcessing){
-    fPhaseIIMRDClusterTree->Branch("runNumber",&fRunNumber,"runNumber/I");
-    fPhaseIIMRDClusterTree->Branch("subrunNumber",&fSubrunNumber,"subrunNumber/I");
-    fPhaseIIMRDClusterTree->Branch("runType",&fRunType,"runType/I");
-    fPhaseIIMRDClusterTree->Branch("startTime",&fStartTime,"startTime/l");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"runNumber",&fRunNumber,"runNumber/I");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"subrunNumber",&fSubrunNumber,"subrunNumber/I");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"runType",&fRunType,"runType/I");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"startTime",&fStartTime,"startTime/l");
 
 
     //Some lower level information to save
-    fPhaseIIMRDClusterTree->Branch("eventNumber",&fEventNumber,"eventNumber/I");
-    fPhaseIIMRDClusterTree->Branch("eventTimeMRD",&fEventTimeMRD,"eventTimeMRD/l");
-    fPhaseIIMRDClusterTree->Branch("eventTimeTank",&fEventTimeTank,"eventTimeTank/l");
-    fPhaseIIMRDClusterTree->Branch("clusterNumber",&fMRDClusterNumber,"clusterNumber/I");
-    fPhaseIIMRDClusterTree->Branch("clusterTime",&fMRDClusterTime,"clusterTime/D");
-    fPhaseIIMRDClusterTree->Branch("clusterTimeSigma",&fMRDClusterTimeSigma,"clusterTimeSigma/D");
-    fPhaseIIMRDClusterTree->Branch("clusterHits",&fMRDClusterHits,"clusterHits/i");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"eventNumber",&fEventNumber,"eventNumber/I");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"eventTimeMRD",&fEventTimeMRD,"eventTimeMRD/l");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"eventTimeTank",&fEventTimeTank,"eventTimeTank/l");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"clusterNumber",&fMRDClusterNumber,"clusterNumber/I");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"clusterTime",&fMRDClusterTime,"clusterTime/D");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"clusterTimeSigma",&fMRDClusterTimeSigma,"clusterTimeSigma/D");
+    fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"clusterHits",&fMRDClusterHits,"clusterHits/i");
     if(MRDHitInfo_fill){
-      fPhaseIIMRDClusterTree->Branch("MRDhitT",&fMRDHitT);
-      fPhaseIIMRDClusterTree->Branch("MRDhitDetID", &fMRDHitDetID);
-      fPhaseIIMRDClusterTree->Branch("vetoHit",&fVetoHit,"vetoHit/I");
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDhitT",&fMRDHitT);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDhitDetID", &fMRDHitDetID);
+      fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"vetoHit",&fVetoHit,"vetoHit/I");
     }
     if(MRDReco_fill){
-      fPhaseIIMRDClusterTree->Branch("numClusterTracks",&fNumClusterTracks,"numClusterTracks/I");
+      fNtupleWriter.AddScalar(fMRDClusterTreeIndex,"numClusterTracks",&fNumClusterTracks,"numClusterTracks/I");
     //Push back some properties
-      fPhaseIIMRDClusterTree->Branch("MRDTrackAngle",&fMRDTrackAngle);
-      fPhaseIIMRDClusterTree->Branch("MRDTrackAngleError",&fMRDTrackAngleError);
-      fPhaseIIMRDClusterTree->Branch("MRDPenetrationDepth",&fMRDPenetrationDepth);
-      fPhaseIIMRDClusterTree->Branch("MRDTrackLength",&fMRDTrackLength);
-      fPhaseIIMRDClusterTree->Branch("MRDEntryPointRadius",&fMRDEntryPointRadius);
-      fPhaseIIMRDClusterTree->Branch("MRDEnergyLoss",&fMRDEnergyLoss);
-      fPhaseIIMRDClusterTree->Branch("MRDEnergyLossError",&fMRDEnergyLossError);
-      fPhaseIIMRDClusterTree->Branch("MRDTrackStartX",&fMRDTrackStartX);
-      fPhaseIIMRDClusterTree->Branch("MRDTrackStartY",&fMRDTrackStartY);
-      fPhaseIIMRDClusterTree->Branch("MRDTrackStartZ",&fMRDTrackStartZ);
-      fPhaseIIMRDClusterTree->Branch("MRDTrackStopX",&fMRDTrackStopX);
-      fPhaseIIMRDClusterTree->Branch("MRDTrackStopY",&fMRDTrackStopY);
-      fPhaseIIMRDClusterTree->Branch("MRDTrackStopZ",&fMRDTrackStopZ);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDTrackAngle",&fMRDTrackAngle);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDTrackAngleError",&fMRDTrackAngleError);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDPenetrationDepth",&fMRDPenetrationDepth);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDTrackLength",&fMRDTrackLength);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDEntryPointRadius",&fMRDEntryPointRadius);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDEnergyLoss",&fMRDEnergyLoss);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDEnergyLossError",&fMRDEnergyLossError);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDTrackStartX",&fMRDTrackStartX);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDTrackStartY",&fMRDTrackStartY);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDTrackStartZ",&fMRDTrackStartZ);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDTrackStopX",&fMRDTrackStopX);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDTrackStopY",&fMRDTrackStopY);
+      fNtupleWriter.AddVector(fMRDClusterTreeIndex,"MRDTrackStopZ",&fMRDTrackStopZ);
     }
   }
 
   if(TriggerProcessing){
     //Metadata for standard Events
-    fPhaseIITrigTree->Branch("runNumber",&fRunNumber,"runNumber/I");
-    fPhaseIITrigTree->Branch("subrunNumber",&fSubrunNumber,"subrunNumber/I");
-    fPhaseIITrigTree->Branch("runType",&fRunType,"runType/I");
-    fPhaseIITrigTree->Branch("startTime",&fStartTime,"startTime/l");
+    fNtupleWriter.AddScalar(fTrigTreeIndex,"runNumber",&fRunNumber,"runNumber/I");
+    fNtupleWriter.AddScalar(fTrigTreeIndex,"subrunNumber",&fSubrunNumber,"subrunNumber/I");
+    fNtupleWriter.AddScalar(fTrigTreeIndex,"runType",&fRunType,"runType/I");
+    fNtupleWriter.AddScalar(fTrigTreeIndex,"startTime",&fStartTime,"startTime/l");
 
     //Some lower level information to save
-    fPhaseIITrigTree->Branch("eventNumber",&fEventNumber,"eventNumber/I");
-    fPhaseIITrigTree->Branch("eventTimeTank",&fEventTimeTank,"eventTimeTank/l");
-    fPhaseIITrigTree->Branch("eventTimeMRD",&fEventTimeMRD,"eventTimeMRD/l");
-    fPhaseIITrigTree->Branch("nhits",&fNHits,"nhits/I");
+    fNtupleWriter.AddScalar(fTrigTreeIndex,"eventNumber",&fEventNumber,"eventNumber/I");
+    fNtupleWriter.AddScalar(fTrigTreeIndex,"eventTimeTank",&fEventTimeTank,"eventTimeTank/l");
+    fNtupleWriter.AddScalar(fTrigTreeIndex,"eventTimeMRD",&fEventTimeMRD,"eventTimeMRD/l");
+    fNtupleWriter.AddScalar(fTrigTreeIndex,"nhits",&fNHits,"nhits/I");
 
 
     //Event Staus Flag Information
     if(fillCleanEventsOnly){
-      fPhaseIITrigTree->Branch("eventStatusApplied",&fEventStatusApplied,"eventStatusApplied/I");
-      fPhaseIITrigTree->Branch("eventStatusFlagged",&fEventStatusFlagged,"eventStatusFlagged/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"eventStatusApplied",&fEventStatusApplied,"eventStatusApplied/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"eventStatusFlagged",&fEventStatusFlagged,"eventStatusFlagged/I");
     }
     //Hit information (PMT and LAPPD)
     if(SiPMPulseInfo_fill){
-      fPhaseIITrigTree->Branch("SiPM1NPulses",&fSiPM1NPulses,"SiPM1NPulses/I");
-      fPhaseIITrigTree->Branch("SiPM2NPulses",&fSiPM2NPulses,"SiPM2NPulses/I");
-      fPhaseIITrigTree->Branch("SiPMhitQ",&fSiPMHitQ);
-      fPhaseIITrigTree->Branch("SiPMhitT",&fSiPMHitT);
-      fPhaseIITrigTree->Branch("SiPMhitAmplitude",&fSiPMHitAmplitude);
-      fPhaseIITrigTree->Branch("SiPMNum",&fSiPMNum);
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"SiPM1NPulses",&fSiPM1NPulses,"SiPM1NPulses/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"SiPM2NPulses",&fSiPM2NPulses,"SiPM2NPulses/I");
+      fNtupleWriter.AddVector(fTrigTreeIndex,"SiPMhitQ",&fSiPMHitQ);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"SiPMhitT",&fSiPMHitT);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"SiPMhitAmplitude",&fSiPMHitAmplitude);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"SiPMNum",&fSiPMNum);
     }
 
     if(TankHitInfo_fill){
-      fPhaseIITrigTree->Branch("filter",&fIsFiltered);
-      fPhaseIITrigTree->Branch("hitX",&fHitX);
-      fPhaseIITrigTree->Branch("hitY",&fHitY);
-      fPhaseIITrigTree->Branch("hitZ",&fHitZ);
-      fPhaseIITrigTree->Branch("hitT",&fHitT);
-      fPhaseIITrigTree->Branch("hitQ",&fHitQ);
-      fPhaseIITrigTree->Branch("hitPE",&fHitPE);
-      fPhaseIITrigTree->Branch("hitType", &fHitType);
-      fPhaseIITrigTree->Branch("hitDetID", &fHitDetID);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"filter",&fIsFiltered);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"hitX",&fHitX);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"hitY",&fHitY);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"hitZ",&fHitZ);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"hitT",&fHitT);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"hitQ",&fHitQ);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"hitPE",&fHitPE);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"hitType", &fHitType);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"hitDetID", &fHitDetID);
     }
 
     if(MRDHitInfo_fill){
-      fPhaseIITrigTree->Branch("MRDhitT",&fMRDHitT);
-      fPhaseIITrigTree->Branch("MRDhitDetID", &fMRDHitDetID);
-      fPhaseIITrigTree->Branch("vetoHit",&fVetoHit,"vetoHit/I");
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDhitT",&fMRDHitT);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDhitDetID", &fMRDHitDetID);
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"vetoHit",&fVetoHit,"vetoHit/I");
     }
     if(MRDReco_fill){
-      fPhaseIITrigTree->Branch("numMRDTracks",&fNumClusterTracks,"numMRDTracks/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"numMRDTracks",&fNumClusterTracks,"numMRDTracks/I");
     //Push back some properties
-      fPhaseIITrigTree->Branch("MRDTrackAngle",&fMRDTrackAngle);
-      fPhaseIITrigTree->Branch("MRDTrackAngleError",&fMRDTrackAngleError);
-      fPhaseIITrigTree->Branch("MRDPenetrationDepth",&fMRDPenetrationDepth);
-      fPhaseIITrigTree->Branch("MRDTrackLength",&fMRDTrackLength);
-      fPhaseIITrigTree->Branch("MRDEntryPointRadius",&fMRDEntryPointRadius);
-      fPhaseIITrigTree->Branch("MRDEnergyLoss",&fMRDEnergyLoss);
-      fPhaseIITrigTree->Branch("MRDEnergyLossError",&fMRDEnergyLossError);
-      fPhaseIITrigTree->Branch("MRDTrackStartX",&fMRDTrackStartX);
-      fPhaseIITrigTree->Branch("MRDTrackStartY",&fMRDTrackStartY);
-      fPhaseIITrigTree->Branch("MRDTrackStartZ",&fMRDTrackStartZ);
-      fPhaseIITrigTree->Branch("MRDTrackStopX",&fMRDTrackStopX);
-      fPhaseIITrigTree->Branch("MRDTrackStopY",&fMRDTrackStopY);
-      fPhaseIITrigTree->Branch("MRDTrackStopZ",&fMRDTrackStopZ);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDTrackAngle",&fMRDTrackAngle);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDTrackAngleError",&fMRDTrackAngleError);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDPenetrationDepth",&fMRDPenetrationDepth);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDTrackLength",&fMRDTrackLength);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDEntryPointRadius",&fMRDEntryPointRadius);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDEnergyLoss",&fMRDEnergyLoss);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDEnergyLossError",&fMRDEnergyLossError);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDTrackStartX",&fMRDTrackStartX);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDTrackStartY",&fMRDTrackStartY);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDTrackStartZ",&fMRDTrackStartZ);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDTrackStopX",&fMRDTrackStopX);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDTrackStopY",&fMRDTrackStopY);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"MRDTrackStopZ",&fMRDTrackStopZ);
     }
 
     //Reconstructed variables after full Muon Reco Analysis
     if(TankReco_fill){
-      fPhaseIITrigTree->Branch("recoVtxX",&fRecoVtxX,"recoVtxX/D");
-      fPhaseIITrigTree->Branch("recoVtxY",&fRecoVtxY,"recoVtxY/D");
-      fPhaseIITrigTree->Branch("recoVtxZ",&fRecoVtxZ,"recoVtxZ/D");
-      fPhaseIITrigTree->Branch("recoVtxTime",&fRecoVtxTime,"recoVtxTime/D");
-      fPhaseIITrigTree->Branch("recoDirX",&fRecoDirX,"recoDirX/D");
-      fPhaseIITrigTree->Branch("recoDirY",&fRecoDirY,"recoDirY/D");
-      fPhaseIITrigTree->Branch("recoDirZ",&fRecoDirZ,"recoDirZ/D");
-      fPhaseIITrigTree->Branch("recoAngle",&fRecoAngle,"recoAngle/D");
-      fPhaseIITrigTree->Branch("recoPhi",&fRecoPhi,"recoPhi/D");
-      fPhaseIITrigTree->Branch("recoVtxFOM",&fRecoVtxFOM,"recoVtxFOM/D");
-      fPhaseIITrigTree->Branch("recoStatus",&fRecoStatus,"recoStatus/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoVtxX",&fRecoVtxX,"recoVtxX/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoVtxY",&fRecoVtxY,"recoVtxY/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoVtxZ",&fRecoVtxZ,"recoVtxZ/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoVtxTime",&fRecoVtxTime,"recoVtxTime/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoDirX",&fRecoDirX,"recoDirX/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoDirY",&fRecoDirY,"recoDirY/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoDirZ",&fRecoDirZ,"recoDirZ/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoAngle",&fRecoAngle,"recoAngle/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoPhi",&fRecoPhi,"recoPhi/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoVtxFOM",&fRecoVtxFOM,"recoVtxFOM/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"recoStatus",&fRecoStatus,"recoStatus/I");
     }
   
     //MC truth information for muons
     //Output to tree when MCTruth_fill = 1 in config
     if (MCTruth_fill){
-      fPhaseIITrigTree->Branch("triggerNumber",&fMCTriggerNum,"triggerNumber/I");
-      fPhaseIITrigTree->Branch("mcEntryNumber",&fMCEventNum,"mcEntryNumber/I");
-      fPhaseIITrigTree->Branch("trueVtxX",&fTrueVtxX,"trueVtxX/D");
-      fPhaseIITrigTree->Branch("trueVtxY",&fTrueVtxY,"trueVtxY/D");
-      fPhaseIITrigTree->Branch("trueVtxZ",&fTrueVtxZ,"trueVtxZ/D");
-      fPhaseIITrigTree->Branch("trueVtxTime",&fTrueVtxTime,"trueVtxTime/D");
-      fPhaseIITrigTree->Branch("trueDirX",&fTrueDirX,"trueDirX/D");
-      fPhaseIITrigTree->Branch("trueDirY",&fTrueDirY,"trueDirY/D");
-      fPhaseIITrigTree->Branch("trueDirZ",&fTrueDirZ,"trueDirZ/D");
-      fPhaseIITrigTree->Branch("trueAngle",&fTrueAngle,"trueAngle/D");
-      fPhaseIITrigTree->Branch("truePhi",&fTruePhi,"truePhi/D");
-      fPhaseIITrigTree->Branch("trueMuonEnergy",&fTrueMuonEnergy, "trueMuonEnergy/D");
-      fPhaseIITrigTree->Branch("trueTrackLengthInWater",&fTrueTrackLengthInWater,"trueTrackLengthInWater/D");
-      fPhaseIITrigTree->Branch("trueTrackLengthInMRD",&fTrueTrackLengthInMRD,"trueTrackLengthInMRD/D");
-      fPhaseIITrigTree->Branch("Pi0Count",&fPi0Count,"Pi0Count/I");
-      fPhaseIITrigTree->Branch("PiPlusCount",&fPiPlusCount,"PiPlusCount/I");
-      fPhaseIITrigTree->Branch("PiMinusCount",&fPiMinusCount,"PiMinusCount/I");
-      fPhaseIITrigTree->Branch("K0Count",&fK0Count,"K0Count/I");
-      fPhaseIITrigTree->Branch("KPlusCount",&fKPlusCount,"KPlusCount/I");
-      fPhaseIITrigTree->Branch("KMinusCount",&fKMinusCount,"KMinusCount/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"triggerNumber",&fMCTriggerNum,"triggerNumber/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"mcEntryNumber",&fMCEventNum,"mcEntryNumber/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueVtxX",&fTrueVtxX,"trueVtxX/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueVtxY",&fTrueVtxY,"trueVtxY/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueVtxZ",&fTrueVtxZ,"trueVtxZ/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueVtxTime",&fTrueVtxTime,"trueVtxTime/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueDirX",&fTrueDirX,"trueDirX/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueDirY",&fTrueDirY,"trueDirY/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueDirZ",&fTrueDirZ,"trueDirZ/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueAngle",&fTrueAngle,"trueAngle/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"truePhi",&fTruePhi,"truePhi/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueMuonEnergy",&fTrueMuonEnergy, "trueMuonEnergy/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueTrackLengthInWater",&fTrueTrackLengthInWater,"trueTrackLengthInWater/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"trueTrackLengthInMRD",&fTrueTrackLengthInMRD,"trueTrackLengthInMRD/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"Pi0Count",&fPi0Count,"Pi0Count/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"PiPlusCount",&fPiPlusCount,"PiPlusCount/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"PiMinusCount",&fPiMinusCount,"PiMinusCount/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"K0Count",&fK0Count,"K0Count/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"KPlusCount",&fKPlusCount,"KPlusCount/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"KMinusCount",&fKMinusCount,"KMinusCount/I");
     }
   
     // Reconstructed variables from each step in Muon Reco Analysis
     // Currently output when RecoDebug_fill = 1 in config 
     if (RecoDebug_fill){
-      fPhaseIITrigTree->Branch("seedVtxX",&fSeedVtxX); 
-      fPhaseIITrigTree->Branch("seedVtxY",&fSeedVtxY); 
-      fPhaseIITrigTree->Branch("seedVtxZ",&fSeedVtxZ);
-      fPhaseIITrigTree->Branch("seedVtxFOM",&fSeedVtxFOM); 
-      fPhaseIITrigTree->Branch("seedVtxTime",&fSeedVtxTime,"seedVtxTime/D");
+      fNtupleWriter.AddVector(fTrigTreeIndex,"seedVtxX",&fSeedVtxX); 
+      fNtupleWriter.AddVector(fTrigTreeIndex,"seedVtxY",&fSeedVtxY); 
+      fNtupleWriter.AddVector(fTrigTreeIndex,"seedVtxZ",&fSeedVtxZ);
+      fNtupleWriter.AddVector(fTrigTreeIndex,"seedVtxFOM",&fSeedVtxFOM); 
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"seedVtxTime",&fSeedVtxTime,"seedVtxTime/D");
     
-      fPhaseIITrigTree->Branch("pointPosX",&fPointPosX,"pointPosX/D");
-      fPhaseIITrigTree->Branch("pointPosY",&fPointPosY,"pointPosY/D");
-      fPhaseIITrigTree->Branch("pointPosZ",&fPointPosZ,"pointPosZ/D");
-      fPhaseIITrigTree->Branch("pointPosTime",&fPointPosTime,"pointPosTime/D");
-      fPhaseIITrigTree->Branch("pointPosFOM",&fPointPosFOM,"pointPosFOM/D");
-      fPhaseIITrigTree->Branch("pointPosStatus",&fPointPosStatus,"pointPosStatus/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointPosX",&fPointPosX,"pointPosX/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointPosY",&fPointPosY,"pointPosY/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointPosZ",&fPointPosZ,"pointPosZ/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointPosTime",&fPointPosTime,"pointPosTime/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointPosFOM",&fPointPosFOM,"pointPosFOM/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointPosStatus",&fPointPosStatus,"pointPosStatus/I");
       
-      fPhaseIITrigTree->Branch("pointDirX",&fPointDirX,"pointDirX/D");
-      fPhaseIITrigTree->Branch("pointDirY",&fPointDirY,"pointDirY/D");
-      fPhaseIITrigTree->Branch("pointDirZ",&fPointDirZ,"pointDirZ/D");
-      fPhaseIITrigTree->Branch("pointDirTime",&fPointDirTime,"pointDirTime/D");
-      fPhaseIITrigTree->Branch("pointDirStatus",&fPointDirStatus,"pointDirStatus/I");
-      fPhaseIITrigTree->Branch("pointDirFOM",&fPointDirFOM,"pointDirFOM/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointDirX",&fPointDirX,"pointDirX/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointDirY",&fPointDirY,"pointDirY/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointDirZ",&fPointDirZ,"pointDirZ/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointDirTime",&fPointDirTime,"pointDirTime/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointDirStatus",&fPointDirStatus,"pointDirStatus/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointDirFOM",&fPointDirFOM,"pointDirFOM/D");
     
-      fPhaseIITrigTree->Branch("pointVtxPosX",&fPointVtxPosX,"pointVtxPosX/D");
-      fPhaseIITrigTree->Branch("pointVtxPosY",&fPointVtxPosY,"pointVtxPosY/D");
-      fPhaseIITrigTree->Branch("pointVtxPosZ",&fPointVtxPosZ,"pointVtxPosZ/D");
-      fPhaseIITrigTree->Branch("pointVtxTime",&fPointVtxTime,"pointVtxTime/D");
-      fPhaseIITrigTree->Branch("pointVtxDirX",&fPointVtxDirX,"pointVtxDirX/D");
-      fPhaseIITrigTree->Branch("pointVtxDirY",&fPointVtxDirY,"pointVtxDirY/D");
-      fPhaseIITrigTree->Branch("pointVtxDirZ",&fPointVtxDirZ,"pointVtxDirZ/D");
-      fPhaseIITrigTree->Branch("pointVtxFOM",&fPointVtxFOM,"pointVtxFOM/D");
-      fPhaseIITrigTree->Branch("pointVtxStatus",&fPointVtxStatus,"pointVtxStatus/I");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointVtxPosX",&fPointVtxPosX,"pointVtxPosX/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointVtxPosY",&fPointVtxPosY,"pointVtxPosY/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointVtxPosZ",&fPointVtxPosZ,"pointVtxPosZ/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointVtxTime",&fPointVtxTime,"pointVtxTime/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointVtxDirX",&fPointVtxDirX,"pointVtxDirX/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointVtxDirY",&fPointVtxDirY,"pointVtxDirY/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointVtxDirZ",&fPointVtxDirZ,"pointVtxDirZ/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointVtxFOM",&fPointVtxFOM,"pointVtxFOM/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"pointVtxStatus",&fPointVtxStatus,"pointVtxStatus/I");
     } 
 
     // Difference in MC Truth and Muon Reconstruction Analysis
     // Output to tree when muonTruthRecoDiff_fill = 1 in config
     if (muonTruthRecoDiff_fill){
-      fPhaseIITrigTree->Branch("deltaVtxX",&fDeltaVtxX,"deltaVtxX/D");
-      fPhaseIITrigTree->Branch("deltaVtxY",&fDeltaVtxY,"deltaVtxY/D");
-      fPhaseIITrigTree->Branch("deltaVtxZ",&fDeltaVtxZ,"deltaVtxZ/D");
-      fPhaseIITrigTree->Branch("deltaVtxR",&fDeltaVtxR,"deltaVtxR/D");
-      fPhaseIITrigTree->Branch("deltaVtxT",&fDeltaVtxT,"deltaVtxT/D");
-      fPhaseIITrigTree->Branch("deltaParallel",&fDeltaParallel,"deltaParallel/D");
-      fPhaseIITrigTree->Branch("deltaPerpendicular",&fDeltaPerpendicular,"deltaPerpendicular/D");
-      fPhaseIITrigTree->Branch("deltaAzimuth",&fDeltaAzimuth,"deltaAzimuth/D");
-      fPhaseIITrigTree->Branch("deltaZenith",&fDeltaZenith,"deltaZenith/D");
-      fPhaseIITrigTree->Branch("deltaAngle",&fDeltaAngle,"deltaAngle/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"deltaVtxX",&fDeltaVtxX,"deltaVtxX/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"deltaVtxY",&fDeltaVtxY,"deltaVtxY/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"deltaVtxZ",&fDeltaVtxZ,"deltaVtxZ/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"deltaVtxR",&fDeltaVtxR,"deltaVtxR/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"deltaVtxT",&fDeltaVtxT,"deltaVtxT/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"deltaParallel",&fDeltaParallel,"deltaParallel/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"deltaPerpendicular",&fDeltaPerpendicular,"deltaPerpendicular/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"deltaAzimuth",&fDeltaAzimuth,"deltaAzimuth/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"deltaZenith",&fDeltaZenith,"deltaZenith/D");
+      fNtupleWriter.AddScalar(fTrigTreeIndex,"deltaAngle",&fDeltaAngle,"deltaAngle/D");
     } 
   }
+
+  // Only the branches of the configured groups were added above; in asynchronous mode the
+  // TTree::Fill and basket compression run in the writer thread
+  if(AsyncWrite){
+    ROOT::EnableThreadSafety();
+    Log("PhaseIITreeMaker Tool: Filling trees in a background thread, "+std::to_string(BasketEntries)+" entries per basket, "+std::to_string(BasketsPerTree)+" baskets per tree",v_message,verbosity);
+  }
+  fNtupleWriter.Start(AsyncWrite,BasketEntries,BasketsPerTree);
   return true;
 }
 
@@ -343,7 +360,7 @@ bool PhaseIITreeMaker::Execute(){
         if(verbosity>3) Log("PhaseIITreeMaker Tool: No cluster classifiers.  Continuing tree",v_debug,verbosity);
       }
       if(SiPMPulseInfo_fill) this->LoadSiPMHits();
-      fPhaseIITankClusterTree->Fill();
+      fNtupleWriter.Fill(fTankClusterTreeIndex);
       cluster_num += 1;
     }
 
@@ -413,7 +430,7 @@ bool PhaseIITreeMaker::Execute(){
         //Get the track info
       }
 
-      fPhaseIIMRDClusterTree->Fill();
+      fNtupleWriter.Fill(fMRDClusterTreeIndex);
       cluster_num += 1;
     }
   }
@@ -462,19 +479,22 @@ bool PhaseIITreeMaker::Execute(){
     // FIll tree with all reconstruction information
     if (RecoDebug_fill) this->FillRecoDebugInfo();
 
-    fPhaseIITrigTree->Fill();
+    fNtupleWriter.Fill(fTrigTreeIndex);
   }
   return true;
 }
 
 bool PhaseIITreeMaker::Finalise(){
+  bool write_ok = fNtupleWriter.Stop();
+  if(AsyncWrite) Log("PhaseIITreeMaker Tool: Wrote "+std::to_string(fNtupleWriter.GetNumEntries())+" entries in "+std::to_string(fNtupleWriter.GetNumBaskets())+" baskets, Execute waited for the writer "+std::to_string(fNtupleWriter.GetNumWaits())+" times",v_message,verbosity);
+  if(!write_ok) Log("PhaseIITreeMaker Tool: Error: "+fNtupleWriter.GetError()+", later entries were not written",v_error,verbosity);
 	fOutput_tfile->cd();
 	fPhaseIITrigTree->Write();
     fPhaseIIMRDClusterTree->Write();
 	fPhaseIITankClusterTree->Write();
 	fOutput_tfile->Close();
 	if(verbosity>0) cout<<"PhaseIITreeMaker exitting"<<endl;
-  return true;
+  return write_ok;
 }
 
 void PhaseIITreeMaker::ResetVariables() {
@@ -13,6 +13,7 @@
 #include "TTree.h"
 #include "TH1D.h"
 #include "TMath.h"
+#include "TROOT.h"
 #include "ADCPulse.h"
 #include "Waveform.h"
 #include "CalibratedADCWaveform.h"
@@ -20,6 +21,7 @@
 #include "RecoDigit.h"
 #include "ANNIEalgorithms.h"
 #include "TimeClass.h"
+#include "NtupleWriter.h"
 
 class PhaseIITreeMaker: public Tool {
 
@@ -65,6 +67,15 @@ class PhaseIITreeMaker: public Tool {
   TTree* fPhaseIITrigTree = nullptr;
   TTree* fPhaseIITankClusterTree = nullptr;
   TTree* fPhaseIIMRDClusterTree = nullptr;
+
+  /// \brief Branches of the configured groups, filled directly or by a writer thread (AsyncWrite)
+  NtupleWriter fNtupleWriter;
+  int fTrigTreeIndex;
+  int fTankClusterTreeIndex;
+  int fMRDClusterTreeIndex;
+  bool AsyncWrite = false;
+  int BasketEntries = 1000;     ///< entries per basket handed to the writer thread
+  int BasketsPerTree = 4;       ///< baskets per tree in flight before Execute waits
  
   std::map<double,std::vector<Hit>>* m_all_clusters = nullptr;  
   Geometry *geom = nullptr;
@@ -1,5 +1,7 @@
 /* vim:set noexpandtab tabstop=4 wrap */
 #include "PulseSimulation.h"
+#include <thread>
+#include <atomic>
 //#include "CreateFakeRawFile.cpp"/
 //#include "GetTemplateRunInfo.cpp"
 //#include "FillEmulatedTriggerdata.cpp"
@@ -22,6 +24,9 @@ bool PulseSimulation::Initialise(std::string configfile, DataModel &data){
 	m_variables.Get("PhaseOneRiffleShuffle",DoPhaseOneRiffle);
 	m_variables.Get("GenerateFakeRootFiles",GenerateFakeRootFiles);
 	m_variables.Get("PutOutputsIntoStore",PutOutputsIntoStore);
+	m_variables.Get("FastEmulation",FastEmulation);
+	m_variables.Get("EmulationThreads",EmulationThreads);
+	m_variables.Get("RandomSeed",RandomSeed);
 	if((!GenerateFakeRootFiles)&&(!PutOutputsIntoStore)){
 		logmessage = "PulseSimulation Tool: Both GenerateFakeRootFiles and PutOutputsIntoStore"
 			" were false! Nowhere to put outputs!";
@@ -101,6 +106,18 @@ bool PulseSimulation::Initialise(std::string configfile, DataModel &data){
 	minibuffer_id=0;
 	sequence_id=0;
 	
+	// pulse shape: the landau width is fixed, so the shape relative to the peak sample is always the same
+	landau_template.resize(110);
+	for(int k=-10; k<100; k++) landau_template.at(k+10) = TMath::Landau(k,0.,2.,true);
+	
+	if(FastEmulation){
+		if(EmulationThreads<=0) EmulationThreads = std::max(1u,std::thread::hardware_concurrency());
+		EmulationThreads = std::min(EmulationThreads,num_adc_cards);
+		gaus_buffers.resize(EmulationThreads);
+		Log("PulseSimulation Tool: fast emulation with "+to_string(EmulationThreads)+" threads, seed "
+			+to_string(RandomSeed),v_message,verbosity);
+	}
+	
 	// TODO: add RWM
 	
 	// create the ROOT application to show debug plots
@@ -386,12 +403,6 @@ void PulseSimulation::AddPMTDataEntry(MCHit* digihit){
 		+ ", area calculated to be: " + to_string(adjusted_digit_q);
 	Log(logmessage,v_debug,verbosity);
 	
-	// construct a suitable pulse waveform using the position and charge of the digit
-	pulsevector.assign(minibuffer_datapoints_per_channel,0);  // clear the temporary pulse vector
-	// fill it with a pulse waveform with suitable form and size
-	Log("PulseSimulation Tool: Generating Waveform for this pulse",v_debug,verbosity);
-	GenerateMinibufferPulse(digits_time_index, adjusted_digit_q, pulsevector);
-	
 	// calculate the offset of the minibuffer, for this channel, within the full buffer for the readout
 	int channeloffset = channelnum * (full_buffer_size / channels_per_adc_card);
 	int minibufferoffset = minibuffer_id*minibuffer_datapoints_per_channel;
@@ -403,10 +414,9 @@ void PulseSimulation::AddPMTDataEntry(MCHit* digihit){
 	std::vector<uint16_t>* thiscards_fullbuffer = &temporary_databuffers.at(cardid);
 	std::vector<uint16_t>::iterator minibuffer_start = thiscards_fullbuffer->begin() + channeloffset + minibufferoffset;
 	
-	// add the generated pulse to the minibuffer at the appropriate location
+	// add a pulse waveform with suitable form and size to the minibuffer at the appropriate location
 	Log("PulseSimulation Tool: Adding pulse to full trace",v_debug,verbosity);
-	std::transform(minibuffer_start, minibuffer_start+minibuffer_datapoints_per_channel, pulsevector.begin(),
-		minibuffer_start, std::plus<uint16_t>() );
+	GenerateMinibufferPulse(digits_time_index, adjusted_digit_q, &(*minibuffer_start));
 	
 //	int pulsepeakindex=(channeloffset+minibufferoffset+digits_time_index);
 //	cout<<"non-zero section of trace (from sample "<<std::max(0,pulsepeakindex-10)
@@ -450,49 +460,37 @@ void PulseSimulation::AddPMTDataEntry(MCHit* digihit){
 	
 }
 
-void PulseSimulation::GenerateMinibufferPulse(int digit_index, double adjusted_digit_q, std::vector<uint16_t> &pulsevector){
-	// Construct a waveform representing the pulse from a single digit
-	// ===============================================================
+void PulseSimulation::GenerateMinibufferPulse(int digit_index, double adjusted_digit_q, uint16_t* minibuffer){
+	// Add a waveform representing the pulse from a single digit to the minibuffer
+	// ===========================================================================
 	// we need to construct a waveform which crosses a Hefty threshold at digit_index
 	// (actually we position it centred at digit_index, it should be shifted according to threshold crossing)
 	// and has an integral of adjusted_digit_q. A landau function has approximately the right shape.
 	//Log("PulseSimulation Tool: Generating pulse waveform",v_debug,verbosity);
 	
-	if(fLandau==nullptr){
-		fLandau = new TF1("fLandau","[2]*TMath::Landau(x,[0],[1],1)",digit_index-10,digit_index+100);
-	}
-	// [0] is ~position of maximum, [1] is width (sigma), [2] is a scaling.
-	// the last parameter (fixed to 1 above) is 'normalise by dividing by sigma'.
+	// The pulse is adjusted_digit_q*TMath::Landau(x,digit_index,2.,1):
+	// 2 is the width (sigma), the last parameter is 'normalise by dividing by sigma'.
 	// with 1, the integral is fixed to 1 and the maximum is varied
 	// (with 0 the maximum is fixed to ~0.18 and the integral varies)
 	// by choosing 1 we can always get the desired integral (Q). How should we vary height vs width?
 	// that's given by the typical aspect ratio of a PMT pulse: 
 	// Looking at data: with X scale in samples (8ns) fitting a landau gives a sigma of ~2
 	// typical digit Qs are 0-30. (PEs?)
+	// Since sigma is fixed and samples are integers, the landau values are taken from landau_template,
+	// which gives the same values as evaluating the function at every sample.
 	
 	// TODO improve this by trading off the width vs height based on the time between the first and last
 	// photons within the digit XXX
 	
-	//cout<<"making pulse with integral "<<adjusted_digit_q<<" and peak "<<digit_index<<endl;
-	fLandau->SetParameters(digit_index, 2., adjusted_digit_q);
-	
-//	if(DRAW_DEBUG_PLOTS){
-//		// make the graph+canvas if we haven't
-//		if(gROOT->FindObject("landaucanvas")==nullptr){
-//			landaucanvas = new TCanvas("landaucanvas","landaucanvas",canvwidth,canvheight);
-//		}
-//		landaucanvas->cd();
-//		fLandau->Draw();
-//		landaucanvas->Update();
-//		gSystem->ProcessEvents();
-//	}
-	
 	// landau function is interesting in region -5*sigma -> 50*sigma, or for sigma=2, -10 to 100
-	//fLandau->SetRange(-10,100); only set in creation as fixed
-	for(int i=(digit_index-10); i<(digit_index+100); i++){
-		// pulses very close to the front/end of the minibuffer: get tructated.
-		if( (i<0) || (i>(pulsevector.size()-1)) ) continue;
-		pulsevector.at(i)=fLandau->Eval(i);
+	// pulses very close to the front/end of the minibuffer: get tructated.
+	// landau_template[0] belongs to sample digit_index-10; the range keeps i-template_offset inside the template
+	int template_offset = digit_index-10;
+	int first = std::max(template_offset, 0);
+	int last = std::min(template_offset+int(landau_template.size()), minibuffer_datapoints_per_channel);
+	for(int i=first; i<last; i++){
+		uint16_t pulsevalue = adjusted_digit_q*landau_template[i-template_offset];
+		minibuffer[i] += pulsevalue;
 	}
 	
 	// ==============
@@ -632,11 +630,16 @@ bool PulseSimulation::FillEmulatedPMTData(){
 	// 0,1,2... (there are 16 cards, numbered up to 21). Each readout has a unique SequenceID.
 	// Data[] arrays are waveforms of 40,000 datapoints per minibuffer
 	
-	// first, add noise to the temporary waveforms
-	AddNoiseToWaveforms();
-	
-	// next, shuffle your library. this also copies temporary_databuffers into emulated_pmtdata_readout
-	RiffleShuffle(DoPhaseOneRiffle); // pass true for phase 1 shuffle, needed for either
+	if(FastEmulation){
+		// noise and shuffle of each card in parallel, with a random stream per card
+		EmulateCards();
+	} else {
+		// first, add noise to the temporary waveforms
+		AddNoiseToWaveforms();
+		
+		// next, shuffle your library. this also copies temporary_databuffers into emulated_pmtdata_readout
+		RiffleShuffle(DoPhaseOneRiffle); // pass true for phase 1 shuffle, needed for either
+	}
 	
 	//cout<<"Filling PMTData tree"<<endl;
 	// loop over all cards and fill the PMTData tree with the constructed data
@@ -854,36 +857,84 @@ void PulseSimulation::RiffleShuffle(bool do_shuffle){
 */
 	//cout<<"Shuffling Data arrays"<<endl;
 	
+	for(int cardi=0; cardi<num_adc_cards; cardi++) RiffleShuffleCard(cardi, do_shuffle);
+	// finally, ask a player to cut the deck
+}
+
+void PulseSimulation::RiffleShuffleCard(int cardi, bool do_shuffle){
+	// shuffle (or copy) one card's temporary buffer into its Data array, see RiffleShuffle
 	int channel_buffer_size = (full_buffer_size / channels_per_adc_card);
-	for(int cardi=0; cardi<num_adc_cards; cardi++){
-		auto& acard = emulated_pmtdata_readout.at(cardi);
-		auto& card_buffer = acard.Data;
-		auto& temp_card_buffer = temporary_databuffers.at(cardi);
-		
-		if(do_shuffle){
-			// split the deck into four piles
-			for(int channeli=0; channeli<channels_per_adc_card; channeli++){
-				auto channel_buffer_start = card_buffer.begin() + (channel_buffer_size * channeli);
-				auto temp_channel_buffer_start = temp_card_buffer.begin() + (channel_buffer_size * channeli);
-				// split each pile into two, then interleave pairs in the two piles
-				for(int samplei=0, samplej=0; samplei<channel_buffer_size; samplei+=4, samplej+=2){
-					//0 = 0
-					*(channel_buffer_start + samplej) = 
-						*(temp_channel_buffer_start + samplei);
-					//1 = 1
-					*(channel_buffer_start + samplej + 1) = 
-						*(temp_channel_buffer_start + samplei + 1);
-					//20,000 = 2
-					*(channel_buffer_start + (channel_buffer_size/2) + samplej ) 
-						= *(temp_channel_buffer_start + samplei + 2);
-					//20,001 = 3
-					*(channel_buffer_start + (channel_buffer_size/2) + samplej + 1) 
-						= *(temp_channel_buffer_start + samplei + 3);
-				}
+	auto& acard = emulated_pmtdata_readout.at(cardi);
+	auto& card_buffer = acard.Data;
+	auto& temp_card_buffer = temporary_databuffers.at(cardi);
+	
+	if(do_shuffle){
+		// split the deck into four piles
+		for(int channeli=0; channeli<channels_per_adc_card; channeli++){
+			auto channel_buffer_start = card_buffer.begin() + (channel_buffer_size * channeli);
+			auto temp_channel_buffer_start = temp_card_buffer.begin() + (channel_buffer_size * channeli);
+			// split each pile into two, then interleave pairs in the two piles
+			for(int samplei=0, samplej=0; samplei<channel_buffer_size; samplei+=4, samplej+=2){
+				//0 = 0
+				*(channel_buffer_start + samplej) = 
+					*(temp_channel_buffer_start + samplei);
+				//1 = 1
+				*(channel_buffer_start + samplej + 1) = 
+					*(temp_channel_buffer_start + samplei + 1);
+				//20,000 = 2
+				*(channel_buffer_start + (channel_buffer_size/2) + samplej ) 
+					= *(temp_channel_buffer_start + samplei + 2);
+				//20,001 = 3
+				*(channel_buffer_start + (channel_buffer_size/2) + samplej + 1) 
+					= *(temp_channel_buffer_start + samplei + 3);
 			}
-		} else {
-			for(int i=0; i<temp_card_buffer.size(); i++) card_buffer.at(i)=temp_card_buffer.at(i);
 		}
+	} else {
+		std::copy(temp_card_buffer.begin(), temp_card_buffer.end(), card_buffer.begin());
 	}
-	// finally, ask a player to cut the deck
+}
+
+void PulseSimulation::EmulateCards(){
+	Log("PulseSimulation Tool: Adding noise and interleaving with "+to_string(EmulationThreads)+" threads",
+		v_debug,verbosity);
+	// cards are independent: each thread takes the next card until all are done
+	std::atomic<int> nextcard(0);
+	auto worker = [this,&nextcard](int threadi){
+		for(int cardi=nextcard++; cardi<num_adc_cards; cardi=nextcard++){
+			EmulateCard(cardi, gaus_buffers.at(threadi));
+		}
+	};
+	std::vector<std::thread> threads;
+	for(int threadi=1; threadi<EmulationThreads; threadi++) threads.emplace_back(worker,threadi);
+	worker(0);
+	for(auto& athread : threads) athread.join();
+}
+
+void PulseSimulation::EmulateCard(int cardi, std::vector<double> &gaus){
+	// same noise model as AddNoiseToWaveforms, with the card's own random stream:
+	// first the offsets of all minibuffers, then one gaussian per sample
+	CounterRandom rng(CounterRandom::StreamKey(RandomSeed, sequence_id, cardi));
+	auto& temp_card_buffer = temporary_databuffers.at(cardi);
+	int nsamples = temp_card_buffer.size();
+	int minibuffer_size = full_buffer_size/minibuffers_per_fullbuffer;
+	int nminibuffers = (nsamples + minibuffer_size - 1)/minibuffer_size;
+	
+	std::vector<int16_t> mboffsets(nminibuffers);
+	for(auto& mboffset : mboffsets) mboffset = static_cast<uint16_t>(rng.Uniform(310,350));
+	gaus.resize(nsamples);
+	rng.FillGaus(gaus.data(), nsamples, 2.);
+	
+	uint16_t* samples = temp_card_buffer.data();
+	for(int mbi=0; mbi<nminibuffers; mbi++){
+		int first = mbi*minibuffer_size;
+		int last = std::min(first+minibuffer_size, nsamples);
+		int16_t mboffset = mboffsets[mbi];
+		for(int samplei=first; samplei<last; samplei++){
+			int16_t currentsamplei = static_cast<int32_t>(samples[samplei]);
+			currentsamplei += mboffset + static_cast<int32_t>(gaus[samplei]);
+			samples[samplei] = static_cast<uint32_t>(currentsamplei);
+		}
+	}
+	
+	RiffleShuffleCard(cardi, DoPhaseOneRiffle);
 }
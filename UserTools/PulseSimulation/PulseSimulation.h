@@ -18,6 +18,7 @@
 #include <stdlib.h>
 
 #include "MCCardData.h"
+#include "CounterRandom.h"
 
 #include "TTree.h"
 #include "TFile.h"
@@ -98,12 +99,15 @@ class PulseSimulation: public Tool {
 	// Internal Functions
 	// ------------------
 	void AddPMTDataEntry(MCHit* digihit);
-	void GenerateMinibufferPulse(int digit_index, double adjusted_digit_q, std::vector<uint16_t> &pulsevector);
+	void GenerateMinibufferPulse(int digit_index, double adjusted_digit_q, uint16_t* minibuffer);
 	void AddMinibufferStartTime(bool droppingremainingsubtriggers);
 	void ConstructEmulatedPmtDataReadout();
 	bool FillEmulatedPMTData();
 	void AddNoiseToWaveforms();
 	void RiffleShuffle(bool do_shuffle);
+	void RiffleShuffleCard(int cardi, bool do_shuffle);
+	void EmulateCards();
+	void EmulateCard(int cardi, std::vector<double> &gaus);
 	void LoadOutputFiles();
 	void FillInitialFileInfo();
 	void FillEmulatedRunInformation();
@@ -130,10 +134,16 @@ class PulseSimulation: public Tool {
 	
 	// Members used in waveform generation
 	// ------------------------------------
-	TF1* fLandau{nullptr};
-	std::vector<uint16_t> pulsevector;
+	std::vector<double> landau_template;     // Landau(x,0,2,normalised) at x=-10..99 samples from the peak
 	double PULSE_HEIGHT_FUDGE_FACTOR;        // because we always need to fudge it
 	
+	// fast emulation: per-card counter-based random streams, cards processed in parallel
+	// -----------------------------------------------------------------------------------
+	bool FastEmulation=false;
+	int EmulationThreads=0;                  // 0: one per core
+	int RandomSeed=0;
+	std::vector<std::vector<double>> gaus_buffers; // one per thread, reused between readouts
+	
 	// variables for connecting events into a run and filling the other file variables
 	// -------------------------------------------------------------------------------
 	TRandom3 R;
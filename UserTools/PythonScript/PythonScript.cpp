@@ -1,4 +1,7 @@
 #include "PythonScript.h"
+#include <sstream>
+#include <limits>
+#include <algorithm>
 PyMODINIT_FUNC test(void){
 
   return PyModule_Create(&StoreModule);
@@ -22,6 +25,46 @@ bool PythonScript::Initialise(std::string configfile, DataModel &data){
   m_variables.Get("ExecuteFunction",executefunction);
   m_variables.Get("FinaliseFunction",finalisefunction);
 
+  batchsize=0;
+  std::string inputkeys="", outputkeys="";
+  batch_event_key="";
+  batch_result_store_name="PythonBatchResults";
+  m_variables.Get("BatchSize",batchsize);
+  m_variables.Get("BatchInputs",inputkeys);
+  m_variables.Get("BatchOutputs",outputkeys);
+  m_variables.Get("BatchEventKey",batch_event_key);
+  m_variables.Get("BatchResultStore",batch_result_store_name);
+  batch_result_file="";
+  m_variables.Get("BatchResultFile",batch_result_file);
+  events_collected=0;
+  own_result_store=false;
+
+  if(batchsize>1){
+    std::vector<BatchType> output_types;
+    if(!ParseBatchKeys(inputkeys,batch_inputs,batch_input_types) || !ParseBatchKeys(outputkeys,batch_outputs,output_types)){
+      std::cout<<"PythonScript: invalid BatchInputs/BatchOutputs, use comma-separated key[:double|float|int]"<<std::endl;
+      return false;
+    }
+    input_buffer.assign(batch_inputs.size()*batchsize,0.);
+    output_buffer.assign(batch_outputs.size()*batchsize,0.);
+    batch_events.reserve(batchsize);
+    if(!m_data->Stores.count(batch_result_store_name)){
+      m_data->Stores[batch_result_store_name]=new BoostStore(false,0);
+      own_result_store=true;
+    }
+    if(batch_result_file!=""){
+      result_file.open(batch_result_file.c_str());
+      if(!result_file.is_open()){
+        std::cout<<"PythonScript: could not open BatchResultFile "<<batch_result_file<<std::endl;
+        return false;
+      }
+      result_file.precision(std::numeric_limits<double>::max_digits10);
+      result_file<<"Event";
+      for(size_t k=0; k<batch_outputs.size(); k++) result_file<<","<<batch_outputs[k];
+      result_file<<std::endl;
+    }
+  }
+
   gstore=m_data->Stores["DataName"];
 
 
@@ -133,6 +176,16 @@ bool PythonScript::Execute(){
 
   PyThreadState_Swap(pythread);
 
+  if(batchsize>1){
+    if(!CollectEvent()) return false;
+    // the last, partly filled batch is run in the Execute of the last event, so the tools
+    // downstream still see its results
+    int stop_loop=0;
+    m_data->vars.Get("StopLoop",stop_loop);
+    if(batch_events.size()==(size_t)batchsize || stop_loop==1) return ExecuteBatch();
+    return true;
+  }
+
   if (pModule != NULL) {
 
     if (pFuncE && PyCallable_Check(pFuncE)) {
@@ -175,6 +228,16 @@ bool PythonScript::Execute(){
 bool PythonScript::Finalise(){
   
   PyThreadState_Swap(pythread);  
+
+  // events left when the chain was stopped without StopLoop
+  bool batch_ok = !(batchsize>1 && !batch_events.empty()) || ExecuteBatch();
+  if(result_file.is_open()) result_file.close();
+  if(own_result_store){
+    delete m_data->Stores[batch_result_store_name];
+    m_data->Stores.erase(batch_result_store_name);
+    own_result_store=false;
+  }
+  if(!batch_ok) return false;
   
   if (pModule != NULL) {
     
@@ -216,3 +279,149 @@ bool PythonScript::Finalise(){
   
   return true;
 }
+
+
+bool PythonScript::ParseBatchKeys(std::string keylist, std::vector<std::string> &names, std::vector<BatchType> &types){
+
+  std::stringstream ss(keylist);
+  std::string entry;
+  while(std::getline(ss,entry,',')){
+    if(entry=="") continue;
+    std::string type="double";
+    size_t colon=entry.find(':');
+    if(colon!=std::string::npos){
+      type=entry.substr(colon+1);
+      entry=entry.substr(0,colon);
+    }
+    if(type=="double") types.push_back(batch_double);
+    else if(type=="float") types.push_back(batch_float);
+    else if(type=="int") types.push_back(batch_int);
+    else return false;
+    names.push_back(entry);
+  }
+
+  return true;
+}
+
+
+bool PythonScript::CollectEvent(){
+
+  size_t row=batch_events.size();
+
+  for(size_t k=0; k<batch_inputs.size(); k++){
+    // missing values are passed as NaN so the script can skip them
+    double value=std::numeric_limits<double>::quiet_NaN();
+    bool got=false;
+    if(batch_input_types[k]==batch_int){
+      int tmp=0;
+      got=gstore->Get(batch_inputs[k],tmp);
+      if(got) value=tmp;
+    }
+    else if(batch_input_types[k]==batch_float){
+      float tmp=0;
+      got=gstore->Get(batch_inputs[k],tmp);
+      if(got) value=tmp;
+    }
+    else{
+      double tmp=0;
+      got=gstore->Get(batch_inputs[k],tmp);
+      if(got) value=tmp;
+    }
+    input_buffer[k*batchsize+row]=value;
+  }
+
+  int evnum=events_collected;
+  if(batch_event_key!="") gstore->Get(batch_event_key,evnum);
+  batch_events.push_back(evnum);
+  events_collected++;
+
+  return true;
+}
+
+
+PyObject* PythonScript::MakeBatchDict(std::vector<std::string> &names, std::vector<double> &buffer, size_t nrows, bool writable){
+
+  PyObject* dict=PyDict_New();
+  if(dict==NULL) return NULL;
+
+  for(size_t k=0; k<names.size(); k++){
+    // a memoryview of the column, cast to format 'd' so numpy.asarray gives a float64 array without copying
+    PyObject* raw=PyMemoryView_FromMemory(reinterpret_cast<char*>(buffer.data()+k*batchsize), nrows*sizeof(double), writable ? PyBUF_WRITE : PyBUF_READ);
+    PyObject* view=(raw!=NULL) ? PyObject_CallMethod(raw,"cast","s","d") : NULL;
+    Py_XDECREF(raw);
+    if(view==NULL || PyDict_SetItemString(dict,names[k].c_str(),view)!=0){
+      Py_XDECREF(view);
+      Py_DECREF(dict);
+      return NULL;
+    }
+    Py_DECREF(view);
+  }
+
+  return dict;
+}
+
+
+bool PythonScript::ExecuteBatch(){
+
+  size_t nrows=batch_events.size();
+  std::fill(output_buffer.begin(),output_buffer.end(),std::numeric_limits<double>::quiet_NaN());
+
+  PyObject* inputs=MakeBatchDict(batch_inputs,input_buffer,nrows,false);
+  PyObject* outputs=MakeBatchDict(batch_outputs,output_buffer,nrows,true);
+  if(inputs==NULL || outputs==NULL){
+    Py_XDECREF(inputs);
+    Py_XDECREF(outputs);
+    PyErr_Print();
+    fprintf(stderr,"Could not create python batch buffers\n");
+    return false;
+  }
+
+  if (!(pFuncE && PyCallable_Check(pFuncE))) {
+    Py_DECREF(inputs);
+    Py_DECREF(outputs);
+    if (PyErr_Occurred())
+      PyErr_Print();
+    fprintf(stderr, "Cannot python execute function \n");
+    return false;
+  }
+
+  pArgs=PyTuple_Pack(2,inputs,outputs);
+  pValue=PyObject_CallObject(pFuncE,pArgs);
+  Py_DECREF(pArgs);
+  Py_DECREF(inputs);
+  Py_DECREF(outputs);
+
+  if(pValue==NULL){
+    PyErr_Print();
+    fprintf(stderr,"Call to Python Execute failed for batch\n");
+    return false;
+  }
+  long ret=PyLong_AsLong(pValue);
+  Py_DECREF(pValue);
+  if(!ret){
+    std::cout<<"Python script returned internal error in execute "<<std::endl;
+    return false;
+  }
+
+  // the results of this batch only, keyed by the event number; earlier batches are replaced,
+  // the csv file keeps the results of every event
+  BoostStore* results=m_data->Stores[batch_result_store_name];
+  for(size_t k=0; k<batch_outputs.size(); k++){
+    std::map<int,double> values;
+    for(size_t i=0; i<nrows; i++) values[batch_events[i]]=output_buffer[k*batchsize+i];
+    results->Set(batch_outputs[k],values);
+  }
+  results->Set("LastBatchEvents",batch_events);
+
+  if(result_file.is_open()){
+    for(size_t i=0; i<nrows; i++){
+      result_file<<batch_events[i];
+      for(size_t k=0; k<batch_outputs.size(); k++) result_file<<","<<output_buffer[k*batchsize+i];
+      result_file<<"\n";
+    }
+    result_file.flush();
+  }
+
+  batch_events.clear();
+  return true;
+}
@@ -3,6 +3,9 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <map>
+#include <fstream>
 #include <Python.h>
 #include <PythonAPI.h>
 
@@ -32,6 +35,27 @@ class PythonScript: public Tool {
 
   int pyinit;
 
+  // batch mode: numeric values of BatchSize events are collected into one buffer per key and
+  // the python execute function is called once per batch with memoryviews of the buffers
+  enum BatchType { batch_double, batch_float, batch_int };
+  bool ParseBatchKeys(std::string keylist, std::vector<std::string> &names, std::vector<BatchType> &types);
+  bool CollectEvent();
+  bool ExecuteBatch();
+  PyObject* MakeBatchDict(std::vector<std::string> &names, std::vector<double> &buffer, size_t nrows, bool writable);
+
+  int batchsize;
+  std::vector<std::string> batch_inputs, batch_outputs;
+  std::vector<BatchType> batch_input_types;
+  std::string batch_event_key;
+  std::string batch_result_store_name;
+  bool own_result_store;              // the result store was created by this tool and is deleted in Finalise
+  std::string batch_result_file;      // optional csv file with one line of results per event
+  std::ofstream result_file;
+  std::vector<double> input_buffer;   // column-major: key k of event i is at k*batchsize+i
+  std::vector<double> output_buffer;
+  std::vector<int> batch_events;      // event number of each row of the current batch
+  int events_collected;
+
 };
 
 
@@ -1,7 +1,20 @@
 #include "SaveANNIEEvent.h"
 
+#include <sstream>
+#include <map>
+#include "Hit.h"
+#include "TimeClass.h"
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+
 SaveANNIEEvent::SaveANNIEEvent():Tool(){}
 
+SaveANNIEEvent::~SaveANNIEEvent(){
+  // the chain can be torn down without Finalise, e.g. after another tool failed
+  StopWriter();
+  delete writer_store;
+}
+
 
 bool SaveANNIEEvent::Initialise(std::string configfile, DataModel &data){
 
@@ -13,23 +26,237 @@ bool SaveANNIEEvent::Initialise(std::string configfile, DataModel &data){
   /////////////////////////////////////////////////////////////////
 
   m_variables.Get("path", path);
+  m_variables.Get("verbosity", verbosity);
+  int async_flag = 0;
+  m_variables.Get("AsyncSave", async_flag);
+  async_save = (async_flag!=0);
+  m_variables.Get("MaxInFlight", max_in_flight);
+  if(max_in_flight<1) max_in_flight=1;
+
+  int tags_flag = 0;
+  m_variables.Get("WriteTags", tags_flag);
+  write_tags = (tags_flag!=0);
+  if(write_tags){
+    std::vector<std::string> columns{"Entry","RunNumber","SubrunNumber","EventNumber","TriggerWord",
+        "EventTimeTank","EventTimeMRD","NHits","NClusters","NMrdTracks"};
+    std::string tag_key_list;
+    m_variables.Get("TagKeys", tag_key_list);
+    std::stringstream ss_keys(tag_key_list);
+    std::string key;
+    while(std::getline(ss_keys, key, ',')){
+      if(key.empty()) continue;
+      size_t colon = key.find(':');
+      std::string type = (colon==std::string::npos) ? "double" : key.substr(colon+1);
+      key = key.substr(0,colon);
+      if(type!="int" && type!="uint32" && type!="uint64" && type!="double" && type!="bool"){
+        Log("SaveANNIEEvent Error: unknown type "+type+" of TagKeys entry "+key,v_error,verbosity);
+        return false;
+      }
+      tag_keys.emplace_back(key,type);
+      columns.push_back(key);
+    }
+    tags.SetColumns(columns);
+    if(!tags.Open(path+".tags")){
+      Log("SaveANNIEEvent Error: could not open tag file "+path+".tags",v_error,verbosity);
+      return false;
+    }
+    tag_row.resize(columns.size());
+  }
+
+  if(async_save){
+    Log("SaveANNIEEvent: writing events in a background thread, at most "+std::to_string(max_in_flight)+" events in flight",v_message,verbosity);
+    writer_store = new BoostStore(false,BOOST_STORE_MULTIEVENT_FORMAT);
+    stop_writer = false;
+    writer_thread = std::thread(&SaveANNIEEvent::WriterLoop, this);
+  }
+
   return true;
 }
 
 
 bool SaveANNIEEvent::Execute(){
 
-  m_data->Stores["ANNIEEvent"]->Save(path);
+  if(write_tags) FillTags();
+
+  if(!async_save){
+    m_data->Stores["ANNIEEvent"]->Save(path);
+    m_data->Stores["ANNIEEvent"]->Delete();
+    return true;
+  }
+
+  {
+    // back-pressure: wait until the writer has room for another event
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    queue_cv.wait(lock, [this]{ return events_in_flight < max_in_flight; });
+    if(writer_error!=""){
+      Log("SaveANNIEEvent Error: "+writer_error,v_error,verbosity);
+      return false;
+    }
+  }
+
+  // BoostStore values are serialised when they are Set, so serialising the store only copies the
+  // serialised entries. The copy belongs to the queue, the ANNIEEvent store is cleared as in
+  // synchronous mode and stays valid for the tools that hold it (e.g. LoadANNIEEvent).
+  std::string buffer;
+  try{
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    {
+      boost::archive::binary_oarchive oa(ss);
+      oa << *m_data->Stores["ANNIEEvent"];
+    }
+    buffer = ss.str();
+  }
+  catch(std::exception &e){
+    Log(std::string("SaveANNIEEvent Error: failed to serialise the event: ")+e.what(),v_error,verbosity);
+    return false;
+  }
   m_data->Stores["ANNIEEvent"]->Delete();
 
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    pending_events.push_back(std::move(buffer));
+    events_in_flight++;
+  }
+  queue_cv.notify_all();
+
   return true;
 }
 
 
 bool SaveANNIEEvent::Finalise(){
 
+  if(write_tags){
+    tags.Close();
+    Log("SaveANNIEEvent: wrote tags of "+std::to_string(tag_entry)+" events to "+path+".tags",v_message,verbosity);
+  }
 
-  m_data->Stores["ANNIEEvent"]->Close();
+  if(!async_save){
+    m_data->Stores["ANNIEEvent"]->Close();
+    return true;
+  }
+
+  StopWriter();
+
+  // the file header is written on Close, so give the writer the Header of the chain's store for that
+  BoostStore* current = m_data->Stores["ANNIEEvent"];
+  std::swap(writer_store->Header, current->Header);
+  writer_store->Close();
+  std::swap(writer_store->Header, current->Header);
+  delete writer_store;
+  writer_store = nullptr;
+
+  Log("SaveANNIEEvent: wrote "+std::to_string(events_written)+" events to "+path,v_message,verbosity);
+  if(writer_error!=""){
+    Log("SaveANNIEEvent Error: "+writer_error+", events after the failure were not saved",v_error,verbosity);
+    return false;
+  }
 
   return true;
 }
+
+
+void SaveANNIEEvent::StopWriter(){
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    stop_writer = true;
+  }
+  queue_cv.notify_all();
+  if(writer_thread.joinable()) writer_thread.join();
+
+}
+
+
+void SaveANNIEEvent::WriterLoop(){
+
+  while(true){
+    std::string event;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      queue_cv.wait(lock, [this]{ return stop_writer || !pending_events.empty(); });
+      if(pending_events.empty()) return;  // stop requested and everything written
+      event = std::move(pending_events.front());
+      pending_events.pop_front();
+    }
+
+    // after an error the remaining events are dropped, so the file never has gaps in the middle
+    if(writer_error=="") WriteEvent(event);
+
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      events_in_flight--;
+    }
+    queue_cv.notify_all();
+  }
+
+}
+
+
+void SaveANNIEEvent::WriteEvent(const std::string &event){
+
+  try{
+    std::stringstream buffer(event, std::ios::in | std::ios::binary);
+    {
+      boost::archive::binary_iarchive ia(buffer);
+      ia >> *writer_store;
+    }
+    writer_store->Save(path);
+    writer_store->Delete();
+    events_written++;
+  }
+  catch(std::exception &e){
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    writer_error = "failed to write event "+std::to_string(events_written)+": "+e.what();
+  }
+  catch(...){
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    writer_error = "failed to write event "+std::to_string(events_written);
+  }
+
+}
+
+
+void SaveANNIEEvent::FillTags(){
+
+  // missing values are -9999, like the unfilled branches of the tree makers
+  BoostStore* event = m_data->Stores["ANNIEEvent"];
+  std::fill(tag_row.begin(), tag_row.end(), -9999.);
+  tag_row.at(0) = tag_entry++;
+
+  int run = 0, subrun = 0;
+  uint32_t event_number = 0, trigger_word = 0;
+  uint64_t tank_time = 0;
+  TimeClass mrd_time;
+  if(event->Get("RunNumber",run)) tag_row.at(1) = run;
+  if(event->Get("SubrunNumber",subrun)) tag_row.at(2) = subrun;
+  if(event->Get("EventNumber",event_number)) tag_row.at(3) = event_number;
+  if(event->Get("TriggerWord",trigger_word)) tag_row.at(4) = trigger_word;
+  if(event->Get("EventTimeTank",tank_time)) tag_row.at(5) = tank_time;
+  if(event->Get("EventTimeMRD",mrd_time)) tag_row.at(6) = mrd_time.GetNs();
+
+  std::map<unsigned long, std::vector<Hit>>* hits = nullptr;
+  if(event->Has("Hits") && event->Get("Hits",hits) && hits){
+    size_t nhits = 0;
+    for(const auto &channel : *hits) nhits += channel.second.size();
+    tag_row.at(7) = nhits;
+  }
+  std::map<double,std::vector<Hit>>* clusters = nullptr;
+  if(m_data->CStore.Get("ClusterMap",clusters) && clusters) tag_row.at(8) = clusters->size();
+  int num_mrd_tracks = 0;
+  if(m_data->Stores.count("MRDTracks") && m_data->Stores.at("MRDTracks")->Get("NumMrdTracks",num_mrd_tracks)){
+    tag_row.at(9) = num_mrd_tracks;
+  }
+
+  for(size_t i=0; i<tag_keys.size(); i++){
+    const std::string &key = tag_keys.at(i).first;
+    const std::string &type = tag_keys.at(i).second;
+    double &value = tag_row.at(10+i);
+    if(type=="int"){ int v; if(event->Get(key,v)) value = v; }
+    else if(type=="uint32"){ uint32_t v; if(event->Get(key,v)) value = v; }
+    else if(type=="uint64"){ uint64_t v; if(event->Get(key,v)) value = v; }
+    else if(type=="bool"){ bool v; if(event->Get(key,v)) value = v; }
+    else { double v; if(event->Get(key,v)) value = v; }
+  }
+
+  if(!tags.WriteRow(tag_row)) Log("SaveANNIEEvent Error: failed to write tags of event "+std::to_string(tag_entry-1),v_error,verbosity);
+}
@@ -3,8 +3,14 @@
 
 #include <string>
 #include <iostream>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "Tool.h"
+#include "ANNIEconstants.h"
+#include "EventTagTable.h"
 
 class SaveANNIEEvent: public Tool {
 
@@ -12,6 +18,7 @@ class SaveANNIEEvent: public Tool {
  public:
 
   SaveANNIEEvent();
+  ~SaveANNIEEvent();
   bool Initialise(std::string configfile,DataModel &data);
   bool Execute();
   bool Finalise();
@@ -19,9 +26,39 @@ class SaveANNIEEvent: public Tool {
 
  private:
   std::string path;
+  int verbosity=1;
 
+  // asynchronous mode: the entries of each event are serialised into a buffer owned by the queue
+  // and a background thread writes them through writer_store, which owns the output file.
+  // The ANNIEEvent store itself stays in place and is cleared like in synchronous mode.
+  bool async_save=false;
+  int max_in_flight=2;                      ///< events queued or being written before Execute blocks
+  BoostStore* writer_store=nullptr;
+  std::thread writer_thread;
+  std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+  std::deque<std::string> pending_events;    ///< serialised event entries
+  int events_in_flight=0;                   ///< queued + currently written
+  bool stop_writer=false;
+  std::string writer_error;                 ///< first error of the writer thread (guarded by queue_mutex)
+  unsigned long events_written=0;
 
+  void StopWriter();                        ///< write the queued events and join the writer thread
+  void WriterLoop();
+  void WriteEvent(const std::string &event);
 
+  // tag file next to the output file, one row of event summary values per saved event
+  bool write_tags=false;
+  EventTagTable tags;
+  std::vector<std::pair<std::string,std::string>> tag_keys;   ///< extra ANNIEEvent scalars: key, type
+  std::vector<double> tag_row;
+  unsigned long tag_entry=0;
+  void FillTags();
+
+  int v_error=0;
+  int v_warning=1;
+  int v_message=2;
+  int v_debug=3;
 
 };
 
@@ -20,6 +20,9 @@ bool TriggerDataDecoder::Initialise(std::string configfile, DataModel &data){
   m_variables.Get("TriggerMaskFile",TriggerMaskFile);
   m_variables.Get("TriggerWordFile",TriggerWordFile);
   m_variables.Get("Mode",mode);
+  int max_queued = max_queued_triggers;
+  m_variables.Get("MaxQueuedTriggers",max_queued);
+  max_queued_triggers = (max_queued>0) ? max_queued : 0;
 
   if (mode != "EventBuilding" && mode != "Monitoring"){
     Log("TriggerDataDecoder tool: Specified mode of operation >> "+mode+" unknown. Use standard EventBuilding mode.",v_error,verbosity);
@@ -36,97 +39,92 @@ bool TriggerDataDecoder::Initialise(std::string configfile, DataModel &data){
     TriggerMask = LoadTriggerMask(TriggerMaskFile);
     if(TriggerMask.size()>0) UseTrigMask = true;
   }
+  // the trigger word is the upper 8 bits of a CTC word, so the mask and the word types are 256 entry tables
+  for(int trigger : TriggerMask){
+    if(trigger>=0 && trigger<256) trigger_mask_table.set(trigger);
+    else Log("TriggerDataDecoder Tool: Trigger mask entry "+to_string(trigger)+" is not a CTC trigger word (0-255), ignored",v_warning,verbosity);
+  }
+  word_types.fill(CTCTrigger);
+  word_types[0xC0] = CTCHeader;
+  word_types[0xC1] = CTCCoarse1;
+  word_types[0xC3] = CTCCoarse1;
+  word_types[0xC2] = CTCCoarse2;
+  word_types[0xC4] = CTCCoarse2;
 
   if(TriggerWordFile!="none"){
     TriggerWords = LoadTriggerWords(TriggerWordFile);    //maps trigger words to human-readable labels
     m_data->CStore.Set("TriggerWordMap",TriggerWords);
   }
 
+  bool ResumeFromCheckpoint = false;
+  m_data->CStore.Get("ResumeFromCheckpoint",ResumeFromCheckpoint);
+  if(ResumeFromCheckpoint && mode == "EventBuilding") this->LoadCheckpoint();
+
   return true;
 }
 
 
 bool TriggerDataDecoder::Execute(){
 
+  new_ctc_data = false;
+
   if (mode == "EventBuilding"){
     m_data->CStore.Set("NewCTCDataAvailable",false);
+    bool CheckpointRequested = false;
+    m_data->CStore.Get("SaveCheckpoint",CheckpointRequested);
+    if(CheckpointRequested) this->SaveCheckpoint();
+    bool WaitingForRawData = false;
+    m_data->CStore.Get("WaitingForRawData",WaitingForRawData);
+    if(WaitingForRawData) return true;
     bool PauseCTCDecoding = false;
     m_data->CStore.Get("PauseCTCDecoding",PauseCTCDecoding);
-    if (PauseCTCDecoding){
+    if (PauseCTCDecoding && pending_words.empty()){
       std::cout << "TriggerDataDecoder tool: Pausing trigger decoding to let Tank and MRD data catch up..." << std::endl;
       return true;
     }
+    //LoadRawData does not load a TrigData entry while words are held back (HoldCTCData)
+    bool held_back = !pending_words.empty();
     //Clear decoding maps if a new run/subrun is encountered
     this->CheckForRunChange();
-  
-    //Get the TriggerData vector pointer from the CStore
-    Log("TriggerDataDecoder Tool: Accessing TrigData vector in CStore",v_debug, verbosity);
-    bool got_tdata = m_data->CStore.Get("TrigData",Tdata);
-    if(!got_tdata){
-      if(verbosity>0) std::cout << "TriggerDataDecoder error: No TriggerData in CStore!" << std::endl;
-      return false;
+
+    //Words held back while the queue was full come before the next entry
+    if(!pending_words.empty()){
+      size_t nconsumed = this->DecodeWords(pending_words.data(),pending_words.size(),max_queued_triggers);
+      pending_words.erase(pending_words.begin(),pending_words.begin()+nconsumed);
     }
-    bool new_ts_available = false;
-    std::vector<uint32_t> aTimeStampData = Tdata->TimeStampData;
-    for(int i = 0; i < (int) aTimeStampData.size(); i++){
-      if(verbosity>v_debug) std::cout<<"TriggerDataDecoder Tool: Loading next TrigData from entry's index " << i <<std::endl;
-      new_ts_available = this->AddWord(aTimeStampData.at(i));
-      if(new_ts_available){
-        if(verbosity>4){
-          std::cout << "PARSED TRIGGER TIME: " << processed_ns.back() << std::endl;
-          std::cout << "PARSED TRIGGER WORD: " << processed_sources.back() << std::endl;
-        }
-        if(UseTrigMask){
-          uint32_t recent_trigger_word = processed_sources.back();
-          for(int j = 0; j<(int) TriggerMask.size(); j++){
-            if(TriggerMask.at(j) == recent_trigger_word){
-              m_data->CStore.Set("NewCTCDataAvailable",true);
-              if(verbosity>4) std::cout << "TRIGGER WORD BEING ADDED TO TRIGWORDMAP" << std::endl;
-              TimeToTriggerWordMap->emplace(processed_ns.back(),processed_sources.back());
-            }
-          }
-        } else {
-          m_data->CStore.Set("NewCTCDataAvailable",true);
-          if(verbosity>4) std::cout << "TRIGGER WORD BEING ADDED TO TRIGWORDMAP" << std::endl;
-          TimeToTriggerWordMap->emplace(processed_ns.back(),processed_sources.back());
-        }
+
+    //LoadRawData only loads a new TrigData entry when CTC decoding is neither paused nor held back
+    if(!PauseCTCDecoding && !held_back){
+      //Get the TriggerData vector pointer from the CStore
+      Log("TriggerDataDecoder Tool: Accessing TrigData vector in CStore",v_debug, verbosity);
+      bool got_tdata = m_data->CStore.Get("TrigData",Tdata);
+      if(!got_tdata){
+        if(verbosity>0) std::cout << "TriggerDataDecoder error: No TriggerData in CStore!" << std::endl;
+        return false;
       }
+      const std::vector<uint32_t> &aTimeStampData = Tdata->TimeStampData;
+      size_t nconsumed = this->DecodeWords(aTimeStampData.data(),aTimeStampData.size(),max_queued_triggers);
+      if(nconsumed<aTimeStampData.size()) pending_words.assign(aTimeStampData.begin()+nconsumed,aTimeStampData.end());
+    }
+
+    //The queue is full: keep the next entry in LoadRawData until the builder has consumed some triggers.
+    //Unlike PauseCTCDecoding this is not lifted by ANNIEEventBuilder, so at most one entry is held back.
+    if(!pending_words.empty()){
+      Log("TriggerDataDecoder Tool: "+to_string(TimeToTriggerWordMap->size())+" triggers waiting to be built, holding back "
+          +to_string(pending_words.size())+" CTC words",v_message,verbosity);
     }
+    m_data->CStore.Set("HoldCTCData",!pending_words.empty());
+    if(new_ctc_data) m_data->CStore.Set("NewCTCDataAvailable",true);
   } 
   else if (mode == "Monitoring"){
     TimeToTriggerWordMap->clear();
-    processed_sources.clear();
-    processed_ns.clear();
     std::map<int,TriggerData> TrigData_Map;
     m_data->Stores["TrigData"]->Get("TrigDataMap",TrigData_Map);
-    bool new_ts_available = false;
-    for (int i_entry=0; i_entry < int(TrigData_Map.size()); i_entry++){
-      TriggerData TData = TrigData_Map.at(i_entry);
-      std::vector<uint32_t> aTimeStampData = TData.TimeStampData;
-      for (int i=0; i < (int) aTimeStampData.size(); i++){
-        new_ts_available = this->AddWord(aTimeStampData.at(i));
-        if (new_ts_available){
-          if(verbosity>4){
-            std::cout << "PARSED TRIGGER TIME: " << processed_ns.back() << std::endl;
-            std::cout << "PARSED TRIGGER WORD: " << processed_sources.back() << std::endl;
-          }
-          if(UseTrigMask){
-            uint32_t recent_trigger_word = processed_sources.back();
-            for(int j = 0; j<(int) TriggerMask.size(); j++){
-              if(TriggerMask.at(j) == recent_trigger_word){
-                m_data->CStore.Set("NewCTCDataAvailable",true);
-                if(verbosity>4) std::cout << "TRIGGER WORD BEING ADDED TO TRIGWORDMAP" << std::endl;
-                TimeToTriggerWordMap->emplace(processed_ns.back(),processed_sources.back());
-              }
-            }
-          } else {
-            m_data->CStore.Set("NewCTCDataAvailable",true);
-            if(verbosity>4) std::cout << "TRIGGER WORD BEING ADDED TO TRIGWORDMAP" << std::endl;
-            TimeToTriggerWordMap->emplace(processed_ns.back(),processed_sources.back());
-          }
-        }     
-      }
+    for (const std::pair<const int,TriggerData> &entry : TrigData_Map){
+      const std::vector<uint32_t> &aTimeStampData = entry.second.TimeStampData;
+      this->DecodeWords(aTimeStampData.data(),aTimeStampData.size(),0);
     }
+    if(new_ctc_data) m_data->CStore.Set("NewCTCDataAvailable",true);
   }
 
   if(verbosity>3) Log("TriggerDataDecoder Tool: size of TimeToTriggerWordMap: "+to_string(TimeToTriggerWordMap->size()),v_message,verbosity); 
@@ -139,44 +137,56 @@ bool TriggerDataDecoder::Execute(){
 
 bool TriggerDataDecoder::Finalise(){
   //delete TimeToTriggerWordMap;	//DONT delete TimeToTriggerWordMap since it wil be deleted by the CStore automatically
+  Log("TriggerDataDecoder Tool: Decoded "+to_string(num_decoded)+" triggers, "+to_string(num_queued)+" passed the trigger mask, "
+      +to_string(num_fifo_resets)+" FIFO resets",v_message,verbosity);
+  if(!pending_words.empty()) Log("TriggerDataDecoder Tool: "+to_string(pending_words.size())+" CTC words were never decoded",v_warning,verbosity);
   std::cout << "TriggerDataDecoder tool exitting" << std::endl;
   return true;
 }
 
-bool TriggerDataDecoder::AddWord(uint32_t word){
-  bool new_timestamp_available = false;
-  uint64_t payload = 0;
-  uint32_t wordid = 0;
-  if(word == 0xF1F0E5E7){
-    have_c1 = false;
-    c1 = 0;
-    have_c2 = false;
-    c2 = 0;
-    fiforesets.push_back(processed_sources.size()); 
-    return new_timestamp_available;
-  }
-
-  wordid = word>>24;
-  payload = word & 0x00FFFFFF;
+size_t TriggerDataDecoder::DecodeWords(const uint32_t* words, size_t nwords, size_t max_queued){
+  for(size_t i=0; i<nwords; i++){
+    uint32_t word = words[i];
+    if(word == 0xF1F0E5E7){
+      have_c1 = false;
+      c1 = 0;
+      have_c2 = false;
+      c2 = 0;
+      num_fifo_resets++;
+      continue;
+    }
 
-  if(wordid == 0xC0){
-    return new_timestamp_available;
-  }
-  else if (wordid == 0xC1 || wordid == 0xC3){
-    c1 = (payload&0x0000FFFF)<<24;
-    have_c1 = true;
-  } else if (wordid == 0xC2 || wordid == 0xC4){
-    c2 = payload << 40;
-    have_c2 = true;
-  } else {
-    if(have_c1 && have_c2){
-      uint64_t ns = (c1 + c2 + payload)*8;
-      processed_sources.push_back(wordid);
-      processed_ns.push_back(ns);
-      new_timestamp_available = true;
+    uint32_t wordid = word>>24;
+    uint64_t payload = word & 0x00FFFFFF;
+    switch(word_types[wordid]){
+      case CTCHeader:
+        break;
+      case CTCCoarse1:
+        c1 = (payload&0x0000FFFF)<<24;
+        have_c1 = true;
+        break;
+      case CTCCoarse2:
+        c2 = payload << 40;
+        have_c2 = true;
+        break;
+      default:
+        if(!(have_c1 && have_c2)) break;
+        bool in_mask = (!UseTrigMask || trigger_mask_table[wordid]);
+        if(in_mask && max_queued>0 && TimeToTriggerWordMap->size()>=max_queued) return i;
+        uint64_t ns = (c1 + c2 + payload)*8;
+        num_decoded++;
+        if(verbosity>4){
+          std::cout << "PARSED TRIGGER TIME: " << ns << std::endl;
+          std::cout << "PARSED TRIGGER WORD: " << wordid << std::endl;
+        }
+        if(!in_mask) break;
+        if(verbosity>4) std::cout << "TRIGGER WORD BEING ADDED TO TRIGWORDMAP" << std::endl;
+        TimeToTriggerWordMap->emplace(ns,wordid);
+        num_queued++;
+        new_ctc_data = true;
     }
   }
-  return new_timestamp_available;
+  return nwords;
 }
 
 void TriggerDataDecoder::CheckForRunChange()
@@ -201,10 +211,15 @@ void TriggerDataDecoder::CheckForRunChange()
   else if (RunNumber != CurrentRunNum){ //New run has been encountered
     Log("TriggerDataDecoder Tool: New run encountered.  Clearing event building maps",v_message,verbosity); 
     TimeToTriggerWordMap->clear();
+    pending_words.clear();
+    CurrentRunNum = RunNumber;
+    CurrentSubrunNum = SubRunNumber;
   }
   else if (SubRunNumber != CurrentSubrunNum){ //New run has been encountered
     Log("TriggerDataDecoder Tool: New subrun encountered.",v_message,verbosity); 
     TimeToTriggerWordMap->clear();
+    pending_words.clear();
+    CurrentSubrunNum = SubRunNumber;
   }
   return;
 }
@@ -250,3 +265,37 @@ std::map<int,std::string> TriggerDataDecoder::LoadTriggerWords(std::string trigg
 
   return triggerwordmap;
 }
+
+void TriggerDataDecoder::SaveCheckpoint(){
+  //Triggers not built yet, words held back and the coarse counters, which carry over between entries
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  Checkpoint->Set("CTCTimeToTriggerWordMap",*TimeToTriggerWordMap);
+  Checkpoint->Set("CTCPendingWords",pending_words);
+  Checkpoint->Set("CTCHaveC1",have_c1);
+  Checkpoint->Set("CTCHaveC2",have_c2);
+  Checkpoint->Set("CTCC1",c1);
+  Checkpoint->Set("CTCC2",c2);
+  Checkpoint->Set("CTCCurrentRunNum",CurrentRunNum);
+  Checkpoint->Set("CTCCurrentSubrunNum",CurrentSubrunNum);
+  Checkpoint->Set("CTCNumDecoded",num_decoded);
+  Checkpoint->Set("CTCNumQueued",num_queued);
+  Checkpoint->Set("CTCNumFIFOResets",num_fifo_resets);
+}
+
+void TriggerDataDecoder::LoadCheckpoint(){
+  BoostStore* Checkpoint = m_data->Stores["Checkpoint"];
+  Checkpoint->Get("CTCTimeToTriggerWordMap",*TimeToTriggerWordMap);
+  Checkpoint->Get("CTCPendingWords",pending_words);
+  m_data->CStore.Set("HoldCTCData",!pending_words.empty());
+  Checkpoint->Get("CTCHaveC1",have_c1);
+  Checkpoint->Get("CTCHaveC2",have_c2);
+  Checkpoint->Get("CTCC1",c1);
+  Checkpoint->Get("CTCC2",c2);
+  Checkpoint->Get("CTCCurrentRunNum",CurrentRunNum);
+  Checkpoint->Get("CTCCurrentSubrunNum",CurrentSubrunNum);
+  Checkpoint->Get("CTCNumDecoded",num_decoded);
+  Checkpoint->Get("CTCNumQueued",num_queued);
+  Checkpoint->Get("CTCNumFIFOResets",num_fifo_resets);
+  m_data->CStore.Set("TimeToTriggerWordMap",TimeToTriggerWordMap);
+  Log("TriggerDataDecoder Tool: Resumed with "+to_string(TimeToTriggerWordMap->size())+" triggers waiting to be built",v_message,verbosity);
+}
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <iostream>
+#include <array>
+#include <bitset>
 
 #include <boost/algorithm/string.hpp>
 
@@ -27,10 +29,12 @@ class TriggerDataDecoder: public Tool {
   bool Execute(); ///< Execute function used to perform Tool purpose.
   bool Finalise(); ///< Finalise function used to clean up resources.
 
-  bool AddWord(uint32_t word);
+  size_t DecodeWords(const uint32_t* words, size_t nwords, size_t max_queued); ///< Decode words into the TimeToTriggerWordMap, stops before a trigger that does not fit in a queue of max_queued (0: no limit). @return number of words consumed
   std::vector<int> LoadTriggerMask(std::string triggermask_file);
   std::map<int,std::string> LoadTriggerWords(std::string triggerwords_file);
   void CheckForRunChange();
+  void SaveCheckpoint();   ///< Add the decoding state to the Checkpoint store (LoadRawData Online mode)
+  void LoadCheckpoint();
  private:
 
   //std::vector<TriggerData> *Tdata = nullptr;
@@ -46,9 +50,18 @@ class TriggerDataDecoder: public Tool {
   std::string TriggerWordsFile;
   std::map<int,std::string> TriggerWords;
 
-  std::vector<int> fiforesets;
-  std::vector<uint32_t> processed_sources;
-  std::vector<uint64_t> processed_ns;
+  // word id (upper 8 bits) -> type of the CTC word
+  enum CTCWordType : uint8_t { CTCTrigger=0, CTCHeader, CTCCoarse1, CTCCoarse2 };
+  std::array<uint8_t,256> word_types;
+  std::bitset<256> trigger_mask_table;   // word ids passing the TriggerMask
+
+  size_t max_queued_triggers = 100000;
+  std::vector<uint32_t> pending_words;   // words not decoded yet because the queue was full
+  bool new_ctc_data = false;
+  uint64_t num_fifo_resets = 0;
+  uint64_t num_decoded = 0;
+  uint64_t num_queued = 0;
+
   bool have_c1 = false;
   bool have_c2 = false;
   uint64_t c1 = 0;
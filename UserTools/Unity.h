@@ -16,6 +16,7 @@
 #include "LAPPDFilter.h"
 #include "LAPPDFindPeak.h"
 #include "LAPPDIntegratePulse.h"
+#include "LAPPDProcessWaveforms.h"
 #include "LAPPDParseACC.h"
 #include "LAPPDParseScope.h"
 #include "LAPPDSaveROOT.h"
@@ -73,6 +74,7 @@
 #include "HitResiduals.h"
 #include "MonitorReceive.h"
 #include "MonitorSimReceive.h"
+#include "MonitorSimStream.h"
 #include "EventSelectorDoE.h"
 #include "DigitBuilderDoE.h"
 #include "MonitorMRDTime.h"
@@ -129,3 +131,6 @@
 #include "MonitorTrigger.h"
 #include "EventClassification.h"
 #include "DataSummary.h"
+#include "NativeEnergyReco.h"
+#include "BenchmarkInput.h"
+#include "BenchmarkSuite.h"
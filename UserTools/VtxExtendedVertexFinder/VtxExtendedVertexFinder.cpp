@@ -30,6 +30,7 @@ bool VtxExtendedVertexFinder::Initialise(std::string configfile, DataModel &data
   /// and free the memory. 
   /// In this tool, the pointer is 
   fExtendedVertex = new RecoVertex();
+  fArena = m_data->Arena.NewPool("VtxExtendedVertexFinder");
   
   return true;
 }
@@ -39,6 +40,7 @@ bool VtxExtendedVertexFinder::Execute(){
   Log("VtxExtendedVertexFinder Tool: Executing",v_debug,verbosity);
   // Reset everything
   this->Reset();
+  fArena->BeginEvent();
   
   // check if event passes the cut
   bool EventCutstatus = false;
@@ -136,6 +138,9 @@ bool VtxExtendedVertexFinder::Execute(){
 bool VtxExtendedVertexFinder::Finalise(){
   // memory has to be freed in the Finalise() function
   delete fExtendedVertex; fExtendedVertex = 0;
+  fArena->Release();
+  Log("VtxExtendedVertexFinder Tool: "+to_string(fArena->GetStats().allocations)+" arena allocations, peak "
+      +to_string(fArena->GetStats().peak_event_bytes)+" bytes per event",v_message,verbosity);
   if(verbosity>0) cout<<"VtxExtendedVertexFinder exitting"<<endl;
   return true;
 }
@@ -174,7 +179,7 @@ RecoVertex* VtxExtendedVertexFinder::FitGridSeeds(std::vector<RecoVertex>* vSeed
   unsigned int nlast = vSeedVtxList->size();
   
   RecoVertex* fSeedPos = 0;
-  RecoVertex* fSimpleVertex = new RecoVertex();
+  RecoVertex* fSimpleVertex = 0;
   RecoVertex* bestGridVertex = new RecoVertex(); // FIXME: pointer must be deleted by the invoker
   
   for( unsigned int n=0; n<nlast; n++ ){
@@ -273,7 +278,7 @@ RecoVertex* VtxExtendedVertexFinder::FindSimpleDirection(RecoVertex* myVertex) {
 
   // set vertex and direction
   // ========================
-  RecoVertex* newVertex = new RecoVertex(); // Note: pointer must be deleted by the invoker
+  RecoVertex* newVertex = fArena->Create<RecoVertex>(); // Note: lives until the next event
   
   if( pass ){
     newVertex->SetVertex(vtxX,vtxY,vtxZ,vtxTime);
@@ -62,6 +62,9 @@ class VtxExtendedVertexFinder: public Tool {
   
   /// Vertex Geometry shared by Fitter tools
   VertexGeometry* myvtxgeo;
+
+  /// simple direction vertices of the seeds, released every event
+  EventArena::Pool* fArena = nullptr;
   
   /// verbosity levels: if 'verbosity' < this level, the message type will be logged.
   int verbosity=-1;
@@ -87,6 +87,7 @@ bool VtxPointPositionFinder::Execute(){
     // return vertex
     if (fUseMinuit){
       fPointPosition  = (RecoVertex*)(this->FitPointPosition(fTrueVertex));
+      this->PushPointPosition(fPointPosition, true);
     } else {
       Log("VtxPointPositionFinder Tool: You've chosen to use MC truth information but not use Minuit for position fit... returning True MC vertex as Point Position",v_message,verbosity);
     RecoVertex* newVertex = new RecoVertex();
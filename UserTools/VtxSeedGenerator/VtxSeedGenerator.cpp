@@ -143,6 +143,34 @@ bool VtxSeedGenerator::GenerateSeedGrid(int NSeeds) {
     return false;
   }
   	
+  if(!fTOFTable.HasSeedGrid()) this->BuildSeedGrid(NSeeds);
+
+  // table row of each digit; the PMT positions are the same every event, LAPPD hit positions are not
+  Log("VtxSeedGenerator Tool: Calculating median times of the seed grid", v_debug,verbosity);
+  vSeedSensors.assign(vSeedDigitList.size(),-1);
+  vSeedTimes.resize(vSeedDigitList.size());
+  for (int entry=0; entry<vSeedDigitList.size(); entry++){
+    const RecoDigit& seeddigit = fDigitList->at(vSeedDigitList.at(entry));
+    vSeedTimes.at(entry) = seeddigit.GetCalTime();
+    if(seeddigit.GetDigitType()==RecoDigit::PMT8inch) vSeedSensors.at(entry) = fTOFTable.AddSensor(seeddigit.GetPosition());
+  }
+  for (int entry=0; entry<vSeedDigitList.size(); entry++){
+    if(vSeedSensors.at(entry)<0) vSeedSensors.at(entry) = fTOFTable.AddEventSensor(fDigitList->at(vSeedDigitList.at(entry)).GetPosition());
+  }
+  fTOFTable.MedianSeedTimes(vSeedSensors,vSeedTimes,vMedianTimes);
+  fTOFTable.ClearEventSensors();
+
+  const std::vector<Position>& grid = fTOFTable.GetSeedGrid();
+  for (int i=0; i<grid.size(); i++){
+    RecoVertex thisgridseed;
+    thisgridseed.SetVertex(grid.at(i),vMedianTimes.at(i));
+    vSeedVtxList->push_back(thisgridseed);
+  }
+  Log("VtxSeedGenerator Tool: Grid of positions and median times calculated", v_debug,verbosity);
+  return true;
+}
+
+void VtxSeedGenerator::BuildSeedGrid(int NSeeds) {
   //Now, we generate our grid of position/time guesses.  Position first.
   //We will use Vogel's method to populate disks with equidistant points
   //inside the ANNIE tank.  The z separation for each disk will be approx. the
@@ -173,8 +201,9 @@ bool VtxSeedGenerator::GenerateSeedGrid(int NSeeds) {
     zpoints.push_back(z);
   }
 
-  //Now, push a vertex for each point in each disk layer
-  double diskind,layers,disk_height,mediantime;
+  //Now, a position for each point in each disk layer
+  double diskind,layers,disk_height;
+  std::vector<Position> grid;
   for (int j=0; j<numlayers; j++){
     for (int k=0; k<points_ondisk; k++) {
       diskind = (double) j;
@@ -184,47 +213,16 @@ bool VtxSeedGenerator::GenerateSeedGrid(int NSeeds) {
       thisgridpos.SetX(xpoints[k]);
       thisgridpos.SetZ(zpoints[k]);
       thisgridpos.SetY(disk_height);
-      mediantime = this->GetMedianSeedTime(thisgridpos);
-      RecoVertex thisgridseed;
-      thisgridseed.SetVertex(thisgridpos,mediantime);
-      vSeedVtxList->push_back(thisgridseed);
+      grid.push_back(thisgridpos);
     }
   }
-  Log("VtxSeedGenerator Tool: Grid of positions and median times calculated", v_debug,verbosity);
-  return true;
-}
 
-double VtxSeedGenerator::GetMedianSeedTime(Position pos){
-  double digitx, digity, digitz, digittime;
-  double dx,dy,dz,dr;
-  double fC, fN;
-  double seedtime;
-  std::vector<double> extraptimes;
-  for (int entry=0; entry<vSeedDigitList.size(); entry++){
-    fThisDigit = vSeedDigitList.at(entry);
-    digitx = fDigitList->at(fThisDigit).GetPosition().X();
-    digity = fDigitList->at(fThisDigit).GetPosition().Y();
-    digitz = fDigitList->at(fThisDigit).GetPosition().Z();
-    digittime = fDigitList->at(fThisDigit).GetCalTime();
-    //Now, find distance to seed position
-    dx = digitx - pos.X();
-    dy = digity - pos.Y();
-    dz = digitz - pos.Z();
-    dr = sqrt(pow(dx,2) + pow(dy,2) + pow(dz,2));
-
-    //Back calculate to the vertex time using speed of light in H20
-    //Very rough estimate; ignores muon path before Cherenkov production
-    //TODO: add charge weighting?  Kinda like CalcSimpleVertex?
-    fC = Parameters::SpeedOfLight();
-    fN = Parameters::Index0();
-    seedtime = digittime - (dr/(fC/fN));
-    extraptimes.push_back(seedtime);
-  }
-  //return the median of the extrapolated vertex times
-  size_t median_index = extraptimes.size() / 2;
-  std::nth_element(extraptimes.begin(), extraptimes.begin()+median_index, extraptimes.end());
-  return extraptimes[median_index];
-}  
+  //Back calculate to the vertex time using speed of light in H20
+  //Very rough estimate; ignores muon path before Cherenkov production
+  //TODO: add charge weighting?  Kinda like CalcSimpleVertex?
+  fTOFTable.SetSeedGrid(grid, Parameters::SpeedOfLight()/Parameters::Index0());
+  Log("VtxSeedGenerator Tool: Seed grid of "+std::to_string(grid.size())+" positions built", v_message,verbosity);
+}
 
 bool VtxSeedGenerator::GenerateVertexSeeds(int NSeeds) {
   double VtxX1 = 0.0;
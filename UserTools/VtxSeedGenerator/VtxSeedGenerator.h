@@ -7,6 +7,7 @@
 #include "Tool.h"
 #include "ANNIEGeometry.h"
 #include "Parameters.h"
+#include "TankTOFTable.h"
 #include "TMath.h"
 #include "TRandom.h"
 
@@ -30,8 +31,8 @@ class VtxSeedGenerator: public Tool {
         /// \brief Grid Seed calculator
         ///
 	bool GenerateSeedGrid(int NSeeds);	
-	/// from the position to a digit
-	double GetMedianSeedTime(Position pos);	
+	/// \brief Fill fTOFTable with the seed grid positions, once per job
+	void BuildSeedGrid(int NSeeds);
  	
  	/// \brief Calculate seed candidate
  	///
@@ -86,6 +87,10 @@ class VtxSeedGenerator: public Tool {
   // Initialize the list that grid vertices will go to
   int UseSeedGrid=0;
   std::vector<RecoVertex>* SeedGridList = nullptr;
+  TankTOFTable fTOFTable;        ///< times of flight from the seed grid to the sensors
+  std::vector<int> vSeedSensors;   ///< fTOFTable row of each digit in vSeedDigitList
+  std::vector<double> vSeedTimes;
+  std::vector<double> vMedianTimes;
   
   /// verbosity levels: if 'verbosity' < this level, the message type will be logged.
   int verbosity=-1;
@@ -31,6 +31,9 @@ time-series.
 #include <TCanvas.h>
 #include <math.h>
 #include <string>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 
 
@@ -46,21 +49,10 @@ bool WaveformNNLS::Initialise(std::string configfile, DataModel &data){
   m_data= &data; //assigning transient data pointer
   /////////////////////////////////////////////////////////////////
 
-  return true;
-}
-
-
-bool WaveformNNLS::Execute(){
-
-	
-
 	//rawdata loaded in format of LAPPDSim
-	string RawDataName;
+	RawDataName = "RawLAPPDData";
 	m_variables.Get("rawdataname", RawDataName);
 
-	map<int,vector<Waveform<double>>> rawData;
-	m_data->Stores["ANNIEEvent"]->Get(RawDataName,rawData);
-
 	//This variable controls the sampling depth of the
 	//nnls algorithm and allows the template to have
 	//more samples than the signal waveform. The template
@@ -68,24 +60,138 @@ bool WaveformNNLS::Execute(){
 	//number of samples. The timestep between template
 	//and signal waveform is made equal by expanding the
 	//signal waveform to a larger number of total samples. 
-	double samplingFactor;
+	samplingFactor = 10;
 	m_variables.Get("sampling_factor", samplingFactor);
 
 	//you can use any template you want for the 
 	//algorithm. It assumes that it is a histogram
 	//in a root file named ""
-	TString tempfilename = "dummy.root";
+	tempfilename = "dummy.root";
 	m_variables.Get("tempfilename", tempfilename);
-	TString temphistname = "dummy";
+	temphistname = "dummy";
 	m_variables.Get("temphistname", temphistname);
 
+	//maximum number of nnls iterations
+	maxiter = 20;
+	m_variables.Get("maxiter", maxiter);
+
+	//number of channels solved in parallel, 0 = one per core
+	nthreads = 0;
+	m_variables.Get("nthreads", nthreads);
+	if(nthreads <= 0) nthreads = std::thread::hardware_concurrency();
+	if(nthreads <= 0) nthreads = 1;
+
+	verbosity = 1;
+	m_variables.Get("verbosity", verbosity);
+
+	//the template only depends on the configuration,
+	//so it is read and resampled once for the whole run
+	if(!LoadTemplate()) return false;
+
+	//the LAPPD sample times are known up front, so the matrix
+	//can be built here. Other raw data types get their matrix
+	//on the first event, when the number of samples is known
+	if(RawDataName == "RawLAPPDData")
+	{
+		SetSampleTimes(0);
+	}
+
+  return true;
+}
+
+
+bool WaveformNNLS::Execute(){
+
+	map<int,vector<Waveform<double>>> rawData;
+	m_data->Stores["ANNIEEvent"]->Get(RawDataName,rawData);
+
+    //The solution to the NNLS algorithm is 
+    //stored in a class defined in the DataModel. 
+    //Check out that class for more info.
+    map<int, NnlsSolution> soln;
+
+	if(rawData.empty())
+	{
+		m_data->Stores["ANNIEEvent"]->Set("nnls_solution", soln);
+		return true;
+	}
+
+	//rebuilds the nnls matrix only if the number of
+	//samples of the raw data differs from the last event
+	if(RawDataName != "RawLAPPDData")
+	{
+		SetSampleTimes(rawData.begin()->second.front().GetSamples()->size());
+	}
+
+    //***Assumes all waveforms are same number of samples
+    //a number of things in this tool would change if that
+    //were not the case
+
+    //the solution entries are created here, before the
+    //channels are handed out to the worker threads, which
+    //then only ever touch their own channel's entry
+    vector<const Waveform<double>*> signalwaves;
+    vector<NnlsSolution*> solutions;
+    for(map<int, vector<Waveform<double>>>::iterator itr = rawData.begin(); itr != rawData.end(); ++itr)
+    {
+    	int ch = itr->first; //channel of this waveform in the loop
+    	if(verbosity > 2) cout << "On channel " << ch << endl;
+
+    	//in the solution object, save the template
+    	//waveform for each channel in the map
+    	soln[ch].SetTemplate(tempwave, temptimes);
+
+    	//I've found that LAPPD has only first element
+    	//of the vector<Waveform<double>> component of the rawData
+    	//populated. Is this true with PMTs? If not, you will need 
+    	//another loop here. 
+    	signalwaves.push_back(&(itr->second.front()));
+    	solutions.push_back(&soln[ch]);
+    }
+
+    //channels are independent problems sharing the (read-only)
+    //template matrix. Each thread has its own workspace and picks
+    //the next unsolved channel until all are done. 
+    size_t nworkers = std::min(workspaces.size(), signalwaves.size());
+    std::atomic<size_t> nextchannel(0);
+    auto worker = [&](NNLSWorkspace* ws)
+    {
+    	for(size_t i = nextchannel++; i < signalwaves.size(); i = nextchannel++)
+    	{
+    		SolveChannel(ws, *signalwaves[i], solutions[i]);
+    	}
+    };
+
+    vector<std::thread> threads;
+    for(size_t w = 1; w < nworkers; w++) threads.emplace_back(worker, workspaces[w]);
+    worker(workspaces[0]);
+    for(size_t w = 0; w < threads.size(); w++) threads[w].join();
+
+
+    m_data->Stores["ANNIEEvent"]->Set("nnls_solution", soln);
+
+
+
+	return true;
+}
+
+//reads the template histogram from the root file and
+//resamples it at the nnls timestep. 
+bool WaveformNNLS::LoadTemplate()
+{
 	//get the template waveform. This assumes
 	//that the file is .root file with a TH1D
 	//named templatehistname
 	TFile* tempfile = new TFile(tempfilename, "READ");
-	TH1D* temphist = (TH1D*)tempfile->Get(temphistname);
-	Waveform<double> tempwave; //signal of template
-	vector<double> temptimes;  //times of template
+	TH1D* temphist = nullptr;
+	if(!tempfile->IsZombie()) temphist = (TH1D*)tempfile->Get(temphistname);
+	if(temphist == nullptr)
+	{
+		cout << "WaveformNNLS: could not read template " << temphistname << " from " << tempfilename << endl;
+		delete tempfile;
+		return false;
+	}
+
 	int nbins = temphist->GetNbinsX(); 
 	double binwidth = temphist->GetBinWidth(0); //should be in ns
 	double starttime = temphist->GetBinLowEdge(0); //first time in template histogram, used to set template to start at 0ps
@@ -95,22 +201,14 @@ bool WaveformNNLS::Execute(){
 	//raw data. Even if the raw data is sampled at a non-constant
 	//rate (for example, well calibrated LAPPD electronics), the raw
 	//waveform is re-sampled (not interpolated) at this new timestep
-	double newtimestep = binwidth*samplingFactor; //in ps
-
-	// check units and such
-	/*
-	cout << "nbins = " << nbins << endl;
-	cout << "binwidth = " << binwidth << endl;
-	cout << "start = " << starttime << endl;
-	cout << "endtime = " << endtime << endl;
-	cout << "newtimestep = " << newtimestep << endl;
-	*/
-	
+	newtimestep = binwidth*samplingFactor; //in ps
 
 	//fill the template waveform and time vectors 
 	//at a downsampled/upsampled time sampling using
 	//linear interpolation. Interpolation not necessary, it
 	//can just be re-sampled. One method may perform better than another
+	tempwave = Waveform<double>();
+	temptimes.clear();
 	for(double t = starttime; t <= endtime; t+=newtimestep)
 	{
 		tempwave.PushSample(temphist->Interpolate(t)); 
@@ -119,14 +217,22 @@ bool WaveformNNLS::Execute(){
 		temptimes.push_back((t - starttime)); 
 	}
 
+	tempfile->Close();
+	delete tempfile;
+
+	return true;
+}
+
+//It is necessary to make sure that the template
+//and the rawdata are on the same time-scale. 
+//This sets the timescale of the raw data and the
+//new signal times at the template timestep, and
+//(re)builds the matrix and the thread workspaces
+//if the number of rows changed.
+void WaveformNNLS::SetSampleTimes(size_t nsamples)
+{
+	vector<float> times;
 
-	//It is necessary to make sure that the template
-	//and the rawdata are on the same time-scale. 
-	//What follows is code to set the timescale of the
-	//raw data. It later is adjusted/resampled to match
-	//the template times. 
-	vector<float> sampletimes;
-    
 	//different data types will have different sample
 	//times. For example, LAPPDs will eventually have
 	//non-constant sampling rates and times associated with
@@ -142,101 +248,39 @@ bool WaveformNNLS::Execute(){
 	    double dt = (1.0/(256*40*1e6))*1e12; //ps
 	    for(int i = 0; i < 256; i++)
 	    {
-	    	sampletimes.push_back(i*dt);
+	    	times.push_back(i*dt);
 	    }
 	}
-	//default to avoid crashing
 	else
 	{
-		Waveform<double> example_waveform = rawData[0].front();
-		for(int i = 0; i < example_waveform.GetSamples()->size(); i++)
+		for(size_t i = 0; i < nsamples; i++)
 		{
-			sampletimes.push_back(i);
+			times.push_back(i);
 		}
 	}
 
+	if(A != nullptr && times == sampletimes) return;
+	sampletimes = times;
+
 	//create a new signal times list based on the 
 	//new timestep that was determined from the template.
 	//this is really only used to (1) return the time at which
 	//a solved nnls component waveform should appear in the rawdata
 	//and (2) to count the number of rows and columns in the nnls matrix
-	vector<double> newsignaltimes;
-	for(double t = sampletimes.front(); t <= sampletimes.back(); t+=newtimestep)
+	newsignaltimes.clear();
+	if(!sampletimes.empty())
 	{
-		newsignaltimes.push_back(t);
+		for(double t = sampletimes.front(); t <= sampletimes.back(); t+=newtimestep)
+		{
+			newsignaltimes.push_back(t);
+		}
 	}
 
 	//the number of rows for the matrix
 	//and the number of samples in the signal waveform
 	//is set to match the timesteps of the NEW template
-	//waveform and the signal waveform. Here, we get
-	//the signal waveform and expand it to that nrows sampling rate
-	map <int, vector<Waveform<double>>> :: iterator itr;
-    Waveform<double> signalwave; 
-    size_t nrows = newsignaltimes.size();
-    int flag; //error flag on nnls solver
-
-    cout << "doing a " << nrows << " x " << nrows << " = " << nrows*nrows << " matrix " << endl;
-
-    //***Assumes all waveforms are same number of samples
-    //a number of things in this tool would change if that
-    //were not the case
-
-    //initialize the main algebra variables
-    //for the nnls algo
-
-    //maximum number of nnls iterations
-	int maxiter;
-	m_variables.Get("maxiter", maxiter);
-
-    nnlsvector* b = new nnlsvector(nrows);
-    nnlsvector* x = new nnlsvector(nrows);
-    nnlsmatrix* A = new denseMatrix(nrows, nrows);
-    BuildTemplateMatrix(A, tempwave, nrows);
-
-    //The solution to the NNLS algorithm is 
-    //stored in a class defined in the DataModel. 
-    //Check out that class for more info.
-    map<int, NnlsSolution> soln;
-
-
-    for(itr = rawData.begin(); itr != rawData.end(); ++itr)
-    {
-    	int ch = itr->first; //channel of this waveform in the loop
-    	cout << "On channel " << ch << endl;
-
-    	//in the solution object, save the template
-    	//waveform for each channel in the map
-    	soln[ch].SetTemplate(tempwave, temptimes);
-
-
-    	//I've found that LAPPD has only first element
-    	//of the vector<Waveform<double>> component of the rawData
-    	//populated. Is this true with PMTs? If not, you will need 
-    	//another loop here. 
-    	signalwave = itr->second.front(); 
-    	
-		//pass the signal vector pointer that gets
-		//modified in the following function
-		BuildWaveformVector(b, signalwave, sampletimes, newtimestep);
-    	
-    	nnls* solver = new nnls(A, b, maxiter);
-    	flag = solver->optimize();
-    	if(flag < 0)
-    	{
-    		cout << "NNLS solver terminated with an error flag" << endl;
-    	}
-    	x = solver->getSolution();
-
-    	SaveNNLSOutput(&soln[ch], A, x, newsignaltimes);
-    }
-
-
-    m_data->Stores["ANNIEEvent"]->Set("nnls_solution", soln);
-
-
-
-	return true;
+	//waveform and the signal waveform. 
+	BuildTemplateMatrix(newsignaltimes.size());
 }
 
 //makes the nnls matrix A given a root template file. 
@@ -245,61 +289,76 @@ bool WaveformNNLS::Execute(){
 //Furthermore, to preserve conclusions about the resulting signals,
 //one needs to maintain that the signal and the template matrix
 //have the same time-step. The variable nrows is the number of rows in the end matrix, 
-//and is determined by the samplingFactor from Execute and the number of samples in the template. 
+//and is determined by the samplingFactor and the number of samples in the template. 
 //Both here and in BuildWaveformVector, the template and signal waveform
 //are over/undersampled to match timestamps and number of samples.
-void WaveformNNLS::BuildTemplateMatrix(nnlsmatrix* A, Waveform<double> tempwave, size_t nrows)
+void WaveformNNLS::BuildTemplateMatrix(size_t nrows)
 {
-
-	int temp_size = tempwave.GetSamples()->size();
-	
-
 	//the nnls matrix consists of:
 	//each row is a version of the template waveform
 	//inserted starting at a sample indexed by the column number. 
 	//the next column then has another template waveform inserted
 	//one sample further in time. The elements below the diagonal
 	//are 0, and any elements that are not part of the template
-	//are 0. 
-	for(int row = 0; row < nrows; row++)
+	//are 0. The matrix is therefore fully described by the template
+	//samples, and only those are stored (see toeplitzMatrix.h).
+	delete A;
+	A = new toeplitzMatrix(nrows, nrows, *(tempwave.GetSamples()));
+
+	if(verbosity > 0) cout << "WaveformNNLS: doing a " << nrows << " x " << nrows << " matrix with a template band of " << A->bandwidth() << " samples" << endl;
+
+	//one set of work vectors and one solver per thread
+	ClearWorkspaces();
+	for(int i = 0; i < nthreads; i++)
 	{
-		for(int col = 0; col < nrows; col++)
-		{
-			//elements below diagonal are zero
-			if(col < row)
-			{
-				A->set(row, col, 0.0);
-			}
-			//on the upper diagonal, the template
-			//waveform is written to a row, starting
-			//with the column = row
-			else if((col - row) < temp_size)
-			{
-				A->set(row, col, tempwave.GetSample(col - row));
-			}
-			//otherwise (outside bounds of template)
-			//set to 0. 
-			else {A->set(row, col, 0.0);}
-		}
+		NNLSWorkspace* ws = new NNLSWorkspace(nrows);
+		ws->solver.setData(A, &ws->b);
+		ws->solver.setMaxit(maxiter);
+		ws->solver.setVerbose(verbosity > 3);
+		workspaces.push_back(ws);
 	}
+}
 
+void WaveformNNLS::ClearWorkspaces()
+{
+	for(size_t i = 0; i < workspaces.size(); i++) delete workspaces[i];
+	workspaces.clear();
+}
 
-} 
+//solves one channel in the given workspace and stores the result
+void WaveformNNLS::SolveChannel(NNLSWorkspace* ws, const Waveform<double>& signalwave, NnlsSolution* soln)
+{
+	//pass the signal vector pointer that gets
+	//modified in the following function
+	BuildWaveformVector(&ws->b, signalwave, sampletimes, newtimestep);
+
+	int flag = ws->solver.optimize(); //error flag on nnls solver
+	if(flag < 0)
+	{
+		cout << "NNLS solver terminated with an error flag" << endl;
+	}
+
+	SaveNNLSOutput(soln, ws->solver.getSolution(), &ws->bsolv, newsignaltimes);
+}
 
 //formats the waveform into the vector format expected by nnls algo.
 //see comment above BuildTemplateMatrix for explanation of nrows
-void WaveformNNLS::BuildWaveformVector(nnlsvector* b, Waveform<double> wave, vector<float> times, double template_timestep)
+void WaveformNNLS::BuildWaveformVector(nnlsvector* b, const Waveform<double>& wave, const vector<float>& times, double template_timestep)
 {
 
 	//make a new signal vector that is
 	//NOT interpolated, but has more samples
 	// so that the timesteps of the template
-	// and signal waveform are equal. 
-	vector<double> newwave;
+	// and signal waveform are equal. Elements
+	// outside of the sampled time range are 0.
+	b->zeroOut();
+	if(times.size() < 2) return;
+
 	float t0;
 	float t1;
 	double current_time;
-	for(int j = 0; j < b->length(); j++)
+	size_t i = 0;
+	for(size_t j = 0; j < b->length(); j++)
 	{
 		//current time iterating through 
 		//times scaled for nnls matrix
@@ -307,8 +366,9 @@ void WaveformNNLS::BuildWaveformVector(nnlsvector* b, Waveform<double> wave, vec
 
 		//find value of waveform at this time by 
 		//finding closest sample times. Assumes the
-		//times vector is ordered
-		for(int i = 0; i < times.size() - 1; i++)
+		//times vector is ordered, so the search continues
+		//from the sample found for the previous time
+		for(; i < times.size() - 1; i++)
 		{
 			t0 = times.at(i);
 			t1 = times.at(i+1);
@@ -318,6 +378,7 @@ void WaveformNNLS::BuildWaveformVector(nnlsvector* b, Waveform<double> wave, vec
 				break;
 			}
 		}
+		if(i >= times.size() - 1) break;
 	}
 
 } 
@@ -329,15 +390,14 @@ void WaveformNNLS::BuildWaveformVector(nnlsvector* b, Waveform<double> wave, vec
 //Each element of x represents a template waveform scaled by
 //the magnitude of the element and placed at a time "t" 
 //(read off of the index of the element)
-void WaveformNNLS::SaveNNLSOutput(NnlsSolution* soln, nnlsmatrix* A, nnlsvector* x, vector<double> signaltimes)
+void WaveformNNLS::SaveNNLSOutput(NnlsSolution* soln, nnlsvector* x, nnlsvector* bsolv, const vector<double>& signaltimes)
 {
 
 	//first, the fully composed (full fit) solution
-	nnlsvector* bsolv = new nnlsvector(x->length());
 	A->dot(false, x, bsolv); //now bsolv is the fitted vector waveform
 	//turn vector into waveform
 	Waveform<double> ff; //waveform version of nnls full (summed) solution
-	for(int i = 0; i < bsolv->length(); i++)
+	for(size_t i = 0; i < bsolv->length(); i++)
 	{
 		ff.PushSample(bsolv->get(i));
 
@@ -366,5 +426,9 @@ void WaveformNNLS::SaveNNLSOutput(NnlsSolution* soln, nnlsmatrix* A, nnlsvector*
 
 bool WaveformNNLS::Finalise(){
 
+  ClearWorkspaces();
+  delete A;
+  A = nullptr;
+
   return true;
 }
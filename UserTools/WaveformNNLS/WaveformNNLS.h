@@ -3,7 +3,9 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
 #include "nnls.h"
+#include "toeplitzMatrix.h"
 
 #include <TFile.h>
 #include <TString.h>
@@ -21,17 +23,48 @@ class WaveformNNLS: public Tool {
   bool Initialise(std::string configfile,DataModel &data);
   bool Execute();
   bool Finalise();
-  void BuildTemplateMatrix(nnlsmatrix* A, Waveform<double> tempwave, size_t nrows); //makes the nnls matrix A given a root template file
-  void BuildWaveformVector(nnlsvector* b, Waveform<double> wave, vector<float> times, double template_timestep); //formats the waveform into the vector format expected by nnls algo
-  void SaveNNLSOutput(NnlsSolution* soln, nnlsmatrix* A, nnlsvector* x, vector<double> signaltimes);
+  bool LoadTemplate(); //reads the root template file and resamples it at the nnls timestep
+  void BuildTemplateMatrix(size_t nrows); //makes the banded nnls matrix A from the template waveform
+  void BuildWaveformVector(nnlsvector* b, const Waveform<double>& wave, const vector<float>& times, double template_timestep); //formats the waveform into the vector format expected by nnls algo
+  void SaveNNLSOutput(NnlsSolution* soln, nnlsvector* x, nnlsvector* bsolv, const vector<double>& signaltimes);
 
 
 
  private:
 
-
-
-
+  //per-thread work vectors and solver, kept between events
+  struct NNLSWorkspace {
+    NNLSWorkspace(size_t nrows) : b(nrows), bsolv(nrows) {}
+    nnlsvector b;      //resampled signal waveform
+    nnlsvector bsolv;  //full fit A*x
+    nnls solver;
+  };
+
+  void SetSampleTimes(size_t nsamples); //sample times of the raw data, (re)builds the matrix if they changed
+  void SolveChannel(NNLSWorkspace* ws, const Waveform<double>& signalwave, NnlsSolution* soln);
+  void ClearWorkspaces();
+
+  //configuration
+  std::string RawDataName;
+  double samplingFactor;
+  TString tempfilename;
+  TString temphistname;
+  int maxiter;
+  int nthreads;
+  int verbosity;
+
+  //template waveform at the nnls timestep, filled once in Initialise
+  Waveform<double> tempwave;
+  vector<double> temptimes;
+  double newtimestep;
+
+  //time axes of the raw data and of the nnls matrix
+  vector<float> sampletimes;
+  vector<double> newsignaltimes;
+
+  //banded template matrix, rebuilt only if the number of samples changes
+  toeplitzMatrix* A = nullptr;
+  std::vector<NNLSWorkspace*> workspaces;
 
 };
 
@@ -43,8 +43,10 @@ int nnls::optimize()
   double step;
   double *px = x->getData();
 
-  cerr << "Iter           Obj           ||g||" << endl;
-  cerr << "----------------------------------" << endl;
+  if (verbose) {
+    cerr << "Iter           Obj           ||g||" << endl;
+    cerr << "----------------------------------" << endl;
+  }
 
   while (!term) {
     out.iter++;
@@ -70,15 +72,15 @@ int nnls::optimize()
 
     computeObjGrad();
     // check the descent condition
-    if (out.iter % M == 0) {
+    if (out.iter >= M && out.iter % M == 0) { // obj(iter - M) must exist
       checkDescentUpdateBeta();
     }
-    if (out.iter % 10 == 0)
+    if (verbose && out.iter % 10 == 0)
       showStatus();
 
     //return 0;
   }
-  showStatus();
+  if (verbose) showStatus();
   cleanUp();
   return 0;
 }
@@ -201,36 +203,75 @@ void nnls::checkDescentUpdateBeta()
   }
 }
 
-int nnls::initialize()
+void nnls::init_()
 {
-  size_t n = A->ncols();
-  x = new nnlsvector(n);
-  g = new nnlsvector(n);
-  refx = new nnlsvector(n);
-  refg = new nnlsvector(n);
-  oldx = new nnlsvector(n);
-  oldg = new nnlsvector(n);
-  xdelta = new nnlsvector(n);
-  gdelta =  new nnlsvector(n);
-  out.memory += 8*n*sizeof(double);
-
-  ax = new nnlsvector(A->nrows());
-  out.memory += sizeof(double)*ax->length();
-
+  x = 0; x0 = 0; oldx = 0; g = 0; oldg = 0; xdelta = 0; gdelta = 0;
+  refx = 0; refg = 0; A = 0; b = 0; ax = 0; fset = 0; fssize = 0;
+  nalloc = 0; nrowsalloc = 0; italloc = -1;
+  out.obj = 0; out.time = 0; out.pgnorms = 0; out.iter = -1; out.memory = 0;
+  maxit = 0;
+  // convergence controlling parameters
+  M = 100; beta = 1.0; beta0 = 1.0; decay = 0.9; pgtol = 1e-3;  sigma = .01;
+  verbose = true;
+}
 
-  fset = (size_t*) malloc(sizeof(size_t)*n);
+nnls::~nnls()
+{
+  delete x; delete g; delete refx; delete refg;
+  delete oldx; delete oldg; delete xdelta; delete gdelta;
+  delete ax;
+  free(fset);
+  delete out.obj; delete out.pgnorms; delete out.time;
+}
 
-  out.memory += sizeof(size_t)*n;
+void nnls::allocate()
+{
+  size_t n = A->ncols();
+  if (n != nalloc) {
+    delete x; delete g; delete refx; delete refg;
+    delete oldx; delete oldg; delete xdelta; delete gdelta;
+    free(fset);
+    x = new nnlsvector(n);
+    g = new nnlsvector(n);
+    refx = new nnlsvector(n);
+    refg = new nnlsvector(n);
+    oldx = new nnlsvector(n);
+    oldg = new nnlsvector(n);
+    xdelta = new nnlsvector(n);
+    gdelta =  new nnlsvector(n);
+    fset = (size_t*) malloc(sizeof(size_t)*n);
+    nalloc = n;
+  } else {
+    // same size as the previous problem, start from clean vectors
+    g->zeroOut(); refx->zeroOut(); refg->zeroOut();
+    oldx->zeroOut(); oldg->zeroOut(); xdelta->zeroOut(); gdelta->zeroOut();
+  }
 
+  if (A->nrows() != nrowsalloc) {
+    delete ax;
+    ax = new nnlsvector(A->nrows());
+    nrowsalloc = A->nrows();
+  }
 
-  x->setAll(.5);
+  if (maxit != italloc) {
+    delete out.obj; delete out.pgnorms; delete out.time;
+    out.obj = new nnlsvector(maxit+1);
+    out.pgnorms = new nnlsvector(maxit+1);
+    out.time = new nnlsvector(maxit+1);
+    italloc = maxit;
+  }
 
-  out.obj = new nnlsvector(maxit+1);
-  out.pgnorms = new nnlsvector(maxit+1);
-  out.time = new nnlsvector(maxit+1);
+  out.memory = 8*n*sizeof(double) + sizeof(double)*ax->length()
+    + sizeof(size_t)*n + sizeof(double)*3*(maxit+1);
+}
 
-  out.memory += sizeof(double)*3*(maxit+1);
+int nnls::initialize()
+{
+  allocate();
+  out.iter = -1;
+  beta = beta0;
 
+  x->setAll(.5);
 
   if (x0) {
 
@@ -300,14 +341,9 @@ void nnls::showStatus()
   fprintf(stderr, "%05d\t %010E\t %010E\n", out.iter, out.obj->get(out.iter), out.npg);
 }
 
+// The work vectors are kept for the next call of optimize()
+// and released in the destructor
 int nnls::cleanUp()
 {
-  delete ax;
-  delete oldx;
-  delete oldg;
-  delete xdelta;
-  delete gdelta;
-  delete fset;
-  delete refx;
   return 0;
 }
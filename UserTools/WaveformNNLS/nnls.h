@@ -47,6 +47,13 @@ private:
   size_t* fset;               // fixed set 
   size_t fssize;              // sizeof fixed set
 
+  // Sizes of the allocated work vectors. The work vectors are kept
+  // between calls of optimize() and only reallocated if the problem
+  // size changes, so one solver can be reused for many right hand sides.
+  size_t nalloc;
+  size_t nrowsalloc;
+  int    italloc;
+
   // The parameters of the solver
 private:
   int maxit;               // maximum num. iters
@@ -55,6 +62,8 @@ private:
   double beta;                // diminishing scalar
   double pgtol;               // projected gradient tolerance
   double sigma;               // constant for descent condition
+  double beta0;               // starting value of beta for every optimize()
+  bool   verbose;             // print the iteration status to stderr
 
   // The solution and statistics variables
 private:
@@ -74,6 +83,8 @@ private:
   int    checkTermination();      // embodies various termination criteria
   void   showStatus();            // 
   int    cleanUp();               // memory deallocation and friends
+  void   allocate();              // (re)allocate the work vectors if the size changed
+  void   init_();                 // shared constructor code
   void   findFixedVariables();    // compute fixed set (binding set)
   void   computeXandGradDelta();  //  
   void   computeObjGrad();        // compute both together to sav time
@@ -83,19 +94,20 @@ private:
 
   // The actual interface to the world!
 public:
-  nnls() { x = 0; A = 0; b = 0; maxit = 0;}
+  nnls() { init_(); }
 
   nnls (nnlsmatrix* A, nnlsvector* b, int maxit) {
-    this->x = 0; this->A = A; this->b = b;
-    this->maxit = maxit; this->x0 = 0;
-    out.obj = 0; out.iter = -1; out.time = 0;
-    fset = 0; out.memory = 0;
-    // convergence controlling parameters
-    M = 100; beta = 1.0; decay = 0.9; pgtol = 1e-3;  sigma = .01;
+    init_();
+    this->A = A; this->b = b;
+    this->maxit = maxit;
   }
 
-  nnls (nnlsmatrix* A, nnlsvector* b, nnlsvector* x0, int maxit)  { nnls(A, b, maxit); this->x0 = x0;}
-  ~nnls(){beta = 0.0;}
+  nnls (nnlsmatrix* A, nnlsvector* b, nnlsvector* x0, int maxit)  {
+    init_();
+    this->A = A; this->b = b;
+    this->maxit = maxit; this->x0 = x0;
+  }
+  ~nnls();
 
   // The various accessors and mutators (or whatever one calls 'em!)
 
@@ -111,16 +123,21 @@ public:
 
   void  setDecay(double d) { decay = d;  }
   void  setM(int m)        { M = m;      }
-  void  setBeta(double b)  { beta = b;   }
+  void  setBeta(double b)  { beta = b; beta0 = b; }
   void  setPgTol(double pg){ pgtol = pg; }
   void  setMaxit(size_t m) { maxit = m;  }
   void  setSigma(double s) { sigma = s; }
+  void  setVerbose(bool v) { verbose = v; }
 
+  // Change the problem; the work vectors (and the solution returned
+  // by getSolution()) are reused if the size stays the same
   void  setData(nnlsmatrix* A, nnlsvector* b)  { this->A = A; this->b = b;}
+  void  setStart(nnlsvector* x0) { this->x0 = x0; }
 
   // The functions that actually launch the ship, and land it!
   int     optimize();
   int     saveStats(const char*fn);
   double  getOptimizationTime() { return out.time->get(out.iter);}
+  int     getIterations() const { return out.iter; }
 };
 #endif
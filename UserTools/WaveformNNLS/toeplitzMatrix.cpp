@@ -0,0 +1,103 @@
+// File: toeplitzMatrix.cc -- banded Toeplitz template matrix for WaveformNNLS
+
+#include "toeplitzMatrix.h"
+
+toeplitzMatrix::toeplitzMatrix() : nnlsmatrix(0, 0) {}
+
+toeplitzMatrix::toeplitzMatrix(size_t r, size_t c, const std::vector<double>& templ) : nnlsmatrix(r, c), band(templ)
+{
+  // the part of the template beyond the last column can never be reached
+  if (band.size() > c) band.resize(c);
+  memory = band.size()*sizeof(double);
+}
+
+toeplitzMatrix::~toeplitzMatrix() {}
+
+/// Returns 'r'-th row into pre-alloced nnlsvector
+int toeplitzMatrix::get_row (size_t i, nnlsvector*& v)
+{
+  if (i >= nrows() || v->length() < ncols()) return -1;
+  v->zeroOut();
+  double* pv = v->getData();
+  for (size_t k = 0; k < band.size() && i + k < ncols(); k++)
+    pv[i + k] = band[k];
+  return 0;
+}
+
+/// Returns 'c'-th col into pre-alloced nnlsvector
+int toeplitzMatrix::get_col (size_t j, nnlsvector*& c)
+{
+  if (j >= ncols() || c->length() < nrows()) return -1;
+  c->zeroOut();
+  double* pc = c->getData();
+  for (size_t k = 0; k < band.size() && k <= j; k++)
+    if (j - k < nrows()) pc[j - k] = band[k];
+  return 0;
+}
+
+/// Returns main or second diagonal (if p == true)
+int toeplitzMatrix::get_diag(bool p, nnlsvector*& d)
+{
+  size_t k = p ? 1 : 0;
+  double val = (k < band.size()) ? band[k] : 0.0;
+  size_t n = (nrows() < ncols()) ? nrows() : ncols();
+  if (p && n == ncols()) n--;
+  if (d->length() < n) return -1;
+  for (size_t i = 0; i < n; i++) d->set(i, val);
+  return 0;
+}
+
+/// r = a*row(i) + r
+int toeplitzMatrix::row_daxpy(size_t i, double a, nnlsvector* r)
+{
+  if (i >= nrows()) return -1;
+  double* pr = r->getData();
+  for (size_t k = 0; k < band.size() && i + k < ncols(); k++)
+    pr[i + k] += a*band[k];
+  return 0;
+}
+
+/// c = a*col(j) + c
+int toeplitzMatrix::col_daxpy(size_t j, double a, nnlsvector* c)
+{
+  if (j >= ncols()) return -1;
+  double* pc = c->getData();
+  for (size_t k = 0; k < band.size() && k <= j; k++)
+    if (j - k < nrows()) pc[j - k] += a*band[k];
+  return 0;
+}
+
+/// Let r := this * x or  this^T * x depending on tranA
+int toeplitzMatrix::dot (bool transp, nnlsvector* x, nnlsvector*r)
+{
+  double* pr = r->getData();
+  double* px = x->getData();
+  const double* pt = band.data();
+  const size_t nb = band.size();
+  const size_t m = nrows();
+  const size_t n = ncols();
+
+  if (!transp) {
+    // (A*x)_i = sum_k t_k x_{i+k}, ascending column like the dense product
+    for (size_t i = 0; i < m; i++) {
+      size_t kmax = (i < n) ? n - i : 0;
+      if (kmax > nb) kmax = nb;
+      const double* pxi = px + i;
+      double s = 0.0;
+      for (size_t k = 0; k < kmax; k++)
+        s += pt[k] * pxi[k];
+      pr[i] = s;
+    }
+  } else {
+    // (A'*x)_j = sum_i t_{j-i} x_i, ascending row like the dense product
+    for (size_t j = 0; j < n; j++) {
+      size_t i0 = (j + 1 > nb) ? j + 1 - nb : 0;
+      size_t i1 = (j < m) ? j + 1 : m;
+      double s = 0.0;
+      for (size_t i = i0; i < i1; i++)
+        s += pt[j - i] * px[i];
+      pr[j] = s;
+    }
+  }
+  return 0;
+}
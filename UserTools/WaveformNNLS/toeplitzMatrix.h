@@ -0,0 +1,79 @@
+// File: toeplitzMatrix.h -*- c++ -*-
+// Banded upper-triangular Toeplitz matrix for the WaveformNNLS template fit.
+
+// The template matrix of the NNLS fit has the template waveform t written
+// into every row, starting at the diagonal: A(i,j) = t[j-i] for
+// 0 <= j-i < t.length(), and 0 otherwise. Only the template samples are
+// stored, so the memory is O(ntemplate) instead of O(nrows*ncols), and the
+// products A*x and A'*x only loop over the band (O(nrows*ntemplate)).
+// The non-zero terms are summed in the same order as denseMatrix::dot,
+// so the solutions are identical to the dense version.
+// The matrix is read-only after construction, so one instance can be
+// shared by several solvers running in different threads.
+
+#ifndef toeplitzMatrix_H
+#define toeplitzMatrix_H
+
+#include <vector>
+#include "nnlsmatrix.h"
+
+class toeplitzMatrix : public nnlsmatrix {
+std::vector<double> band;   // template samples, band[k] = A(i,i+k)
+public:
+
+toeplitzMatrix();
+
+/// Create a rows x cols matrix with the given template on and above the diagonal
+toeplitzMatrix(size_t r, size_t c, const std::vector<double>& templ);
+
+~toeplitzMatrix();
+
+/// Not supported, the matrix is defined by its template
+int load(const char* fn, bool asbin) { return -1; }
+
+/// Number of stored band elements (template samples)
+size_t bandwidth() const { return band.size(); }
+
+/// Get the (i,j) entry of the matrix
+double operator()   (size_t i, size_t j) { return get(i, j); }
+
+/// Get the (i,j) entry of the matrix
+double get (size_t i, size_t j) { return (j >= i && j - i < band.size()) ? band[j - i] : 0.0; }
+
+/// Not supported, the matrix is read-only
+int set (size_t i, size_t j, double val) { return -1; }
+
+/// Returns 'r'-th row into pre-alloced nnlsvector
+int get_row (size_t, nnlsvector*&);
+/// Returns 'c'-th col into pre-alloced nnlsvector
+int get_col (size_t, nnlsvector*&);
+/// Returns main or second diagonal (if p == true)
+int get_diag(bool p, nnlsvector*& d);
+
+/// Not supported, the matrix is read-only
+int set_row(size_t r, nnlsvector*&) { return -1; }
+int set_col(size_t c, nnlsvector*&) { return -1; }
+int set_diag(bool p, nnlsvector*&) { return -1; }
+
+/// nnlsvector l_p norms for this matrix, p > 0
+double norm (double p) { return -1; }
+/// nnlsvector l_p norms, p is 'l1', 'l2', 'fro', 'inf'
+double norm (const char*  p) { return -1; }
+
+/// Not supported, the matrix is read-only
+int apply (double (* fn)(double)) { return -1; }
+int scale (double s) { return -1; }
+int add_const(double s) { return -1; }
+
+/// r = a*row(i) + r
+int row_daxpy(size_t i, double a, nnlsvector* r);
+/// c = a*col(j) + c
+int col_daxpy(size_t j, double a, nnlsvector* c);
+
+/// Let r := this * x or  this^T * x depending on tranA
+int dot (bool transp, nnlsvector* x, nnlsvector*r);
+
+size_t memoryUsage() { return band.size()*sizeof(double); }
+};
+
+#endif